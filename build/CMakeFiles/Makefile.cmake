@@ -0,0 +1,106 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "gkcpp-prefix/tmp/gkcpp-mkdirs.cmake"
+  "/root/repo/gklib/CMakeLists.txt"
+  "/root/repo/src/CMakeLists.txt"
+  "/root/repo/src/IR/CMakeLists.txt"
+  "/root/repo/src/ast/CMakeLists.txt"
+  "/root/repo/src/main/CMakeLists.txt"
+  "/root/repo/src/messages/CMakeLists.txt"
+  "/root/repo/src/parser/CMakeLists.txt"
+  "/root/repo/src/pass/CMakeLists.txt"
+  "/root/repo/src/visitast/CMakeLists.txt"
+  "/root/repo/src/visitir/CMakeLists.txt"
+  "/root/repo/third_party/CMakeLists.txt"
+  "/root/repo/third_party/fmt/CMakeLists.txt"
+  "/root/repo/third_party/fmt/support/cmake/JoinPaths.cmake"
+  "/root/repo/third_party/fmt/support/cmake/cxx14.cmake"
+  "/root/repo/third_party/utfcpp/CMakeLists.txt"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCheckCompilerFlagCommonPatterns.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeParseArguments.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCXXCompilerFlag.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCXXSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/ExternalProject.cmake"
+  "/usr/share/cmake-3.25/Modules/ExternalProject/RepositoryInfo.txt.in"
+  "/usr/share/cmake-3.25/Modules/ExternalProject/cfgcmd.txt.in"
+  "/usr/share/cmake-3.25/Modules/ExternalProject/mkdirs.cmake.in"
+  "/usr/share/cmake-3.25/Modules/GNUInstallDirs.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckCompilerFlag.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckFlagCommonConfig.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "gkcpp-prefix/tmp/gkcpp-mkdirs.cmake"
+  "gkcpp-prefix/src/gkcpp-stamp/gkcpp-source_dirinfo.txt"
+  "gkcpp-prefix/tmp/gkcpp-cfgcmd.txt"
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "gklib/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/ast/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/IR/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/main/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/messages/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/parser/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/pass/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/visitast/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/visitir/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "third_party/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "third_party/fmt/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "third_party/utfcpp/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "CMakeFiles/gkcpp.dir/DependInfo.cmake"
+  "CMakeFiles/parser.dir/DependInfo.cmake"
+  "CMakeFiles/lexer.dir/DependInfo.cmake"
+  "CMakeFiles/test.dir/DependInfo.cmake"
+  "gklib/CMakeFiles/gkcommon.dir/DependInfo.cmake"
+  "gklib/CMakeFiles/gkc23.dir/DependInfo.cmake"
+  "src/CMakeFiles/Ginkgo.dir/DependInfo.cmake"
+  "src/ast/CMakeFiles/ginkgo_ast.dir/DependInfo.cmake"
+  "src/IR/CMakeFiles/ginkgo_IR.dir/DependInfo.cmake"
+  "src/main/CMakeFiles/ginkgo_main.dir/DependInfo.cmake"
+  "src/messages/CMakeFiles/ginkgo_messages.dir/DependInfo.cmake"
+  "src/parser/CMakeFiles/ginkgo_parser.dir/DependInfo.cmake"
+  "src/pass/CMakeFiles/ginkgo_pass.dir/DependInfo.cmake"
+  "src/visitast/CMakeFiles/ginkgo_visitast.dir/DependInfo.cmake"
+  "src/visitir/CMakeFiles/ginkgo_visitir.dir/DependInfo.cmake"
+  "third_party/fmt/CMakeFiles/fmt.dir/DependInfo.cmake"
+  )
@@ -0,0 +1,16 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/gkcpp"
+  "CMakeFiles/gkcpp-complete"
+  "gkcpp-prefix/src/gkcpp-stamp/gkcpp-build"
+  "gkcpp-prefix/src/gkcpp-stamp/gkcpp-configure"
+  "gkcpp-prefix/src/gkcpp-stamp/gkcpp-download"
+  "gkcpp-prefix/src/gkcpp-stamp/gkcpp-install"
+  "gkcpp-prefix/src/gkcpp-stamp/gkcpp-mkdir"
+  "gkcpp-prefix/src/gkcpp-stamp/gkcpp-patch"
+  "gkcpp-prefix/src/gkcpp-stamp/gkcpp-update"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/gkcpp.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "/root/repo/src/parser/lexer.cc"
+  "CMakeFiles/lexer"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/lexer.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
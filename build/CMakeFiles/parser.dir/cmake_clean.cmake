@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "/root/repo/src/parser/yacc.cc"
+  "CMakeFiles/parser"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/parser.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,22 @@
+# Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+# file Copyright.txt or https://cmake.org/licensing for details.
+
+cmake_minimum_required(VERSION 3.5)
+
+file(MAKE_DIRECTORY
+  "/root/repo/gkcpp"
+  "/root/repo/build/gkcpp-prefix/src/gkcpp-build"
+  "/root/repo/build/gkcpp-prefix"
+  "/root/repo/build/gkcpp-prefix/tmp"
+  "/root/repo/build/gkcpp-prefix/src/gkcpp-stamp"
+  "/root/repo/build/gkcpp-prefix/src"
+  "/root/repo/build/gkcpp-prefix/src/gkcpp-stamp"
+)
+
+set(configSubDirs )
+foreach(subDir IN LISTS configSubDirs)
+    file(MAKE_DIRECTORY "/root/repo/build/gkcpp-prefix/src/gkcpp-stamp/${subDir}")
+endforeach()
+if(cfgdir)
+  file(MAKE_DIRECTORY "/root/repo/build/gkcpp-prefix/src/gkcpp-stamp${cfgdir}") # cfgdir has leading slash
+endif()
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "../lib/gkc23.a"
+  "../lib/gkc23.pdb"
+  "CMakeFiles/gkc23.dir/gkbit.c.o"
+  "CMakeFiles/gkc23.dir/gkbit.c.o.d"
+  "CMakeFiles/gkc23.dir/gkckdint.c.o"
+  "CMakeFiles/gkc23.dir/gkckdint.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/gkc23.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "../lib/gkcommon.a"
+  "../lib/gkcommon.pdb"
+  "CMakeFiles/gkcommon.dir/gkarg.c.o"
+  "CMakeFiles/gkcommon.dir/gkarg.c.o.d"
+  "CMakeFiles/gkcommon.dir/gkassert.c.o"
+  "CMakeFiles/gkcommon.dir/gkassert.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/gkcommon.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "../bin/Ginkgo"
+  "../bin/Ginkgo.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/Ginkgo.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,30 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/IR/IRBuilder.cc" "src/IR/CMakeFiles/ginkgo_IR.dir/IRBuilder.cc.o" "gcc" "src/IR/CMakeFiles/ginkgo_IR.dir/IRBuilder.cc.o.d"
+  "/root/repo/build/src/IR/CMakeFiles/ginkgo_IR.dir/cmake_pch.hxx" "src/IR/CMakeFiles/ginkgo_IR.dir/IRBuilder.cc.o" "gcc" "src/IR/CMakeFiles/ginkgo_IR.dir/IRBuilder.cc.o.d"
+  "/root/repo/src/IR/IROperand.cc" "src/IR/CMakeFiles/ginkgo_IR.dir/IROperand.cc.o" "gcc" "src/IR/CMakeFiles/ginkgo_IR.dir/IROperand.cc.o.d"
+  "/root/repo/build/src/IR/CMakeFiles/ginkgo_IR.dir/cmake_pch.hxx" "src/IR/CMakeFiles/ginkgo_IR.dir/IROperand.cc.o" "gcc" "src/IR/CMakeFiles/ginkgo_IR.dir/IROperand.cc.o.d"
+  "/root/repo/src/IR/IRType.cc" "src/IR/CMakeFiles/ginkgo_IR.dir/IRType.cc.o" "gcc" "src/IR/CMakeFiles/ginkgo_IR.dir/IRType.cc.o.d"
+  "/root/repo/build/src/IR/CMakeFiles/ginkgo_IR.dir/cmake_pch.hxx" "src/IR/CMakeFiles/ginkgo_IR.dir/IRType.cc.o" "gcc" "src/IR/CMakeFiles/ginkgo_IR.dir/IRType.cc.o.d"
+  "/root/repo/src/IR/Instr.cc" "src/IR/CMakeFiles/ginkgo_IR.dir/Instr.cc.o" "gcc" "src/IR/CMakeFiles/ginkgo_IR.dir/Instr.cc.o.d"
+  "/root/repo/build/src/IR/CMakeFiles/ginkgo_IR.dir/cmake_pch.hxx" "src/IR/CMakeFiles/ginkgo_IR.dir/Instr.cc.o" "gcc" "src/IR/CMakeFiles/ginkgo_IR.dir/Instr.cc.o.d"
+  "/root/repo/src/IR/Value.cc" "src/IR/CMakeFiles/ginkgo_IR.dir/Value.cc.o" "gcc" "src/IR/CMakeFiles/ginkgo_IR.dir/Value.cc.o.d"
+  "/root/repo/build/src/IR/CMakeFiles/ginkgo_IR.dir/cmake_pch.hxx" "src/IR/CMakeFiles/ginkgo_IR.dir/Value.cc.o" "gcc" "src/IR/CMakeFiles/ginkgo_IR.dir/Value.cc.o.d"
+  "/root/repo/build/src/IR/CMakeFiles/ginkgo_IR.dir/cmake_pch.hxx.cxx" "src/IR/CMakeFiles/ginkgo_IR.dir/cmake_pch.hxx.gch" "gcc" "src/IR/CMakeFiles/ginkgo_IR.dir/cmake_pch.hxx.gch.d"
+  "/root/repo/build/src/IR/CMakeFiles/ginkgo_IR.dir/cmake_pch.hxx" "src/IR/CMakeFiles/ginkgo_IR.dir/cmake_pch.hxx.gch" "gcc" "src/IR/CMakeFiles/ginkgo_IR.dir/cmake_pch.hxx.gch.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,19 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ginkgo_IR.dir/IRBuilder.cc.o"
+  "CMakeFiles/ginkgo_IR.dir/IRBuilder.cc.o.d"
+  "CMakeFiles/ginkgo_IR.dir/IROperand.cc.o"
+  "CMakeFiles/ginkgo_IR.dir/IROperand.cc.o.d"
+  "CMakeFiles/ginkgo_IR.dir/IRType.cc.o"
+  "CMakeFiles/ginkgo_IR.dir/IRType.cc.o.d"
+  "CMakeFiles/ginkgo_IR.dir/Instr.cc.o"
+  "CMakeFiles/ginkgo_IR.dir/Instr.cc.o.d"
+  "CMakeFiles/ginkgo_IR.dir/Value.cc.o"
+  "CMakeFiles/ginkgo_IR.dir/Value.cc.o.d"
+  "CMakeFiles/ginkgo_IR.dir/cmake_pch.hxx.gch"
+  "CMakeFiles/ginkgo_IR.dir/cmake_pch.hxx.gch.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ginkgo_IR.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
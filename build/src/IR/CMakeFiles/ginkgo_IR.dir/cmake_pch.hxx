@@ -0,0 +1,10 @@
+/* generated by CMake */
+
+#pragma GCC system_header
+#ifdef __cplusplus
+#include "/root/repo/src/IR/Instr.h"
+#include "/root/repo/src/IR/IRBuilder.h"
+#include "/root/repo/src/IR/IROperand.h"
+#include "/root/repo/src/IR/IRType.h"
+#include "/root/repo/src/IR/Value.h"
+#endif // __cplusplus
@@ -0,0 +1,28 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/ast/CType.cc" "src/ast/CMakeFiles/ginkgo_ast.dir/CType.cc.o" "gcc" "src/ast/CMakeFiles/ginkgo_ast.dir/CType.cc.o.d"
+  "/root/repo/build/src/ast/CMakeFiles/ginkgo_ast.dir/cmake_pch.hxx" "src/ast/CMakeFiles/ginkgo_ast.dir/CType.cc.o" "gcc" "src/ast/CMakeFiles/ginkgo_ast.dir/CType.cc.o.d"
+  "/root/repo/src/ast/Declaration.cc" "src/ast/CMakeFiles/ginkgo_ast.dir/Declaration.cc.o" "gcc" "src/ast/CMakeFiles/ginkgo_ast.dir/Declaration.cc.o.d"
+  "/root/repo/build/src/ast/CMakeFiles/ginkgo_ast.dir/cmake_pch.hxx" "src/ast/CMakeFiles/ginkgo_ast.dir/Declaration.cc.o" "gcc" "src/ast/CMakeFiles/ginkgo_ast.dir/Declaration.cc.o.d"
+  "/root/repo/src/ast/Expression.cc" "src/ast/CMakeFiles/ginkgo_ast.dir/Expression.cc.o" "gcc" "src/ast/CMakeFiles/ginkgo_ast.dir/Expression.cc.o.d"
+  "/root/repo/build/src/ast/CMakeFiles/ginkgo_ast.dir/cmake_pch.hxx" "src/ast/CMakeFiles/ginkgo_ast.dir/Expression.cc.o" "gcc" "src/ast/CMakeFiles/ginkgo_ast.dir/Expression.cc.o.d"
+  "/root/repo/src/ast/Statement.cc" "src/ast/CMakeFiles/ginkgo_ast.dir/Statement.cc.o" "gcc" "src/ast/CMakeFiles/ginkgo_ast.dir/Statement.cc.o.d"
+  "/root/repo/build/src/ast/CMakeFiles/ginkgo_ast.dir/cmake_pch.hxx" "src/ast/CMakeFiles/ginkgo_ast.dir/Statement.cc.o" "gcc" "src/ast/CMakeFiles/ginkgo_ast.dir/Statement.cc.o.d"
+  "/root/repo/build/src/ast/CMakeFiles/ginkgo_ast.dir/cmake_pch.hxx.cxx" "src/ast/CMakeFiles/ginkgo_ast.dir/cmake_pch.hxx.gch" "gcc" "src/ast/CMakeFiles/ginkgo_ast.dir/cmake_pch.hxx.gch.d"
+  "/root/repo/build/src/ast/CMakeFiles/ginkgo_ast.dir/cmake_pch.hxx" "src/ast/CMakeFiles/ginkgo_ast.dir/cmake_pch.hxx.gch" "gcc" "src/ast/CMakeFiles/ginkgo_ast.dir/cmake_pch.hxx.gch.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,17 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ginkgo_ast.dir/CType.cc.o"
+  "CMakeFiles/ginkgo_ast.dir/CType.cc.o.d"
+  "CMakeFiles/ginkgo_ast.dir/Declaration.cc.o"
+  "CMakeFiles/ginkgo_ast.dir/Declaration.cc.o.d"
+  "CMakeFiles/ginkgo_ast.dir/Expression.cc.o"
+  "CMakeFiles/ginkgo_ast.dir/Expression.cc.o.d"
+  "CMakeFiles/ginkgo_ast.dir/Statement.cc.o"
+  "CMakeFiles/ginkgo_ast.dir/Statement.cc.o.d"
+  "CMakeFiles/ginkgo_ast.dir/cmake_pch.hxx.gch"
+  "CMakeFiles/ginkgo_ast.dir/cmake_pch.hxx.gch.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ginkgo_ast.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
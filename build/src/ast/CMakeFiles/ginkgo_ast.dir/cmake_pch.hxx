@@ -0,0 +1,11 @@
+/* generated by CMake */
+
+#pragma GCC system_header
+#ifdef __cplusplus
+#include "/root/repo/src/ast/CType.h"
+#include "/root/repo/src/ast/Declaration.h"
+#include "/root/repo/src/ast/Expr.h"
+#include "/root/repo/src/ast/Expression.h"
+#include "/root/repo/src/ast/Statement.h"
+#include "/root/repo/src/ast/Tag.h"
+#endif // __cplusplus
@@ -0,0 +1,24 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/main/Driver.cc" "src/main/CMakeFiles/ginkgo_main.dir/Driver.cc.o" "gcc" "src/main/CMakeFiles/ginkgo_main.dir/Driver.cc.o.d"
+  "/root/repo/build/src/main/CMakeFiles/ginkgo_main.dir/cmake_pch.hxx" "src/main/CMakeFiles/ginkgo_main.dir/Driver.cc.o" "gcc" "src/main/CMakeFiles/ginkgo_main.dir/Driver.cc.o.d"
+  "/root/repo/build/src/main/CMakeFiles/ginkgo_main.dir/cmake_pch.hxx.cxx" "src/main/CMakeFiles/ginkgo_main.dir/cmake_pch.hxx.gch" "gcc" "src/main/CMakeFiles/ginkgo_main.dir/cmake_pch.hxx.gch.d"
+  "/root/repo/build/src/main/CMakeFiles/ginkgo_main.dir/cmake_pch.hxx" "src/main/CMakeFiles/ginkgo_main.dir/cmake_pch.hxx.gch" "gcc" "src/main/CMakeFiles/ginkgo_main.dir/cmake_pch.hxx.gch.d"
+  "/root/repo/src/main/main.cc" "src/main/CMakeFiles/ginkgo_main.dir/main.cc.o" "gcc" "src/main/CMakeFiles/ginkgo_main.dir/main.cc.o.d"
+  "/root/repo/build/src/main/CMakeFiles/ginkgo_main.dir/cmake_pch.hxx" "src/main/CMakeFiles/ginkgo_main.dir/main.cc.o" "gcc" "src/main/CMakeFiles/ginkgo_main.dir/main.cc.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
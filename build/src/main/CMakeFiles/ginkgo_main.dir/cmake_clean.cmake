@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ginkgo_main.dir/Driver.cc.o"
+  "CMakeFiles/ginkgo_main.dir/Driver.cc.o.d"
+  "CMakeFiles/ginkgo_main.dir/cmake_pch.hxx.gch"
+  "CMakeFiles/ginkgo_main.dir/cmake_pch.hxx.gch.d"
+  "CMakeFiles/ginkgo_main.dir/main.cc.o"
+  "CMakeFiles/ginkgo_main.dir/main.cc.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ginkgo_main.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
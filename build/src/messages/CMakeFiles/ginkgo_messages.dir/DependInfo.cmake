@@ -0,0 +1,24 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/messages/Error.cc" "src/messages/CMakeFiles/ginkgo_messages.dir/Error.cc.o" "gcc" "src/messages/CMakeFiles/ginkgo_messages.dir/Error.cc.o.d"
+  "/root/repo/build/src/messages/CMakeFiles/ginkgo_messages.dir/cmake_pch.hxx" "src/messages/CMakeFiles/ginkgo_messages.dir/Error.cc.o" "gcc" "src/messages/CMakeFiles/ginkgo_messages.dir/Error.cc.o.d"
+  "/root/repo/build/src/messages/CMakeFiles/ginkgo_messages.dir/cmake_pch.hxx.cxx" "src/messages/CMakeFiles/ginkgo_messages.dir/cmake_pch.hxx.gch" "gcc" "src/messages/CMakeFiles/ginkgo_messages.dir/cmake_pch.hxx.gch.d"
+  "/root/repo/build/src/messages/CMakeFiles/ginkgo_messages.dir/cmake_pch.hxx" "src/messages/CMakeFiles/ginkgo_messages.dir/cmake_pch.hxx.gch" "gcc" "src/messages/CMakeFiles/ginkgo_messages.dir/cmake_pch.hxx.gch.d"
+  "/root/repo/src/messages/errmsg-en_us.cc" "src/messages/CMakeFiles/ginkgo_messages.dir/errmsg-en_us.cc.o" "gcc" "src/messages/CMakeFiles/ginkgo_messages.dir/errmsg-en_us.cc.o.d"
+  "/root/repo/build/src/messages/CMakeFiles/ginkgo_messages.dir/cmake_pch.hxx" "src/messages/CMakeFiles/ginkgo_messages.dir/errmsg-en_us.cc.o" "gcc" "src/messages/CMakeFiles/ginkgo_messages.dir/errmsg-en_us.cc.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
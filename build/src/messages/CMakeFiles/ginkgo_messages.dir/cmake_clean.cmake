@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ginkgo_messages.dir/Error.cc.o"
+  "CMakeFiles/ginkgo_messages.dir/Error.cc.o.d"
+  "CMakeFiles/ginkgo_messages.dir/cmake_pch.hxx.gch"
+  "CMakeFiles/ginkgo_messages.dir/cmake_pch.hxx.gch.d"
+  "CMakeFiles/ginkgo_messages.dir/errmsg-en_us.cc.o"
+  "CMakeFiles/ginkgo_messages.dir/errmsg-en_us.cc.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ginkgo_messages.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,6 @@
+/* generated by CMake */
+
+#pragma GCC system_header
+#ifdef __cplusplus
+#include "/root/repo/src/messages/Error.h"
+#endif // __cplusplus
@@ -0,0 +1,24 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/build/src/parser/CMakeFiles/ginkgo_parser.dir/cmake_pch.hxx.cxx" "src/parser/CMakeFiles/ginkgo_parser.dir/cmake_pch.hxx.gch" "gcc" "src/parser/CMakeFiles/ginkgo_parser.dir/cmake_pch.hxx.gch.d"
+  "/root/repo/build/src/parser/CMakeFiles/ginkgo_parser.dir/cmake_pch.hxx" "src/parser/CMakeFiles/ginkgo_parser.dir/cmake_pch.hxx.gch" "gcc" "src/parser/CMakeFiles/ginkgo_parser.dir/cmake_pch.hxx.gch.d"
+  "/root/repo/src/parser/lexer.cc" "src/parser/CMakeFiles/ginkgo_parser.dir/lexer.cc.o" "gcc" "src/parser/CMakeFiles/ginkgo_parser.dir/lexer.cc.o.d"
+  "/root/repo/build/src/parser/CMakeFiles/ginkgo_parser.dir/cmake_pch.hxx" "src/parser/CMakeFiles/ginkgo_parser.dir/lexer.cc.o" "gcc" "src/parser/CMakeFiles/ginkgo_parser.dir/lexer.cc.o.d"
+  "/root/repo/src/parser/yacc.cc" "src/parser/CMakeFiles/ginkgo_parser.dir/yacc.cc.o" "gcc" "src/parser/CMakeFiles/ginkgo_parser.dir/yacc.cc.o.d"
+  "/root/repo/build/src/parser/CMakeFiles/ginkgo_parser.dir/cmake_pch.hxx" "src/parser/CMakeFiles/ginkgo_parser.dir/yacc.cc.o" "gcc" "src/parser/CMakeFiles/ginkgo_parser.dir/yacc.cc.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
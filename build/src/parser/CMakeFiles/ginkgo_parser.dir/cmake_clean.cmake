@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ginkgo_parser.dir/cmake_pch.hxx.gch"
+  "CMakeFiles/ginkgo_parser.dir/cmake_pch.hxx.gch.d"
+  "CMakeFiles/ginkgo_parser.dir/lexer.cc.o"
+  "CMakeFiles/ginkgo_parser.dir/lexer.cc.o.d"
+  "CMakeFiles/ginkgo_parser.dir/yacc.cc.o"
+  "CMakeFiles/ginkgo_parser.dir/yacc.cc.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ginkgo_parser.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
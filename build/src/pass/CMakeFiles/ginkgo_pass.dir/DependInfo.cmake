@@ -0,0 +1,60 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/pass/BlockLayout.cc" "src/pass/CMakeFiles/ginkgo_pass.dir/BlockLayout.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/BlockLayout.cc.o.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx" "src/pass/CMakeFiles/ginkgo_pass.dir/BlockLayout.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/BlockLayout.cc.o.d"
+  "/root/repo/src/pass/CallingGraph.cc" "src/pass/CMakeFiles/ginkgo_pass.dir/CallingGraph.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/CallingGraph.cc.o.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx" "src/pass/CMakeFiles/ginkgo_pass.dir/CallingGraph.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/CallingGraph.cc.o.d"
+  "/root/repo/src/pass/ColoringAlloc.cc" "src/pass/CMakeFiles/ginkgo_pass.dir/ColoringAlloc.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/ColoringAlloc.cc.o.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx" "src/pass/CMakeFiles/ginkgo_pass.dir/ColoringAlloc.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/ColoringAlloc.cc.o.d"
+  "/root/repo/src/pass/DCE.cc" "src/pass/CMakeFiles/ginkgo_pass.dir/DCE.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/DCE.cc.o.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx" "src/pass/CMakeFiles/ginkgo_pass.dir/DCE.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/DCE.cc.o.d"
+  "/root/repo/src/pass/DUInfo.cc" "src/pass/CMakeFiles/ginkgo_pass.dir/DUInfo.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/DUInfo.cc.o.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx" "src/pass/CMakeFiles/ginkgo_pass.dir/DUInfo.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/DUInfo.cc.o.d"
+  "/root/repo/src/pass/Dominators.cc" "src/pass/CMakeFiles/ginkgo_pass.dir/Dominators.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/Dominators.cc.o.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx" "src/pass/CMakeFiles/ginkgo_pass.dir/Dominators.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/Dominators.cc.o.d"
+  "/root/repo/src/pass/FlowGraph.cc" "src/pass/CMakeFiles/ginkgo_pass.dir/FlowGraph.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/FlowGraph.cc.o.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx" "src/pass/CMakeFiles/ginkgo_pass.dir/FlowGraph.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/FlowGraph.cc.o.d"
+  "/root/repo/src/pass/GVN.cc" "src/pass/CMakeFiles/ginkgo_pass.dir/GVN.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/GVN.cc.o.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx" "src/pass/CMakeFiles/ginkgo_pass.dir/GVN.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/GVN.cc.o.d"
+  "/root/repo/src/pass/IndVars.cc" "src/pass/CMakeFiles/ginkgo_pass.dir/IndVars.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/IndVars.cc.o.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx" "src/pass/CMakeFiles/ginkgo_pass.dir/IndVars.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/IndVars.cc.o.d"
+  "/root/repo/src/pass/Inliner.cc" "src/pass/CMakeFiles/ginkgo_pass.dir/Inliner.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/Inliner.cc.o.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx" "src/pass/CMakeFiles/ginkgo_pass.dir/Inliner.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/Inliner.cc.o.d"
+  "/root/repo/src/pass/LICM.cc" "src/pass/CMakeFiles/ginkgo_pass.dir/LICM.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/LICM.cc.o.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx" "src/pass/CMakeFiles/ginkgo_pass.dir/LICM.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/LICM.cc.o.d"
+  "/root/repo/src/pass/LinearScanAlloc.cc" "src/pass/CMakeFiles/ginkgo_pass.dir/LinearScanAlloc.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/LinearScanAlloc.cc.o.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx" "src/pass/CMakeFiles/ginkgo_pass.dir/LinearScanAlloc.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/LinearScanAlloc.cc.o.d"
+  "/root/repo/src/pass/Liveness.cc" "src/pass/CMakeFiles/ginkgo_pass.dir/Liveness.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/Liveness.cc.o.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx" "src/pass/CMakeFiles/ginkgo_pass.dir/Liveness.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/Liveness.cc.o.d"
+  "/root/repo/src/pass/LoopAnalyze.cc" "src/pass/CMakeFiles/ginkgo_pass.dir/LoopAnalyze.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/LoopAnalyze.cc.o.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx" "src/pass/CMakeFiles/ginkgo_pass.dir/LoopAnalyze.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/LoopAnalyze.cc.o.d"
+  "/root/repo/src/pass/Mem2Reg.cc" "src/pass/CMakeFiles/ginkgo_pass.dir/Mem2Reg.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/Mem2Reg.cc.o.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx" "src/pass/CMakeFiles/ginkgo_pass.dir/Mem2Reg.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/Mem2Reg.cc.o.d"
+  "/root/repo/src/pass/SCCP.cc" "src/pass/CMakeFiles/ginkgo_pass.dir/SCCP.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/SCCP.cc.o.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx" "src/pass/CMakeFiles/ginkgo_pass.dir/SCCP.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/SCCP.cc.o.d"
+  "/root/repo/src/pass/ShrinkWrap.cc" "src/pass/CMakeFiles/ginkgo_pass.dir/ShrinkWrap.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/ShrinkWrap.cc.o.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx" "src/pass/CMakeFiles/ginkgo_pass.dir/ShrinkWrap.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/ShrinkWrap.cc.o.d"
+  "/root/repo/src/pass/SimpleAlloc.cc" "src/pass/CMakeFiles/ginkgo_pass.dir/SimpleAlloc.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/SimpleAlloc.cc.o.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx" "src/pass/CMakeFiles/ginkgo_pass.dir/SimpleAlloc.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/SimpleAlloc.cc.o.d"
+  "/root/repo/src/pass/TailRecursion.cc" "src/pass/CMakeFiles/ginkgo_pass.dir/TailRecursion.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/TailRecursion.cc.o.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx" "src/pass/CMakeFiles/ginkgo_pass.dir/TailRecursion.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/TailRecursion.cc.o.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx.cxx" "src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx.gch" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx.gch.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx" "src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx.gch" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx.gch.d"
+  "/root/repo/src/pass/x64Alloc.cc" "src/pass/CMakeFiles/ginkgo_pass.dir/x64Alloc.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/x64Alloc.cc.o.d"
+  "/root/repo/build/src/pass/CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx" "src/pass/CMakeFiles/ginkgo_pass.dir/x64Alloc.cc.o" "gcc" "src/pass/CMakeFiles/ginkgo_pass.dir/x64Alloc.cc.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,49 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ginkgo_pass.dir/BlockLayout.cc.o"
+  "CMakeFiles/ginkgo_pass.dir/BlockLayout.cc.o.d"
+  "CMakeFiles/ginkgo_pass.dir/CallingGraph.cc.o"
+  "CMakeFiles/ginkgo_pass.dir/CallingGraph.cc.o.d"
+  "CMakeFiles/ginkgo_pass.dir/ColoringAlloc.cc.o"
+  "CMakeFiles/ginkgo_pass.dir/ColoringAlloc.cc.o.d"
+  "CMakeFiles/ginkgo_pass.dir/DCE.cc.o"
+  "CMakeFiles/ginkgo_pass.dir/DCE.cc.o.d"
+  "CMakeFiles/ginkgo_pass.dir/DUInfo.cc.o"
+  "CMakeFiles/ginkgo_pass.dir/DUInfo.cc.o.d"
+  "CMakeFiles/ginkgo_pass.dir/Dominators.cc.o"
+  "CMakeFiles/ginkgo_pass.dir/Dominators.cc.o.d"
+  "CMakeFiles/ginkgo_pass.dir/FlowGraph.cc.o"
+  "CMakeFiles/ginkgo_pass.dir/FlowGraph.cc.o.d"
+  "CMakeFiles/ginkgo_pass.dir/GVN.cc.o"
+  "CMakeFiles/ginkgo_pass.dir/GVN.cc.o.d"
+  "CMakeFiles/ginkgo_pass.dir/IndVars.cc.o"
+  "CMakeFiles/ginkgo_pass.dir/IndVars.cc.o.d"
+  "CMakeFiles/ginkgo_pass.dir/Inliner.cc.o"
+  "CMakeFiles/ginkgo_pass.dir/Inliner.cc.o.d"
+  "CMakeFiles/ginkgo_pass.dir/LICM.cc.o"
+  "CMakeFiles/ginkgo_pass.dir/LICM.cc.o.d"
+  "CMakeFiles/ginkgo_pass.dir/LinearScanAlloc.cc.o"
+  "CMakeFiles/ginkgo_pass.dir/LinearScanAlloc.cc.o.d"
+  "CMakeFiles/ginkgo_pass.dir/Liveness.cc.o"
+  "CMakeFiles/ginkgo_pass.dir/Liveness.cc.o.d"
+  "CMakeFiles/ginkgo_pass.dir/LoopAnalyze.cc.o"
+  "CMakeFiles/ginkgo_pass.dir/LoopAnalyze.cc.o.d"
+  "CMakeFiles/ginkgo_pass.dir/Mem2Reg.cc.o"
+  "CMakeFiles/ginkgo_pass.dir/Mem2Reg.cc.o.d"
+  "CMakeFiles/ginkgo_pass.dir/SCCP.cc.o"
+  "CMakeFiles/ginkgo_pass.dir/SCCP.cc.o.d"
+  "CMakeFiles/ginkgo_pass.dir/ShrinkWrap.cc.o"
+  "CMakeFiles/ginkgo_pass.dir/ShrinkWrap.cc.o.d"
+  "CMakeFiles/ginkgo_pass.dir/SimpleAlloc.cc.o"
+  "CMakeFiles/ginkgo_pass.dir/SimpleAlloc.cc.o.d"
+  "CMakeFiles/ginkgo_pass.dir/TailRecursion.cc.o"
+  "CMakeFiles/ginkgo_pass.dir/TailRecursion.cc.o.d"
+  "CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx.gch"
+  "CMakeFiles/ginkgo_pass.dir/cmake_pch.hxx.gch.d"
+  "CMakeFiles/ginkgo_pass.dir/x64Alloc.cc.o"
+  "CMakeFiles/ginkgo_pass.dir/x64Alloc.cc.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ginkgo_pass.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
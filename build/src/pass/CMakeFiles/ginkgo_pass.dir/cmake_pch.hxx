@@ -0,0 +1,27 @@
+/* generated by CMake */
+
+#pragma GCC system_header
+#ifdef __cplusplus
+#include "/root/repo/src/pass/BlockLayout.h"
+#include "/root/repo/src/pass/CallingGraph.h"
+#include "/root/repo/src/pass/ColoringAlloc.h"
+#include "/root/repo/src/pass/DCE.h"
+#include "/root/repo/src/pass/DUInfo.h"
+#include "/root/repo/src/pass/Dominators.h"
+#include "/root/repo/src/pass/FlowGraph.h"
+#include "/root/repo/src/pass/GVN.h"
+#include "/root/repo/src/pass/IndVars.h"
+#include "/root/repo/src/pass/Inliner.h"
+#include "/root/repo/src/pass/LICM.h"
+#include "/root/repo/src/pass/LinearScanAlloc.h"
+#include "/root/repo/src/pass/Liveness.h"
+#include "/root/repo/src/pass/LoopAnalyze.h"
+#include "/root/repo/src/pass/Mem2Reg.h"
+#include "/root/repo/src/pass/Pass.h"
+#include "/root/repo/src/pass/Pipeline.h"
+#include "/root/repo/src/pass/SCCP.h"
+#include "/root/repo/src/pass/ShrinkWrap.h"
+#include "/root/repo/src/pass/SimpleAlloc.h"
+#include "/root/repo/src/pass/TailRecursion.h"
+#include "/root/repo/src/pass/x64Alloc.h"
+#endif // __cplusplus
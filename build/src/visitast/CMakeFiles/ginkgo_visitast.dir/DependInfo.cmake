@@ -0,0 +1,30 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/visitast/CodeChk.cc" "src/visitast/CMakeFiles/ginkgo_visitast.dir/CodeChk.cc.o" "gcc" "src/visitast/CMakeFiles/ginkgo_visitast.dir/CodeChk.cc.o.d"
+  "/root/repo/build/src/visitast/CMakeFiles/ginkgo_visitast.dir/cmake_pch.hxx" "src/visitast/CMakeFiles/ginkgo_visitast.dir/CodeChk.cc.o" "gcc" "src/visitast/CMakeFiles/ginkgo_visitast.dir/CodeChk.cc.o.d"
+  "/root/repo/src/visitast/Evaluator.cc" "src/visitast/CMakeFiles/ginkgo_visitast.dir/Evaluator.cc.o" "gcc" "src/visitast/CMakeFiles/ginkgo_visitast.dir/Evaluator.cc.o.d"
+  "/root/repo/build/src/visitast/CMakeFiles/ginkgo_visitast.dir/cmake_pch.hxx" "src/visitast/CMakeFiles/ginkgo_visitast.dir/Evaluator.cc.o" "gcc" "src/visitast/CMakeFiles/ginkgo_visitast.dir/Evaluator.cc.o.d"
+  "/root/repo/src/visitast/IRGen.cc" "src/visitast/CMakeFiles/ginkgo_visitast.dir/IRGen.cc.o" "gcc" "src/visitast/CMakeFiles/ginkgo_visitast.dir/IRGen.cc.o.d"
+  "/root/repo/build/src/visitast/CMakeFiles/ginkgo_visitast.dir/cmake_pch.hxx" "src/visitast/CMakeFiles/ginkgo_visitast.dir/IRGen.cc.o" "gcc" "src/visitast/CMakeFiles/ginkgo_visitast.dir/IRGen.cc.o.d"
+  "/root/repo/src/visitast/Scope.cc" "src/visitast/CMakeFiles/ginkgo_visitast.dir/Scope.cc.o" "gcc" "src/visitast/CMakeFiles/ginkgo_visitast.dir/Scope.cc.o.d"
+  "/root/repo/build/src/visitast/CMakeFiles/ginkgo_visitast.dir/cmake_pch.hxx" "src/visitast/CMakeFiles/ginkgo_visitast.dir/Scope.cc.o" "gcc" "src/visitast/CMakeFiles/ginkgo_visitast.dir/Scope.cc.o.d"
+  "/root/repo/src/visitast/TypeBuilder.cc" "src/visitast/CMakeFiles/ginkgo_visitast.dir/TypeBuilder.cc.o" "gcc" "src/visitast/CMakeFiles/ginkgo_visitast.dir/TypeBuilder.cc.o.d"
+  "/root/repo/build/src/visitast/CMakeFiles/ginkgo_visitast.dir/cmake_pch.hxx" "src/visitast/CMakeFiles/ginkgo_visitast.dir/TypeBuilder.cc.o" "gcc" "src/visitast/CMakeFiles/ginkgo_visitast.dir/TypeBuilder.cc.o.d"
+  "/root/repo/build/src/visitast/CMakeFiles/ginkgo_visitast.dir/cmake_pch.hxx.cxx" "src/visitast/CMakeFiles/ginkgo_visitast.dir/cmake_pch.hxx.gch" "gcc" "src/visitast/CMakeFiles/ginkgo_visitast.dir/cmake_pch.hxx.gch.d"
+  "/root/repo/build/src/visitast/CMakeFiles/ginkgo_visitast.dir/cmake_pch.hxx" "src/visitast/CMakeFiles/ginkgo_visitast.dir/cmake_pch.hxx.gch" "gcc" "src/visitast/CMakeFiles/ginkgo_visitast.dir/cmake_pch.hxx.gch.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
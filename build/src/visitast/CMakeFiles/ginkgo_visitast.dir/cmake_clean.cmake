@@ -0,0 +1,19 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ginkgo_visitast.dir/CodeChk.cc.o"
+  "CMakeFiles/ginkgo_visitast.dir/CodeChk.cc.o.d"
+  "CMakeFiles/ginkgo_visitast.dir/Evaluator.cc.o"
+  "CMakeFiles/ginkgo_visitast.dir/Evaluator.cc.o.d"
+  "CMakeFiles/ginkgo_visitast.dir/IRGen.cc.o"
+  "CMakeFiles/ginkgo_visitast.dir/IRGen.cc.o.d"
+  "CMakeFiles/ginkgo_visitast.dir/Scope.cc.o"
+  "CMakeFiles/ginkgo_visitast.dir/Scope.cc.o.d"
+  "CMakeFiles/ginkgo_visitast.dir/TypeBuilder.cc.o"
+  "CMakeFiles/ginkgo_visitast.dir/TypeBuilder.cc.o.d"
+  "CMakeFiles/ginkgo_visitast.dir/cmake_pch.hxx.gch"
+  "CMakeFiles/ginkgo_visitast.dir/cmake_pch.hxx.gch.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ginkgo_visitast.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,12 @@
+/* generated by CMake */
+
+#pragma GCC system_header
+#ifdef __cplusplus
+#include "/root/repo/src/visitast/CodeChk.h"
+#include "/root/repo/src/visitast/Evaluator.h"
+#include "/root/repo/src/visitast/Identifier.h"
+#include "/root/repo/src/visitast/IRGen.h"
+#include "/root/repo/src/visitast/Scope.h"
+#include "/root/repo/src/visitast/ASTVisitor.h"
+#include "/root/repo/src/visitast/TypeBuilder.h"
+#endif // __cplusplus
@@ -0,0 +1,30 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/visitir/CodeGen.cc" "src/visitir/CMakeFiles/ginkgo_visitir.dir/CodeGen.cc.o" "gcc" "src/visitir/CMakeFiles/ginkgo_visitir.dir/CodeGen.cc.o.d"
+  "/root/repo/build/src/visitir/CMakeFiles/ginkgo_visitir.dir/cmake_pch.hxx" "src/visitir/CMakeFiles/ginkgo_visitir.dir/CodeGen.cc.o" "gcc" "src/visitir/CMakeFiles/ginkgo_visitir.dir/CodeGen.cc.o.d"
+  "/root/repo/src/visitir/EmitAsm.cc" "src/visitir/CMakeFiles/ginkgo_visitir.dir/EmitAsm.cc.o" "gcc" "src/visitir/CMakeFiles/ginkgo_visitir.dir/EmitAsm.cc.o.d"
+  "/root/repo/build/src/visitir/CMakeFiles/ginkgo_visitir.dir/cmake_pch.hxx" "src/visitir/CMakeFiles/ginkgo_visitir.dir/EmitAsm.cc.o" "gcc" "src/visitir/CMakeFiles/ginkgo_visitir.dir/EmitAsm.cc.o.d"
+  "/root/repo/src/visitir/Peephole.cc" "src/visitir/CMakeFiles/ginkgo_visitir.dir/Peephole.cc.o" "gcc" "src/visitir/CMakeFiles/ginkgo_visitir.dir/Peephole.cc.o.d"
+  "/root/repo/build/src/visitir/CMakeFiles/ginkgo_visitir.dir/cmake_pch.hxx" "src/visitir/CMakeFiles/ginkgo_visitir.dir/Peephole.cc.o" "gcc" "src/visitir/CMakeFiles/ginkgo_visitir.dir/Peephole.cc.o.d"
+  "/root/repo/src/visitir/SysVConv.cc" "src/visitir/CMakeFiles/ginkgo_visitir.dir/SysVConv.cc.o" "gcc" "src/visitir/CMakeFiles/ginkgo_visitir.dir/SysVConv.cc.o.d"
+  "/root/repo/build/src/visitir/CMakeFiles/ginkgo_visitir.dir/cmake_pch.hxx" "src/visitir/CMakeFiles/ginkgo_visitir.dir/SysVConv.cc.o" "gcc" "src/visitir/CMakeFiles/ginkgo_visitir.dir/SysVConv.cc.o.d"
+  "/root/repo/build/src/visitir/CMakeFiles/ginkgo_visitir.dir/cmake_pch.hxx.cxx" "src/visitir/CMakeFiles/ginkgo_visitir.dir/cmake_pch.hxx.gch" "gcc" "src/visitir/CMakeFiles/ginkgo_visitir.dir/cmake_pch.hxx.gch.d"
+  "/root/repo/build/src/visitir/CMakeFiles/ginkgo_visitir.dir/cmake_pch.hxx" "src/visitir/CMakeFiles/ginkgo_visitir.dir/cmake_pch.hxx.gch" "gcc" "src/visitir/CMakeFiles/ginkgo_visitir.dir/cmake_pch.hxx.gch.d"
+  "/root/repo/src/visitir/x64.cc" "src/visitir/CMakeFiles/ginkgo_visitir.dir/x64.cc.o" "gcc" "src/visitir/CMakeFiles/ginkgo_visitir.dir/x64.cc.o.d"
+  "/root/repo/build/src/visitir/CMakeFiles/ginkgo_visitir.dir/cmake_pch.hxx" "src/visitir/CMakeFiles/ginkgo_visitir.dir/x64.cc.o" "gcc" "src/visitir/CMakeFiles/ginkgo_visitir.dir/x64.cc.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
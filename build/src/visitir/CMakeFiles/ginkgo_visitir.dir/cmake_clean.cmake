@@ -0,0 +1,19 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ginkgo_visitir.dir/CodeGen.cc.o"
+  "CMakeFiles/ginkgo_visitir.dir/CodeGen.cc.o.d"
+  "CMakeFiles/ginkgo_visitir.dir/EmitAsm.cc.o"
+  "CMakeFiles/ginkgo_visitir.dir/EmitAsm.cc.o.d"
+  "CMakeFiles/ginkgo_visitir.dir/Peephole.cc.o"
+  "CMakeFiles/ginkgo_visitir.dir/Peephole.cc.o.d"
+  "CMakeFiles/ginkgo_visitir.dir/SysVConv.cc.o"
+  "CMakeFiles/ginkgo_visitir.dir/SysVConv.cc.o.d"
+  "CMakeFiles/ginkgo_visitir.dir/cmake_pch.hxx.gch"
+  "CMakeFiles/ginkgo_visitir.dir/cmake_pch.hxx.gch.d"
+  "CMakeFiles/ginkgo_visitir.dir/x64.cc.o"
+  "CMakeFiles/ginkgo_visitir.dir/x64.cc.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ginkgo_visitir.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,10 @@
+/* generated by CMake */
+
+#pragma GCC system_header
+#ifdef __cplusplus
+#include "/root/repo/src/visitir/CodeGen.h"
+#include "/root/repo/src/visitir/EmitAsm.h"
+#include "/root/repo/src/visitir/IRVisitor.h"
+#include "/root/repo/src/visitir/Peephole.h"
+#include "/root/repo/src/visitir/SysVConv.h"
+#endif // __cplusplus
@@ -2,40 +2,28 @@
 #include "IR/IROperand.h"
 #include "IR/IRType.h"
 #include "IR/Value.h"
-#include <memory>
 
 
 void BlockBuilder::InsertBasicBlock(const std::string& name)
 {
-    auto bb = std::make_unique<BasicBlock>(name);
-    Insert(std::move(bb));
+    Insert(Container()->Make<BasicBlock>(name));
 }
 
 BasicBlock* BlockBuilder::GetBasicBlock(const std::string& name)
 {
-    auto bb = std::make_unique<BasicBlock>(name);
-    auto pbb = bb.get();
-    Insert(std::move(bb));
-    return pbb;
+    auto bb = Container()->Make<BasicBlock>(name);
+    Insert(bb);
+    return bb;
 }
 
+// A block removed keeps its operands alive, as the function owns them.
 void BlockBuilder::PopBack()
 {
-    if (InsertPoint() != Container()->begin())
-        (*(InsertPoint() - 2))->MergePools(*(InsertPoint() - 1));
     Remove();
 }
 
 void BlockBuilder::RemoveBlk(BasicBlock* bb)
 {
-    auto index = Container()->IndexOf(bb);
-    if (Container()->Size() != 1)
-    {
-        if (index == Container()->Size() - 1) // end of function
-            Container()->At(index - 1)->MergePools(bb);
-        else Container()->At(index + 1)->MergePools(bb);
-    }
-
     Remove(bb);
 }
 
@@ -57,25 +45,25 @@ void InstrBuilder::MatchArithmType(
                 param = integer->Val();
 
             val = FloatConst::CreateFloatConst(
-                Container(), param, target->As<FloatType>());
+                Func(), param, target->As<FloatType>());
         }
         else if (target->Is<IntType>() && val->Type()->Is<FloatType>())
         {
             auto floatpoint = static_cast<const FloatConst*>(val);
             val = IntConst::CreateIntConst(
-                Container(), floatpoint->Val(), target->As<IntType>());
+                Func(), floatpoint->Val(), target->As<IntType>());
         }
         else if (target->Is<FloatType>())
         {
             auto floatpoint = static_cast<const FloatConst*>(val);
             val = FloatConst::CreateFloatConst(
-                Container(), floatpoint->Val(), target->As<FloatType>());
+                Func(), floatpoint->Val(), target->As<FloatType>());
         }
         else
         {
             auto integer = static_cast<const IntConst*>(val);
             val = IntConst::CreateIntConst(
-                Container(), integer->Val(), target->As<IntType>());
+                Func(), integer->Val(), target->As<IntType>());
         }
         return;
     }
@@ -141,35 +129,30 @@ void InstrBuilder::MatchArithmType(
 
 void InstrBuilder::InsertRetInstr()
 {
-    auto pret = std::make_unique<RetInstr>();
-    Insert(std::move(pret));
+    Insert(Make<RetInstr>());
 }
 
 void InstrBuilder::InsertRetInstr(const IROperand* val)
 {
-    auto pret = std::make_unique<RetInstr>(val);
-    Insert(std::move(pret));
+    Insert(Make<RetInstr>(val));
 }
 
 
 void InstrBuilder::InsertBrInstr(const BasicBlock* label)
 {
-    auto pbr = std::make_unique<BrInstr>(label);
-    Insert(std::move(pbr));
+    Insert(Make<BrInstr>(label));
 }
 
 void InstrBuilder::InsertBrInstr(const IROperand* cond,
     const BasicBlock* tblk, const BasicBlock* fblk)
 {
-    auto pbr = std::make_unique<BrInstr>(cond, tblk, fblk);
-    Insert(std::move(pbr));
+    Insert(Make<BrInstr>(cond, tblk, fblk));
 }
 
 
 void InstrBuilder::InsertSwitchInstr(const IROperand* ident)
 {
-    auto pswitch = std::make_unique<SwitchInstr>(ident);
-    Insert(std::move(pswitch));
+    Insert(Make<SwitchInstr>(ident));
 }
 
 
@@ -177,8 +160,8 @@ const Register* InstrBuilder::InsertCallInstr(
     const std::string& result, const FuncType* proto, const std::string& func)
 {
     auto preg = result.empty() ?
-        nullptr : Register::CreateRegister((Container()), result, proto->ReturnType());
-    Insert(std::make_unique<CallInstr>(preg, proto, func));
+        nullptr : Register::CreateRegister(Func(), result, proto->ReturnType());
+    Insert(Make<CallInstr>(preg, proto, func));
     return preg;
 }
 
@@ -190,8 +173,8 @@ const Register* InstrBuilder::InsertCallInstr(
         Point2()->As<FuncType>()->ReturnType();
 
     auto preg = result.empty() ?
-        nullptr : Register::CreateRegister(Container(), result, rety);
-    Insert(std::make_unique<CallInstr>(preg, func));
+        nullptr : Register::CreateRegister(Func(), result, rety);
+    Insert(Make<CallInstr>(preg, func));
     return preg;
 }
 
@@ -205,8 +188,8 @@ const IROperand* InstrBuilder::InsertArithmCastInstr(const IRType* ty, const IRO
 
 #define INSERT_BINARY_INSTR(name)                                       \
 MatchArithmType(lhs, rhs);                                              \
-auto ans = Register::CreateRegister(Container(), result, lhs->Type());  \
-Insert(std::make_unique<name##Instr>(ans, lhs, rhs));                   \
+auto ans = Register::CreateRegister(Func(), result, lhs->Type());  \
+Insert(Make<name##Instr>(ans, lhs, rhs));                               \
 return ans;
 
 const Register* InstrBuilder::InsertAddInstr(const std::string& result,
@@ -245,43 +228,43 @@ const Register* InstrBuilder::InsertXorInstr(const std::string& result,
 
 const Register* InstrBuilder::InsertAllocaInstr(const std::string& result, const IRType* ty)
 {
-    auto ptrty = PtrType::GetPtrType(Container(), ty);
-    auto ans = Register::CreateRegister(Container(), result, ptrty);
-    Insert(std::make_unique<AllocaInstr>(ans, ty));
+    auto ptrty = PtrType::GetPtrType(Func(), ty);
+    auto ans = Register::CreateRegister(Func(), result, ptrty);
+    Insert(Make<AllocaInstr>(ans, ty));
     return ans;
 }
 
 const Register* InstrBuilder::InsertAllocaInstr(
     const std::string& result, const IRType* ty, size_t num)
 {
-    auto ptrty = PtrType::GetPtrType(Container(), ty);
-    auto ans = Register::CreateRegister(Container(), result, ptrty);
-    Insert(std::make_unique<AllocaInstr>(ans, ty, num));
+    auto ptrty = PtrType::GetPtrType(Func(), ty);
+    auto ans = Register::CreateRegister(Func(), result, ptrty);
+    Insert(Make<AllocaInstr>(ans, ty, num));
     return ans;
 }
 
 const Register* InstrBuilder::InsertAllocaInstr(
     const std::string& result, const IRType* ty, size_t num, size_t align)
 {
-    auto ptrty = PtrType::GetPtrType(Container(), ty);
-    auto ans = Register::CreateRegister(Container(), result, ptrty);
-    Insert(std::make_unique<AllocaInstr>(ans, ty, num, align));
+    auto ptrty = PtrType::GetPtrType(Func(), ty);
+    auto ans = Register::CreateRegister(Func(), result, ptrty);
+    Insert(Make<AllocaInstr>(ans, ty, num, align));
     return ans;
 }
 
 
 const Register* InstrBuilder::InsertLoadInstr(const std::string& result, const Register* ptr)
 {
-    auto ans = Register::CreateRegister(Container(), result, ptr->Type()->As<PtrType>()->Point2());
-    Insert(std::make_unique<LoadInstr>(ans, ptr));
+    auto ans = Register::CreateRegister(Func(), result, ptr->Type()->As<PtrType>()->Point2());
+    Insert(Make<LoadInstr>(ans, ptr));
     return ans;
 }
 
 const Register* InstrBuilder::InsertLoadInstr(
     const std::string& result, const Register* ptr, bool vol)
 {
-    auto ans = Register::CreateRegister(Container(), result, ptr->Type()->As<PtrType>()->Point2());
-    Insert(std::make_unique<LoadInstr>(ans, ptr, vol));
+    auto ans = Register::CreateRegister(Func(), result, ptr->Type()->As<PtrType>()->Point2());
+    Insert(Make<LoadInstr>(ans, ptr, vol));
     return ans;
 }
 
@@ -289,25 +272,23 @@ const Register* InstrBuilder::InsertLoadInstr(
 void InstrBuilder::InsertStoreInstr(const IROperand* val, const Register* ptr, bool vol)
 {
     MatchArithmType(ptr->Type()->As<PtrType>()->Point2(), val);
-    auto pstore = std::make_unique<StoreInstr>(val, ptr, vol);
-    Insert(std::move(pstore));
+    Insert(Make<StoreInstr>(val, ptr, vol));
 }
 
 
 const Register* InstrBuilder::InsertGetValInstr(
     const std::string& result, const Register* val, std::variant<const IROperand*, int> index)
 {
-    auto reg = Register::CreateRegister(Container(), result,
+    auto reg = Register::CreateRegister(Func(), result,
         val->Type()->As<HeterType>()->At(std::get<int>(index)).first);
-    Insert(std::move(std::make_unique<GetValInstr>(reg, val, index)));
+    Insert(Make<GetValInstr>(reg, val, index));
     return reg;
 }
 
 void InstrBuilder::InsertSetValInstr(
     const IROperand* newval, const Register* val, std::variant<const IROperand*, int> index)
 {
-    auto psetval = std::make_unique<SetValInstr>(newval, val, index);
-    Insert(std::move(psetval));
+    Insert(Make<SetValInstr>(newval, val, index));
 }
 
 const Register* InstrBuilder::InsertGetElePtrInstr(const std::string& result,
@@ -317,18 +298,18 @@ const Register* InstrBuilder::InsertGetElePtrInstr(const std::string& result,
     const IRType* rety = nullptr;
 
     if (point2->Is<ArrayType>() && inner)
-        rety = PtrType::GetPtrType(Container(), point2->As<ArrayType>()->ArrayOf());
+        rety = PtrType::GetPtrType(Func(), point2->As<ArrayType>()->ArrayOf());
     else if (point2->Is<ArrayType>() /* && !inner*/)
         rety = val->Type();
     else if (point2->Is<HeterType>())
     {
-        rety = PtrType::GetPtrType(Container(),
+        rety = PtrType::GetPtrType(Func(),
             point2->As<HeterType>()->At(std::get<int>(index)).first);
     }
     else
         rety = val->Type();
 
-    const auto* reg = Register::CreateRegister(Container(), result, rety);
+    const auto* reg = Register::CreateRegister(Func(), result, rety);
     if (index.index() == 0 && std::get<0>(index)->Type()->Size() != 8)
     {
         auto i = std::get<0>(index);
@@ -339,7 +320,7 @@ const Register* InstrBuilder::InsertGetElePtrInstr(const std::string& result,
         index = i;
     }
 
-    Insert(std::make_unique<GetElePtrInstr>(inner, reg, val, index));
+    Insert(Make<GetElePtrInstr>(inner, reg, val, index));
     return reg;
 }
 
@@ -347,96 +328,96 @@ const Register* InstrBuilder::InsertGetElePtrInstr(const std::string& result,
 const Register* InstrBuilder::InsertTruncInstr(
     const std::string& result, const IntType* ty, const Register* val)
 {
-    auto ans = Register::CreateRegister(Container(), result, ty);
-    Insert(std::make_unique<TruncInstr>(ans, ty, val));
+    auto ans = Register::CreateRegister(Func(), result, ty);
+    Insert(Make<TruncInstr>(ans, ty, val));
     return ans;
 }
 
 const Register* InstrBuilder::InsertFtruncInstr(
     const std::string& result, const FloatType* ty, const Register* val)
 {
-    auto ans = Register::CreateRegister(Container(), result, ty);
-    Insert(std::make_unique<FtruncInstr>(ans, ty, val));
+    auto ans = Register::CreateRegister(Func(), result, ty);
+    Insert(Make<FtruncInstr>(ans, ty, val));
     return ans;
 }
 
 const Register* InstrBuilder::InsertZextInstr(
     const std::string& result, const IntType* ty, const Register* val)
 {
-    auto ans = Register::CreateRegister(Container(), result, ty);
-    Insert(std::make_unique<ZextInstr>(ans, ty, val));
+    auto ans = Register::CreateRegister(Func(), result, ty);
+    Insert(Make<ZextInstr>(ans, ty, val));
     return ans;
 }
 
 const Register* InstrBuilder::InsertSextInstr(
     const std::string& result, const IntType* ty, const Register* val)
 {
-    auto ans = Register::CreateRegister(Container(), result, ty);
-    Insert(std::make_unique<SextInstr>(ans, ty, val));
+    auto ans = Register::CreateRegister(Func(), result, ty);
+    Insert(Make<SextInstr>(ans, ty, val));
     return ans;
 }
 
 const Register* InstrBuilder::InsertFextInstr(
     const std::string& result, const FloatType* ty, const Register* val)
 {
-    auto ans = Register::CreateRegister(Container(), result, ty);
-    Insert(std::make_unique<FextInstr>(ans, ty, val));
+    auto ans = Register::CreateRegister(Func(), result, ty);
+    Insert(Make<FextInstr>(ans, ty, val));
     return ans;
 }
 
 const Register* InstrBuilder::InsertFtoUInstr(
     const std::string& result, const IntType* ty, const Register* val)
 {
-    auto ans = Register::CreateRegister(Container(), result, ty);
-    Insert(std::make_unique<FtoUInstr>(ans, ty, val));
+    auto ans = Register::CreateRegister(Func(), result, ty);
+    Insert(Make<FtoUInstr>(ans, ty, val));
     return ans;
 }
 
 const Register* InstrBuilder::InsertFtoSInstr(
     const std::string& result, const IntType* ty, const Register* val)
 {
-    auto ans = Register::CreateRegister(Container(), result, ty);
-    Insert(std::make_unique<FtoSInstr>(ans, ty, val));
+    auto ans = Register::CreateRegister(Func(), result, ty);
+    Insert(Make<FtoSInstr>(ans, ty, val));
     return ans;
 }
 
 const Register* InstrBuilder::InsertUtoFInstr(
     const std::string& result, const FloatType* ty, const Register* val)
 {
-    auto ans = Register::CreateRegister(Container(), result, ty);
-    Insert(std::make_unique<UtoFInstr>(ans, ty, val));
+    auto ans = Register::CreateRegister(Func(), result, ty);
+    Insert(Make<UtoFInstr>(ans, ty, val));
     return ans;
 }
 
 const Register* InstrBuilder::InsertStoFInstr(
     const std::string& result, const FloatType* ty, const Register* val)
 {
-    auto ans = Register::CreateRegister(Container(), result, ty);
-    Insert(std::make_unique<StoFInstr>(ans, ty, val));
+    auto ans = Register::CreateRegister(Func(), result, ty);
+    Insert(Make<StoFInstr>(ans, ty, val));
     return ans;
 }
 
 const Register* InstrBuilder::InsertPtrtoIInstr(
     const std::string& result, const IntType* ty, const Register* val)
 {
-    auto ans = Register::CreateRegister(Container(), result, ty);
-    Insert(std::make_unique<PtrtoIInstr>(ans, ty, val));
+    auto ans = Register::CreateRegister(Func(), result, ty);
+    Insert(Make<PtrtoIInstr>(ans, ty, val));
     return ans;
 }
 
 const Register* InstrBuilder::InsertItoPtrInstr(
-    const std::string& result, const PtrType* ty, const Register* val)
+    const std::string& result, const PtrType* ty, const IROperand* val)
 {
-    auto ans = Register::CreateRegister(Container(), result, ty);
-    Insert(std::make_unique<ItoPtrInstr>(ans, ty, val));
+    auto ans = Register::CreateRegister(Func(), result, ty);
+    Insert(Make<ItoPtrInstr>(ans, ty, val));
     return ans;
 }
 
 const Register* InstrBuilder::InsertBitcastInstr(
     const std::string& result, const IRType* ty, const Register* val)
 {
-    auto ans = Register::CreateRegister(Container(), result, ty);
-    Insert(std::make_unique<BitcastInstr>(ans, ty, val));
+    auto ans = Register::CreateRegister(Func(), result, ty);
+    Insert(Make<BitcastInstr>(ans, ty, val));
     return ans;
 }
 
@@ -454,16 +435,16 @@ const Register* InstrBuilder::InsertCmpInstr(
 const Register* InstrBuilder::InsertIcmpInstr(
     const std::string& result, Condition cond, const IROperand* lhs, const IROperand* rhs)
 {
-    auto ans = Register::CreateRegister(Container(), result, IntType::GetInt8(true));
-    Insert(std::make_unique<IcmpInstr>(ans, cond, lhs, rhs));
+    auto ans = Register::CreateRegister(Func(), result, IntType::GetInt8(true));
+    Insert(Make<IcmpInstr>(ans, cond, lhs, rhs));
     return ans;
 }
 
 const Register* InstrBuilder::InsertFcmpInstr(
     const std::string& result, Condition cond, const IROperand* lhs, const IROperand* rhs)
 {
-    auto ans = Register::CreateRegister(Container(), result, IntType::GetInt8(true));
-    Insert(std::make_unique<FcmpInstr>(ans, cond, lhs, rhs));
+    auto ans = Register::CreateRegister(Func(), result, IntType::GetInt8(true));
+    Insert(Make<FcmpInstr>(ans, cond, lhs, rhs));
     return ans;
 }
 
@@ -472,14 +453,14 @@ const Register* InstrBuilder::InsertSelectInstr(
     const std::string& result, const IROperand* selty,
     bool cond, const IROperand* lhs, const IROperand* rhs)
 {
-    auto ans = Register::CreateRegister(Container(), result, lhs->Type());
-    Insert(std::make_unique<SelectInstr>(ans, selty, cond, lhs, rhs));
+    auto ans = Register::CreateRegister(Func(), result, lhs->Type());
+    Insert(Make<SelectInstr>(ans, selty, cond, lhs, rhs));
     return ans;
 }
 
 const Register* InstrBuilder::InsertPhiInstr(const std::string& result, const IRType* ty)
 {
-    auto ans = Register::CreateRegister(Container(), result, ty);
-    Insert(std::make_unique<PhiInstr>(ans, ty));
+    auto ans = Register::CreateRegister(Func(), result, ty);
+    Insert(Make<PhiInstr>(ans, ty));
     return ans;
 }
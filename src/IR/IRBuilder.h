@@ -19,82 +19,56 @@ public:
     // Set the insert point to the end of a CNT.
     void SetInsertPoint(CNT* container)
     {
-        insertmode_ = InsertMode::end;
-        insertpoint_.container_ = container;
-        insertpoint_.index_ = container->Size();
+        container_ = container;
+        insertpoint_ = container->end();
     }
     // Equivalent to SetInsertPoint(current_container, element).
     void SetInsertPoint(ELE* element)
     {
-        insertmode_ = InsertMode::front;
-        insertpoint_.index_ = insertpoint_.container_->IndexOf(element);
+        insertpoint_ = container_->IterOf(element);
     }
     // Set the insert point to the front of a ELE in CNT.
     void SetInsertPoint(CNT* container, ELE* element)
     {
-        insertmode_ = InsertMode::front;
-        insertpoint_.container_ = container;
-        insertpoint_.index_ = container->IndexOf(element);
+        container_ = container;
+        insertpoint_ = container->IterOf(element);
     }
     // Set the insert point to a certain position.
-    // Suppose insertpoint_.container_ is already set.
+    // Suppose container_ is already set.
     void SetInsertPoint(typename CNT::IterType iter)
     {
-        insertmode_ = InsertMode::front;
-        insertpoint_.index_ = std::distance(insertpoint_.container_->begin(), iter);
+        insertpoint_ = iter;
     }
 
-    auto Container() { return insertpoint_.container_; }
-    auto InsertPoint()
-    {
-        return insertpoint_.container_->begin() +
-            insertpoint_.index_;
-    }
+    auto Container() { return container_; }
+    auto InsertPoint() { return insertpoint_; }
 
-    void Insert(std::unique_ptr<ELE> ele)
+    // Elements are inserted in front of the insert point, which keeps
+    // pointing at the same element, or the end, as they are inserted.
+    void Insert(ELE* ele)
     {
-        if (insertmode_ == InsertMode::end)
-            insertpoint_.container_->Append(std::move(ele));
-        else if (insertmode_ == InsertMode::front)
-            insertpoint_.container_->Insert(
-                insertpoint_.index_, std::move(ele));
-        insertpoint_.index_++;
+        container_->Insert(insertpoint_, ele);
     }
 
+    // Remove the element inserted last, i.e., the one before the insert point.
     void Remove()
     {
-        if (insertmode_ == InsertMode::end)
-        {
-            insertpoint_.container_->Remove();
-            insertpoint_.index_--;
-        }
-        else if (insertmode_ == InsertMode::front)
-            insertpoint_.container_->Remove(insertpoint_.index_);
+        container_->Remove(std::prev(insertpoint_));
     }
 
     void Remove(ELE* ele)
     {
-        auto index = insertpoint_.container_->IndexOf(ele);
-        insertpoint_.container_->Remove(index);
-        if (insertmode_ == InsertMode::end)
-            insertpoint_.index_--;
-        else if (insertmode_ == InsertMode::front &&
-            InsertPoint() == insertpoint_.container_->end())
-        {
-            insertpoint_.index_ = insertpoint_.container_->Size();
-            insertmode_ = InsertMode::end;
-        }
+        // the insert point moves on if it is the element
+        bool atpoint = *insertpoint_ == ele;
+        auto next = container_->Remove(ele);
+        if (atpoint)
+            insertpoint_ = next;
     }
 
 
 private:
-    enum class InsertMode { end, front };
-    InsertMode insertmode_{};
-    struct
-    {
-        CNT* container_{};
-        int index_{};
-    } insertpoint_;
+    CNT* container_{};
+    typename CNT::IterType insertpoint_{};
 };
 
 
@@ -113,6 +87,9 @@ class InstrBuilder : public IRBuilderBase<BasicBlock, Instr>
 {
 public:
     Instr* LastInstr() { return *std::prev(InsertPoint()); }
+    // Instructions, operands and types are allocated
+    // from the function of the current block.
+    Function* Func() { return Container()->Parent(); }
 
     void InsertRetInstr();
     void InsertRetInstr(const IROperand* val);
@@ -204,7 +181,7 @@ public:
     const Register* InsertPtrtoIInstr(
         const std::string& r, const IntType* t, const Register* v);
     const Register* InsertItoPtrInstr(
-        const std::string& r, const PtrType* t, const Register* v);
+        const std::string& r, const PtrType* t, const IROperand* v);
     const Register* InsertBitcastInstr(
         const std::string& r, const IRType* t, const Register* v);
 
@@ -222,6 +199,12 @@ public:
 
 
 private:
+    template <class I, class... Args>
+    I* Make(Args&&... args)
+    {
+        return Func()->template Make<I>(std::forward<Args>(args)...);
+    }
+
     void MatchArithmType(const IRType*, const IROperand*&);
     void MatchArithmType(const IROperand*&, const IROperand*&);
 };
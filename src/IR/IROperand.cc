@@ -1,4 +1,5 @@
 #include "IR/IROperand.h"
+#include "IR/Value.h"
 #include <climits>
 #include <cfloat>
 
@@ -16,10 +17,7 @@ IntConst* IntConst::CreateIntConst(Pool<IROperand>* pool, unsigned long ul)
 
 IntConst* IntConst::CreateIntConst(Pool<IROperand>* pool, unsigned long ul, const IntType* t)
 {
-    auto intconst = std::make_unique<IntConst>(ul, t);
-    auto raw = intconst.get();
-    pool->Add(std::move(intconst));
-    return raw;
+    return pool->Make<IntConst>(ul, t);
 }
 
 std::string IntConst::ToString() const
@@ -45,10 +43,7 @@ FloatConst* FloatConst::CreateFloatConst(Pool<IROperand>* pool, double d)
 
 FloatConst* FloatConst::CreateFloatConst(Pool<IROperand>* pool, double d, const FloatType* t)
 {
-    auto floatconst = std::make_unique<FloatConst>(d, t);
-    auto raw = floatconst.get();
-    pool->Add(std::move(floatconst));
-    return raw;
+    return pool->Make<FloatConst>(d, t);
 }
 
 std::string FloatConst::ToString() const
@@ -61,20 +56,20 @@ std::string FloatConst::ToString() const
 
 StrConst* StrConst::CreateStrConst(Pool<IROperand>* pool, const std::string& str, const ArrayType* ty)
 {
-    auto strconst = std::make_unique<StrConst>(str, ty);
-    auto raw = strconst.get();
-    pool->Add(std::move(strconst));
-    return raw;
+    return pool->Make<StrConst>(str, ty);
 }
 
 
 Register* Register::CreateRegister(
     Pool<IROperand>* pool, const std::string& name, const IRType* ty)
 {
-    auto reg = std::make_unique<Register>(name, ty);
-    auto raw = reg.get();
-    pool->Add(std::move(reg));
-    return raw;
+    return pool->Make<Register>(name, ty);
+}
+
+Register* Register::CreateRegister(
+    Function* func, const std::string& name, const IRType* ty)
+{
+    return func->MakeRegister(name, ty);
 }
 
 std::string Register::ToString() const
@@ -8,6 +8,8 @@
 #include "utils/DynCast.h"
 #include "utils/Pool.h"
 
+class Function;
+
 
 class IROperand
 {
@@ -108,15 +110,22 @@ public:
     static bool ClassOf(const Register* const) { return true; }
     static bool ClassOf(const IROperand* const op) { return op->id_ == OpId::reg; }
 
+    // Registers of a function are made by it, and numbered. Those of
+    // the module, i.e., the addresses of globals, have no number.
     static Register* CreateRegister(Pool<IROperand>*, const std::string&, const IRType*);
+    static Register* CreateRegister(Function*, const std::string&, const IRType*);
     Register(const std::string& n, const IRType* t) :
         name_(n), IROperand(OpId::reg, t) {}
 
     std::string ToString() const override;
     std::string Name() const { return name_; }
+    // unique in the function, see Function::MakeRegister
+    size_t Number() const { return number_; }
 
 private:
+    friend class Function;
     std::string name_{};
+    size_t number_{ static_cast<size_t>(-1) };
 };
 
 #endif // _IROPERAND_H_
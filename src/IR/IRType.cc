@@ -39,11 +39,8 @@ const IntType* IntType::GetInt64(bool s)
     return &uint64;
 }
 
-#define GET_INT_HELPER(size)                            \
-auto ptr = std::make_unique<IntType>(size, align, s);   \
-auto raw = ptr.get();                                   \
-pool->Add(std::move(ptr));                              \
-return raw
+#define GET_INT_HELPER(size) \
+return pool->Make<IntType>(size, align, s)
 
 const IntType* IntType::GetInt8(Pool<IRType>* pool, size_t align, bool s) { GET_INT_HELPER(1); }
 const IntType* IntType::GetInt16(Pool<IRType>* pool, size_t align, bool s) { GET_INT_HELPER(2); }
@@ -63,11 +60,8 @@ const FloatType* FloatType::GetFloat64()
     return &float64;
 }
 
-#define GET_FLOAT_HELPER(size)                          \
-auto ptr = std::make_unique<FloatType>(size, align);    \
-auto raw = ptr.get();                                   \
-pool->Add(std::move(ptr));                              \
-return raw
+#define GET_FLOAT_HELPER(size) \
+return pool->Make<FloatType>(size, align)
 
 const FloatType* FloatType::GetFloat32(Pool<IRType>* pool, size_t align) { GET_FLOAT_HELPER(4); }
 const FloatType* FloatType::GetFloat64(Pool<IRType>* pool, size_t align) { GET_FLOAT_HELPER(8); }
@@ -78,10 +72,7 @@ const FloatType* FloatType::GetFloat64(Pool<IRType>* pool, size_t align) { GET_F
 FuncType* FuncType::GetFuncType(
     Pool<IRType>* pool, const IRType* retty, bool vol)
 {
-    auto ty = std::make_unique<FuncType>(retty, vol);
-    auto addr = ty.get();
-    pool->Add(std::move(ty));
-    return addr;
+    return pool->Make<FuncType>(retty, vol);
 }
 
 void FuncType::AddParam(const IRType* ty)
@@ -92,10 +83,7 @@ void FuncType::AddParam(const IRType* ty)
 
 PtrType* PtrType::GetPtrType(Pool<IRType>* pool, const IRType* point2)
 {
-    auto ty = std::make_unique<PtrType>(point2);
-    auto addr = ty.get();
-    pool->Add(std::move(ty));
-    return addr;
+    return pool->Make<PtrType>(point2);
 }
 
 PtrType* PtrType::GetPtrType(Pool<IRType>* pool, size_t align, const IRType* point2)
@@ -109,10 +97,7 @@ PtrType* PtrType::GetPtrType(Pool<IRType>* pool, size_t align, const IRType* poi
 ArrayType* ArrayType::GetArrayType(
     Pool<IRType>* pool, size_t count, const IRType* elety)
 {
-    auto ty = std::make_unique<ArrayType>(count, elety);
-    auto addr = ty.get();
-    pool->Add(std::move(ty));
-    return addr;
+    return pool->Make<ArrayType>(count, elety);
 }
 
 ArrayType* ArrayType::GetArrayType(
@@ -142,19 +127,13 @@ ArrayType::ArrayType(size_t count, size_t align, const IRType* t) :
 StructType* StructType::GetStructType(
     Pool<IRType>* pool, const std::string& name, size_t s, size_t a)
 {
-    auto ty = std::make_unique<StructType>(name, s, a);
-    auto addr = ty.get();
-    pool->Add(std::move(ty));
-    return addr;
+    return pool->Make<StructType>(name, s, a);
 }
 
 UnionType* UnionType::GetUnionType(
     Pool<IRType>* pool, const std::string& name, size_t s, size_t a)
 {
-    auto ty = std::make_unique<UnionType>(name, s, a);
-    auto addr = ty.get();
-    pool->Add(std::move(ty));
-    return addr;
+    return pool->Make<UnionType>(name, s, a);
 }
 
 bool IRType::operator<(const IRType& rhs) const
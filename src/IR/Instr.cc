@@ -5,6 +5,10 @@
 #include <cfloat>
 
 
+BasicBlock* Instr::Parent() { return Owner<BasicBlock, Instr>(); }
+const BasicBlock* Instr::Parent() const { return Owner<BasicBlock, Instr>(); }
+
+
 void OpNode::Accept(IRVisitor* v) { v->VisitNode(this); }
 std::string OpNode::ToString() const { return op_->ToString(); }
 const IRType* OpNode::Type() const { return op_->Type(); }
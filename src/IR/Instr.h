@@ -3,6 +3,7 @@
 
 #include "IR/IRType.h"
 #include "IR/IROperand.h"
+#include "utils/Container.h"
 #include "utils/DynCast.h"
 #include <memory>
 #include <string>
@@ -12,7 +13,7 @@ class BasicBlock;
 class IRVisitor;
 
 
-class Instr
+class Instr : public ContainerNode
 {
 public:
     enum class InstrId
@@ -34,8 +35,8 @@ public:
     static bool ClassOf(const Instr* const) { return true; }
     InstrId id_{};
 
-    static Instr* CreateInstr(BasicBlock*, std::unique_ptr<Instr>);
     Instr(InstrId instr) : id_(instr) {}
+    virtual ~Instr() {}
 
     virtual std::string ToString() const { return ""; }
     virtual void Accept(IRVisitor*) {}
@@ -43,6 +44,9 @@ public:
     ENABLE_IS;
     ENABLE_AS;
 
+    BasicBlock* Parent();
+    const BasicBlock* Parent() const;
+
     bool IsControlInstr() const 
     { 
         return id_ == InstrId::br ||
@@ -164,9 +168,11 @@ public:
     void Accept(IRVisitor*) override;
 
     void AddValueBlkPair(const IntConst* val, const BasicBlock* blk) { cases_.push_back({ val, blk }); }
+    auto& GetValueBlkPairs() { return cases_; }
     const auto& GetValueBlkPairs() const { return cases_; }
     void SetDefault(const BasicBlock* bb) { default_ = bb; }
     auto GetDefault() const { return default_; }
+    void SetIdent(const IROperand* i) { ident_ = i; }
     auto GetIdent() const { return ident_; }
 
 private:
@@ -191,10 +197,13 @@ public:
     void Accept(IRVisitor*) override;
 
     void AddArgv(const IROperand* argv) { arglist_.push_back(argv); }
+    auto& ArgvList() { return arglist_; }
     const auto& ArgvList() const { return arglist_; }
+    auto& Result() { return result_; }
     auto Result() const { return result_; }
     auto Proto() const { return proto_; }
     auto FuncName() const { return func_; }
+    auto& FuncAddr() { return funcaddr_; }
     auto FuncAddr() const { return funcaddr_; }
 
 private:
@@ -518,6 +527,7 @@ public:
     auto Value() const { return value_; }
     auto& Dest() { return pointer_; }
     auto Dest() const { return pointer_; }
+    auto Volatile() const { return volatile_; }
 
 private:
     const IROperand* value_{};
@@ -578,11 +588,14 @@ public:
 
     bool IsInner() const { return isinner_; }
 
+    auto& Result() { return result_; }
     auto Result() const { return result_; }
+    auto& Pointer() { return pointer_; }
     auto Pointer() const { return pointer_; }
 
     bool HoldsInt() const { return std::holds_alternative<int>(index_); }
     auto IntIndex() const { return std::get<1>(index_); }
+    auto& OpIndex() { return std::get<0>(index_); }
     auto OpIndex() const { return std::get<0>(index_); }
 
 private:
@@ -614,8 +627,15 @@ private:
 class ConvertInstr : public Instr
 {
 public:
+    static bool ClassOf(const ConvertInstr* const) { return true; }
+    static bool ClassOf(const Instr* const i)
+    {
+        return int(i->id_) >= int(InstrId::trunc) &&
+            int(i->id_) <= int(InstrId::bitcast);
+    }
+
     ConvertInstr(
-        InstrId id, const Register* r, const IRType* t, const Register* v
+        InstrId id, const Register* r, const IRType* t, const IROperand* v
     ) : Instr(id), result_(r), type_(t), value_(v) {}
 
     auto& Dest() { return result_; }
@@ -628,7 +648,7 @@ public:
 private:
     const Register* result_{};
     const IRType* type_{};
-    const Register* value_{};
+    const IROperand* value_{};
 };
 
 
@@ -790,7 +810,7 @@ public:
     static bool ClassOf(const Instr* const i) { return i->id_ == InstrId::itoptr; }
 
     ItoPtrInstr(
-        const Register* r, const PtrType* t, const Register* v
+        const Register* r, const PtrType* t, const IROperand* v
     ) : ConvertInstr(InstrId::itoptr, r, t, v) {}
 
     std::string ToString() const override;
@@ -836,8 +856,11 @@ public:
     void Accept(IRVisitor*) override;
 
     auto Cond() const { return cond_; }
+    auto& Op1() { return op1_; }
     auto Op1() const { return op1_; }
+    auto& Op2() { return op2_; }
     auto Op2() const { return op2_; }
+    auto& Result() { return result_; }
     auto Result() const { return result_; }
 
 private:
@@ -863,8 +886,11 @@ public:
     void Accept(IRVisitor*) override;
 
     auto Cond() const { return cond_; }
+    auto& Op1() { return op1_; }
     auto Op1() const { return op1_; }
+    auto& Op2() { return op2_; }
     auto Op2() const { return op2_; }
+    auto& Result() { return result_; }
     auto Result() const { return result_; }
 
 private:
@@ -923,7 +949,9 @@ public:
     void Accept(IRVisitor*) override;
 
     void AddBlockValPair(const BasicBlock*, const IROperand*);
+    auto& GetBlockValPair() { return labels_; }
     const auto& GetBlockValPair() const { return labels_; }
+    auto& Result() { return result_; }
     auto Result() const { return result_; }
 
 private:
@@ -15,48 +15,37 @@ void Module::Accept(IRVisitor* v)
     v->VisitModule(this);
 }
 
-Function* Module::AddFunc(std::unique_ptr<Function> func)
-{
-    auto pfunc = func.get();
-    Append(std::move(func));
-    symindex_.emplace(pfunc->Name(), Size() - 1);
-    return pfunc;
-}
-
 Function* Module::AddFunc(const std::string& name, const FuncType* functy)
 {
-    return AddFunc(std::make_unique<Function>(name, functy));
-}
-
-GlobalVar* Module::AddGlobalVar(std::unique_ptr<GlobalVar> var)
-{
-    auto pvar = var.get();
-    Append(std::move(var));
-    symindex_.emplace(pvar->Name(), Size() - 1);
-    return pvar;
+    auto func = Pool<Value>::Make<Function>(name, functy);
+    Append(func);
+    symbols_.emplace(name, func);
+    return func;
 }
 
 GlobalVar* Module::AddGlobalVar(const std::string& name, const IRType* ptype)
 {
-    return AddGlobalVar(std::make_unique<GlobalVar>(name, ptype));
+    auto var = Pool<Value>::Make<GlobalVar>(name, ptype);
+    Append(var);
+    symbols_.emplace(name, var);
+    return var;
 }
 
 Function* Module::GetFunction(const std::string& name)
 {
-    int index = symindex_.at(name);
-    return At(index)->As<Function>();
+    return symbols_.at(name)->As<Function>();
 }
 
 GlobalVar* Module::GetGlobalVar(const std::string& name)
 {
-    int index = symindex_.at(name);
-    return At(index)->As<GlobalVar>();
+    return symbols_.at(name)->As<GlobalVar>();
 }
 
 
 std::string Function::ToString() const
 {
     std::string func = "def " + ReturnType()->ToString() + ' ';
+    if (Static()) func += "static ";
     if (Inline()) func += "inline ";
     if (Noreturn()) func += "noreturn ";
     func += Name() + '(';
@@ -94,9 +83,8 @@ std::string Function::ToString() const
     else
     {
         func += " {\n";
-        for (auto i = elements_.begin(); i < elements_.end() - 1; ++i)
-            func += (*i)->ToString() + '\n';
-        func += elements_.back()->ToString() + '}';
+        for (auto bb : *this)
+            func += bb->ToString() + (bb == Back() ? "}" : "\n");
     }
 
     return func;
@@ -109,33 +97,56 @@ void Function::Accept(IRVisitor* v)
 
 BasicBlock* Function::GetBasicBlock(const std::string& name)
 {
-    for (auto& pbb : elements_)
-        if (name == pbb->Name())
-            return pbb.get();
+    for (auto bb : *this)
+        if (name == bb->Name())
+            return bb;
     return nullptr;
 }
 
-BasicBlock* Function::GetBasicBlock(int index)
+
+void Function::AddParam(const Register* r)
 {
-    if (index < 0)
-        return (elements_.end() + index)->get();
-    else
-        return elements_[index].get();
+    params_.push_back(r);
 }
 
+void Function::ReleaseBody()
+{
+    Container<BasicBlock>::Clear();
+    params_.clear();
+    registers_.clear();
+    returnvalue_ = nullptr;
+    Pool<Instr>::Clear();
+    Pool<BasicBlock>::Clear();
+    Pool<IROperand>::Clear();
+    Pool<IRType>::Clear();
+}
 
-void Function::AddParam(const Register* r)
+void Function::Append(BasicBlock* bb)
 {
-    params_.push_back(r);
+    if (bb->number_ >= numbers_)
+        bb->number_ = numbers_++;
+    Container<BasicBlock>::Append(bb);
+}
+
+Function::IterType Function::Insert(IterType pos, BasicBlock* bb)
+{
+    if (bb->number_ >= numbers_)
+        bb->number_ = numbers_++;
+    return Container<BasicBlock>::Insert(pos, bb);
+}
+
+Register* Function::MakeRegister(const std::string& name, const IRType* ty)
+{
+    auto reg = Pool<IROperand>::Make<Register>(name, ty);
+    reg->number_ = registers_.size();
+    registers_.push_back(reg);
+    return reg;
 }
 
 
 GlobalVar* GlobalVar::CreateGlobalVar(Module* mod, const std::string& name, const IRType* ty)
 {
-    auto var = std::make_unique<GlobalVar>(name, ty);
-    auto pvar = var.get();
-    mod->AddGlobalVar(std::move(var));
-    return pvar;
+    return mod->AddGlobalVar(name, ty);
 }
 
 std::string GlobalVar::ToString() const
@@ -156,18 +167,17 @@ void GlobalVar::Accept(IRVisitor* v)
 
 BasicBlock* BasicBlock::CreateBasicBlock(Function* func, const std::string& name)
 {
-    std::unique_ptr<BasicBlock> bb = std::make_unique<BasicBlock>(name);
-    auto raw = bb.get();
-    func->Append(std::move(bb));
-    return raw;
+    auto bb = func->Make<BasicBlock>(name);
+    func->Append(bb);
+    return bb;
 }
 
 std::string BasicBlock::ToString() const
 {
     std::string blk{};
     if (!Name().empty()) blk += Name() + ":\n";
-    for (auto i = elements_.begin(); i != elements_.end(); ++i)
-        blk += "  " + (*i)->ToString() + ";\n";
+    for (auto i : *this)
+        blk += "  " + i->ToString() + ";\n";
     return blk;
 }
 
@@ -175,9 +185,3 @@ void BasicBlock::Accept(IRVisitor* v)
 {
     v->VisitBasicBlock(this);
 }
-
-void BasicBlock::MergePools(BasicBlock* bb)
-{
-    Pool<IRType>::Merge(bb);
-    Pool<IROperand>::Merge(bb);
-}
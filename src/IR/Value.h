@@ -11,6 +11,7 @@
 #include <memory>
 #include <stack>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include <unordered_map>
 
@@ -19,7 +20,7 @@ class GlobalVar;
 class IRVisitor;
 
 
-class Value
+class Value : public ContainerNode
 {
 public:
     enum class ValueId { value, module, function, globalvar, basicblock };
@@ -44,8 +45,13 @@ private:
 };
 
 
+// Functions and global variables are allocated from the pool of values of
+// the module. The basic blocks, instructions, operands and types of a
+// function are allocated from the pools of the function, which releases
+// them once its code is emitted, see Function::ReleaseBody.
+
 class Module : public Value, public Container<Value>,
-               public Pool<IRType>, public Pool<IROperand>
+               public Pool<IRType>, public Pool<IROperand>, public Pool<Value>
 {
 public:
     static bool ClassOf(const Module* const) { return true; }
@@ -56,20 +62,20 @@ public:
     std::string ToString() const override;
     void Accept(IRVisitor*) override;
 
-    Function* AddFunc(std::unique_ptr<Function>);
     Function* AddFunc(const std::string&, const FuncType*);
-    GlobalVar* AddGlobalVar(std::unique_ptr<GlobalVar>);
     GlobalVar* AddGlobalVar(const std::string&, const IRType*);
     Function* GetFunction(const std::string&);
     GlobalVar* GetGlobalVar(const std::string&);
 
 
 private:
-    std::unordered_map<std::string, int> symindex_{};
+    std::unordered_map<std::string, Value*> symbols_{};
 };
 
 
-class Function : public Value, public Container<BasicBlock>
+class Function : public Value, public Container<BasicBlock>,
+                 public Pool<BasicBlock>, public Pool<Instr>,
+                 public Pool<IROperand>, public Pool<IRType>
 {
 public:
     static bool ClassOf(const Function* const) { return true; }
@@ -86,32 +92,70 @@ public:
     const auto Addr() const { return addr_; }
 
     BasicBlock* GetBasicBlock(const std::string&);
-    BasicBlock* GetBasicBlock(int);
     void AddParam(const Register*);
 
+    // Make a basic block or an instruction of this function.
+    template <class U, class... Args>
+    U* Make(Args&&... args)
+    {
+        if constexpr (std::is_base_of_v<Instr, U>)
+            return Pool<Instr>::Make<U>(std::forward<Args>(args)...);
+        else
+            return Pool<BasicBlock>::Make<U>(std::forward<Args>(args)...);
+    }
+
+    // Blocks are numbered when first added, and numbers are not reused,
+    // so analyses can keep tables indexed by them, of BlockNumbers() slots.
+    // A block released and put back keeps its number.
+    void Append(BasicBlock*);
+    IterType Insert(IterType, BasicBlock*);
+    size_t BlockNumbers() const { return numbers_; }
+
+    // Registers are numbered densely in the order they are made, so
+    // analyses can keep tables of RegNumbers() slots indexed by them,
+    // and get the registers back from Registers().
+    Register* MakeRegister(const std::string&, const IRType*);
+    size_t RegNumbers() const { return registers_.size(); }
+    const auto& Registers() const { return registers_; }
+
     auto Type() const { return functype_; }
     const auto& Params() const { return params_; }
     const auto& ParamType() const { return functype_->ParamType(); }
     const IRType* ReturnType() const { return functype_->ReturnType(); }
 
+    bool Static() const { return static_; }
+    bool& Static() { return static_; }
     bool Inline() const { return inline_; }
     bool& Inline() { return inline_; }
     bool Noreturn() const { return noreturn_; }
     bool& Noreturn() { return noreturn_; }
     bool Variadic() const { return functype_->Variadic(); }
+    // Static local variables are allocated on the stack
+    // for now, so the function can't be duplicated.
+    bool StaticVar() const { return staticvar_; }
+    bool& StaticVar() { return staticvar_; }
 
     auto ReturnValue() const { return returnvalue_; }
     auto& ReturnValue() { return returnvalue_; }
 
+    // Copies of a function inlined into others share its
+    // constants and types, so its body has to be kept.
+    bool Inlined() const { return inlined_; }
+    bool& Inlined() { return inlined_; }
+    // Release the body, leaving a declaration of the function.
+    void ReleaseBody();
+
 
 private:
     const Register* addr_{};
 
-    bool inline_{}, noreturn_{};
+    bool static_{}, inline_{}, noreturn_{}, staticvar_{}, inlined_{};
 
     const Register* returnvalue_{};
     const FuncType* functype_{};
     std::vector<const Register*> params_{};
+    size_t numbers_{};
+    std::vector<const Register*> registers_{};
 };
 
 
@@ -142,8 +186,7 @@ private:
 };
 
 
-class BasicBlock : public Value, public Container<Instr>,
-                   public Pool<IROperand>, public Pool<IRType>
+class BasicBlock : public Value, public Container<Instr>
 {
 public:
     static bool ClassOf(const BasicBlock* const) { return true; }
@@ -158,7 +201,14 @@ public:
     Instr* LastInstr() { return Empty() ? nullptr : *std::prev(end()); }
     const Instr* LastInstr() const { return Empty() ? nullptr : *std::prev(end()); }
 
-    void MergePools(BasicBlock*);
+    Function* Parent() { return Owner<Function, BasicBlock>(); }
+    const Function* Parent() const { return Owner<Function, BasicBlock>(); }
+    // unique in the function, see Function::Append
+    size_t Number() const { return number_; }
+
+private:
+    friend class Function;
+    size_t number_{ static_cast<size_t>(-1) };
 };
 
 
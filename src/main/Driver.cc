@@ -1,10 +1,24 @@
 #include "main/Driver.h"
+#include "pass/BlockLayout.h"
+#include "pass/CallingGraph.h"
+#include "pass/ColoringAlloc.h"
+#include "pass/DCE.h"
 #include "pass/FlowGraph.h"
+#include "pass/Dominators.h"
 #include "pass/DUInfo.h"
+#include "pass/GVN.h"
+#include "pass/IndVars.h"
+#include "pass/Inliner.h"
+#include "pass/LICM.h"
+#include "pass/LinearScanAlloc.h"
 #include "pass/Liveness.h"
 #include "pass/LoopAnalyze.h"
+#include "pass/Mem2Reg.h"
 #include "pass/Pipeline.h"
+#include "pass/SCCP.h"
+#include "pass/ShrinkWrap.h"
 #include "pass/SimpleAlloc.h"
+#include "pass/TailRecursion.h"
 #include "parser/yacc.hh"
 #include "visitast/CodeChk.h"
 #include "visitast/IRGen.h"
@@ -130,11 +144,43 @@ void Driver::GenerateIR()
 Pipeline Driver::InitPipeline()
 {
     Pipeline simple{ module_.get() };
+    simple.AddPass<CallingGraph>(10);
+    if (optlevel_ >= 1)
+        simple.AddPass<Inliner>(20, 10);
+    if (optlevel_ >= 1)
+        simple.AddPass<TailRecursion>(50);
     simple.AddPass<FlowGraph>(100);
+    simple.AddPass<Dominators>(110, 100);
+    simple.AddPass<Mem2Reg>(120, 100, 110);
+    if (optlevel_ >= 1)
+    {
+        simple.AddPass<SCCP>(130, 100, 110);
+        simple.AddPass<GVN>(140, 110);
+    }
     simple.AddPass<DUInfo>(200);
+    if (optlevel_ >= 1)
+        simple.AddPass<DCE>(210, 100, 110, 200);
     simple.AddPass<LoopAnalyze>(300, 100);
+    if (optlevel_ >= 1)
+    {
+        simple.AddPass<LICM>(310, 100, 110, 200, 300);
+        simple.AddPass<IndVars>(320, 100, 110, 200, 300);
+    }
     simple.AddPass<Liveness>(400, 100, 200, 300);
-    simple.AddPass<SimpleAlloc>(500, 200, 400);
+    // the graph coloring allocator is slow but does a better job
+    auto regalloc = regalloc_.value_or(
+        optlevel_ >= 2 ? RegAllocType::coloring : RegAllocType::simple);
+    if (regalloc == RegAllocType::linearscan)
+        simple.AddPass<LinearScanAlloc>(500, 200, 300, 400);
+    else if (regalloc == RegAllocType::coloring)
+        simple.AddPass<ColoringAlloc>(500, 200, 300, 400);
+    else
+        simple.AddPass<SimpleAlloc>(500, 200, 400);
+    if (optlevel_ >= 1)
+    {
+        simple.AddPass<ShrinkWrap>(600, 100, 110, 200, 400, 500);
+        simple.AddPass<BlockLayout>(700, 100, 300);
+    }
     return std::move(simple);
 }
 
@@ -143,7 +189,11 @@ void Driver::GenerateAsm(const std::string& output)
     // Note here that the parameter stands for output
     // file name, not input as in the other methods.
     Pipeline pl = InitPipeline();
-    CodeGen codegen{ output, &pl, pl.GetPass<SimpleAlloc>(500) };
+    CodeGen codegen{ output, &pl, pl.GetPass<x64Alloc>(500), pl.GetPass<DUInfo>(200),
+        pl.GetPass<Liveness>(400), optlevel_ >= 1 ? pl.GetPass<ShrinkWrap>(600) : nullptr,
+        optlevel_ >= 1 ? pl.GetPass<BlockLayout>(700) : nullptr };
+    if (optlevel_ >= 1)
+        codegen.EnablePeephole();
 
     std::ostream* pstream = nullptr;
     if (summaryflag_)
@@ -154,10 +204,27 @@ void Driver::GenerateAsm(const std::string& output)
             pstream = new std::ofstream(passtream_);
         codegen.SetSummaryStream(pstream);
 
-        for (auto i : modpassprint_)
-            codegen.AddModulePass2Print(pl.GetPass<ModulePass>(i));
-        for (auto i : funcpassprint_)
-            codegen.AddFuncPass2Print(pl.GetPass<FunctionPass>(i));
+        // passes left out at this opt level have nothing to print
+        auto notrun = [this] (const std::string& name) {
+            std::cerr << "Ginkgo: " << name << " doesn't run at -O"
+                << optlevel_ << ", no summary printed for it\n";
+        };
+        for (auto& [i, name] : modpassprint_)
+        {
+            if (pl.HasPass(i))
+                codegen.AddModulePass2Print(pl.GetPass<ModulePass>(i));
+            else
+                notrun(name);
+        }
+        for (auto& [i, name] : funcpassprint_)
+        {
+            if (pl.HasPass(i))
+                codegen.AddFuncPass2Print(pl.GetPass<FunctionPass>(i));
+            else
+                notrun(name);
+        }
+        if (peepholeprint_)
+            codegen.PrintPeephole();
     }
 
     codegen.VisitModule(module_.get());
@@ -4,6 +4,7 @@
 #include "ast/Statement.h"
 #include "IR/Value.h"
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -17,6 +18,13 @@ enum class OutputType
     intermediate
 };
 
+enum class RegAllocType
+{
+    simple,
+    linearscan,
+    coloring
+};
+
 class Driver
 {
 public:
@@ -27,11 +35,14 @@ public:
     void SetLink2Ginkgo(bool l) { link2gk_ = l; }
     void SetInputName(const std::string& n) { inputname_ = n; }
     void SetOutputName(const std::string& n) { outputname_ = n; }
+    void SetRegAlloc(RegAllocType ty) { regalloc_ = ty; }
+    void SetOptLevel(int l) { optlevel_ = l; }
 
     void SetSummaryFlag() { summaryflag_ = true; }
     void SetSummaryStream(const std::string& o) { passtream_ = o; }
-    void AddModulePass2Print(int p) { modpassprint_.push_back(p); }
-    void AddFuncPass2Print(int p) { funcpassprint_.push_back(p); }
+    void AddModulePass2Print(int p, const char* n) { modpassprint_.emplace_back(p, n); }
+    void AddFuncPass2Print(int p, const char* n) { funcpassprint_.emplace_back(p, n); }
+    void SetPeepholePrint() { peepholeprint_ = true; }
 
     void Run();
 
@@ -56,6 +67,9 @@ private:
     void EmitIntermediate();
 
     OutputType outputype_{};
+    // left unset to take the default of the opt level
+    std::optional<RegAllocType> regalloc_{};
+    int optlevel_{};
     std::string cppath_{};
     std::string libpath_{};
     std::string libc23path_{};
@@ -68,8 +82,9 @@ private:
 
     bool summaryflag_{};
     std::string passtream_{};
-    std::vector<int> modpassprint_{};
-    std::vector<int> funcpassprint_{};
+    std::vector<std::pair<int, std::string>> modpassprint_{};
+    std::vector<std::pair<int, std::string>> funcpassprint_{};
+    bool peepholeprint_{};
 
     TransUnit transunit_{};
     std::unique_ptr<Module> module_{};
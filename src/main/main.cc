@@ -1,3 +1,5 @@
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <string>
 #include "main/Driver.h"
@@ -5,16 +7,44 @@
 
 std::pair<int, bool> PassName2Index(const char* name)
 {
-    if (strcmp(name, "FlowGraph") == 0)
+    if (strcmp(name, "CallingGraph") == 0)
+        return std::make_pair(10, false);
+    else if (strcmp(name, "Inliner") == 0)
+        return std::make_pair(20, false);
+    else if (strcmp(name, "TailRecursion") == 0)
+        return std::make_pair(50, true);
+    else if (strcmp(name, "FlowGraph") == 0)
         return std::make_pair(100, true);
+    else if (strcmp(name, "Dominators") == 0)
+        return std::make_pair(110, true);
+    else if (strcmp(name, "Mem2Reg") == 0)
+        return std::make_pair(120, true);
+    else if (strcmp(name, "SCCP") == 0)
+        return std::make_pair(130, true);
+    else if (strcmp(name, "GVN") == 0)
+        return std::make_pair(140, true);
     else if (strcmp(name, "DUInfo") == 0)
         return std::make_pair(200, true);
+    else if (strcmp(name, "DCE") == 0)
+        return std::make_pair(210, true);
     else if (strcmp(name, "LoopAnalyze") == 0)
         return std::make_pair(300, true);
+    else if (strcmp(name, "LICM") == 0)
+        return std::make_pair(310, true);
+    else if (strcmp(name, "IndVars") == 0)
+        return std::make_pair(320, true);
     else if (strcmp(name, "Liveness") == 0)
         return std::make_pair(400, true);
     else if (strcmp(name, "SimpleAlloc") == 0)
         return std::make_pair(500, true);
+    else if (strcmp(name, "LinearScanAlloc") == 0)
+        return std::make_pair(500, true);
+    else if (strcmp(name, "ColoringAlloc") == 0)
+        return std::make_pair(500, true);
+    else if (strcmp(name, "ShrinkWrap") == 0)
+        return std::make_pair(600, true);
+    else if (strcmp(name, "BlockLayout") == 0)
+        return std::make_pair(700, true);
     return std::make_pair(0, false);
 }
 
@@ -38,6 +68,23 @@ int main(int argc, char* argv[])
             driver.AddIncludeDir(argv[++i]);
         else if (strcmp(argv[i], "-lgk") == 0)
             driver.SetLink2Ginkgo(true);
+        else if (strncmp(argv[i], "-O", 2) == 0)
+            driver.SetOptLevel(atoi(argv[i] + 2));
+        else if (strcmp(argv[i], "-regalloc") == 0)
+        {
+            i += 1;
+            if (i < argc && strcmp(argv[i], "linearscan") == 0)
+                driver.SetRegAlloc(RegAllocType::linearscan);
+            else if (i < argc && strcmp(argv[i], "coloring") == 0)
+                driver.SetRegAlloc(RegAllocType::coloring);
+            else if (i < argc && strcmp(argv[i], "simple") == 0)
+                driver.SetRegAlloc(RegAllocType::simple);
+            else
+            {
+                fprintf(stderr, "Ginkgo: -regalloc takes simple, linearscan or coloring\n");
+                return 1;
+            }
+        }
         else if (strcmp(argv[i], "-pass-summary") == 0)
         {
             driver.SetSummaryFlag();
@@ -54,13 +101,25 @@ int main(int argc, char* argv[])
                     driver.SetSummaryStream(argv[++i]);
                     i += 1;
                 }
+                else if (strcmp(argv[i], "Peephole") == 0)
+                {
+                    // run by EmitAsm rather than in the pipeline
+                    driver.SetPeepholePrint();
+                    i += 1;
+                }
                 else
                 {
-                    auto [index, isfunc] = PassName2Index(argv[i++]);
+                    auto name = argv[i++];
+                    auto [index, isfunc] = PassName2Index(name);
+                    if (index == 0)
+                    {
+                        fprintf(stderr, "Ginkgo: no pass named %s to summarize\n", name);
+                        return 1;
+                    }
                     if (isfunc)
-                        driver.AddFuncPass2Print(index);
+                        driver.AddFuncPass2Print(index, name);
                     else
-                        driver.AddModulePass2Print(index);
+                        driver.AddModulePass2Print(index, name);
                 }
             }
         }
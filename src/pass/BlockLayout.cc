@@ -0,0 +1,161 @@
+#include "pass/BlockLayout.h"
+#include "IR/Instr.h"
+#include "IR/Value.h"
+#include <fmt/format.h>
+#include <utility>
+
+
+bool BlockLayout::HasTerminator(const BasicBlock* bb) const
+{
+    for (auto i : *bb)
+        if (i->IsControlInstr())
+            return true;
+    return false;
+}
+
+const BasicBlock* BlockLayout::Loop(const BasicBlock* bb) const
+{
+    return loops_->IsHeader(bb) ? bb : loops_->GetHeader(bb);
+}
+
+bool BlockLayout::InLoop(const BasicBlock* bb, const BasicBlock* header) const
+{
+    for (auto h = Loop(bb); h; h = loops_->GetHeader(h))
+        if (h == header)
+            return true;
+    return false;
+}
+
+BasicBlock* BlockLayout::Rotate(const BasicBlock* header) const
+{
+    if (!loops_->IsHeader(header) || loops_->InIrreducible(header))
+        return nullptr;
+
+    const BasicBlock* body = nullptr;
+    int succs = 0;
+    for (auto [succ, _] : fg_->GetFlowGraph()[header])
+    {
+        succs += 1;
+        if (!succ || !InLoop(succ, header))
+            continue;
+        // a header jumping to itself is already at the bottom
+        if (body || succ == header)
+            return nullptr;
+        body = succ;
+    }
+    if (!body || succs != 2)
+        return nullptr;
+    return blocks_[index_.at(body)];
+}
+
+BasicBlock* BlockLayout::BestSucc(const BasicBlock* bb) const
+{
+    auto loop = Loop(bb);
+    auto rank = [this, loop] (const BasicBlock* succ) {
+        return std::make_pair(loop && !InLoop(succ, loop), index_.at(succ)); };
+
+    const BasicBlock* best = nullptr;
+    for (auto [succ, _] : fg_->GetFlowGraph()[bb])
+        if (succ && !placed_.count(succ) && (!best || rank(succ) < rank(best)))
+            best = succ;
+    return best ? blocks_[index_.at(best)] : nullptr;
+}
+
+BasicBlock* BlockLayout::StayIn(
+    const std::vector<const BasicBlock*>& pending, const BasicBlock* loop) const
+{
+    for (auto it = pending.rbegin(); it != pending.rend(); ++it)
+        if (auto succ = BestSucc(*it); succ && InLoop(succ, loop))
+            return succ;
+    return nullptr;
+}
+
+void BlockLayout::Place(BasicBlock* bb)
+{
+    // the first block of each loop in the order
+    for (auto loop = Loop(bb); loop; loop = loops_->GetHeader(loop))
+        if (entered_.insert(loop).second && !order_.empty())
+            aligned_.insert(bb);
+    placed_.insert(bb);
+    order_.push_back(bb);
+}
+
+
+void BlockLayout::ExecuteOnFunction(Function* func)
+{
+    CurFunc() = func;
+    if (func->Empty())
+        return;
+    for (auto bb : *func)
+    {
+        // A block without a terminator falls through to the next one.
+        if (!HasTerminator(bb))
+        {
+            order_.assign(func->begin(), func->end());
+            return;
+        }
+        index_[bb] = blocks_.size();
+        blocks_.push_back(bb);
+    }
+
+    // blocks placed, some successors of which are not
+    std::vector<const BasicBlock*> pending{};
+    BasicBlock* next = func->Front();
+    const BasicBlock* from = nullptr;
+    while (next)
+    {
+        // Entering a loop at a header testing for the exit?
+        if (auto body = Rotate(next); body && from &&
+            !placed_.count(body) && !InLoop(from, next))
+        {
+            rotated_.push_back(next);
+            next = body;
+        }
+        Place(next);
+        pending.push_back(next);
+
+        from = next;
+        next = BestSucc(next);
+        // Lay out the rest of the loop before leaving it.
+        if (auto loop = Loop(from); loop && (!next || !InLoop(next, loop)))
+            if (auto succ = StayIn(pending, loop); succ)
+                next = succ;
+        while (!next && !pending.empty())
+        {
+            from = pending.back();
+            next = BestSucc(from);
+            if (!next)
+                pending.pop_back();
+        }
+    }
+
+    // Unreachable blocks go to the end.
+    for (auto bb : *func)
+        if (!placed_.count(bb))
+            order_.push_back(bb);
+}
+
+void BlockLayout::ExitFunction()
+{
+    index_.clear();
+    blocks_.clear();
+    placed_.clear();
+    order_.clear();
+    entered_.clear();
+    aligned_.clear();
+    rotated_.clear();
+}
+
+
+std::string BlockLayout::PrintSummary() const
+{
+    std::string summary{ fmt::format(
+        "Pass BlockLayout in function {}:\n", CurFunc()->Name()) };
+    summary += "Block order (aligned loop tops marked with *):\n";
+    for (auto bb : order_)
+        summary += bb->Name() + (aligned_.count(bb) ? " *\n" : "\n");
+    summary += "Rotated loops:\n";
+    for (auto header : rotated_)
+        summary += header->Name() + '\n';
+    return std::move(summary);
+}
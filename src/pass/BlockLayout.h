@@ -0,0 +1,71 @@
+#ifndef _BLOCK_LAYOUT_H_
+#define _BLOCK_LAYOUT_H_
+
+#include "pass/Pass.h"
+#include "pass/FlowGraph.h"
+#include "pass/LoopAnalyze.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class Module;
+class BasicBlock;
+class Function;
+
+
+// The order blocks are emitted in. Starting from the entry, each block is
+// followed by its successor most likely taken, so that the branch to it
+// becomes a fall-through: one staying in the innermost loop of the block
+// rather than leaving it, or the first one created if both do. When the
+// chain ends, it continues from the successors of the blocks placed most
+// recently, which keeps the rest of a loop body together. A loop whose
+// header tests for the exit is rotated: the body is placed first, and
+// the header after the block jumping back to it, so every iteration
+// takes only the conditional branch at the bottom, and the preheader
+// jumps to the test once. The first block of each loop in the order is
+// aligned. Jumps to the next block are left to the peephole optimizer.
+// See Profile Guided Code Positioning by Pettis and Hansen (1990), and
+// Branch Prediction for Free by Ball and Larus (1993) for the heuristics.
+
+class BlockLayout : public FunctionPass
+{
+public:
+    BlockLayout(Module* m, Pass* fg, Pass* loops) : FunctionPass(m),
+        fg_(static_cast<FlowGraph*>(fg)), loops_(static_cast<LoopAnalyze*>(loops)) {}
+
+    std::string PrintSummary() const override;
+
+    void ExecuteOnFunction(Function*) override;
+    void ExitFunction() override;
+
+    const std::vector<BasicBlock*>& Order() const { return order_; }
+    bool Aligned(const BasicBlock* bb) const { return aligned_.count(bb); }
+
+private:
+    bool HasTerminator(const BasicBlock*) const;
+    // the innermost loop the block is in, i.e., its header
+    const BasicBlock* Loop(const BasicBlock*) const;
+    bool InLoop(const BasicBlock* bb, const BasicBlock* header) const;
+    // the successor of a header staying in its loop, if it can be rotated
+    BasicBlock* Rotate(const BasicBlock*) const;
+    BasicBlock* BestSucc(const BasicBlock*) const;
+    // the best successor in the loop of any block placed
+    BasicBlock* StayIn(const std::vector<const BasicBlock*>&, const BasicBlock*) const;
+    void Place(BasicBlock*);
+
+    // the position of each block in the function, and the block there
+    std::unordered_map<const BasicBlock*, int> index_{};
+    std::vector<BasicBlock*> blocks_{};
+    std::unordered_set<const BasicBlock*> placed_{};
+    std::vector<BasicBlock*> order_{};
+    // loops some block of which is placed
+    std::unordered_set<const BasicBlock*> entered_{};
+    std::unordered_set<const BasicBlock*> aligned_{};
+    std::vector<const BasicBlock*> rotated_{};
+
+    FlowGraph* fg_{};
+    LoopAnalyze* loops_{};
+};
+
+#endif // _BLOCK_LAYOUT_H_
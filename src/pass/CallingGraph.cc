@@ -1,10 +1,11 @@
 #include "pass/CallingGraph.h"
 #include "IR/Instr.h"
 #include "IR/Value.h"
+#include <algorithm>
 #include <fmt/format.h>
 
 
-void CallingGraph::VisitFunction(Function* func)
+void CallingGraph::VisitFunction(GraphType::Builder& calling, Function* func)
 {
     if (func->Empty())
         return;
@@ -12,36 +13,81 @@ void CallingGraph::VisitFunction(Function* func)
     for (auto bb : *func)
         for (auto i : *bb)
             if (auto c = i->As<CallInstr>(); c)
-                VisitCallInstr(c);
+                VisitCallInstr(calling, func, bb, c);
 }
 
-void CallingGraph::VisitCallInstr(Function* f, CallInstr* c)
+void CallingGraph::VisitCallInstr(
+    GraphType::Builder& calling, Function* func, BasicBlock* bb, CallInstr* c)
 {
     if (c->FuncName().empty())
         return;
     // return if we're calling a builtin function
-    if (c->FuncName() == "@__Ginkgo_assert")
+    if (c->FuncName().rfind("@__Ginkgo_", 0) == 0)
         return;
 
-    calling_.AddValueEdge(func,
-        CurModule()->GetFunction(c->FuncName()), { bb, c });
+    auto callee = CurModule()->GetFunction(c->FuncName());
+    calling.AddValueEdge(func, callee, { bb, c });
+}
+
+void CallingGraph::FindSCCs(const Function* func)
+{
+    int num = dfsnum_.size();
+    dfsnum_[func] = { num, num };
+    stack_.push_back(func);
+    onstack_.insert(func);
+
+    for (auto [to, _] : calling_[func])
+    {
+        if (!dfsnum_.count(to))
+        {
+            FindSCCs(to);
+            dfsnum_[func].second = std::min(
+                dfsnum_[func].second, dfsnum_[to].second);
+        }
+        else if (onstack_.count(to))
+            dfsnum_[func].second = std::min(
+                dfsnum_[func].second, dfsnum_[to].first);
+    }
+
+    if (dfsnum_[func].first != dfsnum_[func].second)
+        return;
+    auto& scc = sccs_.emplace_back();
+    const Function* top = nullptr;
+    do
+    {
+        top = stack_.back();
+        stack_.pop_back();
+        onstack_.erase(top);
+        scc.push_back(top);
+    } while (top != func);
 }
 
 
 std::string CallingGraph::PrintSummary() const
 {
     std::string summary{ "Pass CallingGraph:\n" };
-    for (auto& [v, adj] : calling_)
-        for (auto& [to, info] : adj)
-            summary += fmt::format(
-                "{} -> {} in block {}\n", v->Name(), info.first->Name());
+    for (auto v : calling_.GetVertices())
+        for (auto [to, info] : calling_[v])
+            summary += fmt::format("{} -> {} in block {}\n",
+                v->Name(), to->Name(), info.first->Name());
     return std::move(summary);
 }
 
 
 void CallingGraph::ExecuteOnModule()
 {
+    sccs_.clear();
+    GraphType::Builder calling{};
+    for (auto v : *CurModule())
+        if (auto f = v->As<Function>(); f)
+            calling.AddVertex(f);
     for (auto v : *CurModule())
         if (auto f = v->As<Function>(); f)
-            VisitFunction(f);
+            VisitFunction(calling, f);
+    calling_ = calling.Build();
+
+    for (auto v : *CurModule())
+        if (auto f = v->As<Function>(); f && !dfsnum_.count(f))
+            FindSCCs(f);
+    dfsnum_.clear();
 }
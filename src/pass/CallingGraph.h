@@ -5,6 +5,8 @@
 #include "utils/Graph.h"
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 class BasicBlock;
 class Function;
@@ -12,47 +14,41 @@ class Module;
 class CallInstr;
 
 
+// The call graph of a module. Each direct call adds an edge from the caller
+// to the callee, labeled with the call instruction and its block; calls
+// through pointers and to builtins are not recorded. The strongly connected
+// components are found with Tarjan's algorithm, which yields them callees
+// first, i.e., in the bottom-up order interprocedural passes want.
+
 class CallingGraph : public ModulePass
 {
 public:
     using CallInfo = std::pair<const BasicBlock*, const CallInstr*>;
-    using GraphType = Graph<const Function*, CallInfo>;
-
-    template <class ITER>
-    class PredsIter
-    {
-    public:
-        PredsIter(ITER b, ITER e) : begin_(b), end_(e) {}
-        ITER begin() { return begin_; }
-        ITER end() { return end_; }
-    private:
-        ITER begin_{};
-        ITER end_{};
-    };
+    using GraphType = CSRGraph<const Function*, CallInfo>;
 
     CallingGraph(Module* m) : ModulePass(m) {}
     std::string PrintSummary() const override;
     void ExecuteOnModule() override;
 
     const auto& GetCallingGraph() const { return calling_; }
-    auto& GetCallingGraph() { return calling_; }
-    const auto GetPredsOf(const Function* func) const
-    {
-        auto [b, e] = preds_.equal_range(func);
-        return PredsIter(b, e);
-    }
-    auto GetPredsOf(const Function* func)
-    {
-        auto [b, e] = preds_.equal_range(func);
-        return PredsIter(b, e);
-    }
+    // callers of the function, once per call
+    auto GetPredsOf(const Function* func) const { return calling_.GetPreds(func); }
+    // strongly connected components, callees before callers
+    const auto& GetSCCs() const { return sccs_; }
 
 private:
-    void VisitFunction(Function*);
-    void VisitCallInstr(Function*, CallInstr*);
-
-    Graph<const Function*, CallInfo> calling_{};
-    std::unordered_multimap<const Function*, const Function*> preds_{};
+    void VisitFunction(GraphType::Builder&, Function*);
+    void VisitCallInstr(GraphType::Builder&, Function*, BasicBlock*, CallInstr*);
+    void FindSCCs(const Function*);
+
+    GraphType calling_{};
+
+    std::vector<std::vector<const Function*>> sccs_{};
+    // DFS number and lowlink of each function visited,
+    // and the functions not assigned to a component yet
+    std::unordered_map<const Function*, std::pair<int, int>> dfsnum_{};
+    std::vector<const Function*> stack_{};
+    std::unordered_set<const Function*> onstack_{};
 };
 
 #endif // _CALLING_GRAPH_H_
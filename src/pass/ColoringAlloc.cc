@@ -0,0 +1,645 @@
+#include "pass/ColoringAlloc.h"
+#include "IR/Value.h"
+#include "IR/Instr.h"
+#include <algorithm>
+#include <cmath>
+#include <fmt/format.h>
+
+
+// The shift count is always placed in cl.
+static const x64Alloc::RegSet shiftcount = { x64Phys::rcx };
+// div, idiv and the unsigned mul write to rdx.
+static const x64Alloc::RegSet highhalf = { x64Phys::rdx };
+
+static RegTag Phys2Tag(x64Phys phys) { return static_cast<RegTag>(static_cast<int>(phys) + 2); }
+static x64Phys Tag2Phys(RegTag tag) { return static_cast<x64Phys>(static_cast<int>(tag) - 2); }
+
+
+bool ColoringAlloc::NeedAlloc(const IROperand* op) const
+{
+    auto reg = op->As<Register>();
+    if (!reg || reg->Name()[0] == '@' || allocas_.Test(reg->Number()))
+        return false;
+    return !reg->Type()->Is<HeterType>();
+}
+
+bool ColoringAlloc::IsFloat(const IROperand* op) const
+{
+    return op->Type()->Is<FloatType>();
+}
+
+int ColoringAlloc::Colors(const IROperand* op) const
+{
+    return IsFloat(op) ? VecRegOrder().size() : IntRegOrder().size();
+}
+
+double ColoringAlloc::Weight() const
+{
+    return std::pow(10.0, loops_->LoopDepth(curbb_));
+}
+
+
+bool ColoringAlloc::HasNode(const IROperand* op) const
+{
+    auto reg = op->As<Register>();
+    return reg && reg->Number() < nodes_.size() && nodes_[reg->Number()].reg_;
+}
+
+ColoringAlloc::Node& ColoringAlloc::GetNode(const IROperand* op)
+{
+    auto& node = NodeOf(op);
+    if (!node.reg_)
+    {
+        node.reg_ = op->As<Register>();
+        order_.push_back(op);
+        interf_.AddVertex(op);
+    }
+    return node;
+}
+
+void ColoringAlloc::Use(const IROperand* op)
+{
+    if (auto heter = heters_.find(op);
+        heter != heters_.end() && curbb_ == CurFunc()->Front())
+        heter->second = points_[curbb_].size() - 1;
+    if (MapConstAndGlobalVar(op) || !NeedAlloc(op))
+        return;
+    GetNode(op).weight_ += Weight();
+    points_[curbb_].back().uses_.push_back(op);
+}
+
+bool ColoringAlloc::OnStack(const IROperand* op)
+{
+    auto ty = op->Type();
+    if (!ty->Is<HeterType>())
+        return false;
+    auto offset = AllocateOnX64Stack(ArchInfo(), ty->Size(), ty->Align());
+    MapRegister(op, std::make_unique<x64Mem>(
+        ty->Size(), offset, RegTag::rbp, RegTag::none, 0));
+    return true;
+}
+
+void ColoringAlloc::Def(const IROperand* op)
+{
+    if (OnStack(op))
+        return;
+    GetNode(op).weight_ += Weight();
+    points_[curbb_].back().def_ = op;
+}
+
+void ColoringAlloc::Clobbered(const RegSet& regs, bool def)
+{
+    points_[curbb_].back().clobber_ = &regs;
+    points_[curbb_].back().clobberdef_ = def;
+}
+
+
+const IROperand* ColoringAlloc::Find(const IROperand* op) const
+{
+    while (alias_[Number(op)])
+        op = alias_[Number(op)];
+    return op;
+}
+
+BitVector ColoringAlloc::Neighbors(const IROperand* op) const
+{
+    BitVector neighbors(nodes_.size());
+    auto& vertices = interf_.GetVertices();
+    for (auto index : interf_[op])
+        if (auto n = Find(*vertices[index]); n != op)
+            neighbors.Set(Number(n));
+    return neighbors;
+}
+
+void ColoringAlloc::Interfere(const IROperand* op1, const IROperand* op2)
+{
+    // values in different register files never interfere
+    if (op1 == op2 || IsFloat(op1) != IsFloat(op2))
+        return;
+    interf_.AddEdge(op1, op2);
+    interf_.AddEdge(op2, op1);
+}
+
+void ColoringAlloc::Forbid(const IROperand* op, const RegSet& regs)
+{
+    NodeOf(op).forbid_.insert(regs.begin(), regs.end());
+}
+
+
+void ColoringAlloc::BuildGraph(Function* func)
+{
+    auto entry = func->Front();
+    // Registers holding parts of a parameter are clobbered
+    // before it is copied to the stack by the front-end.
+    int lastheter = -1;
+    RegSet heterregs{};
+    for (auto [param, last] : heters_)
+    {
+        lastheter = std::max(lastheter, last);
+        for (auto& place : *GetIROpMap(param)->As<x64Heter>())
+            if (place.InReg())
+                heterregs.insert(Tag2Phys(place.ToReg()));
+    }
+
+    // Sets of live nodes are bits over the numbers of the registers.
+    auto& regs = func->Registers();
+    for (auto bb : *func)
+    {
+        BitVector live(nodes_.size());
+        for (auto op : live_->LiveOut(bb))
+            if (HasNode(op))
+                live.Set(Number(op));
+
+        auto& points = points_[bb];
+        for (int i = points.size() - 1; i >= 0; --i)
+        {
+            auto& point = points[i];
+            // The result is written while the operands are still being
+            // read, except the one it may reuse, if it dies here.
+            auto across = live;
+            for (auto op : point.uses_)
+                if (op != point.reuse_ || live.Test(Number(op)))
+                    across.Set(Number(op));
+            if (point.def_)
+                for (auto num : across)
+                    Interfere(point.def_, regs[num]);
+
+            auto clobbered = across;
+            for (auto op : point.uses_)
+                clobbered.Set(Number(op));
+            if (point.def_)
+                clobbered.Reset(Number(point.def_));
+            if (point.def_ && point.clobberdef_)
+                clobbered.Set(Number(point.def_));
+            if (point.clobber_)
+                for (auto num : clobbered)
+                    Forbid(regs[num], *point.clobber_);
+            if (bb == entry && i <= lastheter)
+            {
+                for (auto num : clobbered)
+                    Forbid(regs[num], heterregs);
+                if (point.def_)
+                    Forbid(point.def_, heterregs);
+            }
+
+            if (point.def_)
+                live.Reset(Number(point.def_));
+            for (auto op : point.uses_)
+                live.Set(Number(op));
+        }
+
+        // Results of phi instructions are defined at
+        // the beginning of the block simultaneously.
+        auto& phis = phidefs_[bb];
+        for (auto def : phis)
+        {
+            for (auto num : live)
+                Interfere(def, regs[num]);
+            for (auto op : phis)
+                Interfere(def, op);
+        }
+        for (auto def : phis)
+            live.Reset(Number(def));
+
+        // So are the parameters.
+        if (bb != entry)
+            continue;
+        for (auto param : params_)
+        {
+            for (auto num : live)
+                Interfere(param, regs[num]);
+            for (auto op : params_)
+                Interfere(param, op);
+            Forbid(param, heterregs);
+        }
+    }
+
+    // The address to return a big structure to is kept in rdi.
+    if (auto ty = func->ReturnType(); ty->Is<HeterType>() && ty->Size() > 16)
+        for (auto op : order_)
+            Forbid(op, { x64Phys::rdi });
+}
+
+void ColoringAlloc::Coalesce()
+{
+    // copies in inner loops are more likely to be removed
+    std::stable_sort(moves_.begin(), moves_.end(),
+        [] (const Move& m, const Move& n) { return m.weight_ > n.weight_; });
+
+    for (auto& move : moves_)
+    {
+        auto dest = Find(move.dest_);
+        auto src = Find(move.src_);
+        if (dest == src || IsFloat(dest) != IsFloat(src))
+            continue;
+        auto neighbors = Neighbors(dest);
+        if (neighbors.Test(Number(src)))
+            continue;
+
+        // The Briggs test: the merged node has fewer than
+        // K neighbors of significant degree, so it is colorable.
+        auto& regs = CurFunc()->Registers();
+        auto srcneighbors = Neighbors(src);
+        neighbors |= srcneighbors;
+        int k = Colors(dest);
+        auto significant = std::count_if(neighbors.begin(), neighbors.end(),
+            [this, &regs, k] (size_t n) { return Neighbors(regs[n]).Count() >= static_cast<size_t>(k); });
+        if (significant >= k)
+            continue;
+
+        alias_[Number(src)] = dest;
+        for (auto n : srcneighbors)
+            Interfere(dest, regs[n]);
+        auto& to = NodeOf(dest);
+        auto& from = NodeOf(src);
+        to.weight_ += from.weight_;
+        to.forbid_.insert(from.forbid_.begin(), from.forbid_.end());
+        if (to.hint_ == RegTag::none)
+            to.hint_ = from.hint_;
+    }
+}
+
+void ColoringAlloc::Simplify()
+{
+    // the degrees of the nodes still in the graph, or -1
+    std::vector<const IROperand*> remaining{};
+    std::vector<int> degree(nodes_.size(), -1);
+    for (auto op : order_)
+    {
+        if (Find(op) != op)
+            continue;
+        remaining.push_back(op);
+        degree[Number(op)] = Neighbors(op).Count();
+    }
+
+    while (!remaining.empty())
+    {
+        auto pick = std::find_if(remaining.begin(), remaining.end(),
+            [this, &degree] (const IROperand* op) { return degree[Number(op)] < Colors(op); });
+        // No node is trivially colorable. Remove the one that is cheapest
+        // to spill and hope it is still colorable later (the optimistic
+        // coloring of Briggs).
+        if (pick == remaining.end())
+        {
+            pick = std::min_element(remaining.begin(), remaining.end(),
+                [this, &degree] (const IROperand* op1, const IROperand* op2) {
+                    return NodeOf(op1).weight_ / degree[Number(op1)] <
+                        NodeOf(op2).weight_ / degree[Number(op2)];
+                });
+        }
+
+        auto op = *pick;
+        remaining.erase(pick);
+        degree[Number(op)] = -1;
+        stack_.push_back(op);
+        for (auto n : Neighbors(op))
+            if (degree[n] >= 0)
+                degree[n]--;
+    }
+}
+
+RegTag ColoringAlloc::PickColor(const IROperand* op) const
+{
+    auto& node = NodeOf(op);
+    RegSet used{};
+    for (auto n : Neighbors(op))
+        if (auto color = nodes_[n].color_; color != RegTag::none)
+            used.insert(Tag2Phys(color));
+
+    auto& order = IsFloat(op) ? VecRegOrder() : IntRegOrder();
+    auto isfree = [&] (x64Phys phys) {
+        return !node.forbid_.count(phys) && !used.count(phys) &&
+            std::find(order.begin(), order.end(), phys) != order.end();
+    };
+
+    // Prefer the register the value is passed in, and then
+    // those of the nodes it is copied from or to.
+    std::vector<RegTag> prefer{ node.hint_ };
+    for (auto& move : moves_)
+    {
+        auto dest = Find(move.dest_);
+        auto src = Find(move.src_);
+        if (dest == op)
+            prefer.push_back(NodeOf(src).color_);
+        else if (src == op)
+            prefer.push_back(NodeOf(dest).color_);
+    }
+    for (auto tag : prefer)
+        if (tag != RegTag::none && isfree(Tag2Phys(tag)))
+            return tag;
+
+    for (auto phys : order)
+        if (isfree(phys))
+            return Phys2Tag(phys);
+    return RegTag::none;
+}
+
+void ColoringAlloc::Assign()
+{
+    // Coalesced nodes spilled share the same stack slot,
+    // kept by the node they are merged into.
+    std::vector<size_t> sizes(nodes_.size());
+    std::vector<int> members(nodes_.size());
+    std::unordered_map<const IROperand*, long> slots{};
+    for (auto op : order_)
+    {
+        auto rep = Number(Find(op));
+        sizes[rep] = std::max(sizes[rep], op->Type()->Size());
+        members[rep]++;
+    }
+
+    for (auto op : order_)
+    {
+        auto rep = Find(op);
+        auto color = NodeOf(rep).color_;
+        auto ty = op->Type();
+        bool isparam = std::find(params_.begin(), params_.end(), op) != params_.end();
+        auto passed = GetIROpMap(op);
+
+        if (color != RegTag::none)
+        {
+            Mark(Tag2Phys(color));
+            auto mapped = std::make_unique<x64Reg>(color, ty->Size());
+            if (!isparam)
+                MapRegister(op, std::move(mapped));
+            else if (!passed->Is<x64Reg>() || *passed != color)
+                HomeParam(op, std::move(mapped));
+            continue;
+        }
+
+        // A parameter passed on the stack is simply left there,
+        // unless it has to share the stack slot with others.
+        if (!isparam || passed->Is<x64Reg>() || members[Number(rep)] > 1)
+        {
+            if (!slots.count(rep))
+                slots[rep] = AllocateOnX64Stack(
+                    ArchInfo(), sizes[Number(rep)], sizes[Number(rep)]);
+            auto mapped = std::make_unique<x64Mem>(
+                ty->Size(), slots[rep], RegTag::rbp, RegTag::none, 0);
+            if (isparam)
+                HomeParam(op, std::move(mapped));
+            else
+                MapRegister(op, std::move(mapped));
+        }
+        // the stack slot holds the value of the pointer itself
+        if (ty->Is<PtrType>())
+            MarkLoadTwice(op);
+    }
+}
+
+
+std::string ColoringAlloc::PrintSummary() const
+{
+    std::string summary{ fmt::format(
+        "Pass ColoringAlloc in function {}:\n", CurFunc()->Name()) };
+    summary += "IR virtual reg: spill cost (-> coalesced into)\n";
+    for (auto op : order_)
+    {
+        summary += fmt::format("{}: {}", op->As<Register>()->Name(), NodeOf(op).weight_);
+        if (auto rep = Find(op); rep != op)
+            summary += fmt::format(" -> {}", rep->As<Register>()->Name());
+        summary += '\n';
+    }
+    return summary + x64Alloc::PrintSummary();
+}
+
+void ColoringAlloc::ExitFunction()
+{
+    x64Alloc::ExitFunction();
+    curbb_ = nullptr;
+    points_.clear();
+    phidefs_.clear();
+    moves_.clear();
+    nodes_.clear();
+    order_.clear();
+    params_.clear();
+    allocas_ = {};
+    heters_.clear();
+    interf_.Clear();
+    alias_.clear();
+    stack_.clear();
+}
+
+
+void ColoringAlloc::BinaryAllocaHelper(BinaryInstr* i, bool reuse)
+{
+    Use(i->Lhs());
+    Use(i->Rhs());
+    Def(i->Result());
+    if (!reuse || !HasNode(i->Lhs()) || !HasNode(i->Result()))
+        return;
+    points_[curbb_].back().reuse_ = i->Lhs();
+    moves_.push_back({ i->Result(), i->Lhs(), Weight() });
+}
+
+void ColoringAlloc::ConvertAllocaHelper(ConvertInstr* i)
+{
+    Use(i->Value());
+    Def(i->Dest());
+}
+
+
+void ColoringAlloc::VisitFunction(Function* func)
+{
+    nodes_.resize(func->RegNumbers());
+    alias_.resize(func->RegNumbers());
+    allocas_ = BitVector(func->RegNumbers());
+    for (auto bb : *func)
+        for (auto i : *bb)
+            if (i->Is<AllocaInstr>())
+                VisitAllocaInstr(i->As<AllocaInstr>());
+    LoadParam();
+
+    for (auto param : func->Params())
+    {
+        auto mapped = GetIROpMap(param);
+        if (mapped->Is<x64Heter>())
+            heters_[param] = -1;
+        auto ty = param->Type();
+        if ((!ty->Is<IntType>() && !ty->Is<FloatType>()) || !info_->HasUse(param))
+            continue;
+        params_.push_back(param);
+        if (auto reg = mapped->As<x64Reg>(); reg)
+            GetNode(param).hint_ = reg->Tag();
+        else
+            GetNode(param);
+    }
+
+    for (auto bb : *func)
+        VisitBasicBlock(bb);
+
+    BuildGraph(func);
+    Coalesce();
+    Simplify();
+    for (auto op = stack_.rbegin(); op != stack_.rend(); ++op)
+        NodeOf(*op).color_ = PickColor(*op);
+    Assign();
+
+    // we need to guarantee that info.allocated_ is always a multiple of 16
+    auto& info = ArchInfo();
+    info.allocated_ = MakeAlign(info.allocated_, 16);
+    info.rspoffset_ = info.allocated_;
+}
+
+void ColoringAlloc::VisitBasicBlock(BasicBlock* bb)
+{
+    curbb_ = bb;
+    auto& points = points_[bb];
+    for (auto i : *bb)
+    {
+        if (i->Is<AllocaInstr>())
+            continue;
+        if (!i->Is<PhiInstr>())
+            points.emplace_back();
+        i->Accept(this);
+    }
+}
+
+
+void ColoringAlloc::VisitRetInstr(RetInstr* i)
+{
+    if (i->ReturnValue())
+        Use(i->ReturnValue());
+}
+
+void ColoringAlloc::VisitBrInstr(BrInstr* i)
+{
+    if (i->Cond())
+        Use(i->Cond());
+}
+
+void ColoringAlloc::VisitSwitchInstr(SwitchInstr* i)
+{
+    Use(i->GetIdent());
+    for (auto [tag, _] : i->GetValueBlkPairs())
+        MapConstAndGlobalVar(tag);
+}
+
+void ColoringAlloc::VisitCallInstr(CallInstr* i)
+{
+    for (auto op : i->ArgvList())
+        Use(op);
+    if (i->FuncAddr()) // Call through a function pointer?
+        Use(i->FuncAddr());
+    if (i->Result())
+        Def(i->Result());
+    Clobbered(CallClobbered(), false);
+}
+
+
+void ColoringAlloc::VisitAddInstr(AddInstr* i) { BinaryAllocaHelper(i); }
+void ColoringAlloc::VisitFaddInstr(FaddInstr* i) { BinaryAllocaHelper(i); }
+void ColoringAlloc::VisitSubInstr(SubInstr* i) { BinaryAllocaHelper(i); }
+void ColoringAlloc::VisitFsubInstr(FsubInstr* i) { BinaryAllocaHelper(i); }
+void ColoringAlloc::VisitFmulInstr(FmulInstr* i) { BinaryAllocaHelper(i); }
+void ColoringAlloc::VisitFdivInstr(FdivInstr* i) { BinaryAllocaHelper(i); }
+void ColoringAlloc::VisitAndInstr(AndInstr* i) { BinaryAllocaHelper(i); }
+void ColoringAlloc::VisitOrInstr(OrInstr* i) { BinaryAllocaHelper(i); }
+void ColoringAlloc::VisitXorInstr(XorInstr* i) { BinaryAllocaHelper(i); }
+
+void ColoringAlloc::VisitMulInstr(MulInstr* i)
+{
+    BinaryAllocaHelper(i);
+    if (!i->Lhs()->Type()->As<IntType>()->IsSigned() &&
+        !i->Rhs()->Type()->As<IntType>()->IsSigned())
+        Clobbered(highhalf, true);
+}
+
+// The dividend is moved to rax, so sharing a register with it saves nothing.
+void ColoringAlloc::VisitDivInstr(DivInstr* i) { BinaryAllocaHelper(i, false); Clobbered(highhalf, true); }
+void ColoringAlloc::VisitModInstr(ModInstr* i) { BinaryAllocaHelper(i, false); Clobbered(highhalf, true); }
+void ColoringAlloc::VisitShlInstr(ShlInstr* i) { BinaryAllocaHelper(i); Clobbered(shiftcount, true); }
+void ColoringAlloc::VisitLshrInstr(LshrInstr* i) { BinaryAllocaHelper(i); Clobbered(shiftcount, true); }
+void ColoringAlloc::VisitAshrInstr(AshrInstr* i) { BinaryAllocaHelper(i); Clobbered(shiftcount, true); }
+
+
+void ColoringAlloc::VisitAllocaInstr(AllocaInstr* i)
+{
+    auto size = i->Type()->Size();
+    auto align = i->Type()->Align();
+    auto extra = align > size ? align - size : 0;
+
+    // See the FIXME in SimpleAlloc::VisitAllocaInstr.
+    auto offset = AllocateOnX64Stack(ArchInfo(), size + extra, align);
+    MapRegister(i->Result(), std::make_unique<x64Mem>(
+        size, offset, RegTag::rbp, RegTag::none, 0));
+    allocas_.Set(i->Result()->Number());
+}
+
+void ColoringAlloc::VisitLoadInstr(LoadInstr* i)
+{
+    Use(i->Pointer());
+    Def(i->Result());
+}
+
+void ColoringAlloc::VisitStoreInstr(StoreInstr* i)
+{
+    Use(i->Dest());
+    Use(i->Value());
+}
+
+void ColoringAlloc::VisitGetElePtrInstr(GetElePtrInstr* i)
+{
+    if (!i->HoldsInt())
+        Use(i->OpIndex());
+    Use(i->Pointer());
+    Def(i->Result());
+}
+
+
+void ColoringAlloc::VisitTruncInstr(TruncInstr* i) { ConvertAllocaHelper(i); }
+void ColoringAlloc::VisitFtruncInstr(FtruncInstr* i) { ConvertAllocaHelper(i); }
+
+void ColoringAlloc::VisitZextInstr(ZextInstr* i) { ConvertAllocaHelper(i); }
+void ColoringAlloc::VisitSextInstr(SextInstr* i) { ConvertAllocaHelper(i); }
+void ColoringAlloc::VisitFextInstr(FextInstr* i) { ConvertAllocaHelper(i); }
+void ColoringAlloc::VisitFtoUInstr(FtoUInstr* i) { ConvertAllocaHelper(i); }
+void ColoringAlloc::VisitFtoSInstr(FtoSInstr* i) { ConvertAllocaHelper(i); }
+
+void ColoringAlloc::VisitUtoFInstr(UtoFInstr* i) { ConvertAllocaHelper(i); }
+void ColoringAlloc::VisitStoFInstr(StoFInstr* i) { ConvertAllocaHelper(i); }
+void ColoringAlloc::VisitPtrtoIInstr(PtrtoIInstr* i) { ConvertAllocaHelper(i); }
+void ColoringAlloc::VisitItoPtrInstr(ItoPtrInstr* i) { ConvertAllocaHelper(i); }
+void ColoringAlloc::VisitBitcastInstr(BitcastInstr* i) { ConvertAllocaHelper(i); }
+
+
+void ColoringAlloc::VisitIcmpInstr(IcmpInstr* i)
+{
+    Use(i->Op1());
+    Use(i->Op2());
+    Def(i->Result());
+}
+
+void ColoringAlloc::VisitFcmpInstr(FcmpInstr* i)
+{
+    Use(i->Op1());
+    Use(i->Op2());
+    Def(i->Result());
+}
+
+void ColoringAlloc::VisitSelectInstr(SelectInstr* i)
+{
+    Use(i->SelType());
+    Use(i->Value1());
+    Use(i->Value2());
+    Def(i->Result());
+}
+
+void ColoringAlloc::VisitPhiInstr(PhiInstr* i)
+{
+    auto result = i->Result();
+    if (OnStack(result))
+        return;
+    GetNode(result).weight_ += Weight();
+    phidefs_[curbb_].push_back(result);
+
+    // The copies take place at the end of the predecessors.
+    for (auto [bb, op] : i->GetBlockValPair())
+    {
+        if (MapConstAndGlobalVar(op) || !NeedAlloc(op))
+            continue;
+        auto weight = std::pow(10.0, loops_->LoopDepth(bb));
+        GetNode(op).weight_ += weight;
+        moves_.push_back({ result, op, weight });
+    }
+}
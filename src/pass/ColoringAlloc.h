@@ -0,0 +1,185 @@
+#ifndef _COLORING_ALLOC_H_
+#define _COLORING_ALLOC_H_
+
+#include "pass/Pass.h"
+#include "pass/DUInfo.h"
+#include "pass/Liveness.h"
+#include "pass/LoopAnalyze.h"
+#include "pass/x64Alloc.h"
+#include "utils/BitVector.h"
+#include "utils/Graph.h"
+#include "visitir/IRVisitor.h"
+#include "visitir/x64.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class BinaryInstr;
+class ConvertInstr;
+class Instr;
+class IROperand;
+class Register;
+
+
+// The ColoringAlloc allocates registers by coloring the interference graph
+// of virtual registers in the Chaitin-Briggs style. Virtual registers
+// connected by the copies that phi instructions are lowered to are coalesced
+// first, as long as the Briggs test says the merged node is still colorable.
+// Then nodes of insignificant degree are removed from the graph one by one,
+// and colored optimistically in the reverse order, preferring the colors of
+// the nodes they are copied from or to. A node that can't be colored is kept
+// on the stack during its whole lifetime. As usual, rax, r11 and xmm0 are
+// never allocated. The implementation is based on Improvements to Graph
+// Coloring Register Allocation by Briggs, Cooper and Torczon (1994).
+// See https://dl.acm.org/doi/10.1145/177492.177575 for more information.
+
+class ColoringAlloc : public x64Alloc
+{
+public:
+    ColoringAlloc(Module* m, Pass* du, Pass* l, Pass* live) :
+        x64Alloc(m), info_(static_cast<DUInfo*>(du)),
+        loops_(static_cast<LoopAnalyze*>(l)),
+        live_(static_cast<Liveness*>(live)) {}
+
+    std::string PrintSummary() const override;
+    void ExitFunction() override;
+
+private:
+    struct Node
+    {
+        const Register* reg_{};
+        double weight_{};
+        // registers that must not be assigned to the node
+        RegSet forbid_{};
+        // the register the value is passed in, if it is a parameter
+        RegTag hint_{ RegTag::none };
+        RegTag color_{ RegTag::none };
+    };
+
+    // what an instruction reads, writes and clobbers
+    struct Point
+    {
+        std::vector<const IROperand*> uses_{};
+        const IROperand* def_{};
+        // the operand whose register the result may reuse
+        const IROperand* reuse_{};
+        const RegSet* clobber_{};
+        // if false, the result can still be put in the clobbered registers
+        bool clobberdef_{};
+    };
+
+    // a copy between the result and an operand of a phi instruction,
+    // or between the result and the first operand of a binary instruction
+    struct Move
+    {
+        const IROperand* dest_{};
+        const IROperand* src_{};
+        double weight_{};
+    };
+
+    bool NeedAlloc(const IROperand*) const;
+    bool IsFloat(const IROperand*) const;
+    int Colors(const IROperand*) const;
+    double Weight() const;
+
+    // Nodes, and sets of them, are indexed by the numbers of
+    // the registers, see Function::MakeRegister.
+    static size_t Number(const IROperand* op) { return op->As<Register>()->Number(); }
+    bool HasNode(const IROperand*) const;
+    Node& GetNode(const IROperand*);
+    Node& NodeOf(const IROperand* op) { return nodes_[Number(op)]; }
+    const Node& NodeOf(const IROperand* op) const { return nodes_[Number(op)]; }
+    void Use(const IROperand*);
+    bool OnStack(const IROperand*);
+    void Def(const IROperand*);
+    void Clobbered(const RegSet&, bool def);
+
+    const IROperand* Find(const IROperand*) const;
+    BitVector Neighbors(const IROperand*) const;
+    void Interfere(const IROperand*, const IROperand*);
+    void Forbid(const IROperand*, const RegSet&);
+
+    void BuildGraph(Function*);
+    void Coalesce();
+    void Simplify();
+    RegTag PickColor(const IROperand*) const;
+    void Assign();
+
+    void BinaryAllocaHelper(BinaryInstr*, bool reuse = true);
+    void ConvertAllocaHelper(ConvertInstr*);
+
+    BasicBlock* curbb_{};
+    std::unordered_map<const BasicBlock*, std::vector<Point>> points_{};
+    std::unordered_map<const BasicBlock*, std::vector<const IROperand*>> phidefs_{};
+    std::vector<Move> moves_{};
+
+    std::vector<Node> nodes_{};
+    // nodes in the order they are created, for a deterministic result
+    std::vector<const IROperand*> order_{};
+    std::vector<const IROperand*> params_{};
+    BitVector allocas_{};
+    // the last use of each parameter of heterogeneous type passed in registers
+    std::unordered_map<const IROperand*, int> heters_{};
+
+    Graph<const IROperand*> interf_{};
+    // the nodes coalesced ones are merged into
+    std::vector<const IROperand*> alias_{};
+    // nodes in the order they are removed from the graph
+    std::vector<const IROperand*> stack_{};
+
+    DUInfo* info_{};
+    LoopAnalyze* loops_{};
+    Liveness* live_{};
+
+private:
+    void VisitFunction(Function*) override;
+    void VisitBasicBlock(BasicBlock*) override;
+
+    void VisitRetInstr(RetInstr*) override;
+    void VisitBrInstr(BrInstr*) override;
+    void VisitSwitchInstr(SwitchInstr*) override;
+    void VisitCallInstr(CallInstr*) override;
+
+    void VisitAddInstr(AddInstr*) override;
+    void VisitFaddInstr(FaddInstr*) override;
+    void VisitSubInstr(SubInstr*) override;
+    void VisitFsubInstr(FsubInstr*) override;
+    void VisitMulInstr(MulInstr*) override;
+    void VisitFmulInstr(FmulInstr*) override;
+    void VisitDivInstr(DivInstr*) override;
+    void VisitFdivInstr(FdivInstr*) override;
+    void VisitModInstr(ModInstr*) override;
+    void VisitShlInstr(ShlInstr*) override;
+    void VisitLshrInstr(LshrInstr*) override;
+    void VisitAshrInstr(AshrInstr*) override;
+    void VisitAndInstr(AndInstr*) override;
+    void VisitOrInstr(OrInstr*) override;
+    void VisitXorInstr(XorInstr*) override;
+
+    void VisitAllocaInstr(AllocaInstr*) override;
+    void VisitLoadInstr(LoadInstr*) override;
+    void VisitStoreInstr(StoreInstr*) override;
+    void VisitGetElePtrInstr(GetElePtrInstr*) override;
+
+    void VisitTruncInstr(TruncInstr*) override;
+    void VisitFtruncInstr(FtruncInstr*) override;
+
+    void VisitZextInstr(ZextInstr*) override;
+    void VisitSextInstr(SextInstr*) override;
+    void VisitFextInstr(FextInstr*) override;
+    void VisitFtoUInstr(FtoUInstr*) override;
+    void VisitFtoSInstr(FtoSInstr*) override;
+
+    void VisitUtoFInstr(UtoFInstr*) override;
+    void VisitStoFInstr(StoFInstr*) override;
+    void VisitPtrtoIInstr(PtrtoIInstr*) override;
+    void VisitItoPtrInstr(ItoPtrInstr*) override;
+    void VisitBitcastInstr(BitcastInstr*) override;
+
+    void VisitIcmpInstr(IcmpInstr*) override;
+    void VisitFcmpInstr(FcmpInstr*) override;
+    void VisitSelectInstr(SelectInstr*) override;
+    void VisitPhiInstr(PhiInstr*) override;
+};
+
+#endif // _COLORING_ALLOC_H_
@@ -0,0 +1,486 @@
+#include "pass/DCE.h"
+#include "IR/Instr.h"
+#include "IR/IROperand.h"
+#include "IR/Value.h"
+#include <algorithm>
+#include <fmt/format.h>
+
+
+bool DCE::HasPhi(const BasicBlock* bb)
+{
+    return !bb->Empty() && bb->Front()->Is<PhiInstr>();
+}
+
+Instr* DCE::Terminator(BasicBlock* bb)
+{
+    for (auto i : *bb)
+        if (i->IsControlInstr())
+            return i;
+    return nullptr;
+}
+
+std::vector<const BasicBlock*> DCE::Succs(BasicBlock* bb)
+{
+    std::vector<const BasicBlock*> succs{};
+    auto term = Terminator(bb);
+    if (!term)
+        return succs;
+    if (auto br = term->As<BrInstr>(); br)
+    {
+        succs.push_back(br->GetTrueBlk());
+        if (br->Cond())
+            succs.push_back(br->GetFalseBlk());
+    }
+    else if (auto swtch = term->As<SwitchInstr>(); swtch)
+    {
+        for (auto [_, blk] : swtch->GetValueBlkPairs())
+            succs.push_back(blk);
+        succs.push_back(swtch->GetDefault());
+    }
+    return succs;
+}
+
+void DCE::Retarget(Instr* term, const BasicBlock* from, const BasicBlock* to)
+{
+    auto target = const_cast<BasicBlock*>(to);
+    if (auto br = term->As<BrInstr>(); br)
+    {
+        if (br->GetTrueBlk() == from)
+            br->SetTrueBlk(target);
+        if (br->Cond() && br->GetFalseBlk() == from)
+            br->SetFalseBlk(target);
+    }
+    else if (auto swtch = term->As<SwitchInstr>(); swtch)
+    {
+        for (auto& [_, blk] : swtch->GetValueBlkPairs())
+            if (blk == from)
+                blk = to;
+        if (swtch->GetDefault() == from)
+            swtch->SetDefault(to);
+    }
+}
+
+
+void DCE::FindPreds(Function* func)
+{
+    preds_.clear();
+    for (auto bb : *func)
+    {
+        for (auto succ : Succs(bb))
+        {
+            auto& preds = preds_[succ];
+            if (std::find(preds.begin(), preds.end(), bb) == preds.end())
+                preds.push_back(bb);
+        }
+    }
+}
+
+bool DCE::FoldBranch(Function* func)
+{
+    bool changed = false;
+    for (auto bb : *func)
+    {
+        auto pos = bb->begin();
+        while (pos != bb->end() && !(*pos)->IsControlInstr())
+            ++pos;
+        if (pos == bb->end())
+            continue;
+        // Allocas are kept, since the variables may be used elsewhere.
+        for (auto i = std::next(pos); i != bb->end(); )
+        {
+            if ((*i)->Is<AllocaInstr>())
+            {
+                ++i;
+                continue;
+            }
+            i = bb->Remove(i);
+            changed = true;
+        }
+
+        auto term = *pos;
+        if (auto br = term->As<BrInstr>(); br && br->Cond() &&
+            br->GetTrueBlk() == br->GetFalseBlk())
+        {
+            br->Cond() = nullptr;
+            br->SetFalseBlk(nullptr);
+            changed = true;
+        }
+        else if (auto swtch = term->As<SwitchInstr>(); swtch)
+        {
+            auto target = swtch->GetDefault();
+            auto& cases = swtch->GetValueBlkPairs();
+            if (std::any_of(cases.begin(), cases.end(),
+                [target] (const auto& c) { return c.second != target; }))
+                continue;
+            bb->Insert(bb->Remove(pos), func->Make<BrInstr>(target));
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+bool DCE::RemoveUnreachable(Function* func)
+{
+    auto entry = func->Front();
+    std::unordered_set<const BasicBlock*> reached{ entry };
+    std::vector<BasicBlock*> worklist{ entry };
+    while (!worklist.empty())
+    {
+        auto bb = worklist.back();
+        worklist.pop_back();
+        for (auto succ : Succs(bb))
+            if (reached.insert(succ).second)
+                worklist.push_back(const_cast<BasicBlock*>(succ));
+    }
+    if (reached.size() == func->Size())
+        return false;
+
+    for (auto bb : *func)
+    {
+        if (!reached.count(bb))
+            continue;
+        for (auto i : *bb)
+        {
+            auto phi = i->As<PhiInstr>();
+            if (!phi)
+                continue;
+            auto& pairs = phi->GetBlockValPair();
+            pairs.erase(std::remove_if(pairs.begin(), pairs.end(),
+                [&reached] (const auto& pair) { return !reached.count(pair.first); }),
+                pairs.end());
+        }
+    }
+
+    for (auto i = std::prev(func->end()); i != func->begin(); )
+    {
+        auto bb = *i--;
+        if (reached.count(bb))
+            continue;
+        removed_.push_back(bb->Name());
+        // A variable may be declared where control never reaches,
+        // e.g., at the beginning of a switch body, and used later.
+        for (auto inst : *bb)
+            if (auto alloca = inst->As<AllocaInstr>(); alloca)
+                entry->Insert(entry->begin(), func->Make<AllocaInstr>(
+                    alloca->Result(), alloca->Type(), alloca->Num(), alloca->Align()));
+        func->Remove(bb);
+    }
+    return true;
+}
+
+bool DCE::Thread(Function* func)
+{
+    auto forward = [] (BasicBlock* bb) -> const BasicBlock* {
+        if (bb->Size() != 1)
+            return nullptr;
+        auto br = bb->Front()->As<BrInstr>();
+        return br && !br->Cond() && br->GetTrueBlk() != bb ?
+            br->GetTrueBlk() : nullptr;
+    };
+
+    bool changed = false;
+    FindPreds(func);
+    for (auto i = std::next(func->begin()); i != func->end(); ++i)
+    {
+        auto bb = *i;
+        auto target = forward(bb);
+        // Chains of empty blocks are threaded from the end, and a loop
+        // made up of empty blocks is left alone.
+        if (!target || forward(const_cast<BasicBlock*>(target)))
+            continue;
+
+        auto& targetpreds = preds_[target];
+        auto preds = preds_[bb];
+        for (auto pred : preds)
+        {
+            // Values coming from the predecessor would be ambiguous.
+            if (HasPhi(target) && std::find(targetpreds.begin(),
+                targetpreds.end(), pred) != targetpreds.end())
+                continue;
+
+            Retarget(Terminator(pred), bb, target);
+            for (auto inst : *const_cast<BasicBlock*>(target))
+            {
+                auto phi = inst->As<PhiInstr>();
+                if (!phi)
+                    break;
+                auto& pairs = phi->GetBlockValPair();
+                auto pair = std::find_if(pairs.begin(), pairs.end(),
+                    [bb] (const auto& p) { return p.first == bb; });
+                if (pair != pairs.end())
+                    phi->AddBlockValPair(pred, pair->second);
+            }
+
+            threaded_.push_back(fmt::format("{}: {} to {}",
+                pred->Name(), bb->Name(), target->Name()));
+            targetpreds.push_back(pred);
+            auto& bbpreds = preds_[bb];
+            bbpreds.erase(std::find(bbpreds.begin(), bbpreds.end(), pred));
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+bool DCE::Merge(Function* func)
+{
+    bool changed = false;
+    FindPreds(func);
+    // Removing a block merged leaves the position of the others intact.
+    for (auto bb : *func)
+    {
+        while (true)
+        {
+            auto term = Terminator(bb);
+            auto br = term ? term->As<BrInstr>() : nullptr;
+            if (!br || br->Cond())
+                break;
+            auto succ = const_cast<BasicBlock*>(br->GetTrueBlk());
+            if (succ == bb || succ == func->Front() ||
+                preds_[succ].size() != 1 || HasPhi(succ))
+                break;
+
+            merged_.push_back(fmt::format("{} into {}", succ->Name(), bb->Name()));
+            bb->Remove(term);
+            bb->Splice(bb->end(), *succ, succ->begin(), succ->end());
+
+            for (auto next : Succs(bb))
+            {
+                for (auto inst : *const_cast<BasicBlock*>(next))
+                {
+                    auto phi = inst->As<PhiInstr>();
+                    if (!phi)
+                        break;
+                    for (auto& pair : phi->GetBlockValPair())
+                        if (pair.first == succ)
+                            pair.first = bb;
+                }
+                auto& preds = preds_[next];
+                std::replace(preds.begin(), preds.end(), succ, bb);
+            }
+
+            func->Remove(succ);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+bool DCE::Simplify(Function* func)
+{
+    bool changed = false;
+    while (true)
+    {
+        bool round = FoldBranch(func);
+        round |= RemoveUnreachable(func);
+        round |= Thread(func);
+        round |= Merge(func);
+        if (!round)
+            return changed;
+        changed = true;
+    }
+}
+
+
+void DCE::Mark(Function* func)
+{
+    for (auto bb : *func)
+    {
+        for (auto i : *bb)
+        {
+            if (i->IsControlInstr() || i->Is<CallInstr>() ||
+                i->Is<StoreInstr>() || i->Is<LoadInstr>())
+            {
+                live_.insert(i);
+                worklist_.push_back(i);
+            }
+        }
+    }
+
+    while (!worklist_.empty())
+    {
+        auto inst = worklist_.back();
+        worklist_.pop_back();
+        const_cast<Instr*>(inst)->Accept(this);
+    }
+}
+
+void DCE::Sweep(Function* func)
+{
+    for (auto bb : *func)
+        deadinstrs_ += bb->RemoveIf(
+            [this] (const Instr* i) { return !live_.count(i); });
+}
+
+
+void DCE::Operand(const IROperand* op)
+{
+    if (!op || !op->Is<Register>() || !info_->HasDef(op))
+        return;
+    auto def = info_->GetDef(op);
+    if (live_.insert(def).second)
+        worklist_.push_back(def);
+}
+
+void DCE::BinaryHelper(BinaryInstr* bin)
+{
+    Operand(bin->Lhs());
+    Operand(bin->Rhs());
+}
+
+void DCE::ConvertHelper(ConvertInstr* cvt)
+{
+    Operand(cvt->Value());
+}
+
+
+void DCE::VisitRetInstr(RetInstr* ret)
+{
+    Operand(ret->ReturnValue());
+}
+
+void DCE::VisitBrInstr(BrInstr* br)
+{
+    Operand(br->Cond());
+}
+
+void DCE::VisitSwitchInstr(SwitchInstr* swtch)
+{
+    Operand(swtch->GetIdent());
+}
+
+void DCE::VisitCallInstr(CallInstr* call)
+{
+    Operand(call->FuncAddr());
+    for (auto arg : call->ArgvList())
+        Operand(arg);
+}
+
+
+void DCE::VisitAddInstr(AddInstr* inst) { BinaryHelper(inst); }
+void DCE::VisitFaddInstr(FaddInstr* inst) { BinaryHelper(inst); }
+void DCE::VisitSubInstr(SubInstr* inst) { BinaryHelper(inst); }
+void DCE::VisitFsubInstr(FsubInstr* inst) { BinaryHelper(inst); }
+void DCE::VisitMulInstr(MulInstr* inst) { BinaryHelper(inst); }
+void DCE::VisitFmulInstr(FmulInstr* inst) { BinaryHelper(inst); }
+void DCE::VisitDivInstr(DivInstr* inst) { BinaryHelper(inst); }
+void DCE::VisitFdivInstr(FdivInstr* inst) { BinaryHelper(inst); }
+void DCE::VisitModInstr(ModInstr* inst) { BinaryHelper(inst); }
+void DCE::VisitShlInstr(ShlInstr* inst) { BinaryHelper(inst); }
+void DCE::VisitLshrInstr(LshrInstr* inst) { BinaryHelper(inst); }
+void DCE::VisitAshrInstr(AshrInstr* inst) { BinaryHelper(inst); }
+void DCE::VisitAndInstr(AndInstr* inst) { BinaryHelper(inst); }
+void DCE::VisitOrInstr(OrInstr* inst) { BinaryHelper(inst); }
+void DCE::VisitXorInstr(XorInstr* inst) { BinaryHelper(inst); }
+
+
+void DCE::VisitLoadInstr(LoadInstr* load)
+{
+    Operand(load->Pointer());
+}
+
+void DCE::VisitStoreInstr(StoreInstr* store)
+{
+    Operand(store->Value());
+    Operand(store->Dest());
+}
+
+void DCE::VisitGetElePtrInstr(GetElePtrInstr* gep)
+{
+    Operand(gep->Pointer());
+    if (!gep->HoldsInt())
+        Operand(gep->OpIndex());
+}
+
+
+void DCE::VisitTruncInstr(TruncInstr* inst) { ConvertHelper(inst); }
+void DCE::VisitFtruncInstr(FtruncInstr* inst) { ConvertHelper(inst); }
+void DCE::VisitZextInstr(ZextInstr* inst) { ConvertHelper(inst); }
+void DCE::VisitSextInstr(SextInstr* inst) { ConvertHelper(inst); }
+void DCE::VisitFextInstr(FextInstr* inst) { ConvertHelper(inst); }
+void DCE::VisitFtoUInstr(FtoUInstr* inst) { ConvertHelper(inst); }
+void DCE::VisitFtoSInstr(FtoSInstr* inst) { ConvertHelper(inst); }
+void DCE::VisitUtoFInstr(UtoFInstr* inst) { ConvertHelper(inst); }
+void DCE::VisitStoFInstr(StoFInstr* inst) { ConvertHelper(inst); }
+void DCE::VisitPtrtoIInstr(PtrtoIInstr* inst) { ConvertHelper(inst); }
+void DCE::VisitItoPtrInstr(ItoPtrInstr* inst) { ConvertHelper(inst); }
+void DCE::VisitBitcastInstr(BitcastInstr* inst) { ConvertHelper(inst); }
+
+
+void DCE::VisitIcmpInstr(IcmpInstr* icmp)
+{
+    Operand(icmp->Op1());
+    Operand(icmp->Op2());
+}
+
+void DCE::VisitFcmpInstr(FcmpInstr* fcmp)
+{
+    Operand(fcmp->Op1());
+    Operand(fcmp->Op2());
+}
+
+void DCE::VisitSelectInstr(SelectInstr* select)
+{
+    Operand(select->SelType());
+    Operand(select->Value1());
+    Operand(select->Value2());
+}
+
+void DCE::VisitPhiInstr(PhiInstr* phi)
+{
+    for (auto [_, op] : phi->GetBlockValPair())
+        Operand(op);
+}
+
+
+std::string DCE::PrintSummary() const
+{
+    std::string summary{ fmt::format(
+        "Pass DCE in function {}:\n", CurFunc()->Name()) };
+    summary += "Blocks removed:\n";
+    for (auto& name : removed_)
+        summary += name + '\n';
+    summary += "Jumps threaded:\n";
+    for (auto& jump : threaded_)
+        summary += jump + '\n';
+    summary += "Blocks merged:\n";
+    for (auto& merge : merged_)
+        summary += merge + '\n';
+    summary += fmt::format("Instructions removed: {}\n", deadinstrs_);
+    return std::move(summary);
+}
+
+
+void DCE::ExecuteOnFunction(Function* func)
+{
+    CurFunc() = func;
+    if (Simplify(func))
+    {
+        // Passes following this one see the new flow graph.
+        dom_->ExitFunction();
+        fg_->ExitFunction();
+        info_->ExitFunction();
+        fg_->ExecuteOnFunction(func);
+        dom_->ExecuteOnFunction(func);
+        info_->ExecuteOnFunction(func);
+    }
+
+    Mark(func);
+    Sweep(func);
+    if (deadinstrs_)
+    {
+        info_->ExitFunction();
+        info_->ExecuteOnFunction(func);
+    }
+}
+
+void DCE::ExitFunction()
+{
+    preds_.clear();
+    live_.clear();
+    worklist_.clear();
+    removed_.clear();
+    threaded_.clear();
+    merged_.clear();
+    deadinstrs_ = 0;
+}
@@ -0,0 +1,128 @@
+#ifndef _DCE_H_
+#define _DCE_H_
+
+#include "pass/Pass.h"
+#include "pass/Dominators.h"
+#include "pass/DUInfo.h"
+#include "pass/FlowGraph.h"
+#include "visitir/IRVisitor.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class Module;
+class BasicBlock;
+class BinaryInstr;
+class ConvertInstr;
+class Instr;
+class IROperand;
+
+
+// Dead code elimination and CFG simplification. First the flow graph is
+// cleaned up until nothing changes: instructions following a terminator
+// are dropped, a conditional branch with both targets the same becomes a
+// jump, blocks unreachable from the entry are removed, jumps to a block
+// holding nothing but a jump are threaded to the final target, and a block
+// is merged into its only predecessor if that predecessor jumps to it
+// unconditionally. Then instructions are marked live starting from the ones
+// with side effects, following the definitions of their operands given by
+// DUInfo, and the instructions never marked are removed. Loads are kept
+// since the IR doesn't tell volatile accesses apart. The implementation is
+// based on the Dead and Clean algorithms in chapter 10 of Engineering a
+// Compiler by Cooper and Torczon.
+
+class DCE : public FunctionPass, private IRVisitor
+{
+public:
+    DCE(Module* m, Pass* fg, Pass* dom, Pass* du) : FunctionPass(m),
+        fg_(static_cast<FlowGraph*>(fg)), dom_(static_cast<Dominators*>(dom)),
+        info_(static_cast<DUInfo*>(du)) {}
+
+    std::string PrintSummary() const override;
+
+    void ExecuteOnFunction(Function*) override;
+    void ExitFunction() override;
+
+private:
+    static bool HasPhi(const BasicBlock*);
+    // the first terminator of a block, or nullptr if there's none
+    static Instr* Terminator(BasicBlock*);
+    static std::vector<const BasicBlock*> Succs(BasicBlock*);
+    // Make the terminator of a block jump to another target.
+    static void Retarget(Instr*, const BasicBlock* from, const BasicBlock* to);
+
+    void FindPreds(Function*);
+    bool FoldBranch(Function*);
+    bool RemoveUnreachable(Function*);
+    bool Thread(Function*);
+    bool Merge(Function*);
+    bool Simplify(Function*);
+
+    void Mark(Function*);
+    void Sweep(Function*);
+
+    // Mark the instruction defining an operand as live.
+    void Operand(const IROperand*);
+    void BinaryHelper(BinaryInstr*);
+    void ConvertHelper(ConvertInstr*);
+
+    std::unordered_map<const BasicBlock*, std::vector<BasicBlock*>> preds_{};
+    std::unordered_set<const Instr*> live_{};
+    std::vector<const Instr*> worklist_{};
+
+    std::vector<std::string> removed_{};
+    std::vector<std::string> threaded_{};
+    std::vector<std::string> merged_{};
+    int deadinstrs_{};
+
+    FlowGraph* fg_{};
+    Dominators* dom_{};
+    DUInfo* info_{};
+
+private:
+    void VisitRetInstr(RetInstr*) override;
+    void VisitBrInstr(BrInstr*) override;
+    void VisitSwitchInstr(SwitchInstr*) override;
+    void VisitCallInstr(CallInstr*) override;
+
+    void VisitAddInstr(AddInstr*) override;
+    void VisitFaddInstr(FaddInstr*) override;
+    void VisitSubInstr(SubInstr*) override;
+    void VisitFsubInstr(FsubInstr*) override;
+    void VisitMulInstr(MulInstr*) override;
+    void VisitFmulInstr(FmulInstr*) override;
+    void VisitDivInstr(DivInstr*) override;
+    void VisitFdivInstr(FdivInstr*) override;
+    void VisitModInstr(ModInstr*) override;
+    void VisitShlInstr(ShlInstr*) override;
+    void VisitLshrInstr(LshrInstr*) override;
+    void VisitAshrInstr(AshrInstr*) override;
+    void VisitAndInstr(AndInstr*) override;
+    void VisitOrInstr(OrInstr*) override;
+    void VisitXorInstr(XorInstr*) override;
+
+    void VisitLoadInstr(LoadInstr*) override;
+    void VisitStoreInstr(StoreInstr*) override;
+    void VisitGetElePtrInstr(GetElePtrInstr*) override;
+
+    void VisitTruncInstr(TruncInstr*) override;
+    void VisitFtruncInstr(FtruncInstr*) override;
+    void VisitZextInstr(ZextInstr*) override;
+    void VisitSextInstr(SextInstr*) override;
+    void VisitFextInstr(FextInstr*) override;
+    void VisitFtoUInstr(FtoUInstr*) override;
+    void VisitFtoSInstr(FtoSInstr*) override;
+    void VisitUtoFInstr(UtoFInstr*) override;
+    void VisitStoFInstr(StoFInstr*) override;
+    void VisitPtrtoIInstr(PtrtoIInstr*) override;
+    void VisitItoPtrInstr(ItoPtrInstr*) override;
+    void VisitBitcastInstr(BitcastInstr*) override;
+
+    void VisitIcmpInstr(IcmpInstr*) override;
+    void VisitFcmpInstr(FcmpInstr*) override;
+    void VisitSelectInstr(SelectInstr*) override;
+    void VisitPhiInstr(PhiInstr*) override;
+};
+
+#endif // _DCE_H_
@@ -25,13 +25,69 @@ void DUInfo::ConvertDUHelper(ConvertInstr* cvt)
 {
     AddDef(cvt->Dest(), cvt);
     AddDef(curbb_, cvt->Dest());
-    AddUse(cvt->Value(), cvt);
-    AddUse(curbb_, cvt->Value());
+    if (cvt->Value()->Is<Register>())
+    {
+        AddUse(cvt->Value(), cvt);
+        AddUse(curbb_, cvt->Value());
+    }
+}
+
+
+void DUInfo::AddDef(const IROperand* op, const Instr* i)
+{
+    if (!Numbered(op))
+        return;
+    if (Number(op) >= def_.size())
+        def_.resize(Number(op) + 1);
+    if (!def_[Number(op)])
+        def_[Number(op)] = i;
+}
+
+void DUInfo::AddUse(const IROperand* op, const Instr* i)
+{
+    if (!Numbered(op))
+        return;
+    if (Number(op) >= uses_.size())
+        uses_.resize(Number(op) + 1);
+    uses_[Number(op)].push_back(i);
+}
+
+void DUInfo::AddPhiUse(const BasicBlock* bb, const IROperand* op)
+{
+    if (Numbered(op))
+        Block(bb).phiuse_.push_back(op);
+}
+
+void DUInfo::Insert(BitVector& set, const IROperand* op)
+{
+    if (!Numbered(op))
+        return;
+    set.Reserve(Number(op) + 1);
+    set.Set(Number(op));
+}
+
+
+DUInfo::BlockDU& DUInfo::Block(const BasicBlock* bb)
+{
+    if (bb->Number() >= blocks_.size())
+        blocks_.resize(bb->Number() + 1);
+    return blocks_[bb->Number()];
+}
+
+const DUInfo::BlockDU& DUInfo::Block(const BasicBlock* bb) const
+{
+    static const BlockDU empty{};
+    if (bb->Number() >= blocks_.size())
+        return empty;
+    return blocks_[bb->Number()];
 }
 
 
 void DUInfo::VisitFunction(Function* func)
 {
+    blocks_.resize(func->BlockNumbers());
+    def_.resize(func->RegNumbers());
+    uses_.resize(func->RegNumbers());
     for (auto b : *func)
         VisitBasicBlock(b);
 }
@@ -204,47 +260,61 @@ void DUInfo::VisitPhiInstr(PhiInstr* phi)
 {
     AddDef(phi->Result(), phi);
     AddPhiDef(curbb_, phi->Result());
-    for (auto [_, op] : phi->GetBlockValPair())
+    // A phi use takes place at the end of the corresponding
+    // predecessor, rather than in the block of the phi itself.
+    for (auto [bb, op] : phi->GetBlockValPair())
     {
         if (op->Is<Register>())
         {
             AddUse(op, phi);
-            AddPhiUse(curbb_, op);
+            AddPhiUse(bb, op);
         }
     }
 }
 
 
 #define SUMMARY_HELPER                                      \
-if (ops.size() == 0)                                        \
-    continue;                                               \
-auto last = std::for_each_n(ops.begin(), ops.size() - 1,    \
-    [&] (const IROperand* op) {                             \
-        summary += op->As<Register>()->Name();              \
-    });                                                     \
-summary += (*last)->As<Register>()->Name()
+auto sep = "";                                              \
+for (auto op : ops)                                         \
+{                                                           \
+    summary += sep + op->As<Register>()->Name();            \
+    sep = ", ";                                             \
+}                                                           \
+summary += '\n'
 
 std::string DUInfo::PrintSummary() const
 {
     std::string summary{ fmt::format(
         "Pass DUInfo in function {}:\n", CurFunc()->Name()) };
-    for (auto& [bb, ops] : bbdef_)
+    for (auto bb : *CurFunc())
     {
+        const auto& ops = GetDef(bb);
+        if (ops.empty())
+            continue;
         summary += fmt::format("IR operands defined in {}:\n", bb->Name());
         SUMMARY_HELPER;
     }
-    for (auto& [bb, ops] : bbuse_)
+    for (auto bb : *CurFunc())
     {
+        const auto& ops = GetUse(bb);
+        if (ops.empty())
+            continue;
         summary += fmt::format("IR operands used in {}:\n", bb->Name());
         SUMMARY_HELPER;
     }
-    for (auto& [bb, ops] : bbphidef_)
+    for (auto bb : *CurFunc())
     {
+        const auto& ops = GetPhiDef(bb);
+        if (ops.empty())
+            continue;
         summary += fmt::format("IR operands defined by phi instruction in {}:\n", bb->Name());
         SUMMARY_HELPER;
     }
-    for (auto& [bb, ops] : bbphidef_)
+    for (auto bb : *CurFunc())
     {
+        const auto& ops = GetPhiUse(bb);
+        if (ops.empty())
+            continue;
         summary += fmt::format("IR operands used in phi instruction in {}:\n", bb->Name());
         SUMMARY_HELPER;
     }
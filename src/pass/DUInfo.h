@@ -2,11 +2,11 @@
 #define _DU_INFO_H_
 
 #include "pass/Pass.h"
+#include "utils/BitVector.h"
 #include "visitir/IRVisitor.h"
 #include <list>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
 class BinaryInstr;
 class ConvertInstr;
@@ -14,6 +14,54 @@ class IROperand;
 class Instr;
 
 
+// A set of registers of a function, as bits over their numbers,
+// iterated over as operands.
+class RegisterSet
+{
+public:
+    using Registers = std::vector<const Register*>;
+
+    class Iterator
+    {
+    public:
+        using difference_type = ptrdiff_t;
+        using value_type = const IROperand*;
+        using pointer = const IROperand**;
+        using reference = const IROperand*;
+        using iterator_category = std::forward_iterator_tag;
+
+        Iterator(BitVector::Iterator i, const Registers& regs) :
+            bit_(i), registers_(&regs) {}
+
+        const IROperand* operator*() const { return (*registers_)[*bit_]; }
+        auto& operator++() { ++bit_; return *this; }
+        auto operator++(int) { auto retval = *this; ++bit_; return retval; }
+        bool operator==(const Iterator& other) const { return bit_ == other.bit_; }
+        bool operator!=(const Iterator& other) const { return bit_ != other.bit_; }
+
+    private:
+        BitVector::Iterator bit_;
+        const Registers* registers_{};
+    };
+
+    RegisterSet(const BitVector& set, const Registers& regs) :
+        set_(&set), registers_(&regs) {}
+
+    auto begin() const { return Iterator(set_->begin(), *registers_); }
+    auto end() const { return Iterator(set_->end(), *registers_); }
+    size_t size() const { return set_->Count(); }
+    bool empty() const { return set_->Empty(); }
+
+private:
+    const BitVector* set_{};
+    const Registers* registers_{};
+};
+
+
+// Registers are recorded by their numbers, see Function::MakeRegister.
+// Those of the module, i.e., the addresses of globals, are never defined
+// in a function nor kept in a register, so nothing is recorded for them.
+
 class DUInfo : public FunctionPass, private IRVisitor
 {
 public:
@@ -28,61 +76,92 @@ public:
     }
     void ExitFunction() override
     {
-        def_.clear(); uses_.clear(); bbdef_.clear();
-        bbuse_.clear(); bbphidef_.clear(); bbphiuse_.clear();
+        def_.clear(); uses_.clear(); blocks_.clear();
     }
 
-    bool HasDef(const BasicBlock* bb) const { return bbdef_.count(bb); }
-    bool HasPhiDef(const BasicBlock* bb) const { return bbphidef_.count(bb); }
-    bool HasUse(const BasicBlock* bb) const { return bbuse_.count(bb); }
-    bool HasPhiUse(const BasicBlock* bb) const { return bbphiuse_.count(bb); }
-
-    const Instr* GetDef(const IROperand* op) const { return def_.at(op); }
-    const auto& GetDef(const BasicBlock* bb) const { return bbdef_.at(bb); }
-    auto GetPhiDef(const BasicBlock* bb) const { return bbphidef_.at(bb); }
-
-    const auto& GetUse(const IROperand* op) const { return uses_.at(op); }
-    const auto& GetUse(const BasicBlock* bb) const { return bbuse_.at(bb); }
-    const auto& GetPhiUse(const BasicBlock* bb) const { return bbphiuse_.at(bb); }
-    bool IsLastUse(const IROperand* op, const Instr* i) const { return uses_.at(op).back() == i; }
-
-    void AddDef(const IROperand* op, const Instr* i) { def_.emplace(op, i); }
-    void AddDef(const BasicBlock* bb, const IROperand* op) { bbdef_[bb].insert(op); }
-    void AddPhiDef(const BasicBlock* bb, const IROperand* op) { bbphidef_[bb].insert(op); }
-
-    void AddUse(const IROperand* op, const Instr* i) { uses_[op].push_back(i); }
-    void AddUse(const BasicBlock* bb, const IROperand* op) { bbuse_[bb].insert(op); }
-    void AddPhiUse(const BasicBlock* bb, const IROperand* op) { bbphiuse_[bb].push_back(op); }
-
-    void DelDef(const IROperand* op) { def_.erase(op); }
-    void DelDef(const BasicBlock* bb) { bbdef_.erase(bb); }
-    void DelDef(const BasicBlock* bb, const IROperand* op) { bbdef_.at(bb).erase(op); }
-    void DelPhiDef(const BasicBlock* bb) { bbphidef_.erase(bb); }
-
-    void DelUse(const IROperand* op) { uses_.erase(op); }
-    void DelUse(const IROperand* op, const Instr* i) { uses_.at(op).remove(i); }
-    void DelUse(const BasicBlock* bb) { bbuse_.erase(bb); }
-    void DelUse(const BasicBlock* bb, const IROperand* op) { bbuse_.at(bb).erase(op); }
-    void DelPhiUse(const BasicBlock* bb, const IROperand* op) { bbphiuse_.at(bb).remove(op); }
+    bool HasDef(const BasicBlock* bb) const { return Has(bb, &BlockDU::def_); }
+    bool HasDef(const IROperand* op) const
+    { return Number(op) < def_.size() && def_[Number(op)]; }
+    bool HasPhiDef(const BasicBlock* bb) const { return Has(bb, &BlockDU::phidef_); }
+    bool HasUse(const BasicBlock* bb) const { return Has(bb, &BlockDU::use_); }
+    bool HasPhiUse(const BasicBlock* bb) const { return Has(bb, &BlockDU::phiuse_); }
+    bool HasUse(const IROperand* op) const
+    { return Number(op) < uses_.size() && !uses_[Number(op)].empty(); }
+
+    const Instr* GetDef(const IROperand* op) const { return def_.at(Number(op)); }
+    RegisterSet GetDef(const BasicBlock* bb) const { return Set(Block(bb).def_); }
+    RegisterSet GetPhiDef(const BasicBlock* bb) const { return Set(Block(bb).phidef_); }
+
+    const auto& GetUse(const IROperand* op) const { return uses_.at(Number(op)); }
+    RegisterSet GetUse(const BasicBlock* bb) const { return Set(Block(bb).use_); }
+    const auto& GetPhiUse(const BasicBlock* bb) const { return Block(bb).phiuse_; }
+    bool IsLastUse(const IROperand* op, const Instr* i) const { return GetUse(op).back() == i; }
+
+    void AddDef(const IROperand* op, const Instr* i);
+    void AddDef(const BasicBlock* bb, const IROperand* op) { Insert(Block(bb).def_, op); }
+    void AddPhiDef(const BasicBlock* bb, const IROperand* op) { Insert(Block(bb).phidef_, op); }
+
+    void AddUse(const IROperand* op, const Instr* i);
+    void AddUse(const BasicBlock* bb, const IROperand* op) { Insert(Block(bb).use_, op); }
+    void AddPhiUse(const BasicBlock* bb, const IROperand* op);
+
+    void DelDef(const IROperand* op) { if (HasDef(op)) def_[Number(op)] = nullptr; }
+    void DelDef(const BasicBlock* bb) { Block(bb).def_.Clear(); }
+    void DelDef(const BasicBlock* bb, const IROperand* op) { Erase(Block(bb).def_, op); }
+    void DelPhiDef(const BasicBlock* bb) { Block(bb).phidef_.Clear(); }
+
+    void DelUse(const IROperand* op) { if (HasUse(op)) uses_[Number(op)].clear(); }
+    void DelUse(const IROperand* op, const Instr* i) { if (HasUse(op)) uses_[Number(op)].remove(i); }
+    void DelUse(const BasicBlock* bb) { Block(bb).use_.Clear(); }
+    void DelUse(const BasicBlock* bb, const IROperand* op) { Erase(Block(bb).use_, op); }
+    void DelPhiUse(const BasicBlock* bb, const IROperand* op) { Block(bb).phiuse_.remove(op); }
 
 private:
     void BinaryDUHelper(BinaryInstr*);
     void ConvertDUHelper(ConvertInstr*);
 
+    // Operands other than registers of the function get a number past any table.
+    static size_t Number(const IROperand* op)
+    {
+        auto reg = op->As<Register>();
+        return reg ? reg->Number() : static_cast<size_t>(-1);
+    }
+    static bool Numbered(const IROperand* op) { return Number(op) != static_cast<size_t>(-1); }
+    static void Insert(BitVector&, const IROperand*);
+    static void Erase(BitVector& set, const IROperand* op)
+    { if (set.Test(Number(op))) set.Reset(Number(op)); }
+    RegisterSet Set(const BitVector& set) const { return { set, CurFunc()->Registers() }; }
+
     const BasicBlock* curbb_{};
 
-    std::unordered_map<const IROperand*, const Instr*> def_{};
-    std::unordered_map<const IROperand*, std::list<const Instr*>> uses_{};
-
-    // variables defined (without phi) in basic blocks
-    std::unordered_map<const BasicBlock*, std::unordered_set<const IROperand*>> bbdef_{};
-    // variables used (without phi) in basic blocks
-    std::unordered_map<const BasicBlock*, std::unordered_set<const IROperand*>> bbuse_{};
-    // variables defined by a phi instruction;
-    std::unordered_map<const BasicBlock*, std::unordered_set<const IROperand*>> bbphidef_{};
-    // variables used in phi instructions; use list to save some memory,
-    // since there's no need to keep the elements unique
-    std::unordered_map<const BasicBlock*, std::list<const IROperand*>> bbphiuse_{};
+    // indexed by the numbers of registers
+    std::vector<const Instr*> def_{};
+    std::vector<std::list<const Instr*>> uses_{};
+
+    struct BlockDU
+    {
+        // variables defined (without phi) in the block
+        BitVector def_{};
+        // variables used (without phi) in the block
+        BitVector use_{};
+        // variables defined by a phi instruction
+        BitVector phidef_{};
+        // variables used in phi instructions; use list to save some memory,
+        // since there's no need to keep the elements unique
+        std::list<const IROperand*> phiuse_{};
+    };
+    // indexed by the numbers of blocks
+    std::vector<BlockDU> blocks_{};
+
+    // Blocks added after the pass ran, and the exit, have nothing.
+    // Recording something for such a block makes room for it.
+    BlockDU& Block(const BasicBlock*);
+    const BlockDU& Block(const BasicBlock*) const;
+    template <class T>
+    bool Has(const BasicBlock* bb, T BlockDU::* field) const
+    { return bb && bb->Number() < blocks_.size() && !Empty(blocks_[bb->Number()].*field); }
+    static bool Empty(const BitVector& set) { return set.Empty(); }
+    static bool Empty(const std::list<const IROperand*>& list) { return list.empty(); }
 
 private:
     void VisitFunction(Function*) override;
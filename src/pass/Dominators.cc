@@ -1,15 +1,18 @@
 #include "pass/Dominators.h"
 #include "utils/Graph.h"
+#include <algorithm>
 #include <fmt/format.h>
 
 
 void Dominators::DFS(const FlowGraph::GraphType& fg, const BasicBlock* bb, int& poi)
 {
+    // mark bb as visited before walking through its successors
+    indexof_[bb->Number()] = visiting_;
     for (auto [to, _] : fg[bb])
-        // not present in the set
-        if (!indexof_.count(to))
+        // neither the exit nor visited
+        if (to && IndexOf(to) == unreached_)
             DFS(fg, to, poi);
-    indexof_[bb] = poi;
+    indexof_[bb->Number()] = poi;
     bbvia_.push_back(bb);
     poi += 1;
 }
@@ -18,10 +21,10 @@ void Dominators::MapPostorder(const Function* func)
 {
     auto& fg = graphs_->GetFlowGraph();
     int poi = 0; // post-order index
+    indexof_.assign(func->BlockNumbers(), unreached_);
 
-    for (auto& v : fg.GetVertices())
-        if (auto vv = *v; !indexof_.count(vv))
-            DFS(fg, vv, poi);
+    // Blocks unreachable from the entry have no dominators at all.
+    DFS(fg, func->Front(), poi);
 
     idom_.reserve(poi);
     std::fill_n(std::back_inserter(idom_), poi, -1);
@@ -29,9 +32,8 @@ void Dominators::MapPostorder(const Function* func)
 
 void Dominators::FindIDom(const Function* func)
 {
-    int start = indexof_[func->At(0)];
+    int start = IndexOf(func->Front());
 
-    const auto& flow = graphs_->GetFlowGraph();
     auto defined = [this] (int po) -> bool {
         return idom_[po] != -1;
     };
@@ -41,23 +43,21 @@ void Dominators::FindIDom(const Function* func)
     while (changing)
     {
         changing = false;
-        // Except the start node (the node with the biggest postorder number)
-        for (auto i = bbvia_.size() - 1; i >= 0; --i)
+        // In reverse postorder, except the start node
+        // (the node with the biggest postorder number)
+        for (int i = start - 1; i >= 0; --i)
         {
             int newidom = -1;
             auto node = bbvia_[i];
-            // Pick some processed predecessor of the current block
-            for (auto& [_, pred] : graphs_->GetPredsOf(node))
+            for (auto pred : graphs_->GetPredsOf(node))
             {
-                if (auto p = indexof_[pred]; defined(p))
-                {
-                    newidom = p;
-                    break;
-                }
+                auto p = IndexOf(pred);
+                if (p == unreached_ || !defined(p))
+                    continue;
+                // Pick some processed predecessor of the current block
+                // first, then intersect it with the other ones.
+                newidom = newidom == -1 ? p : Intersect(p, newidom);
             }
-            for (auto& [_, pred] : graphs_->GetPredsOf(node))
-                if (auto p = indexof_[pred]; defined(p))
-                    newidom = Intersect(p, newidom);
             if (idom_[i] != newidom)
             {
                 idom_[i] = newidom;
@@ -82,27 +82,93 @@ int Dominators::Intersect(int b1, int b2)
 
 void Dominators::ConstructDoms(const Function* func)
 {
-    auto start = func->At(0);
-    domins_.emplace(start, start);
-    for (auto& [node, _] : indexof_)
+    auto start = func->Front();
+    domins_.resize(func->BlockNumbers());
+    children_.resize(func->BlockNumbers());
+    domins_[start->Number()].push_back(start);
+    for (int index = 0; index < bbvia_.size(); ++index)
     {
+        auto node = bbvia_[index];
+        if (node == start)
+            continue;
+        children_[bbvia_[idom_[index]]->Number()].push_back(node);
+        auto& doms = domins_[node->Number()];
         for (auto current = node; current != start; )
         {
-            domins_.emplace(node, current);
-            current = bbvia_[idom_[indexof_[current]]];
+            doms.push_back(current);
+            current = bbvia_[idom_[IndexOf(current)]];
         }
+        doms.push_back(start);
     }
 }
 
+void Dominators::FindFrontier(const Function* func)
+{
+    frontier_.resize(func->BlockNumbers());
+    for (auto node : bbvia_)
+    {
+        std::unordered_set<const BasicBlock*> preds{};
+        for (auto pred : graphs_->GetPredsOf(node))
+            if (Reachable(pred))
+                preds.insert(pred);
+        if (preds.size() < 2)
+            continue;
+
+        auto idom = bbvia_[idom_[IndexOf(node)]];
+        for (auto runner : preds)
+        {
+            while (runner != idom)
+            {
+                auto& frontier = frontier_[runner->Number()];
+                if (std::find(frontier.begin(), frontier.end(), node) != frontier.end())
+                    break;
+                frontier.push_back(node);
+                runner = bbvia_[idom_[IndexOf(runner)]];
+            }
+        }
+    }
+}
+
+
+int Dominators::IndexOf(const BasicBlock* bb) const
+{
+    return bb->Number() < indexof_.size() ? indexof_[bb->Number()] : unreached_;
+}
+
+const Dominators::Blocks& Dominators::Find(
+    const std::vector<Blocks>& table, const BasicBlock* bb)
+{
+    static const Blocks none{};
+    return bb->Number() < table.size() ? table[bb->Number()] : none;
+}
+
+const BasicBlock* Dominators::GetIDom(const BasicBlock* bb) const
+{
+    if (!Reachable(bb))
+        return nullptr;
+    auto idom = bbvia_[idom_[IndexOf(bb)]];
+    return idom == bb ? nullptr : idom;
+}
+
+bool Dominators::Dominate(const BasicBlock* dom, const BasicBlock* bb) const
+{
+    const auto& doms = GetDominators(bb);
+    return std::find(doms.begin(), doms.end(), dom) != doms.end();
+}
+
 
 std::string Dominators::PrintSummary() const
 {
     std::string summary{ fmt::format(
         "Pass Dominators in function {}:\n", CurFunc()->Name()) };
     summary += "basic block : dominated by the basic block\n";
-    for (auto [k, v] : domins_)
-        if (k && v)
-            summary += fmt::format("{} : {}\n", k->Name(), v->Name());
+    for (auto bb : *CurFunc())
+        for (auto dom : GetDominators(bb))
+            summary += fmt::format("{} : {}\n", bb->Name(), dom->Name());
+    summary += "basic block : dominance frontier\n";
+    for (auto bb : *CurFunc())
+        for (auto frontier : GetDomFrontier(bb))
+            summary += fmt::format("{} : {}\n", bb->Name(), frontier->Name());
     return std::move(summary);
 }
 
@@ -112,6 +178,8 @@ void Dominators::ExecuteOnFunction(Function* func)
     CurFunc() = func;
     MapPostorder(func);
     FindIDom(func);
+    ConstructDoms(func);
+    FindFrontier(func);
 }
 
 void Dominators::ExitFunction()
@@ -120,4 +188,6 @@ void Dominators::ExitFunction()
     bbvia_.clear();
     idom_.clear();
     domins_.clear();
+    children_.clear();
+    frontier_.clear();
 }
@@ -4,7 +4,6 @@
 #include "pass/Pass.h"
 #include "pass/FlowGraph.h"
 #include <string>
-#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -15,6 +14,10 @@ class Module;
 // on A Simple, Fast Dominance Algorithm by Cooper, Harvey & Kennedy (2006).
 // See https://www.researchgate.net/publication/2569680_A_Simple_Fast_Dominance_Algorithm
 // for more information.
+// Besides the dominator sets, the pass keeps the dominator tree and the
+// dominance frontiers (computed by the algorithm in section 4 of the same
+// paper), which are needed to place phi instructions during SSA construction.
+// Only blocks reachable from the entry are taken into account.
 
 class Dominators : public FunctionPass
 {
@@ -27,20 +30,41 @@ public:
     void ExecuteOnFunction(Function*) override;
     void ExitFunction() override;
 
-    auto GetDominators(const BasicBlock* bb) const { return domins_.equal_range(bb); }
+    using Blocks = std::vector<const BasicBlock*>;
+    const Blocks& GetDominators(const BasicBlock* bb) const { return Find(domins_, bb); }
+    // Blocks immediately dominated by bb, i.e., children of bb in the dominator tree.
+    const Blocks& GetChildren(const BasicBlock* bb) const { return Find(children_, bb); }
+    const Blocks& GetDomFrontier(const BasicBlock* bb) const { return Find(frontier_, bb); }
+
+    // Return nullptr for the entry block and unreachable blocks.
+    const BasicBlock* GetIDom(const BasicBlock*) const;
+    bool Dominate(const BasicBlock* dom, const BasicBlock* bb) const;
+    bool Reachable(const BasicBlock* bb) const { return bb && IndexOf(bb) >= 0; }
 
 private:
     void DFS(const FlowGraph::GraphType&, const BasicBlock*, int&);
     void MapPostorder(const Function*);
     void FindIDom(const Function*);
     int Intersect(int, int);
+    // Blocks added after the pass ran have no entries.
+    int IndexOf(const BasicBlock*) const;
+    static const Blocks& Find(const std::vector<Blocks>&, const BasicBlock*);
     void ConstructDoms(const Function*);
+    void FindFrontier(const Function*);
 
+    // Blocks are indexed by their postorder numbers in
+    // bbvia_ and idom_, and by their own numbers below.
     std::vector<const BasicBlock*> bbvia_{};
-    std::unordered_map<const BasicBlock*, int> indexof_{};
     std::vector<int> idom_{};
 
-    std::unordered_multimap<const BasicBlock*, const BasicBlock*> domins_{};
+    // the postorder number, or one of the marks below
+    std::vector<int> indexof_{};
+    static constexpr int unreached_ = -1;
+    static constexpr int visiting_ = -2;
+
+    std::vector<Blocks> domins_{};
+    std::vector<Blocks> children_{};
+    std::vector<Blocks> frontier_{};
     FlowGraph* graphs_{};
 };
 
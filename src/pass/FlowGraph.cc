@@ -4,75 +4,68 @@
 #include <fmt/format.h>
 
 
-void FlowGraph::VisitBasicBlock(BasicBlock* bb)
+void FlowGraph::VisitBasicBlock(GraphType::Builder& flow, BasicBlock* bb)
 {
     for (auto i : *bb)
     {
         switch (i->id_)
         {
+        // Instructions following the first
+        // terminator are never executed.
         case Instr::InstrId::br:
-            VisitBrInstr(bb, i->As<BrInstr>());
-            break;
+            VisitBrInstr(flow, bb, i->As<BrInstr>());
+            return;
         case Instr::InstrId::swtch:
-            VisitSwitchInstr(bb, i->As<SwitchInstr>());
-            break;
+            VisitSwitchInstr(flow, bb, i->As<SwitchInstr>());
+            return;
         case Instr::InstrId::ret:
-            VisitRetInstr(bb, i->As<RetInstr>());
-            break;
+            VisitRetInstr(flow, bb, i->As<RetInstr>());
+            return;
         }
     }
 }
 
-void FlowGraph::VisitBrInstr(BasicBlock* bb, BrInstr* br)
+void FlowGraph::VisitBrInstr(GraphType::Builder& flow, BasicBlock* bb, BrInstr* br)
 {
     if (br->Cond())
     {
-        flow_.AddValueEdge(
+        flow.AddValueEdge(
             bb, br->GetTrueBlk(), { br->Cond(), true });
-        flow_.AddValueEdge(
+        flow.AddValueEdge(
             bb, br->GetFalseBlk(), { br->Cond(), false });
-        preds_.emplace(br->GetTrueBlk(), bb);
-        preds_.emplace(br->GetFalseBlk(), bb);
     }
     else
-    {
-        flow_.AddValueEdge(
+        flow.AddValueEdge(
             bb, br->GetTrueBlk(), { nullptr, true });
-        preds_.emplace(br->GetTrueBlk(), bb);
-    }
 }
 
-void FlowGraph::VisitSwitchInstr(BasicBlock* bb, SwitchInstr* s)
+void FlowGraph::VisitSwitchInstr(GraphType::Builder& flow, BasicBlock* bb, SwitchInstr* s)
 {
     for (auto [i, to] : s->GetValueBlkPairs())
-    {
-        flow_.AddValueEdge(bb, to, { i, true });
-        preds_.emplace(to, bb);
-    }
+        flow.AddValueEdge(bb, to, { i, true });
 
-    flow_.AddValueEdge(
+    flow.AddValueEdge(
         bb, s->GetDefault(), { s->GetIdent(), false });
-    preds_.emplace(s->GetDefault(), bb);
 }
 
-void FlowGraph::VisitRetInstr(BasicBlock* bb, RetInstr* r)
+void FlowGraph::VisitRetInstr(GraphType::Builder& flow, BasicBlock* bb, RetInstr* r)
 {
-    flow_.AddValueEdge(bb, nullptr, { nullptr, true });
+    flow.AddValueEdge(bb, nullptr, { nullptr, true });
 }
 
 
 std::string FlowGraph::PrintSummary() const
 {
     std::string summary{ fmt::format("Pass FlowGraph in function {}:\n", CurFunc()->Name()) };
-    for (auto [v, adj] : flow_)
+    for (auto v : flow_.GetVertices())
     {
-        for (auto [to, cond] : *adj)
+        for (auto [to, cond] : flow_[v])
         {
             if (to == nullptr)
-                summary += fmt::format("{} -> exit\n", (**v)->Name());
+                summary += fmt::format("{} -> exit\n", v->Name());
             else
             {
-                summary += fmt::format("{} -> {}", (**v)->Name(), to->Name());
+                summary += fmt::format("{} -> {}", v->Name(), to->Name());
                 if (!cond.first)
                     summary += '\n';
                 else if (cond.second)
@@ -89,10 +82,12 @@ std::string FlowGraph::PrintSummary() const
 void FlowGraph::ExecuteOnFunction(Function* func)
 {
     CurFunc() = func;
+    GraphType::Builder flow{};
     for (auto bb : *func)
-        flow_.AddVertex(bb);
+        flow.AddVertex(bb);
     // Stands for exit
-    flow_.AddVertex(nullptr);
+    flow.AddVertex(nullptr);
     for (auto bb : *func)
-        VisitBasicBlock(bb);
+        VisitBasicBlock(flow, bb);
+    flow_ = flow.Build();
 }
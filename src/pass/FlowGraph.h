@@ -4,7 +4,7 @@
 #include "pass/Pass.h"
 #include "utils/Graph.h"
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 class Module;
 class Function;
@@ -20,49 +20,34 @@ class FlowGraph : public FunctionPass
 {
 public:
     using JumpCond = std::pair<const IROperand*, bool>;
-    using GraphType = Graph<const BasicBlock*, JumpCond>;
 
-    template <class ITER>
-    class PredsIter
+    // The exit takes index 0 and blocks follow by their numbers. A block
+    // numbered after the graph was built falls past the last row, so the
+    // graph reads it as having no edges rather than as the exit.
+    struct BlockIndex
     {
-    public:
-        PredsIter(ITER b, ITER e) : begin_(b), end_(e) {}
-        ITER begin() { return begin_; }
-        ITER end() { return end_; }
-    private:
-        ITER begin_{};
-        ITER end_{};
+        int operator()(const BasicBlock* bb) const { return bb ? static_cast<int>(bb->Number()) + 1 : 0; }
+        int Add(const BasicBlock* bb) { return (*this)(bb); }
     };
+    using GraphType = CSRGraph<const BasicBlock*, JumpCond, BlockIndex>;
 
     FlowGraph(Module* m) : FunctionPass(m) {}
 
     std::string PrintSummary() const override;
 
     void ExecuteOnFunction(Function*) override;
-    void ExitFunction() override { flow_.Clear(); preds_.clear(); }
+    void ExitFunction() override { flow_.Clear(); }
 
     const auto& GetFlowGraph() const { return flow_; }
-    auto& GetFlowGraph() { return flow_; }
-
-    const auto GetPredsOf(const BasicBlock* bb) const
-    {
-        auto [b, e] = preds_.equal_range(bb);
-        return PredsIter(b, e);
-    }
-    auto GetPredsOf(const BasicBlock* bb)
-    {
-        auto [b, e] = preds_.equal_range(bb);
-        return PredsIter(b, e);
-    }
+    auto GetPredsOf(const BasicBlock* bb) const { return flow_.GetPreds(bb); }
 
 private:
-    void VisitBasicBlock(BasicBlock*);
-    void VisitBrInstr(BasicBlock*, BrInstr*);
-    void VisitSwitchInstr(BasicBlock*, SwitchInstr*);
-    void VisitRetInstr(BasicBlock*, RetInstr*);
+    void VisitBasicBlock(GraphType::Builder&, BasicBlock*);
+    void VisitBrInstr(GraphType::Builder&, BasicBlock*, BrInstr*);
+    void VisitSwitchInstr(GraphType::Builder&, BasicBlock*, SwitchInstr*);
+    void VisitRetInstr(GraphType::Builder&, BasicBlock*, RetInstr*);
 
-    Graph<const BasicBlock*, JumpCond> flow_{};
-    std::unordered_multimap<const BasicBlock*, const BasicBlock*> preds_{};
+    GraphType flow_{};
 };
 
 #endif // _FLOW_GRAPH_H_
@@ -0,0 +1,306 @@
+#include "pass/GVN.h"
+#include "IR/Instr.h"
+#include "IR/IROperand.h"
+#include "IR/IRType.h"
+#include "IR/Value.h"
+#include <cstring>
+#include <functional>
+#include <fmt/format.h>
+
+
+size_t GVN::ExprHash::operator()(const Expr& e) const
+{
+    auto h = std::hash<int>()(static_cast<int>(e.id_));
+    h = h * 31 + std::hash<const void*>()(e.type_);
+    h = h * 31 + std::hash<const void*>()(e.op1_);
+    h = h * 31 + std::hash<const void*>()(e.op2_);
+    return h * 31 + std::hash<long>()(e.extra_);
+}
+
+
+void GVN::Number(BasicBlock* bb)
+{
+    auto mark = scope_.size();
+    for (auto i : *bb)
+    {
+        curinst_ = i;
+        i->Accept(this);
+        if (i->IsControlInstr())
+            break;
+    }
+
+    for (auto child : dom_->GetChildren(bb))
+        Number(const_cast<BasicBlock*>(child));
+
+    while (scope_.size() > mark)
+    {
+        table_.erase(scope_.back());
+        scope_.pop_back();
+    }
+}
+
+void GVN::Rewrite(Function* func)
+{
+    mode_ = Mode::rewrite;
+    for (auto bb : *func)
+        for (auto i = bb->end(); i != bb->begin(); )
+        {
+            auto inst = *--i;
+            if (dead_.count(inst))
+                i = bb->Remove(i);
+            else
+                inst->Accept(this);
+        }
+}
+
+
+const IROperand* GVN::Leader(const IROperand* op)
+{
+    if (auto ic = op->As<IntConst>(); ic)
+    {
+        auto& leader = consts_[{ ic->Type(), false, ic->Val() }];
+        return leader ? leader : leader = op;
+    }
+    if (auto fc = op->As<FloatConst>(); fc)
+    {
+        double val = fc->Val();
+        unsigned long bits = 0;
+        std::memcpy(&bits, &val, sizeof(double));
+        auto& leader = consts_[{ fc->Type(), true, bits }];
+        return leader ? leader : leader = op;
+    }
+    while (replace_.count(op))
+        op = replace_[op];
+    return op;
+}
+
+void GVN::Available(const Expr& expr, const IROperand* result)
+{
+    if (auto avail = table_.find(expr); avail != table_.end())
+    {
+        replace_[result] = avail->second;
+        dead_.insert(curinst_);
+        replaced_.push_back(fmt::format("{} -> {}",
+            result->ToString(), avail->second->ToString()));
+        return;
+    }
+    table_.emplace(expr, result);
+    scope_.push_back(expr);
+}
+
+
+void GVN::Operand(const IROperand*& op)
+{
+    if (mode_ == Mode::rewrite && op)
+        while (replace_.count(op))
+            op = replace_[op];
+}
+
+void GVN::Pointer(const Register*& reg)
+{
+    const IROperand* op = reg;
+    Operand(op);
+    reg = op->As<Register>();
+}
+
+void GVN::BinaryHelper(BinaryInstr* bin)
+{
+    if (mode_ == Mode::rewrite)
+    {
+        Operand(bin->Lhs());
+        Operand(bin->Rhs());
+        return;
+    }
+
+    Expr expr{ bin->id_, bin->Result()->Type(),
+        Leader(bin->Lhs()), Leader(bin->Rhs()) };
+    switch (bin->id_)
+    {
+    case Instr::InstrId::add: case Instr::InstrId::mul:
+    case Instr::InstrId::fadd: case Instr::InstrId::fmul:
+    case Instr::InstrId::btand: case Instr::InstrId::btor:
+    case Instr::InstrId::btxor:
+        // commutative
+        if (std::less<const IROperand*>()(expr.op2_, expr.op1_))
+            std::swap(expr.op1_, expr.op2_);
+        break;
+    default: break;
+    }
+    Available(expr, bin->Result());
+}
+
+void GVN::ConvertHelper(ConvertInstr* cvt)
+{
+    if (mode_ == Mode::rewrite)
+    {
+        Operand(cvt->Value());
+        return;
+    }
+    Available({ cvt->id_, cvt->Dest()->Type(), Leader(cvt->Value()) }, cvt->Dest());
+}
+
+
+void GVN::VisitRetInstr(RetInstr* ret)
+{
+    Operand(ret->ReturnValue());
+}
+
+void GVN::VisitBrInstr(BrInstr* br)
+{
+    Operand(br->Cond());
+}
+
+void GVN::VisitSwitchInstr(SwitchInstr* swtch)
+{
+    auto ident = swtch->GetIdent();
+    Operand(ident);
+    swtch->SetIdent(ident);
+}
+
+void GVN::VisitCallInstr(CallInstr* call)
+{
+    if (call->FuncAddr())
+        Pointer(call->FuncAddr());
+    for (auto& arg : call->ArgvList())
+        Operand(arg);
+}
+
+
+void GVN::VisitAddInstr(AddInstr* inst) { BinaryHelper(inst); }
+void GVN::VisitFaddInstr(FaddInstr* inst) { BinaryHelper(inst); }
+void GVN::VisitSubInstr(SubInstr* inst) { BinaryHelper(inst); }
+void GVN::VisitFsubInstr(FsubInstr* inst) { BinaryHelper(inst); }
+void GVN::VisitMulInstr(MulInstr* inst) { BinaryHelper(inst); }
+void GVN::VisitFmulInstr(FmulInstr* inst) { BinaryHelper(inst); }
+void GVN::VisitDivInstr(DivInstr* inst) { BinaryHelper(inst); }
+void GVN::VisitFdivInstr(FdivInstr* inst) { BinaryHelper(inst); }
+void GVN::VisitModInstr(ModInstr* inst) { BinaryHelper(inst); }
+void GVN::VisitShlInstr(ShlInstr* inst) { BinaryHelper(inst); }
+void GVN::VisitLshrInstr(LshrInstr* inst) { BinaryHelper(inst); }
+void GVN::VisitAshrInstr(AshrInstr* inst) { BinaryHelper(inst); }
+void GVN::VisitAndInstr(AndInstr* inst) { BinaryHelper(inst); }
+void GVN::VisitOrInstr(OrInstr* inst) { BinaryHelper(inst); }
+void GVN::VisitXorInstr(XorInstr* inst) { BinaryHelper(inst); }
+
+
+void GVN::VisitLoadInstr(LoadInstr* load)
+{
+    if (mode_ == Mode::rewrite)
+        Pointer(load->Pointer());
+}
+
+void GVN::VisitStoreInstr(StoreInstr* store)
+{
+    if (mode_ != Mode::rewrite)
+        return;
+    Operand(store->Value());
+    Pointer(store->Dest());
+}
+
+void GVN::VisitGetElePtrInstr(GetElePtrInstr* gep)
+{
+    if (mode_ == Mode::rewrite)
+    {
+        Pointer(gep->Pointer());
+        if (!gep->HoldsInt())
+            Operand(gep->OpIndex());
+        return;
+    }
+
+    Expr expr{ gep->id_, gep->Result()->Type(), Leader(gep->Pointer()) };
+    if (gep->HoldsInt())
+        expr.extra_ = static_cast<long>(gep->IntIndex()) << 2 | 2;
+    else
+        expr.op2_ = Leader(gep->OpIndex());
+    expr.extra_ |= gep->IsInner();
+    Available(expr, gep->Result());
+}
+
+
+void GVN::VisitTruncInstr(TruncInstr* inst) { ConvertHelper(inst); }
+void GVN::VisitFtruncInstr(FtruncInstr* inst) { ConvertHelper(inst); }
+void GVN::VisitZextInstr(ZextInstr* inst) { ConvertHelper(inst); }
+void GVN::VisitSextInstr(SextInstr* inst) { ConvertHelper(inst); }
+void GVN::VisitFextInstr(FextInstr* inst) { ConvertHelper(inst); }
+void GVN::VisitFtoUInstr(FtoUInstr* inst) { ConvertHelper(inst); }
+void GVN::VisitFtoSInstr(FtoSInstr* inst) { ConvertHelper(inst); }
+void GVN::VisitUtoFInstr(UtoFInstr* inst) { ConvertHelper(inst); }
+void GVN::VisitStoFInstr(StoFInstr* inst) { ConvertHelper(inst); }
+void GVN::VisitPtrtoIInstr(PtrtoIInstr* inst) { ConvertHelper(inst); }
+void GVN::VisitItoPtrInstr(ItoPtrInstr* inst) { ConvertHelper(inst); }
+void GVN::VisitBitcastInstr(BitcastInstr* inst) { ConvertHelper(inst); }
+
+
+void GVN::VisitIcmpInstr(IcmpInstr* icmp)
+{
+    if (mode_ == Mode::rewrite)
+    {
+        Operand(icmp->Op1());
+        Operand(icmp->Op2());
+        return;
+    }
+
+    Expr expr{ icmp->id_, icmp->Result()->Type(), Leader(icmp->Op1()),
+        Leader(icmp->Op2()), static_cast<long>(icmp->Cond()) };
+    if ((icmp->Cond() == Condition::eq || icmp->Cond() == Condition::ne) &&
+        std::less<const IROperand*>()(expr.op2_, expr.op1_))
+        std::swap(expr.op1_, expr.op2_);
+    Available(expr, icmp->Result());
+}
+
+void GVN::VisitFcmpInstr(FcmpInstr* fcmp)
+{
+    if (mode_ == Mode::rewrite)
+    {
+        Operand(fcmp->Op1());
+        Operand(fcmp->Op2());
+        return;
+    }
+
+    Available({ fcmp->id_, fcmp->Result()->Type(), Leader(fcmp->Op1()),
+        Leader(fcmp->Op2()), static_cast<long>(fcmp->Cond()) }, fcmp->Result());
+}
+
+void GVN::VisitSelectInstr(SelectInstr* select)
+{
+    Operand(select->SelType());
+    Operand(select->Value1());
+    Operand(select->Value2());
+}
+
+void GVN::VisitPhiInstr(PhiInstr* phi)
+{
+    for (auto& [_, op] : phi->GetBlockValPair())
+        Operand(op);
+}
+
+
+std::string GVN::PrintSummary() const
+{
+    std::string summary{ fmt::format(
+        "Pass GVN in function {}:\n", CurFunc()->Name()) };
+    summary += "Redundant values replaced:\n";
+    for (auto& r : replaced_)
+        summary += r + '\n';
+    return std::move(summary);
+}
+
+
+void GVN::ExecuteOnFunction(Function* func)
+{
+    CurFunc() = func;
+    mode_ = Mode::number;
+    Number(func->Front());
+    if (!dead_.empty())
+        Rewrite(func);
+}
+
+void GVN::ExitFunction()
+{
+    table_.clear();
+    scope_.clear();
+    consts_.clear();
+    replace_.clear();
+    dead_.clear();
+    replaced_.clear();
+}
@@ -0,0 +1,143 @@
+#ifndef _GVN_H_
+#define _GVN_H_
+
+#include "IR/Instr.h"
+#include "pass/Pass.h"
+#include "pass/Dominators.h"
+#include "visitir/IRVisitor.h"
+#include <map>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class Module;
+class BasicBlock;
+class BinaryInstr;
+class ConvertInstr;
+class IROperand;
+class IRType;
+class Register;
+
+
+// Global value numbering over the dominator tree. Binary instructions,
+// conversions, geteleptr and comparisons are hashed by their opcodes and
+// the value numbers of their operands. Walking the dominator tree from the
+// entry, an instruction computing an expression already available in a
+// dominating block is removed, and its result is replaced by the earlier
+// one. Expressions are forgotten once the walk leaves the subtree of the
+// block computing them, so every replacement is dominated by its definition.
+// Memory is never looked at, so loads are not numbered. The implementation
+// is the dominator-based scheme in Value Numbering by Briggs, Cooper and
+// Simpson (1997). See also chapter 11 in SSA-based Compiler Design.
+
+class GVN : public FunctionPass, private IRVisitor
+{
+public:
+    GVN(Module* m, Pass* dom) :
+        FunctionPass(m), dom_(static_cast<Dominators*>(dom)) {}
+
+    std::string PrintSummary() const override;
+
+    void ExecuteOnFunction(Function*) override;
+    void ExitFunction() override;
+
+private:
+    enum class Mode { number, rewrite };
+
+    // An expression is its opcode, the type of its result, and the value
+    // numbers of its operands. Some instructions carry an extra field,
+    // e.g., the condition of a comparison or the index of a geteleptr.
+    struct Expr
+    {
+        Instr::InstrId id_{};
+        const IRType* type_{};
+        const IROperand* op1_{};
+        const IROperand* op2_{};
+        long extra_{};
+
+        bool operator==(const Expr& e) const
+        {
+            return id_ == e.id_ && type_ == e.type_ &&
+                op1_ == e.op1_ && op2_ == e.op2_ && extra_ == e.extra_;
+        }
+    };
+
+    struct ExprHash
+    {
+        size_t operator()(const Expr&) const;
+    };
+
+    void Number(BasicBlock*);
+    void Rewrite(Function*);
+
+    // The value number of an operand: the register replacing it, or
+    // the first constant seen with the same type and value.
+    const IROperand* Leader(const IROperand*);
+    void Available(const Expr&, const IROperand* result);
+
+    void Operand(const IROperand*&);
+    void Pointer(const Register*&);
+    void BinaryHelper(BinaryInstr*);
+    void ConvertHelper(ConvertInstr*);
+
+    Mode mode_{};
+    Instr* curinst_{};
+
+    std::unordered_map<Expr, const IROperand*, ExprHash> table_{};
+    // expressions added in the blocks on the current path of the dominator tree
+    std::vector<Expr> scope_{};
+    std::map<std::tuple<const IRType*, bool, unsigned long>, const IROperand*> consts_{};
+    std::unordered_map<const IROperand*, const IROperand*> replace_{};
+    std::unordered_set<const Instr*> dead_{};
+    std::vector<std::string> replaced_{};
+
+    Dominators* dom_{};
+
+private:
+    void VisitRetInstr(RetInstr*) override;
+    void VisitBrInstr(BrInstr*) override;
+    void VisitSwitchInstr(SwitchInstr*) override;
+    void VisitCallInstr(CallInstr*) override;
+
+    void VisitAddInstr(AddInstr*) override;
+    void VisitFaddInstr(FaddInstr*) override;
+    void VisitSubInstr(SubInstr*) override;
+    void VisitFsubInstr(FsubInstr*) override;
+    void VisitMulInstr(MulInstr*) override;
+    void VisitFmulInstr(FmulInstr*) override;
+    void VisitDivInstr(DivInstr*) override;
+    void VisitFdivInstr(FdivInstr*) override;
+    void VisitModInstr(ModInstr*) override;
+    void VisitShlInstr(ShlInstr*) override;
+    void VisitLshrInstr(LshrInstr*) override;
+    void VisitAshrInstr(AshrInstr*) override;
+    void VisitAndInstr(AndInstr*) override;
+    void VisitOrInstr(OrInstr*) override;
+    void VisitXorInstr(XorInstr*) override;
+
+    void VisitLoadInstr(LoadInstr*) override;
+    void VisitStoreInstr(StoreInstr*) override;
+    void VisitGetElePtrInstr(GetElePtrInstr*) override;
+
+    void VisitTruncInstr(TruncInstr*) override;
+    void VisitFtruncInstr(FtruncInstr*) override;
+    void VisitZextInstr(ZextInstr*) override;
+    void VisitSextInstr(SextInstr*) override;
+    void VisitFextInstr(FextInstr*) override;
+    void VisitFtoUInstr(FtoUInstr*) override;
+    void VisitFtoSInstr(FtoSInstr*) override;
+    void VisitUtoFInstr(UtoFInstr*) override;
+    void VisitStoFInstr(StoFInstr*) override;
+    void VisitPtrtoIInstr(PtrtoIInstr*) override;
+    void VisitItoPtrInstr(ItoPtrInstr*) override;
+    void VisitBitcastInstr(BitcastInstr*) override;
+
+    void VisitIcmpInstr(IcmpInstr*) override;
+    void VisitFcmpInstr(FcmpInstr*) override;
+    void VisitSelectInstr(SelectInstr*) override;
+    void VisitPhiInstr(PhiInstr*) override;
+};
+
+#endif // _GVN_H_
@@ -0,0 +1,527 @@
+#include "pass/IndVars.h"
+#include "IR/Instr.h"
+#include "IR/IROperand.h"
+#include "IR/IRType.h"
+#include "IR/Value.h"
+#include <algorithm>
+#include <fmt/format.h>
+
+
+Instr* IndVars::Terminator(BasicBlock* bb)
+{
+    for (auto i : *bb)
+        if (i->IsControlInstr())
+            return i;
+    return nullptr;
+}
+
+long IndVars::Extend(unsigned long val, const IRType* type)
+{
+    auto size = type->Size();
+    if (size >= 8)
+        return static_cast<long>(val);
+    auto shift = 64 - size * 8;
+    return static_cast<long>(val << shift) >> shift;
+}
+
+
+bool IndVars::FindLoop(BasicBlock* header, Loop& loop)
+{
+    loop.header_ = header;
+    for (auto pred : fg_->GetPredsOf(header))
+    {
+        auto bb = const_cast<BasicBlock*>(pred);
+        if (dom_->Dominate(header, bb))
+        {
+            if (loop.latch_ && loop.latch_ != bb)
+                return false;
+            loop.latch_ = bb;
+        }
+        else
+        {
+            if (loop.preheader_ && loop.preheader_ != bb)
+                return false;
+            loop.preheader_ = bb;
+        }
+    }
+    if (!loop.latch_ || !loop.preheader_)
+        return false;
+    auto br = Terminator(loop.preheader_)->As<BrInstr>();
+    return br && !br->Cond();
+}
+
+void IndVars::FindBody(const Loop& loop)
+{
+    auto header = loop.header_;
+    body_.insert(header);
+    std::vector<const BasicBlock*> worklist{ loop.latch_ };
+    while (!worklist.empty())
+    {
+        auto bb = worklist.back();
+        worklist.pop_back();
+        if (!body_.insert(bb).second)
+            continue;
+        for (auto pred : fg_->GetPredsOf(bb))
+            if (dom_->Dominate(header, pred))
+                worklist.push_back(pred);
+    }
+
+    for (auto bb : body_)
+    {
+        if (info_->HasDef(bb))
+            for (auto def : info_->GetDef(bb))
+                loopdefs_.insert(def);
+        if (info_->HasPhiDef(bb))
+            for (auto def : info_->GetPhiDef(bb))
+                loopdefs_.insert(def);
+    }
+}
+
+std::vector<IndVars::IndVar> IndVars::FindIndVars(const Loop& loop)
+{
+    std::vector<IndVar> indvars{};
+    for (auto inst : *loop.header_)
+    {
+        auto phi = inst->As<PhiInstr>();
+        if (!phi)
+            break;
+        auto type = phi->Result()->Type();
+        auto& pairs = phi->GetBlockValPair();
+        if (!type->Is<IntType>() || type->Is<PtrType>() || pairs.size() != 2)
+            continue;
+
+        IndVar iv{ phi->Result() };
+        const IROperand* next = nullptr;
+        for (auto [bb, val] : pairs)
+        {
+            if (bb == loop.preheader_)
+                iv.init_ = val;
+            else if (bb == loop.latch_)
+                next = val;
+        }
+        if (!iv.init_ || !next || !info_->HasDef(next))
+            continue;
+
+        // next = value + c, c + value or value - c
+        auto def = info_->GetDef(next);
+        auto bin = def->As<BinaryInstr>();
+        if (!bin || (!bin->Is<AddInstr>() && !bin->Is<SubInstr>()))
+            continue;
+        const IntConst* step = nullptr;
+        if (bin->Lhs() == iv.value_)
+            step = bin->Rhs()->As<IntConst>();
+        else if (bin->Is<AddInstr>() && bin->Rhs() == iv.value_)
+            step = bin->Lhs()->As<IntConst>();
+        if (!step)
+            continue;
+        iv.step_ = Extend(step->Val(), type);
+        if (bin->Is<SubInstr>())
+            iv.step_ = -iv.step_;
+
+        iv.next_ = const_cast<Instr*>(def);
+        for (auto bb : body_)
+        {
+            auto blk = const_cast<BasicBlock*>(bb);
+            if (blk->Contains(iv.next_))
+                iv.bb_ = blk;
+        }
+        if (iv.bb_)
+            indvars.push_back(iv);
+    }
+    return indvars;
+}
+
+bool IndVars::Invariant(const IROperand* op) const
+{
+    return !op->Is<Register>() || !loopdefs_.count(op);
+}
+
+const IROperand* IndVars::Widen(const Loop& loop, const IROperand* op)
+{
+    auto i64 = IntType::GetInt64(true);
+    if (auto ic = op->As<IntConst>(); ic)
+        return IntConst::CreateIntConst(CurFunc(),
+            static_cast<unsigned long>(Extend(ic->Val(), ic->Type())), i64);
+
+    auto reg = op->As<Register>();
+    auto wide = Register::CreateRegister(
+        CurFunc(), reg->Name() + ".wide", i64);
+    auto pos = loop.preheader_->IterOf(Terminator(loop.preheader_));
+    loop.preheader_->Insert(pos, CurFunc()->Make<SextInstr>(wide, i64, reg));
+    return wide;
+}
+
+void IndVars::InsertAfter(Instr* pos, BasicBlock* bb, Instr* inst)
+{
+    bb->Insert(std::next(bb->IterOf(pos)), inst);
+}
+
+
+IndVars::IndVar IndVars::WidenIndVar(
+    const Loop& loop, const IndVar& iv, std::vector<const IROperand*>& sexts)
+{
+    auto type = iv.value_->Type()->As<IntType>();
+    if (!type->IsSigned() || type->Size() >= 8 || !info_->HasUse(iv.value_))
+        return {};
+
+    auto i64 = IntType::GetInt64(true);
+    std::vector<const Instr*> exts{};
+    for (auto use : info_->GetUse(iv.value_))
+    {
+        auto sext = use->As<SextInstr>();
+        if (sext && sext->Value() == iv.value_ && sext->Dest()->Type()->Size() == 8 &&
+            std::find(exts.begin(), exts.end(), use) == exts.end())
+            exts.push_back(use);
+    }
+    if (exts.empty())
+        return {};
+
+    // wide = phi [init, preheader], [wnext, latch]; wnext = wide + step
+    auto header = loop.header_;
+    auto name = iv.value_->As<Register>()->Name();
+    auto wide = Register::CreateRegister(CurFunc(), name + ".wide", i64);
+    auto wnext = Register::CreateRegister(CurFunc(), name + ".wnext", i64);
+    auto init = Widen(loop, iv.init_);
+    auto step = IntConst::CreateIntConst(
+        CurFunc(), static_cast<unsigned long>(iv.step_), i64);
+
+    auto phi = CurFunc()->Make<PhiInstr>(wide, i64);
+    phi->AddBlockValPair(loop.preheader_, init);
+    phi->AddBlockValPair(loop.latch_, wnext);
+    header->Insert(header->begin(), phi);
+    auto add = CurFunc()->Make<AddInstr>(wnext, wide, step);
+    InsertAfter(iv.next_, iv.bb_, add);
+
+    for (auto ext : exts)
+    {
+        auto dest = const_cast<Instr*>(ext)->As<SextInstr>()->Dest();
+        replace_[dest] = wide;
+        dead_.insert(ext);
+        sexts.push_back(dest);
+    }
+
+    // Comparisons with invariants are done on the wide variable.
+    auto next = iv.next_->As<BinaryInstr>()->Result();
+    std::vector<const Instr*> cmps{};
+    for (auto val : { iv.value_, static_cast<const IROperand*>(next) })
+    {
+        if (!info_->HasUse(val))
+            continue;
+        for (auto use : info_->GetUse(val))
+            if (use->Is<IcmpInstr>() &&
+                std::find(cmps.begin(), cmps.end(), use) == cmps.end())
+                cmps.push_back(use);
+    }
+    for (auto use : cmps)
+    {
+        auto icmp = const_cast<Instr*>(use)->As<IcmpInstr>();
+        auto& op1 = icmp->Op1();
+        auto& op2 = icmp->Op2();
+        auto isiv = [&] (const IROperand* op) { return op == iv.value_ || op == next; };
+        if (isiv(op1) == isiv(op2))
+            continue;
+        auto& other = isiv(op1) ? op2 : op1;
+        if (!Invariant(other) || !other->Type()->As<IntType>()->IsSigned())
+            continue;
+
+        for (auto op : { &op1, &op2 })
+        {
+            if (*op == iv.value_)
+                *op = wide;
+            else if (*op == next)
+                *op = wnext;
+            else
+                *op = Widen(loop, *op);
+        }
+        tests_.push_back(icmp->Result()->ToString());
+    }
+
+    narrow_.push_back(iv);
+    widened_.push_back(fmt::format("{} to {}", iv.value_->ToString(), wide->ToString()));
+    return { wide, init, iv.step_, add, iv.bb_ };
+}
+
+void IndVars::ReduceAddress(const Loop& loop,
+    const IndVar& iv, const std::vector<const IROperand*>& uses)
+{
+    auto header = loop.header_;
+    auto preheader = loop.preheader_;
+    std::vector<const Instr*> geps{};
+    for (auto val : uses)
+    {
+        if (!info_->HasUse(val))
+            continue;
+        for (auto use : info_->GetUse(val))
+            if (auto gep = use->As<GetElePtrInstr>(); gep && !gep->HoldsInt() &&
+                gep->OpIndex() == val && Invariant(gep->Pointer()) &&
+                gep->Pointer()->Type()->Is<PtrType>() && !dead_.count(use) &&
+                std::find(geps.begin(), geps.end(), use) == geps.end())
+                geps.push_back(use);
+    }
+
+    auto step = IntConst::CreateIntConst(CurFunc(),
+        static_cast<unsigned long>(iv.step_), IntType::GetInt64(true));
+    for (auto use : geps)
+    {
+        // ptr = phi [gep p, init], [pnext, latch]; pnext = gep ptr, step
+        auto gep = const_cast<Instr*>(use)->As<GetElePtrInstr>();
+        auto type = gep->Result()->Type();
+        auto name = gep->Result()->Name();
+        auto pinit = Register::CreateRegister(CurFunc(), name + ".init", type);
+        auto ptr = Register::CreateRegister(CurFunc(), name + ".iv", type);
+        auto pnext = Register::CreateRegister(CurFunc(), name + ".next", type);
+
+        auto pos = preheader->IterOf(Terminator(preheader));
+        preheader->Insert(pos, CurFunc()->Make<GetElePtrInstr>(
+            gep->IsInner(), pinit, gep->Pointer(), iv.init_));
+        auto phi = CurFunc()->Make<PhiInstr>(ptr, type);
+        phi->AddBlockValPair(preheader, pinit);
+        phi->AddBlockValPair(loop.latch_, pnext);
+        header->Insert(header->begin(), phi);
+        InsertAfter(iv.next_, iv.bb_,
+            CurFunc()->Make<GetElePtrInstr>(false, pnext, ptr, step));
+
+        replace_[gep->Result()] = ptr;
+        dead_.insert(use);
+        reduced_.push_back(fmt::format("{} to {}",
+            gep->Result()->ToString(), ptr->ToString()));
+    }
+}
+
+void IndVars::RemoveNarrow(Function* func)
+{
+    // The narrow variable is dead if it only feeds itself.
+    for (auto& iv : narrow_)
+    {
+        auto phi = info_->GetDef(iv.value_);
+        auto next = iv.next_->As<BinaryInstr>()->Result();
+        auto onlyuse = [this] (const IROperand* op, const Instr* user) {
+            if (!info_->HasUse(op))
+                return true;
+            auto uses = info_->GetUse(op);
+            return std::all_of(uses.begin(), uses.end(),
+                [user] (const Instr* use) { return use == user; });
+        };
+        if (!onlyuse(iv.value_, iv.next_) || !onlyuse(next, phi))
+            continue;
+
+        for (auto bb : *func)
+        {
+            if (bb->Contains(phi))
+            {
+                bb->Remove(const_cast<Instr*>(phi));
+                break;
+            }
+        }
+        iv.bb_->Remove(iv.next_);
+    }
+}
+
+
+void IndVars::Rewrite(Function* func)
+{
+    for (auto bb : *func)
+        for (auto i = bb->end(); i != bb->begin(); )
+        {
+            auto inst = *--i;
+            if (dead_.count(inst))
+                i = bb->Remove(i);
+            else
+                inst->Accept(this);
+        }
+}
+
+void IndVars::Operand(const IROperand*& op)
+{
+    if (op)
+        while (replace_.count(op))
+            op = replace_[op];
+}
+
+void IndVars::Pointer(const Register*& reg)
+{
+    const IROperand* op = reg;
+    Operand(op);
+    reg = op->As<Register>();
+}
+
+void IndVars::BinaryHelper(BinaryInstr* bin)
+{
+    Operand(bin->Lhs());
+    Operand(bin->Rhs());
+}
+
+void IndVars::ConvertHelper(ConvertInstr* cvt)
+{
+    Operand(cvt->Value());
+}
+
+
+void IndVars::VisitRetInstr(RetInstr* ret)
+{
+    Operand(ret->ReturnValue());
+}
+
+void IndVars::VisitBrInstr(BrInstr* br)
+{
+    Operand(br->Cond());
+}
+
+void IndVars::VisitSwitchInstr(SwitchInstr* swtch)
+{
+    auto ident = swtch->GetIdent();
+    Operand(ident);
+    swtch->SetIdent(ident);
+}
+
+void IndVars::VisitCallInstr(CallInstr* call)
+{
+    if (call->FuncAddr())
+        Pointer(call->FuncAddr());
+    for (auto& arg : call->ArgvList())
+        Operand(arg);
+}
+
+
+void IndVars::VisitAddInstr(AddInstr* inst) { BinaryHelper(inst); }
+void IndVars::VisitFaddInstr(FaddInstr* inst) { BinaryHelper(inst); }
+void IndVars::VisitSubInstr(SubInstr* inst) { BinaryHelper(inst); }
+void IndVars::VisitFsubInstr(FsubInstr* inst) { BinaryHelper(inst); }
+void IndVars::VisitMulInstr(MulInstr* inst) { BinaryHelper(inst); }
+void IndVars::VisitFmulInstr(FmulInstr* inst) { BinaryHelper(inst); }
+void IndVars::VisitDivInstr(DivInstr* inst) { BinaryHelper(inst); }
+void IndVars::VisitFdivInstr(FdivInstr* inst) { BinaryHelper(inst); }
+void IndVars::VisitModInstr(ModInstr* inst) { BinaryHelper(inst); }
+void IndVars::VisitShlInstr(ShlInstr* inst) { BinaryHelper(inst); }
+void IndVars::VisitLshrInstr(LshrInstr* inst) { BinaryHelper(inst); }
+void IndVars::VisitAshrInstr(AshrInstr* inst) { BinaryHelper(inst); }
+void IndVars::VisitAndInstr(AndInstr* inst) { BinaryHelper(inst); }
+void IndVars::VisitOrInstr(OrInstr* inst) { BinaryHelper(inst); }
+void IndVars::VisitXorInstr(XorInstr* inst) { BinaryHelper(inst); }
+
+
+void IndVars::VisitLoadInstr(LoadInstr* load)
+{
+    Pointer(load->Pointer());
+}
+
+void IndVars::VisitStoreInstr(StoreInstr* store)
+{
+    Operand(store->Value());
+    Pointer(store->Dest());
+}
+
+void IndVars::VisitGetElePtrInstr(GetElePtrInstr* gep)
+{
+    Pointer(gep->Pointer());
+    if (!gep->HoldsInt())
+        Operand(gep->OpIndex());
+}
+
+
+void IndVars::VisitTruncInstr(TruncInstr* inst) { ConvertHelper(inst); }
+void IndVars::VisitFtruncInstr(FtruncInstr* inst) { ConvertHelper(inst); }
+void IndVars::VisitZextInstr(ZextInstr* inst) { ConvertHelper(inst); }
+void IndVars::VisitSextInstr(SextInstr* inst) { ConvertHelper(inst); }
+void IndVars::VisitFextInstr(FextInstr* inst) { ConvertHelper(inst); }
+void IndVars::VisitFtoUInstr(FtoUInstr* inst) { ConvertHelper(inst); }
+void IndVars::VisitFtoSInstr(FtoSInstr* inst) { ConvertHelper(inst); }
+void IndVars::VisitUtoFInstr(UtoFInstr* inst) { ConvertHelper(inst); }
+void IndVars::VisitStoFInstr(StoFInstr* inst) { ConvertHelper(inst); }
+void IndVars::VisitPtrtoIInstr(PtrtoIInstr* inst) { ConvertHelper(inst); }
+void IndVars::VisitItoPtrInstr(ItoPtrInstr* inst) { ConvertHelper(inst); }
+void IndVars::VisitBitcastInstr(BitcastInstr* inst) { ConvertHelper(inst); }
+
+
+void IndVars::VisitIcmpInstr(IcmpInstr* icmp)
+{
+    Operand(icmp->Op1());
+    Operand(icmp->Op2());
+}
+
+void IndVars::VisitFcmpInstr(FcmpInstr* fcmp)
+{
+    Operand(fcmp->Op1());
+    Operand(fcmp->Op2());
+}
+
+void IndVars::VisitSelectInstr(SelectInstr* select)
+{
+    Operand(select->SelType());
+    Operand(select->Value1());
+    Operand(select->Value2());
+}
+
+void IndVars::VisitPhiInstr(PhiInstr* phi)
+{
+    for (auto& [_, op] : phi->GetBlockValPair())
+        Operand(op);
+}
+
+
+std::string IndVars::PrintSummary() const
+{
+    std::string summary{ fmt::format(
+        "Pass IndVars in function {}:\n", CurFunc()->Name()) };
+    summary += "Induction variables widened:\n";
+    for (auto& w : widened_)
+        summary += w + '\n';
+    summary += "Exit tests widened:\n";
+    for (auto& t : tests_)
+        summary += t + '\n';
+    summary += "Addresses reduced:\n";
+    for (auto& r : reduced_)
+        summary += r + '\n';
+    return std::move(summary);
+}
+
+
+void IndVars::ExecuteOnFunction(Function* func)
+{
+    CurFunc() = func;
+    std::vector<Loop> loops{};
+    for (auto bb : *func)
+        if (bb != func->Front() && loops_->IsHeader(bb) && !loops_->IsIrreducible(bb))
+            if (Loop loop{}; FindLoop(bb, loop))
+                loops.push_back(loop);
+
+    for (auto& loop : loops)
+    {
+        FindBody(loop);
+        for (auto& iv : FindIndVars(loop))
+        {
+            if (iv.value_->Type()->Size() == 8)
+            {
+                ReduceAddress(loop, iv, { iv.value_ });
+                continue;
+            }
+            std::vector<const IROperand*> sexts{};
+            if (auto wide = WidenIndVar(loop, iv, sexts); wide.value_)
+                ReduceAddress(loop, wide, sexts);
+        }
+        body_.clear();
+        loopdefs_.clear();
+    }
+    if (replace_.empty() && tests_.empty())
+        return;
+
+    // The flow graph stays the same; only the definitions change.
+    Rewrite(func);
+    info_->ExitFunction();
+    info_->ExecuteOnFunction(func);
+    RemoveNarrow(func);
+    info_->ExitFunction();
+    info_->ExecuteOnFunction(func);
+}
+
+void IndVars::ExitFunction()
+{
+    body_.clear();
+    loopdefs_.clear();
+    replace_.clear();
+    dead_.clear();
+    narrow_.clear();
+    widened_.clear();
+    reduced_.clear();
+    tests_.clear();
+}
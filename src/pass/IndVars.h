@@ -0,0 +1,159 @@
+#ifndef _IND_VARS_H_
+#define _IND_VARS_H_
+
+#include "pass/Pass.h"
+#include "pass/Dominators.h"
+#include "pass/DUInfo.h"
+#include "pass/FlowGraph.h"
+#include "pass/LoopAnalyze.h"
+#include "visitir/IRVisitor.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class Module;
+class BasicBlock;
+class BinaryInstr;
+class ConvertInstr;
+class Instr;
+class IROperand;
+class IRType;
+class Register;
+
+
+// Induction variable simplification and strength reduction. A basic
+// induction variable is a phi instruction in the header of a natural loop
+// whose value from the latch is itself plus or minus a constant. A signed
+// induction variable narrower than 64 bits that is sign-extended in the loop
+// is widened to 64 bits, so the extensions go away; this is fine since
+// signed overflow is undefined behavior. Comparisons of the variable with
+// loop invariants, typically the exit test, are done on the wide variable
+// as well, and the narrow one is removed if nothing else needs it. Then
+// each geteleptr indexed by a 64-bit induction variable off an invariant
+// pointer is replaced by a pointer induction variable, which starts at the
+// first element and moves by a constant number of elements every iteration.
+// Only loops with a preheader (see LICM) and a single latch are considered.
+// See section 14.1 in Advanced Compiler Design and Implementation by
+// Muchnick, and Operator Strength Reduction by Cooper, Simpson & Vick (2001).
+
+class IndVars : public FunctionPass, private IRVisitor
+{
+public:
+    IndVars(Module* m, Pass* fg, Pass* dom, Pass* du, Pass* l) : FunctionPass(m),
+        fg_(static_cast<FlowGraph*>(fg)), dom_(static_cast<Dominators*>(dom)),
+        info_(static_cast<DUInfo*>(du)), loops_(static_cast<LoopAnalyze*>(l)) {}
+
+    std::string PrintSummary() const override;
+
+    void ExecuteOnFunction(Function*) override;
+    void ExitFunction() override;
+
+private:
+    // value = init + k * step in the k-th iteration,
+    // and next = value + step is computed in block bb
+    struct IndVar
+    {
+        const IROperand* value_{};
+        const IROperand* init_{};
+        long step_{};
+        Instr* next_{};
+        BasicBlock* bb_{};
+    };
+
+    struct Loop
+    {
+        BasicBlock* header_{};
+        BasicBlock* preheader_{};
+        const BasicBlock* latch_{};
+    };
+
+    static Instr* Terminator(BasicBlock*);
+    static long Extend(unsigned long, const IRType*);
+
+    bool FindLoop(BasicBlock* header, Loop&);
+    void FindBody(const Loop&);
+    std::vector<IndVar> FindIndVars(const Loop&);
+    bool Invariant(const IROperand*) const;
+    // A 64-bit version of an invariant, computed in the preheader.
+    const IROperand* Widen(const Loop&, const IROperand*);
+    void InsertAfter(Instr* pos, BasicBlock*, Instr*);
+
+    // Widen a narrow induction variable if it's sign-extended in the loop,
+    // and collect the extensions. Return the wide one, or one with no value
+    // if nothing is done.
+    IndVar WidenIndVar(const Loop&, const IndVar&, std::vector<const IROperand*>& sexts);
+    void ReduceAddress(const Loop&, const IndVar&,
+        const std::vector<const IROperand*>& uses);
+    void RemoveNarrow(Function*);
+
+    void Rewrite(Function*);
+    void Operand(const IROperand*&);
+    void Pointer(const Register*&);
+    void BinaryHelper(BinaryInstr*);
+    void ConvertHelper(ConvertInstr*);
+
+    std::unordered_set<const BasicBlock*> body_{};
+    std::unordered_set<const IROperand*> loopdefs_{};
+
+    std::unordered_map<const IROperand*, const IROperand*> replace_{};
+    std::unordered_set<const Instr*> dead_{};
+    // narrow induction variables widened, which may be no longer used
+    std::vector<IndVar> narrow_{};
+
+    std::vector<std::string> widened_{};
+    std::vector<std::string> reduced_{};
+    std::vector<std::string> tests_{};
+
+    FlowGraph* fg_{};
+    Dominators* dom_{};
+    DUInfo* info_{};
+    LoopAnalyze* loops_{};
+
+private:
+    void VisitRetInstr(RetInstr*) override;
+    void VisitBrInstr(BrInstr*) override;
+    void VisitSwitchInstr(SwitchInstr*) override;
+    void VisitCallInstr(CallInstr*) override;
+
+    void VisitAddInstr(AddInstr*) override;
+    void VisitFaddInstr(FaddInstr*) override;
+    void VisitSubInstr(SubInstr*) override;
+    void VisitFsubInstr(FsubInstr*) override;
+    void VisitMulInstr(MulInstr*) override;
+    void VisitFmulInstr(FmulInstr*) override;
+    void VisitDivInstr(DivInstr*) override;
+    void VisitFdivInstr(FdivInstr*) override;
+    void VisitModInstr(ModInstr*) override;
+    void VisitShlInstr(ShlInstr*) override;
+    void VisitLshrInstr(LshrInstr*) override;
+    void VisitAshrInstr(AshrInstr*) override;
+    void VisitAndInstr(AndInstr*) override;
+    void VisitOrInstr(OrInstr*) override;
+    void VisitXorInstr(XorInstr*) override;
+
+    void VisitLoadInstr(LoadInstr*) override;
+    void VisitStoreInstr(StoreInstr*) override;
+    void VisitGetElePtrInstr(GetElePtrInstr*) override;
+
+    void VisitTruncInstr(TruncInstr*) override;
+    void VisitFtruncInstr(FtruncInstr*) override;
+    void VisitZextInstr(ZextInstr*) override;
+    void VisitSextInstr(SextInstr*) override;
+    void VisitFextInstr(FextInstr*) override;
+    void VisitFtoUInstr(FtoUInstr*) override;
+    void VisitFtoSInstr(FtoSInstr*) override;
+    void VisitUtoFInstr(UtoFInstr*) override;
+    void VisitStoFInstr(StoFInstr*) override;
+    void VisitPtrtoIInstr(PtrtoIInstr*) override;
+    void VisitItoPtrInstr(ItoPtrInstr*) override;
+    void VisitBitcastInstr(BitcastInstr*) override;
+
+    void VisitIcmpInstr(IcmpInstr*) override;
+    void VisitFcmpInstr(FcmpInstr*) override;
+    void VisitSelectInstr(SelectInstr*) override;
+    void VisitPhiInstr(PhiInstr*) override;
+};
+
+#endif // _IND_VARS_H_
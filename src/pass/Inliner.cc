@@ -0,0 +1,341 @@
+#include "pass/Inliner.h"
+#include "IR/Instr.h"
+#include "IR/IROperand.h"
+#include "IR/IRType.h"
+#include "IR/Value.h"
+#include <fmt/format.h>
+
+
+int Inliner::Size(const Function* func)
+{
+    int size = 0;
+    for (auto bb : *const_cast<Function*>(func))
+        for (auto i : *bb)
+            size += !i->Is<AllocaInstr>();
+    return size;
+}
+
+bool Inliner::ShouldInline(Function* caller,
+    const CallInstr* call, const Function* callee) const
+{
+    if (callee->Empty() || callee == caller || scc_.count(callee) ||
+        callee->Variadic() || callee->Noreturn() || callee->StaticVar())
+        return false;
+    if (callee->ReturnType()->Is<HeterType>() ||
+        callee->Params().size() != call->ArgvList().size())
+        return false;
+    for (auto param : callee->Params())
+        if (param->Type()->Is<HeterType>())
+            return false;
+
+    auto size = Size(callee);
+    if (Size(caller) + size > growthlimit_)
+        return false;
+    if (callee->Inline())
+        return size <= inlinelimit_;
+    if (callee->Static())
+        return size <= staticlimit_;
+    return size <= limit_;
+}
+
+void Inliner::InlineCalls(Function* caller)
+{
+    std::vector<std::pair<BasicBlock*, CallInstr*>> calls{};
+    for (auto bb : *caller)
+        for (auto i : *bb)
+            if (auto call = i->As<CallInstr>(); call && !call->FuncName().empty() &&
+                call->FuncName().rfind("@__Ginkgo_", 0) != 0)
+                calls.emplace_back(bb, call);
+
+    // Calls later in a block go first, so that splitting
+    // the block leaves the earlier ones where they are.
+    for (auto it = calls.rbegin(); it != calls.rend(); ++it)
+    {
+        auto [bb, call] = *it;
+        auto callee = CurModule()->GetFunction(call->FuncName());
+        if (ShouldInline(caller, call, callee))
+            Inline(caller, bb, call, callee);
+    }
+}
+
+void Inliner::Inline(Function* caller,
+    BasicBlock* bb, CallInstr* call, Function* callee)
+{
+    suffix_ = fmt::format("{}.{}", callee->Name().substr(1), ++count_);
+    inlined_.push_back(fmt::format("{} in block {} of {}",
+        callee->Name(), bb->Name(), caller->Name()));
+    caller_ = caller;
+    entry_ = caller->Front();
+    callee->Inlined() = true;
+
+    // Split the block after the call. Phis now see the second half
+    // as the predecessor, since it ends with the old terminator.
+    cont_ = BasicBlock::CreateBasicBlock(caller, bb->Name() + '.' + suffix_);
+    caller->Insert(std::next(caller->IterOf(bb)), caller->Release(cont_));
+    cont_->Splice(cont_->end(), *bb, std::next(bb->IterOf(call)), bb->end());
+    for (auto blk : *caller)
+        for (auto inst : *blk)
+        {
+            auto phi = inst->As<PhiInstr>();
+            if (!phi)
+                break;
+            for (auto& [pred, _] : phi->GetBlockValPair())
+                if (pred == bb)
+                    pred = cont_;
+        }
+
+    retval_ = nullptr;
+    if (call->Result() && !callee->ReturnType()->Is<VoidType>())
+    {
+        auto type = callee->ReturnType();
+        retval_ = Register::CreateRegister(caller, call->Result()->Name() +
+            ".ret", PtrType::GetPtrType(caller, type));
+        entry_->Insert(entry_->begin(), caller->Make<AllocaInstr>(retval_, type));
+        cont_->Insert(cont_->begin(), caller->Make<LoadInstr>(call->Result(), retval_));
+    }
+
+    map_.clear();
+    blocks_.clear();
+    for (int i = 0; i < callee->Params().size(); ++i)
+        map_[callee->Params()[i]] = call->ArgvList()[i];
+    // The blocks of the callee go between the two halves.
+    auto pos = caller->IterOf(cont_);
+    for (auto blk : *callee)
+    {
+        blocks_[blk] = BasicBlock::CreateBasicBlock(caller, blk->Name() + '.' + suffix_);
+        caller->Insert(pos, caller->Release(blocks_[blk]));
+    }
+    for (auto blk : *callee)
+    {
+        curbb_ = blocks_[blk];
+        for (auto inst : *blk)
+            inst->Accept(this);
+    }
+
+    bb->Remove(call);
+    bb->Append(caller->Make<BrInstr>(blocks_[callee->Front()]));
+}
+
+
+void Inliner::Append(Instr* inst)
+{
+    curbb_->Append(inst);
+}
+
+void Inliner::Operand(const IROperand*& op)
+{
+    if (!op)
+        return;
+    if (auto mapped = map_.find(op); mapped != map_.end())
+    {
+        op = mapped->second;
+        return;
+    }
+    // Constants and globals are shared by the caller and the callee.
+    auto reg = op->As<Register>();
+    if (!reg || reg->Name()[0] == '@')
+        return;
+    op = map_[op] = Register::CreateRegister(
+        curbb_->Parent(), reg->Name() + '.' + suffix_, reg->Type());
+}
+
+void Inliner::Pointer(const Register*& reg)
+{
+    const IROperand* op = reg;
+    Operand(op);
+    reg = op->As<Register>();
+}
+
+void Inliner::BinaryHelper(BinaryInstr* bin)
+{
+    Operand(bin->Lhs());
+    Operand(bin->Rhs());
+    Pointer(bin->Result());
+    Append(bin);
+}
+
+void Inliner::ConvertHelper(ConvertInstr* cvt)
+{
+    Operand(cvt->Value());
+    Pointer(cvt->Dest());
+    Append(cvt);
+}
+
+
+void Inliner::VisitRetInstr(RetInstr* ret)
+{
+    if (retval_ && ret->ReturnValue())
+    {
+        auto value = ret->ReturnValue();
+        Operand(value);
+        Append(caller_->Make<StoreInstr>(value, retval_, false));
+    }
+    Append(caller_->Make<BrInstr>(cont_));
+}
+
+void Inliner::VisitBrInstr(BrInstr* br)
+{
+    auto clone = caller_->Make<BrInstr>(*br);
+    Operand(clone->Cond());
+    clone->SetTrueBlk(blocks_.at(br->GetTrueBlk()));
+    if (br->Cond())
+        clone->SetFalseBlk(blocks_.at(br->GetFalseBlk()));
+    Append(clone);
+}
+
+void Inliner::VisitSwitchInstr(SwitchInstr* swtch)
+{
+    auto clone = caller_->Make<SwitchInstr>(*swtch);
+    auto ident = clone->GetIdent();
+    Operand(ident);
+    clone->SetIdent(ident);
+    for (auto& [_, blk] : clone->GetValueBlkPairs())
+        blk = blocks_.at(blk);
+    clone->SetDefault(blocks_.at(swtch->GetDefault()));
+    Append(clone);
+}
+
+void Inliner::VisitCallInstr(CallInstr* call)
+{
+    auto clone = caller_->Make<CallInstr>(*call);
+    if (clone->FuncAddr())
+        Pointer(clone->FuncAddr());
+    for (auto& arg : clone->ArgvList())
+        Operand(arg);
+    if (clone->Result())
+        Pointer(clone->Result());
+    Append(clone);
+}
+
+
+void Inliner::VisitAddInstr(AddInstr* inst) { BinaryHelper(caller_->Make<AddInstr>(*inst)); }
+void Inliner::VisitFaddInstr(FaddInstr* inst) { BinaryHelper(caller_->Make<FaddInstr>(*inst)); }
+void Inliner::VisitSubInstr(SubInstr* inst) { BinaryHelper(caller_->Make<SubInstr>(*inst)); }
+void Inliner::VisitFsubInstr(FsubInstr* inst) { BinaryHelper(caller_->Make<FsubInstr>(*inst)); }
+void Inliner::VisitMulInstr(MulInstr* inst) { BinaryHelper(caller_->Make<MulInstr>(*inst)); }
+void Inliner::VisitFmulInstr(FmulInstr* inst) { BinaryHelper(caller_->Make<FmulInstr>(*inst)); }
+void Inliner::VisitDivInstr(DivInstr* inst) { BinaryHelper(caller_->Make<DivInstr>(*inst)); }
+void Inliner::VisitFdivInstr(FdivInstr* inst) { BinaryHelper(caller_->Make<FdivInstr>(*inst)); }
+void Inliner::VisitModInstr(ModInstr* inst) { BinaryHelper(caller_->Make<ModInstr>(*inst)); }
+void Inliner::VisitShlInstr(ShlInstr* inst) { BinaryHelper(caller_->Make<ShlInstr>(*inst)); }
+void Inliner::VisitLshrInstr(LshrInstr* inst) { BinaryHelper(caller_->Make<LshrInstr>(*inst)); }
+void Inliner::VisitAshrInstr(AshrInstr* inst) { BinaryHelper(caller_->Make<AshrInstr>(*inst)); }
+void Inliner::VisitAndInstr(AndInstr* inst) { BinaryHelper(caller_->Make<AndInstr>(*inst)); }
+void Inliner::VisitOrInstr(OrInstr* inst) { BinaryHelper(caller_->Make<OrInstr>(*inst)); }
+void Inliner::VisitXorInstr(XorInstr* inst) { BinaryHelper(caller_->Make<XorInstr>(*inst)); }
+
+
+// Variables of the callee live in the frame of the caller.
+void Inliner::VisitAllocaInstr(AllocaInstr* alloca)
+{
+    auto clone = caller_->Make<AllocaInstr>(*alloca);
+    Pointer(clone->Result());
+    entry_->Insert(entry_->begin(), clone);
+}
+
+void Inliner::VisitLoadInstr(LoadInstr* load)
+{
+    auto clone = caller_->Make<LoadInstr>(*load);
+    Pointer(clone->Pointer());
+    Pointer(clone->Result());
+    Append(clone);
+}
+
+void Inliner::VisitStoreInstr(StoreInstr* store)
+{
+    auto clone = caller_->Make<StoreInstr>(*store);
+    Operand(clone->Value());
+    Pointer(clone->Dest());
+    Append(clone);
+}
+
+void Inliner::VisitGetElePtrInstr(GetElePtrInstr* gep)
+{
+    auto clone = caller_->Make<GetElePtrInstr>(*gep);
+    Pointer(clone->Pointer());
+    if (!clone->HoldsInt())
+        Operand(clone->OpIndex());
+    Pointer(clone->Result());
+    Append(clone);
+}
+
+
+void Inliner::VisitTruncInstr(TruncInstr* inst) { ConvertHelper(caller_->Make<TruncInstr>(*inst)); }
+void Inliner::VisitFtruncInstr(FtruncInstr* inst) { ConvertHelper(caller_->Make<FtruncInstr>(*inst)); }
+void Inliner::VisitZextInstr(ZextInstr* inst) { ConvertHelper(caller_->Make<ZextInstr>(*inst)); }
+void Inliner::VisitSextInstr(SextInstr* inst) { ConvertHelper(caller_->Make<SextInstr>(*inst)); }
+void Inliner::VisitFextInstr(FextInstr* inst) { ConvertHelper(caller_->Make<FextInstr>(*inst)); }
+void Inliner::VisitFtoUInstr(FtoUInstr* inst) { ConvertHelper(caller_->Make<FtoUInstr>(*inst)); }
+void Inliner::VisitFtoSInstr(FtoSInstr* inst) { ConvertHelper(caller_->Make<FtoSInstr>(*inst)); }
+void Inliner::VisitUtoFInstr(UtoFInstr* inst) { ConvertHelper(caller_->Make<UtoFInstr>(*inst)); }
+void Inliner::VisitStoFInstr(StoFInstr* inst) { ConvertHelper(caller_->Make<StoFInstr>(*inst)); }
+void Inliner::VisitPtrtoIInstr(PtrtoIInstr* inst) { ConvertHelper(caller_->Make<PtrtoIInstr>(*inst)); }
+void Inliner::VisitItoPtrInstr(ItoPtrInstr* inst) { ConvertHelper(caller_->Make<ItoPtrInstr>(*inst)); }
+void Inliner::VisitBitcastInstr(BitcastInstr* inst) { ConvertHelper(caller_->Make<BitcastInstr>(*inst)); }
+
+
+void Inliner::VisitIcmpInstr(IcmpInstr* icmp)
+{
+    auto clone = caller_->Make<IcmpInstr>(*icmp);
+    Operand(clone->Op1());
+    Operand(clone->Op2());
+    Pointer(clone->Result());
+    Append(clone);
+}
+
+void Inliner::VisitFcmpInstr(FcmpInstr* fcmp)
+{
+    auto clone = caller_->Make<FcmpInstr>(*fcmp);
+    Operand(clone->Op1());
+    Operand(clone->Op2());
+    Pointer(clone->Result());
+    Append(clone);
+}
+
+void Inliner::VisitSelectInstr(SelectInstr* select)
+{
+    auto clone = caller_->Make<SelectInstr>(*select);
+    Operand(clone->SelType());
+    Operand(clone->Value1());
+    Operand(clone->Value2());
+    Pointer(clone->Result());
+    Append(clone);
+}
+
+void Inliner::VisitPhiInstr(PhiInstr* phi)
+{
+    auto clone = caller_->Make<PhiInstr>(*phi);
+    for (auto& [blk, op] : clone->GetBlockValPair())
+    {
+        blk = blocks_.at(blk);
+        Operand(op);
+    }
+    Pointer(clone->Result());
+    Append(clone);
+}
+
+
+std::string Inliner::PrintSummary() const
+{
+    std::string summary{ "Pass Inliner:\n" };
+    summary += "Calls inlined:\n";
+    for (auto& call : inlined_)
+        summary += call + '\n';
+    return summary;
+}
+
+
+void Inliner::ExecuteOnModule()
+{
+    for (auto& scc : cg_->GetSCCs())
+    {
+        scc_.insert(scc.begin(), scc.end());
+        for (auto func : scc)
+            if (!func->Empty())
+                InlineCalls(const_cast<Function*>(func));
+        scc_.clear();
+    }
+    // The calls inlined are gone from the calling graph.
+    if (!inlined_.empty())
+        cg_->ExecuteOnModule();
+}
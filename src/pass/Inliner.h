@@ -0,0 +1,131 @@
+#ifndef _INLINER_H_
+#define _INLINER_H_
+
+#include "pass/Pass.h"
+#include "pass/CallingGraph.h"
+#include "visitir/IRVisitor.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class Module;
+class BasicBlock;
+class BinaryInstr;
+class CallInstr;
+class ConvertInstr;
+class Function;
+class Instr;
+class IROperand;
+class Register;
+
+
+// Function inlining. The strongly connected components of the call graph
+// are visited bottom-up, so a callee has got its own calls inlined before
+// it is inlined anywhere; calls within a component (recursion) are never
+// inlined. A direct call is inlined if the callee is small enough, where the
+// size is the number of instructions in it: functions declared inline may
+// be fairly large, static ones somewhat smaller, and any others only as
+// small as an accessor. The caller is split after the call, the blocks of
+// the callee are cloned in between with fresh registers, the arguments
+// replace the parameters, and each return stores the value to a variable
+// loaded where the call was, which Mem2Reg later promotes. Allocas of the
+// callee are moved to the entry of the caller. Variadic functions, ones with
+// static variables (which live on the stack for now), and ones passing or
+// returning structures by value are not inlined. See section
+// 15.2 in Advanced Compiler Design and Implementation by Muchnick.
+
+class Inliner : public ModulePass, private IRVisitor
+{
+public:
+    Inliner(Module* m, Pass* cg) :
+        ModulePass(m), cg_(static_cast<CallingGraph*>(cg)) {}
+
+    std::string PrintSummary() const override;
+    void ExecuteOnModule() override;
+
+private:
+    static int Size(const Function*);
+    bool ShouldInline(Function* caller, const CallInstr*, const Function* callee) const;
+    void InlineCalls(Function*);
+    void Inline(Function* caller, BasicBlock*, CallInstr*, Function* callee);
+
+    // Instructions of the callee are cloned into the current block, with
+    // the operands defined in the callee mapped to the ones in the caller.
+    void Append(Instr*);
+    void Operand(const IROperand*&);
+    void Pointer(const Register*&);
+    void BinaryHelper(BinaryInstr*);
+    void ConvertHelper(ConvertInstr*);
+
+    // functions declared inline, static ones, and the others
+    static constexpr int inlinelimit_ = 120;
+    static constexpr int staticlimit_ = 60;
+    static constexpr int limit_ = 20;
+    // Stop inlining into a caller once it has grown this large.
+    static constexpr int growthlimit_ = 4000;
+
+    std::unordered_set<const Function*> scc_{};
+    std::unordered_map<const IROperand*, const IROperand*> map_{};
+    std::unordered_map<const BasicBlock*, BasicBlock*> blocks_{};
+    std::string suffix_{};
+    // where cloned instructions go, the return value and the continuation
+    Function* caller_{};
+    BasicBlock* curbb_{};
+    BasicBlock* entry_{};
+    const Register* retval_{};
+    BasicBlock* cont_{};
+    int count_{};
+
+    std::vector<std::string> inlined_{};
+
+    CallingGraph* cg_{};
+
+private:
+    void VisitRetInstr(RetInstr*) override;
+    void VisitBrInstr(BrInstr*) override;
+    void VisitSwitchInstr(SwitchInstr*) override;
+    void VisitCallInstr(CallInstr*) override;
+
+    void VisitAddInstr(AddInstr*) override;
+    void VisitFaddInstr(FaddInstr*) override;
+    void VisitSubInstr(SubInstr*) override;
+    void VisitFsubInstr(FsubInstr*) override;
+    void VisitMulInstr(MulInstr*) override;
+    void VisitFmulInstr(FmulInstr*) override;
+    void VisitDivInstr(DivInstr*) override;
+    void VisitFdivInstr(FdivInstr*) override;
+    void VisitModInstr(ModInstr*) override;
+    void VisitShlInstr(ShlInstr*) override;
+    void VisitLshrInstr(LshrInstr*) override;
+    void VisitAshrInstr(AshrInstr*) override;
+    void VisitAndInstr(AndInstr*) override;
+    void VisitOrInstr(OrInstr*) override;
+    void VisitXorInstr(XorInstr*) override;
+
+    void VisitAllocaInstr(AllocaInstr*) override;
+    void VisitLoadInstr(LoadInstr*) override;
+    void VisitStoreInstr(StoreInstr*) override;
+    void VisitGetElePtrInstr(GetElePtrInstr*) override;
+
+    void VisitTruncInstr(TruncInstr*) override;
+    void VisitFtruncInstr(FtruncInstr*) override;
+    void VisitZextInstr(ZextInstr*) override;
+    void VisitSextInstr(SextInstr*) override;
+    void VisitFextInstr(FextInstr*) override;
+    void VisitFtoUInstr(FtoUInstr*) override;
+    void VisitFtoSInstr(FtoSInstr*) override;
+    void VisitUtoFInstr(UtoFInstr*) override;
+    void VisitStoFInstr(StoFInstr*) override;
+    void VisitPtrtoIInstr(PtrtoIInstr*) override;
+    void VisitItoPtrInstr(ItoPtrInstr*) override;
+    void VisitBitcastInstr(BitcastInstr*) override;
+
+    void VisitIcmpInstr(IcmpInstr*) override;
+    void VisitFcmpInstr(FcmpInstr*) override;
+    void VisitSelectInstr(SelectInstr*) override;
+    void VisitPhiInstr(PhiInstr*) override;
+};
+
+#endif // _INLINER_H_
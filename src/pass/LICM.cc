@@ -0,0 +1,418 @@
+#include "pass/LICM.h"
+#include "IR/Instr.h"
+#include "IR/IRBuilder.h"
+#include "IR/IROperand.h"
+#include "IR/IRType.h"
+#include "IR/Value.h"
+#include <algorithm>
+#include <fmt/format.h>
+
+
+Instr* LICM::Terminator(BasicBlock* bb)
+{
+    for (auto i : *bb)
+        if (i->IsControlInstr())
+            return i;
+    return nullptr;
+}
+
+void LICM::Retarget(Instr* term, const BasicBlock* from, const BasicBlock* to)
+{
+    auto target = const_cast<BasicBlock*>(to);
+    if (auto br = term->As<BrInstr>(); br)
+    {
+        if (br->GetTrueBlk() == from)
+            br->SetTrueBlk(target);
+        if (br->Cond() && br->GetFalseBlk() == from)
+            br->SetFalseBlk(target);
+    }
+    else if (auto swtch = term->As<SwitchInstr>(); swtch)
+    {
+        for (auto& [_, blk] : swtch->GetValueBlkPairs())
+            if (blk == from)
+                blk = to;
+        if (swtch->GetDefault() == from)
+            swtch->SetDefault(to);
+    }
+}
+
+
+bool LICM::InsertPreheaders(Function* func)
+{
+    bool changed = false;
+    for (auto header : headers_)
+    {
+        // Edges from blocks dominated by the header are back edges.
+        std::vector<BasicBlock*> outside{};
+        for (auto pred : fg_->GetPredsOf(header))
+        {
+            auto bb = const_cast<BasicBlock*>(pred);
+            if (!dom_->Dominate(header, bb) &&
+                std::find(outside.begin(), outside.end(), bb) == outside.end())
+                outside.push_back(bb);
+        }
+        if (outside.empty())
+            continue;
+
+        auto term = Terminator(outside.front());
+        if (auto br = term->As<BrInstr>(); outside.size() == 1 && br && !br->Cond())
+        {
+            preheaders_[header] = outside.front();
+            continue;
+        }
+        preheaders_[header] = InsertPreheader(
+            func, const_cast<BasicBlock*>(header), outside);
+        changed = true;
+    }
+    return changed;
+}
+
+BasicBlock* LICM::InsertPreheader(Function* func,
+    BasicBlock* header, const std::vector<BasicBlock*>& outside)
+{
+    auto preheader = BasicBlock::CreateBasicBlock(func, header->Name() + ".ph");
+    func->Insert(func->IterOf(header), func->Release(preheader));
+    created_.push_back(preheader->Name());
+
+    // Values coming from outside the loop are merged in the preheader.
+    InstrBuilder ibud{};
+    ibud.SetInsertPoint(preheader);
+    for (auto inst : *header)
+    {
+        auto phi = inst->As<PhiInstr>();
+        if (!phi)
+            break;
+        auto& pairs = phi->GetBlockValPair();
+        auto isoutside = [&outside] (const auto& pair) {
+            return std::find(outside.begin(), outside.end(), pair.first) != outside.end(); };
+        auto split = std::stable_partition(pairs.begin(), pairs.end(),
+            [&isoutside] (const auto& pair) { return !isoutside(pair); });
+        if (split == pairs.end())
+            continue;
+
+        const IROperand* val = split->second;
+        if (std::any_of(split, pairs.end(),
+            [val] (const auto& pair) { return pair.second != val; }))
+        {
+            auto result = ibud.InsertPhiInstr(fmt::format("{}.ph",
+                phi->Result()->Name()), phi->Result()->Type());
+            auto newphi = ibud.LastInstr()->As<PhiInstr>();
+            for (auto it = split; it != pairs.end(); ++it)
+                newphi->AddBlockValPair(it->first, it->second);
+            val = result;
+        }
+        pairs.erase(split, pairs.end());
+        phi->AddBlockValPair(preheader, val);
+    }
+    ibud.InsertBrInstr(header);
+
+    for (auto pred : outside)
+        Retarget(Terminator(pred), header, preheader);
+    return preheader;
+}
+
+void LICM::FindBody(const BasicBlock* header)
+{
+    body_.insert(header);
+    std::vector<const BasicBlock*> worklist{};
+    for (auto pred : fg_->GetPredsOf(header))
+        if (dom_->Dominate(header, pred))
+            worklist.push_back(pred);
+
+    while (!worklist.empty())
+    {
+        auto bb = worklist.back();
+        worklist.pop_back();
+        if (!body_.insert(bb).second)
+            continue;
+        for (auto pred : fg_->GetPredsOf(bb))
+            if (dom_->Dominate(header, pred))
+                worklist.push_back(pred);
+    }
+
+    for (auto bb : body_)
+    {
+        if (info_->HasDef(bb))
+            for (auto def : info_->GetDef(bb))
+                loopdefs_.insert(def);
+        if (info_->HasPhiDef(bb))
+            for (auto def : info_->GetPhiDef(bb))
+                loopdefs_.insert(def);
+
+        for (auto inst : *const_cast<BasicBlock*>(bb))
+        {
+            if (inst->Is<CallInstr>())
+                hascall_ = true;
+            else if (auto store = inst->As<StoreInstr>(); store)
+                stores_.push_back(store->Dest());
+        }
+    }
+}
+
+void LICM::Hoist(const BasicBlock* header)
+{
+    auto preheader = preheaders_.find(header);
+    if (preheader == preheaders_.end())
+        return;
+    FindBody(header);
+
+    // Definitions are visited before their uses in the dominator tree order.
+    std::vector<const BasicBlock*> worklist{ header };
+    while (!worklist.empty())
+    {
+        auto bb = worklist.back();
+        worklist.pop_back();
+        HoistBlock(const_cast<BasicBlock*>(bb), preheader->second);
+        for (auto child : dom_->GetChildren(bb))
+            if (body_.count(child))
+                worklist.push_back(child);
+    }
+
+    body_.clear();
+    loopdefs_.clear();
+    stores_.clear();
+    hascall_ = false;
+}
+
+void LICM::HoistBlock(BasicBlock* bb, BasicBlock* preheader)
+{
+    for (auto i = bb->begin(); i != bb->end(); )
+    {
+        auto inst = *i;
+        if (inst->IsControlInstr())
+            break;
+        hoistable_ = false;
+        inst->Accept(this);
+        if (!hoistable_)
+        {
+            ++i;
+            continue;
+        }
+
+        loopdefs_.erase(def_);
+        hoisted_.push_back(fmt::format("{}: {} to {}",
+            def_->ToString(), bb->Name(), preheader->Name()));
+        ++i;
+        auto pos = preheader->IterOf(Terminator(preheader));
+        preheader->Insert(pos, bb->Release(inst));
+    }
+}
+
+
+bool LICM::Invariant(const IROperand* op) const
+{
+    return !op->Is<Register>() || !loopdefs_.count(op);
+}
+
+const IROperand* LICM::Object(const IROperand* ptr, bool constoffset) const
+{
+    while (info_->HasDef(ptr))
+    {
+        auto def = info_->GetDef(ptr);
+        if (def->Is<AllocaInstr>())
+            return ptr;
+        auto gep = def->As<GetElePtrInstr>();
+        if (!gep || (constoffset && !gep->HoldsInt()))
+            return nullptr;
+        ptr = gep->Pointer();
+    }
+    // Registers defined nowhere in the function are either
+    // parameters or addresses of globals.
+    auto& params = CurFunc()->Params();
+    if (!ptr->Is<Register>() ||
+        std::find(params.begin(), params.end(), ptr) != params.end())
+        return nullptr;
+    return ptr;
+}
+
+bool LICM::Escaped(const IROperand* var) const
+{
+    if (!info_->HasUse(var))
+        return false;
+    for (auto use : info_->GetUse(var))
+    {
+        if (auto load = use->As<LoadInstr>(); load && load->Pointer() == var)
+            continue;
+        if (auto store = use->As<StoreInstr>(); store &&
+            store->Dest() == var && store->Value() != var)
+            continue;
+        return true;
+    }
+    return false;
+}
+
+bool LICM::SafeLoad(const LoadInstr* load) const
+{
+    if (load->Volatile() || !Invariant(load->Pointer()))
+        return false;
+    auto object = Object(load->Pointer());
+    if (!object)
+        return false;
+
+    // Only stores to the variable itself may change it.
+    if (info_->HasDef(object) && !Escaped(object))
+        return std::none_of(stores_.begin(), stores_.end(),
+            [object] (const IROperand* dest) { return dest == object; });
+
+    if (hascall_)
+        return false;
+    return std::all_of(stores_.begin(), stores_.end(),
+        [this, object] (const IROperand* dest) {
+            auto other = Object(dest, false);
+            return other && other != object; });
+}
+
+
+void LICM::BinaryHelper(BinaryInstr* bin)
+{
+    def_ = bin->Result();
+    hoistable_ = Invariant(bin->Lhs()) && Invariant(bin->Rhs());
+}
+
+void LICM::ConvertHelper(ConvertInstr* cvt)
+{
+    def_ = cvt->Dest();
+    hoistable_ = Invariant(cvt->Value());
+}
+
+
+void LICM::VisitAddInstr(AddInstr* inst) { BinaryHelper(inst); }
+void LICM::VisitFaddInstr(FaddInstr* inst) { BinaryHelper(inst); }
+void LICM::VisitSubInstr(SubInstr* inst) { BinaryHelper(inst); }
+void LICM::VisitFsubInstr(FsubInstr* inst) { BinaryHelper(inst); }
+void LICM::VisitMulInstr(MulInstr* inst) { BinaryHelper(inst); }
+void LICM::VisitFmulInstr(FmulInstr* inst) { BinaryHelper(inst); }
+void LICM::VisitFdivInstr(FdivInstr* inst) { BinaryHelper(inst); }
+void LICM::VisitShlInstr(ShlInstr* inst) { BinaryHelper(inst); }
+void LICM::VisitLshrInstr(LshrInstr* inst) { BinaryHelper(inst); }
+void LICM::VisitAshrInstr(AshrInstr* inst) { BinaryHelper(inst); }
+void LICM::VisitAndInstr(AndInstr* inst) { BinaryHelper(inst); }
+void LICM::VisitOrInstr(OrInstr* inst) { BinaryHelper(inst); }
+void LICM::VisitXorInstr(XorInstr* inst) { BinaryHelper(inst); }
+
+// Division may trap, unless the divisor is a constant other than 0 and -1.
+void LICM::VisitDivInstr(DivInstr* inst)
+{
+    BinaryHelper(inst);
+    auto divisor = inst->Rhs()->As<IntConst>();
+    auto size = inst->Rhs()->Type()->Size();
+    auto mask = size >= 8 ? ~0ul : (1ul << size * 8) - 1;
+    hoistable_ = hoistable_ && divisor &&
+        (divisor->Val() & mask) != 0 && (divisor->Val() & mask) != mask;
+}
+
+void LICM::VisitModInstr(ModInstr* inst)
+{
+    BinaryHelper(inst);
+    auto divisor = inst->Rhs()->As<IntConst>();
+    auto size = inst->Rhs()->Type()->Size();
+    auto mask = size >= 8 ? ~0ul : (1ul << size * 8) - 1;
+    hoistable_ = hoistable_ && divisor &&
+        (divisor->Val() & mask) != 0 && (divisor->Val() & mask) != mask;
+}
+
+
+void LICM::VisitLoadInstr(LoadInstr* load)
+{
+    def_ = load->Result();
+    hoistable_ = SafeLoad(load);
+}
+
+void LICM::VisitGetElePtrInstr(GetElePtrInstr* gep)
+{
+    def_ = gep->Result();
+    hoistable_ = Invariant(gep->Pointer()) &&
+        (gep->HoldsInt() || Invariant(gep->OpIndex()));
+}
+
+
+void LICM::VisitTruncInstr(TruncInstr* inst) { ConvertHelper(inst); }
+void LICM::VisitFtruncInstr(FtruncInstr* inst) { ConvertHelper(inst); }
+void LICM::VisitZextInstr(ZextInstr* inst) { ConvertHelper(inst); }
+void LICM::VisitSextInstr(SextInstr* inst) { ConvertHelper(inst); }
+void LICM::VisitFextInstr(FextInstr* inst) { ConvertHelper(inst); }
+void LICM::VisitFtoUInstr(FtoUInstr* inst) { ConvertHelper(inst); }
+void LICM::VisitFtoSInstr(FtoSInstr* inst) { ConvertHelper(inst); }
+void LICM::VisitUtoFInstr(UtoFInstr* inst) { ConvertHelper(inst); }
+void LICM::VisitStoFInstr(StoFInstr* inst) { ConvertHelper(inst); }
+void LICM::VisitPtrtoIInstr(PtrtoIInstr* inst) { ConvertHelper(inst); }
+void LICM::VisitItoPtrInstr(ItoPtrInstr* inst) { ConvertHelper(inst); }
+void LICM::VisitBitcastInstr(BitcastInstr* inst) { ConvertHelper(inst); }
+
+
+void LICM::VisitIcmpInstr(IcmpInstr* icmp)
+{
+    def_ = icmp->Result();
+    hoistable_ = Invariant(icmp->Op1()) && Invariant(icmp->Op2());
+}
+
+void LICM::VisitFcmpInstr(FcmpInstr* fcmp)
+{
+    def_ = fcmp->Result();
+    hoistable_ = Invariant(fcmp->Op1()) && Invariant(fcmp->Op2());
+}
+
+void LICM::VisitSelectInstr(SelectInstr* select)
+{
+    def_ = select->Result();
+    hoistable_ = Invariant(select->SelType()) &&
+        Invariant(select->Value1()) && Invariant(select->Value2());
+}
+
+
+std::string LICM::PrintSummary() const
+{
+    std::string summary{ fmt::format(
+        "Pass LICM in function {}:\n", CurFunc()->Name()) };
+    summary += "Preheaders created:\n";
+    for (auto& name : created_)
+        summary += name + '\n';
+    summary += "Instructions hoisted:\n";
+    for (auto& hoisted : hoisted_)
+        summary += hoisted + '\n';
+    return std::move(summary);
+}
+
+
+void LICM::ExecuteOnFunction(Function* func)
+{
+    CurFunc() = func;
+    for (auto bb : *func)
+        if (bb != func->Front() && loops_->IsHeader(bb) && !loops_->IsIrreducible(bb))
+            headers_.push_back(bb);
+    if (headers_.empty())
+        return;
+    // Inner loops first, so that their invariants can be hoisted further.
+    std::stable_sort(headers_.begin(), headers_.end(),
+        [this] (const BasicBlock* a, const BasicBlock* b) {
+            return loops_->LoopDepth(a) > loops_->LoopDepth(b); });
+
+    if (InsertPreheaders(func))
+    {
+        dom_->ExitFunction();
+        fg_->ExitFunction();
+        info_->ExitFunction();
+        fg_->ExecuteOnFunction(func);
+        dom_->ExecuteOnFunction(func);
+        info_->ExecuteOnFunction(func);
+    }
+
+    for (auto header : headers_)
+        Hoist(header);
+
+    if (created_.empty() && hoisted_.empty())
+        return;
+    // Passes following this one see the new loops and definitions.
+    loops_->ExitFunction();
+    info_->ExitFunction();
+    info_->ExecuteOnFunction(func);
+    loops_->ExecuteOnFunction(func);
+}
+
+void LICM::ExitFunction()
+{
+    headers_.clear();
+    preheaders_.clear();
+    created_.clear();
+    hoisted_.clear();
+}
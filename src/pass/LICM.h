@@ -0,0 +1,131 @@
+#ifndef _LICM_H_
+#define _LICM_H_
+
+#include "pass/Pass.h"
+#include "pass/Dominators.h"
+#include "pass/DUInfo.h"
+#include "pass/FlowGraph.h"
+#include "pass/LoopAnalyze.h"
+#include "visitir/IRVisitor.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class Module;
+class BasicBlock;
+class BinaryInstr;
+class ConvertInstr;
+class Instr;
+class IROperand;
+
+
+// Loop-invariant code motion. Every natural loop found by LoopAnalyze is
+// given a preheader, i.e., a block jumping to the header and nothing else,
+// through which all the edges entering the loop go. Then, from the innermost
+// loops outwards, instructions whose operands are all defined outside the
+// loop (or hoisted already) are moved to the end of the preheader, walking
+// the blocks of the loop in the dominator tree order. Arithmetic that can't
+// trap, conversions, comparisons, selects and geteleptr are hoisted freely.
+// A load is hoisted only if it reads a variable or a global at a constant
+// offset and nothing in the loop may write there; that is, the variable is
+// only loaded from and stored to, and never stored to in the loop, or else
+// the loop calls no function and stores only to other known objects.
+// Irreducible loops are left alone. See chapter 13 in Engineering a Compiler
+// by Cooper and Torczon, and Advanced Compiler Design and Implementation
+// by Muchnick, section 13.2.
+
+class LICM : public FunctionPass, private IRVisitor
+{
+public:
+    LICM(Module* m, Pass* fg, Pass* dom, Pass* du, Pass* l) : FunctionPass(m),
+        fg_(static_cast<FlowGraph*>(fg)), dom_(static_cast<Dominators*>(dom)),
+        info_(static_cast<DUInfo*>(du)), loops_(static_cast<LoopAnalyze*>(l)) {}
+
+    std::string PrintSummary() const override;
+
+    void ExecuteOnFunction(Function*) override;
+    void ExitFunction() override;
+
+private:
+    static Instr* Terminator(BasicBlock*);
+    static void Retarget(Instr*, const BasicBlock* from, const BasicBlock* to);
+
+    // Create the preheaders of all the natural loops.
+    // Return whether the CFG is changed.
+    bool InsertPreheaders(Function*);
+    BasicBlock* InsertPreheader(Function*, BasicBlock* header,
+        const std::vector<BasicBlock*>& outside);
+    void FindBody(const BasicBlock* header);
+    void Hoist(const BasicBlock* header);
+    void HoistBlock(BasicBlock*, BasicBlock* preheader);
+
+    bool Invariant(const IROperand*) const;
+    // The variable or the global a pointer is derived from. If asked,
+    // nullptr is returned unless the pointer is at a constant offset to it.
+    const IROperand* Object(const IROperand*, bool constoffset = true) const;
+    bool Escaped(const IROperand*) const;
+    bool SafeLoad(const LoadInstr*) const;
+
+    void BinaryHelper(BinaryInstr*);
+    void ConvertHelper(ConvertInstr*);
+
+    std::vector<const BasicBlock*> headers_{};
+    std::unordered_map<const BasicBlock*, BasicBlock*> preheaders_{};
+
+    // blocks in the loop being processed, and the values defined in it
+    std::unordered_set<const BasicBlock*> body_{};
+    std::unordered_set<const IROperand*> loopdefs_{};
+    std::vector<const IROperand*> stores_{};
+    bool hascall_{};
+    // whether the instruction visited can be hoisted, and its result
+    bool hoistable_{};
+    const IROperand* def_{};
+
+    std::vector<std::string> created_{};
+    std::vector<std::string> hoisted_{};
+
+    FlowGraph* fg_{};
+    Dominators* dom_{};
+    DUInfo* info_{};
+    LoopAnalyze* loops_{};
+
+private:
+    void VisitAddInstr(AddInstr*) override;
+    void VisitFaddInstr(FaddInstr*) override;
+    void VisitSubInstr(SubInstr*) override;
+    void VisitFsubInstr(FsubInstr*) override;
+    void VisitMulInstr(MulInstr*) override;
+    void VisitFmulInstr(FmulInstr*) override;
+    void VisitDivInstr(DivInstr*) override;
+    void VisitFdivInstr(FdivInstr*) override;
+    void VisitModInstr(ModInstr*) override;
+    void VisitShlInstr(ShlInstr*) override;
+    void VisitLshrInstr(LshrInstr*) override;
+    void VisitAshrInstr(AshrInstr*) override;
+    void VisitAndInstr(AndInstr*) override;
+    void VisitOrInstr(OrInstr*) override;
+    void VisitXorInstr(XorInstr*) override;
+
+    void VisitLoadInstr(LoadInstr*) override;
+    void VisitGetElePtrInstr(GetElePtrInstr*) override;
+
+    void VisitTruncInstr(TruncInstr*) override;
+    void VisitFtruncInstr(FtruncInstr*) override;
+    void VisitZextInstr(ZextInstr*) override;
+    void VisitSextInstr(SextInstr*) override;
+    void VisitFextInstr(FextInstr*) override;
+    void VisitFtoUInstr(FtoUInstr*) override;
+    void VisitFtoSInstr(FtoSInstr*) override;
+    void VisitUtoFInstr(UtoFInstr*) override;
+    void VisitStoFInstr(StoFInstr*) override;
+    void VisitPtrtoIInstr(PtrtoIInstr*) override;
+    void VisitItoPtrInstr(ItoPtrInstr*) override;
+    void VisitBitcastInstr(BitcastInstr*) override;
+
+    void VisitIcmpInstr(IcmpInstr*) override;
+    void VisitFcmpInstr(FcmpInstr*) override;
+    void VisitSelectInstr(SelectInstr*) override;
+};
+
+#endif // _LICM_H_
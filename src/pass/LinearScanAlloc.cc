@@ -0,0 +1,472 @@
+#include "pass/LinearScanAlloc.h"
+#include "IR/Value.h"
+#include "IR/Instr.h"
+#include <algorithm>
+#include <cmath>
+#include <fmt/format.h>
+
+
+// The shift count is always placed in cl.
+static const x64Alloc::RegSet shiftcount = { x64Phys::rcx };
+// div, idiv and the unsigned mul write to rdx.
+static const x64Alloc::RegSet highhalf = { x64Phys::rdx };
+
+static RegTag Phys2Tag(x64Phys phys) { return static_cast<RegTag>(static_cast<int>(phys) + 2); }
+static x64Phys Tag2Phys(RegTag tag) { return static_cast<x64Phys>(static_cast<int>(tag) - 2); }
+
+
+bool LinearScanAlloc::NeedAlloc(const IROperand* op) const
+{
+    auto reg = op->As<Register>();
+    if (!reg || reg->Name()[0] == '@' || allocas_.Test(reg->Number()))
+        return false;
+    return !reg->Type()->Is<HeterType>();
+}
+
+LinearScanAlloc::Interval* LinearScanAlloc::GetInterval(const IROperand* op)
+{
+    auto reg = op->As<Register>();
+    if (!reg || reg->Number() >= intervals_.size() || !intervals_[reg->Number()].reg_)
+        return nullptr;
+    return &intervals_[reg->Number()];
+}
+
+
+void LinearScanAlloc::Extend(const IROperand* op, int pos, bool access)
+{
+    auto& interval = intervals_[op->As<Register>()->Number()];
+    if (!interval.reg_)
+    {
+        interval.reg_ = op->As<Register>();
+        interval.start_ = interval.end_ = pos;
+        order_.push_back(&interval);
+    }
+    interval.start_ = std::min(interval.start_, pos);
+    interval.end_ = std::max(interval.end_, pos);
+    if (access)
+        interval.weight_ += std::pow(10.0, loops_->LoopDepth(curbb_));
+}
+
+void LinearScanAlloc::Use(const IROperand* op)
+{
+    if (auto heter = heters_.find(op); heter != heters_.end())
+        heter->second = pos_;
+    if (MapConstAndGlobalVar(op) || !NeedAlloc(op))
+        return;
+    Extend(op, pos_);
+}
+
+void LinearScanAlloc::Def(const IROperand* op)
+{
+    auto ty = op->Type();
+    if (ty->Is<HeterType>())
+    {
+        auto offset = AllocateOnX64Stack(ArchInfo(), ty->Size(), ty->Align());
+        MapRegister(op, std::make_unique<x64Mem>(
+            ty->Size(), offset, RegTag::rbp, RegTag::none, 0));
+        return;
+    }
+    Extend(op, pos_);
+}
+
+void LinearScanAlloc::Clobbered(const RegSet& regs, bool def)
+{
+    clobbers_.push_back({ pos_, &regs, def });
+}
+
+
+void LinearScanAlloc::BuildIntervals(Function* func)
+{
+    // Parameters are live from the very beginning of the function.
+    for (auto param : func->Params())
+    {
+        auto ty = param->Type();
+        if ((!ty->Is<IntType>() && !ty->Is<FloatType>()) || !info_->HasUse(param))
+            continue;
+        Extend(param, 0, false);
+        if (auto reg = GetIROpMap(param)->As<x64Reg>(); reg)
+            GetInterval(param)->hint_ = reg->Tag();
+    }
+    for (auto param : func->Params())
+        if (GetIROpMap(param)->Is<x64Heter>())
+            heters_[param] = 0;
+
+    pos_ = 1;
+    for (auto bb : *func)
+        VisitBasicBlock(bb);
+
+    // Copies for phi instructions take place at the end of the predecessors.
+    for (auto phi : phis_)
+    {
+        for (auto [bb, op] : phi->GetBlockValPair())
+        {
+            auto end = border_[bb].second;
+            if (!MapConstAndGlobalVar(op) && NeedAlloc(op))
+                Extend(op, end, false);
+            Extend(phi->Result(), end, false);
+        }
+    }
+
+    for (auto bb : *func)
+    {
+        auto [start, end] = border_[bb];
+        for (auto op : live_->LiveIn(bb))
+            if (GetInterval(op))
+                Extend(op, start, false);
+        for (auto op : live_->LiveOut(bb))
+            if (GetInterval(op))
+                Extend(op, end, false);
+    }
+
+    // Registers holding parts of a parameter are clobbered
+    // before it is copied to the stack by the front-end.
+    for (auto [param, last] : heters_)
+    {
+        for (auto& place : *GetIROpMap(param)->As<x64Heter>())
+        {
+            if (!place.InReg())
+                continue;
+            auto phys = Tag2Phys(place.ToReg());
+            for (auto interval : order_)
+                if (interval->start_ <= last)
+                    interval->forbid_.insert(phys);
+        }
+    }
+
+    // The address to return a big structure to is kept in rdi.
+    if (auto ty = func->ReturnType(); ty->Is<HeterType>() && ty->Size() > 16)
+        for (auto interval : order_)
+            interval->forbid_.insert(x64Phys::rdi);
+
+    // Clobbers are recorded in order of their positions.
+    for (auto interval : order_)
+    {
+        auto clobber = std::lower_bound(clobbers_.begin(), clobbers_.end(),
+            interval->start_, [] (const Clobber& c, int pos) { return c.pos_ < pos; });
+        for (; clobber != clobbers_.end() && clobber->pos_ <= interval->end_; ++clobber)
+            if (clobber->def_ || clobber->pos_ != interval->start_)
+                interval->forbid_.insert(clobber->regs_->begin(), clobber->regs_->end());
+    }
+}
+
+RegTag LinearScanAlloc::FindFree(
+    const Interval& cur, const std::vector<Interval*>& active) const
+{
+    auto isfree = [&] (x64Phys phys) {
+        if (cur.forbid_.count(phys))
+            return false;
+        return std::none_of(active.begin(), active.end(),
+            [phys] (const Interval* i) { return Tag2Phys(i->tag_) == phys; });
+    };
+
+    bool isfloat = cur.reg_->Type()->Is<FloatType>();
+    if (cur.hint_ != RegTag::none && isfree(Tag2Phys(cur.hint_)) &&
+        (isfloat ? cur.hint_ != RegTag::xmm0 : cur.hint_ != RegTag::rax))
+        return cur.hint_;
+
+    if (isfloat)
+    {
+        for (auto phys : VecRegOrder())
+            if (isfree(phys))
+                return Phys2Tag(phys);
+    }
+    else
+    {
+        for (auto phys : IntRegOrder())
+            if (isfree(phys))
+                return Phys2Tag(phys);
+    }
+    return RegTag::none;
+}
+
+void LinearScanAlloc::ScanIntervals()
+{
+    std::vector<Interval*> sorted = order_;
+    std::stable_sort(sorted.begin(), sorted.end(),
+        [] (const Interval* i, const Interval* j) { return i->start_ < j->start_; });
+
+    std::vector<Interval*> active{};
+    for (auto cur : sorted)
+    {
+        active.erase(std::remove_if(active.begin(), active.end(),
+            [cur] (const Interval* i) { return i->end_ < cur->start_; }), active.end());
+
+        if (auto tag = FindFree(*cur, active); tag != RegTag::none)
+        {
+            cur->tag_ = tag;
+            active.push_back(cur);
+            continue;
+        }
+
+        // Spill the cheapest one among the current interval and
+        // the active ones whose registers are available to it.
+        bool isfloat = cur->reg_->Type()->Is<FloatType>();
+        Interval* victim = nullptr;
+        for (auto i : active)
+        {
+            if (i->reg_->Type()->Is<FloatType>() != isfloat ||
+                cur->forbid_.count(Tag2Phys(i->tag_)))
+                continue;
+            if (i->weight_ < (victim ? victim->weight_ : cur->weight_))
+                victim = i;
+        }
+        if (!victim)
+            continue;
+
+        cur->tag_ = victim->tag_;
+        victim->tag_ = RegTag::none;
+        std::replace(active.begin(), active.end(), victim, cur);
+    }
+}
+
+void LinearScanAlloc::Assign(Interval* interval)
+{
+    auto reg = interval->reg_;
+    auto ty = reg->Type();
+    bool isparam = interval->start_ == 0;
+    auto passed = GetIROpMap(reg);
+
+    if (interval->tag_ != RegTag::none)
+    {
+        Mark(Tag2Phys(interval->tag_));
+        auto mapped = std::make_unique<x64Reg>(interval->tag_, ty->Size());
+        if (!isparam)
+            MapRegister(reg, std::move(mapped));
+        else if (!passed->Is<x64Reg>() || *passed != interval->tag_)
+            HomeParam(reg, std::move(mapped));
+        return;
+    }
+
+    // A parameter passed on the stack is simply left there.
+    if (!isparam || passed->Is<x64Reg>())
+    {
+        auto offset = AllocateOnX64Stack(ArchInfo(), ty->Size(), ty->Size());
+        auto mapped = std::make_unique<x64Mem>(
+            ty->Size(), offset, RegTag::rbp, RegTag::none, 0);
+        if (isparam)
+            HomeParam(reg, std::move(mapped));
+        else
+            MapRegister(reg, std::move(mapped));
+    }
+    // the stack slot holds the value of the pointer itself
+    if (ty->Is<PtrType>())
+        MarkLoadTwice(reg);
+}
+
+
+std::string LinearScanAlloc::PrintSummary() const
+{
+    std::string summary{ fmt::format(
+        "Pass LinearScanAlloc in function {}:\n", CurFunc()->Name()) };
+    summary += "IR virtual reg: [start, end], spill cost\n";
+    for (auto interval : order_)
+        summary += fmt::format("{}: [{}, {}], {}\n", interval->reg_->Name(),
+            interval->start_, interval->end_, interval->weight_);
+    return summary + x64Alloc::PrintSummary();
+}
+
+void LinearScanAlloc::ExitFunction()
+{
+    x64Alloc::ExitFunction();
+    pos_ = 0;
+    curbb_ = nullptr;
+    border_.clear();
+    intervals_.clear();
+    order_.clear();
+    clobbers_.clear();
+    allocas_ = {};
+    phis_.clear();
+    heters_.clear();
+}
+
+
+void LinearScanAlloc::BinaryAllocaHelper(BinaryInstr* i)
+{
+    Use(i->Lhs());
+    Use(i->Rhs());
+    Def(i->Result());
+}
+
+void LinearScanAlloc::ConvertAllocaHelper(ConvertInstr* i)
+{
+    Use(i->Value());
+    Def(i->Dest());
+}
+
+
+void LinearScanAlloc::VisitFunction(Function* func)
+{
+    // Registers are all numbered by now, so the intervals never move.
+    intervals_.resize(func->RegNumbers());
+    allocas_ = BitVector(func->RegNumbers());
+    for (auto bb : *func)
+        for (auto i : *bb)
+            if (i->Is<AllocaInstr>())
+                VisitAllocaInstr(i->As<AllocaInstr>());
+    LoadParam();
+
+    BuildIntervals(func);
+    ScanIntervals();
+    // Parameters first, so that they are still
+    // mapped to where they are passed in.
+    for (auto interval : order_)
+        if (interval->start_ == 0)
+            Assign(interval);
+    for (auto interval : order_)
+        if (interval->start_ != 0)
+            Assign(interval);
+
+    // we need to guarantee that info.allocated_ is always a multiple of 16
+    auto& info = ArchInfo();
+    info.allocated_ = MakeAlign(info.allocated_, 16);
+    info.rspoffset_ = info.allocated_;
+}
+
+void LinearScanAlloc::VisitBasicBlock(BasicBlock* bb)
+{
+    curbb_ = bb;
+    border_[bb].first = pos_++;
+    for (auto i : *bb)
+    {
+        if (i->Is<AllocaInstr>())
+            continue;
+        i->Accept(this);
+        pos_++;
+    }
+    border_[bb].second = pos_++;
+}
+
+
+void LinearScanAlloc::VisitRetInstr(RetInstr* i)
+{
+    if (i->ReturnValue())
+        Use(i->ReturnValue());
+}
+
+void LinearScanAlloc::VisitBrInstr(BrInstr* i)
+{
+    if (i->Cond())
+        Use(i->Cond());
+}
+
+void LinearScanAlloc::VisitSwitchInstr(SwitchInstr* i)
+{
+    Use(i->GetIdent());
+    for (auto [tag, _] : i->GetValueBlkPairs())
+        MapConstAndGlobalVar(tag);
+}
+
+void LinearScanAlloc::VisitCallInstr(CallInstr* i)
+{
+    for (auto op : i->ArgvList())
+        Use(op);
+    if (i->FuncAddr()) // Call through a function pointer?
+        Use(i->FuncAddr());
+    if (i->Result())
+        Def(i->Result());
+    Clobbered(CallClobbered(), false);
+}
+
+
+void LinearScanAlloc::VisitAddInstr(AddInstr* i) { BinaryAllocaHelper(i); }
+void LinearScanAlloc::VisitFaddInstr(FaddInstr* i) { BinaryAllocaHelper(i); }
+void LinearScanAlloc::VisitSubInstr(SubInstr* i) { BinaryAllocaHelper(i); }
+void LinearScanAlloc::VisitFsubInstr(FsubInstr* i) { BinaryAllocaHelper(i); }
+void LinearScanAlloc::VisitFmulInstr(FmulInstr* i) { BinaryAllocaHelper(i); }
+void LinearScanAlloc::VisitFdivInstr(FdivInstr* i) { BinaryAllocaHelper(i); }
+void LinearScanAlloc::VisitAndInstr(AndInstr* i) { BinaryAllocaHelper(i); }
+void LinearScanAlloc::VisitOrInstr(OrInstr* i) { BinaryAllocaHelper(i); }
+void LinearScanAlloc::VisitXorInstr(XorInstr* i) { BinaryAllocaHelper(i); }
+
+void LinearScanAlloc::VisitMulInstr(MulInstr* i)
+{
+    BinaryAllocaHelper(i);
+    if (!i->Lhs()->Type()->As<IntType>()->IsSigned() &&
+        !i->Rhs()->Type()->As<IntType>()->IsSigned())
+        Clobbered(highhalf, true);
+}
+
+void LinearScanAlloc::VisitDivInstr(DivInstr* i) { BinaryAllocaHelper(i); Clobbered(highhalf, true); }
+void LinearScanAlloc::VisitModInstr(ModInstr* i) { BinaryAllocaHelper(i); Clobbered(highhalf, true); }
+void LinearScanAlloc::VisitShlInstr(ShlInstr* i) { BinaryAllocaHelper(i); Clobbered(shiftcount, true); }
+void LinearScanAlloc::VisitLshrInstr(LshrInstr* i) { BinaryAllocaHelper(i); Clobbered(shiftcount, true); }
+void LinearScanAlloc::VisitAshrInstr(AshrInstr* i) { BinaryAllocaHelper(i); Clobbered(shiftcount, true); }
+
+
+void LinearScanAlloc::VisitAllocaInstr(AllocaInstr* i)
+{
+    auto size = i->Type()->Size();
+    auto align = i->Type()->Align();
+    auto extra = align > size ? align - size : 0;
+
+    // See the FIXME in SimpleAlloc::VisitAllocaInstr.
+    auto offset = AllocateOnX64Stack(ArchInfo(), size + extra, align);
+    MapRegister(i->Result(), std::make_unique<x64Mem>(
+        size, offset, RegTag::rbp, RegTag::none, 0));
+    allocas_.Set(i->Result()->Number());
+}
+
+void LinearScanAlloc::VisitLoadInstr(LoadInstr* i)
+{
+    Use(i->Pointer());
+    Def(i->Result());
+}
+
+void LinearScanAlloc::VisitStoreInstr(StoreInstr* i)
+{
+    Use(i->Dest());
+    Use(i->Value());
+}
+
+void LinearScanAlloc::VisitGetElePtrInstr(GetElePtrInstr* i)
+{
+    if (!i->HoldsInt())
+        Use(i->OpIndex());
+    Use(i->Pointer());
+    Def(i->Result());
+}
+
+
+void LinearScanAlloc::VisitTruncInstr(TruncInstr* i) { ConvertAllocaHelper(i); }
+void LinearScanAlloc::VisitFtruncInstr(FtruncInstr* i) { ConvertAllocaHelper(i); }
+
+void LinearScanAlloc::VisitZextInstr(ZextInstr* i) { ConvertAllocaHelper(i); }
+void LinearScanAlloc::VisitSextInstr(SextInstr* i) { ConvertAllocaHelper(i); }
+void LinearScanAlloc::VisitFextInstr(FextInstr* i) { ConvertAllocaHelper(i); }
+void LinearScanAlloc::VisitFtoUInstr(FtoUInstr* i) { ConvertAllocaHelper(i); }
+void LinearScanAlloc::VisitFtoSInstr(FtoSInstr* i) { ConvertAllocaHelper(i); }
+
+void LinearScanAlloc::VisitUtoFInstr(UtoFInstr* i) { ConvertAllocaHelper(i); }
+void LinearScanAlloc::VisitStoFInstr(StoFInstr* i) { ConvertAllocaHelper(i); }
+void LinearScanAlloc::VisitPtrtoIInstr(PtrtoIInstr* i) { ConvertAllocaHelper(i); }
+void LinearScanAlloc::VisitItoPtrInstr(ItoPtrInstr* i) { ConvertAllocaHelper(i); }
+void LinearScanAlloc::VisitBitcastInstr(BitcastInstr* i) { ConvertAllocaHelper(i); }
+
+
+void LinearScanAlloc::VisitIcmpInstr(IcmpInstr* i)
+{
+    Use(i->Op1());
+    Use(i->Op2());
+    Def(i->Result());
+}
+
+void LinearScanAlloc::VisitFcmpInstr(FcmpInstr* i)
+{
+    Use(i->Op1());
+    Use(i->Op2());
+    Def(i->Result());
+}
+
+void LinearScanAlloc::VisitSelectInstr(SelectInstr* i)
+{
+    Use(i->SelType());
+    Use(i->Value1());
+    Use(i->Value2());
+    Def(i->Result());
+}
+
+void LinearScanAlloc::VisitPhiInstr(PhiInstr* i)
+{
+    Def(i->Result());
+    phis_.push_back(i);
+}
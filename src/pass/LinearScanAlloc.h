@@ -0,0 +1,156 @@
+#ifndef _LINEAR_SCAN_ALLOC_H_
+#define _LINEAR_SCAN_ALLOC_H_
+
+#include "pass/Pass.h"
+#include "pass/DUInfo.h"
+#include "pass/Liveness.h"
+#include "pass/LoopAnalyze.h"
+#include "pass/x64Alloc.h"
+#include "utils/BitVector.h"
+#include "visitir/IRVisitor.h"
+#include "visitir/x64.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class BinaryInstr;
+class ConvertInstr;
+class Instr;
+class IROperand;
+class Register;
+
+
+// The LinearScanAlloc allocates registers from the whole register file,
+// except rax, r11 and xmm0 reserved for the code generator, in a single
+// pass over live intervals. Instructions are numbered in the order the
+// basic blocks are laid out, and the interval of a virtual register is
+// the smallest range covering its definition, its uses and the borders of
+// the blocks it is live-in/live-out at. A virtual register is either kept in
+// one physical register or spilled to the stack during its whole lifetime.
+// When no register is free, the interval with the lowest spill cost,
+// weighted by the loop nesting depth of each use, is spilled.
+// Some instructions clobber certain registers, e.g., calls clobber every
+// caller-saved register, and the intervals across them can't use these.
+// The implementation is based on Linear Scan Register Allocation by
+// Poletto and Sarkar (1999). See https://dl.acm.org/doi/10.1145/330249.330250.
+
+class LinearScanAlloc : public x64Alloc
+{
+public:
+    LinearScanAlloc(Module* m, Pass* du, Pass* l, Pass* live) :
+        x64Alloc(m), info_(static_cast<DUInfo*>(du)),
+        loops_(static_cast<LoopAnalyze*>(l)),
+        live_(static_cast<Liveness*>(live)) {}
+
+    std::string PrintSummary() const override;
+    void ExitFunction() override;
+
+private:
+    struct Interval
+    {
+        const Register* reg_{};
+        int start_{ -1 };
+        int end_{ -1 };
+        double weight_{};
+        // registers that must not be assigned to the interval
+        RegSet forbid_{};
+        // the register the value is passed in, if it is a parameter
+        RegTag hint_{ RegTag::none };
+        RegTag tag_{ RegTag::none };
+    };
+
+    // registers clobbered by an instruction; if 'def' is false, the
+    // result of the instruction can still be put in these registers.
+    struct Clobber
+    {
+        int pos_{};
+        const RegSet* regs_{};
+        bool def_{};
+    };
+
+    bool NeedAlloc(const IROperand*) const;
+    // the interval of a register, if it has one
+    Interval* GetInterval(const IROperand*);
+
+    void Extend(const IROperand*, int pos, bool access = true);
+    void Use(const IROperand*);
+    void Def(const IROperand*);
+    void Clobbered(const RegSet&, bool def);
+
+    void BuildIntervals(Function*);
+    void ScanIntervals();
+    RegTag FindFree(const Interval&, const std::vector<Interval*>&) const;
+    void Assign(Interval*);
+
+    void BinaryAllocaHelper(BinaryInstr*);
+    void ConvertAllocaHelper(ConvertInstr*);
+
+    int pos_{};
+    BasicBlock* curbb_{};
+    std::unordered_map<const BasicBlock*, std::pair<int, int>> border_{};
+    // indexed by the numbers of registers, see Function::MakeRegister
+    std::vector<Interval> intervals_{};
+    // intervals in the order they are created, for a deterministic result
+    std::vector<Interval*> order_{};
+    std::vector<Clobber> clobbers_{};
+    BitVector allocas_{};
+    std::vector<PhiInstr*> phis_{};
+    // the last use of each parameter of heterogeneous type passed in registers
+    std::unordered_map<const IROperand*, int> heters_{};
+
+    DUInfo* info_{};
+    LoopAnalyze* loops_{};
+    Liveness* live_{};
+
+private:
+    void VisitFunction(Function*) override;
+    void VisitBasicBlock(BasicBlock*) override;
+
+    void VisitRetInstr(RetInstr*) override;
+    void VisitBrInstr(BrInstr*) override;
+    void VisitSwitchInstr(SwitchInstr*) override;
+    void VisitCallInstr(CallInstr*) override;
+
+    void VisitAddInstr(AddInstr*) override;
+    void VisitFaddInstr(FaddInstr*) override;
+    void VisitSubInstr(SubInstr*) override;
+    void VisitFsubInstr(FsubInstr*) override;
+    void VisitMulInstr(MulInstr*) override;
+    void VisitFmulInstr(FmulInstr*) override;
+    void VisitDivInstr(DivInstr*) override;
+    void VisitFdivInstr(FdivInstr*) override;
+    void VisitModInstr(ModInstr*) override;
+    void VisitShlInstr(ShlInstr*) override;
+    void VisitLshrInstr(LshrInstr*) override;
+    void VisitAshrInstr(AshrInstr*) override;
+    void VisitAndInstr(AndInstr*) override;
+    void VisitOrInstr(OrInstr*) override;
+    void VisitXorInstr(XorInstr*) override;
+
+    void VisitAllocaInstr(AllocaInstr*) override;
+    void VisitLoadInstr(LoadInstr*) override;
+    void VisitStoreInstr(StoreInstr*) override;
+    void VisitGetElePtrInstr(GetElePtrInstr*) override;
+
+    void VisitTruncInstr(TruncInstr*) override;
+    void VisitFtruncInstr(FtruncInstr*) override;
+
+    void VisitZextInstr(ZextInstr*) override;
+    void VisitSextInstr(SextInstr*) override;
+    void VisitFextInstr(FextInstr*) override;
+    void VisitFtoUInstr(FtoUInstr*) override;
+    void VisitFtoSInstr(FtoSInstr*) override;
+
+    void VisitUtoFInstr(UtoFInstr*) override;
+    void VisitStoFInstr(StoFInstr*) override;
+    void VisitPtrtoIInstr(PtrtoIInstr*) override;
+    void VisitItoPtrInstr(ItoPtrInstr*) override;
+    void VisitBitcastInstr(BitcastInstr*) override;
+
+    void VisitIcmpInstr(IcmpInstr*) override;
+    void VisitFcmpInstr(FcmpInstr*) override;
+    void VisitSelectInstr(SelectInstr*) override;
+    void VisitPhiInstr(PhiInstr*) override;
+};
+
+#endif // _LINEAR_SCAN_ALLOC_H_
@@ -1,13 +1,41 @@
 #include "pass/Liveness.h"
+#include "IR/Instr.h"
 #include "utils/Graph.h"
 #include <fmt/format.h>
 #include <unordered_map>
 #include <unordered_set>
 
 
+void Liveness::LocalSets(const Function* func)
+{
+    regs_ = func->RegNumbers();
+    auto slots = func->BlockNumbers() + 1;
+    for (auto sets : { &def_, &use_, &phidef_, &phiuse_, &livein_, &liveout_ })
+        sets->assign(slots, BitVector(regs_));
+    for (auto bb : *func)
+    {
+        auto slot = Slot(bb);
+        if (duinfo_->HasPhiDef(bb))
+            for (auto op : duinfo_->GetPhiDef(bb))
+                phidef_[slot].Set(Number(op));
+        if (duinfo_->HasDef(bb))
+            for (auto op : duinfo_->GetDef(bb))
+                def_[slot].Set(Number(op));
+        // A variable defined in bb is never upward exposed,
+        // as its definition dominates its uses.
+        if (duinfo_->HasUse(bb))
+            for (auto op : duinfo_->GetUse(bb))
+                if (!def_[slot].Test(Number(op)))
+                    use_[slot].Set(Number(op));
+        if (duinfo_->HasPhiUse(bb))
+            for (auto op : duinfo_->GetPhiUse(bb))
+                phiuse_[slot].Set(Number(op));
+    }
+}
+
 void Liveness::PartialLiveness(const FlowGraph::GraphType& fg, const BasicBlock* bb)
 {
-    onpath_.insert(bb);
+    onpath_[Slot(bb)] = true;
 
     for (auto v : fg[bb])
     {
@@ -21,12 +49,10 @@ void Liveness::PartialLiveness(const FlowGraph::GraphType& fg, const BasicBlock*
         PartialLiveness(fg, to);
     }
 
-    std::unordered_set<const IROperand*> live{};
     // live <- PhiUses(bb)
-    if (duinfo_->HasPhiUse(bb))
-        for (auto op : duinfo_->GetPhiUse(bb))
-            live.insert(op);
+    auto live = phiuse_[Slot(bb)];
     // live <- (U(s in succ(bb)) (LiveIn(s) \ PhiDefs(s))) U live
+    BitVector in{ regs_ };
     for (auto v : fg[bb])
     {
         if (OnPath(v.to_))
@@ -34,59 +60,46 @@ void Liveness::PartialLiveness(const FlowGraph::GraphType& fg, const BasicBlock*
         auto to = v.to_;
         if (loops_->IsReenrty(bb, to))
             to = FindOLE(bb, to);
-        live.merge(livein_[to]);
-        if (duinfo_->HasPhiDef(to))
-            for (auto op : duinfo_->GetPhiDef(to))
-                live.erase(op);
+        in = livein_[Slot(to)];
+        in -= phidef_[Slot(to)];
+        live |= in;
     }
     // copy to liveout
-    liveout_[bb] = live;
+    liveout_[Slot(bb)] = live;
 
     // LiveIn(bb) = PhiDefs(bb) U UpwardExposed(bb) U (LiveOut(bb) \ Defs(bb))
     // UpwardExposed(bb) : variables used in bb without any preceding definition in bb
-    // remove variables defined in bb
-    if (duinfo_->HasDef(bb))
-        for (auto op : duinfo_->GetDef(bb))
-            live.erase(op);
-    // add variables used in bb to live
-    if (duinfo_->HasUse(bb))
-        for (auto op : duinfo_->GetUse(bb))
-            live.insert(op);
-    // add variable defined by phi instruction
-    if (duinfo_->HasPhiDef(bb))
-        for (auto op : duinfo_->GetPhiDef(bb))
-            live.insert(op);
-    livein_[bb] = std::move(live);
-
-    onpath_.erase(bb);
-    visited_.insert(bb);
+    live -= def_[Slot(bb)];
+    live |= use_[Slot(bb)];
+    live |= phidef_[Slot(bb)];
+    livein_[Slot(bb)] = std::move(live);
+
+    onpath_[Slot(bb)] = false;
+    visited_[Slot(bb)] = true;
 }
 
 void Liveness::PropagateHeader(const Function* func)
 {
     // If a variable is live-in at the header of a loop,
     // then it is live at all nodes inside the loop.
-    std::unordered_map<const BasicBlock*, std::unordered_set<const IROperand*>> liveloop{};
+    std::vector<BitVector> liveloop(livein_.size());
+    std::vector<bool> done(livein_.size());
     for (auto bb : *func)
     {
-        auto header = loops_->GetHeader(bb);
+        // A header is inside its own loop, which matters when the header
+        // is the only block of the loop, e.g., after invariants are hoisted.
+        auto header = loops_->IsHeader(bb) ? bb : loops_->GetHeader(bb);
         while (header)
         {
-            if (auto set = liveloop.find(header); set != liveloop.end())
-            {
-                livein_[bb].merge(set->second);
-                liveout_[bb].merge(set->second);
-            }
-            else
+            auto& set = liveloop[Slot(header)];
+            if (!done[Slot(header)])
             {
-                auto temp = livein_[header];
-                if (duinfo_->HasPhiDef(header))
-                    for (auto op : duinfo_->GetPhiDef(header))
-                        temp.erase(op);
-                livein_[bb].merge(temp);
-                liveout_[bb].merge(temp);
-                liveloop[header] = std::move(temp);
+                set = livein_[Slot(header)];
+                set -= phidef_[Slot(header)];
+                done[Slot(header)] = true;
             }
+            livein_[Slot(bb)] |= set;
+            liveout_[Slot(bb)] |= set;
             header = loops_->GetHeader(header);
         }
     }
@@ -115,19 +128,57 @@ const BasicBlock* Liveness::FindOLE(
     return prev;
 }
 
+void Liveness::ScanBlock(const BasicBlock* bb) const
+{
+    scanned_[Slot(bb)] = true;
+    std::unordered_map<const Instr*, std::vector<size_t>> defs{}, uses{};
+    if (duinfo_->HasDef(bb))
+        for (auto op : duinfo_->GetDef(bb))
+            if (duinfo_->HasDef(op))
+                defs[duinfo_->GetDef(op)].push_back(Number(op));
+    if (duinfo_->HasUse(bb))
+        for (auto op : duinfo_->GetUse(bb))
+            for (auto use : duinfo_->GetUse(op))
+                // Phi operands are used at the end of the predecessors.
+                if (use->Parent() == bb && !use->Is<PhiInstr>())
+                    uses[use].push_back(Number(op));
+
+    auto live = liveout_[Slot(bb)];
+    for (auto i = bb->end(); i != bb->begin(); )
+    {
+        auto instr = *--i;
+        liveafter_[instr] = live;
+        if (auto def = defs.find(instr); def != defs.end())
+            for (auto num : def->second)
+                live.Reset(num);
+        if (auto use = uses.find(instr); use != uses.end())
+            for (auto num : use->second)
+                live.Set(num);
+    }
+}
+
+Liveness::LiveSet Liveness::LiveAfter(const Instr* instr) const
+{
+    if (!scanned_[Slot(instr->Parent())])
+        ScanBlock(instr->Parent());
+    return { liveafter_.at(instr), CurFunc()->Registers() };
+}
+
 
 #define SUMMARY_HELPER(which)                                   \
-for (auto& pair : which)                                        \
+for (auto bb : *CurFunc())                                      \
 {                                                               \
-    auto& set = pair.second;                                    \
-    if (set.size() == 0)                                        \
+    auto& set = which[Slot(bb)];                                \
+    if (set.Empty())                                            \
         continue;                                               \
-    summary += fmt::format("[{}]: ", pair.first->Name());       \
-    auto last = std::for_each_n(set.begin(), set.size() - 1,    \
-    [&] (const IROperand* op) {                                 \
-        summary += op->As<Register>()->Name() + ", ";           \
-    });                                                         \
-    summary += (*last)->As<Register>()->Name() + "\n";          \
+    summary += fmt::format("[{}]: ", bb->Name());               \
+    auto sep = "";                                              \
+    for (auto num : set)                                        \
+    {                                                           \
+        summary += sep + CurFunc()->Registers()[num]->Name();   \
+        sep = ", ";                                             \
+    }                                                           \
+    summary += '\n';                                            \
 }
 
 std::string Liveness::PrintSummary() const
@@ -147,6 +198,11 @@ std::string Liveness::PrintSummary() const
 void Liveness::ExecuteOnFunction(Function* func)
 {
     CurFunc() = func;
-    PartialLiveness(fg_->GetFlowGraph(), func->At(0));
+    auto slots = func->BlockNumbers() + 1;
+    onpath_.resize(slots);
+    visited_.resize(slots);
+    scanned_.resize(slots);
+    LocalSets(func);
+    PartialLiveness(fg_->GetFlowGraph(), func->Front());
     PropagateHeader(func);
 }
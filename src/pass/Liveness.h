@@ -5,12 +5,15 @@
 #include "pass/FlowGraph.h"
 #include "pass/DUInfo.h"
 #include "pass/LoopAnalyze.h"
+#include "utils/BitVector.h"
 #include <string>
-#include <unordered_set>
+#include <unordered_map>
+#include <vector>
 
 class Module;
 class Function;
 class BasicBlock;
+class Instr;
 
 
 // Do liveness analysis on SSA IR. The implementation
@@ -18,6 +21,9 @@ class BasicBlock;
 // 9.2 in SSA-based Compiler Design. 
 // See https://link.springer.com/book/10.1007/978-3-030-80515-9
 // for more information.
+// The sets are bit vectors over the numbers the registers get from their
+// function, so that each step of the dataflow is a few word-parallel passes. Sets of registers live after each instruction
+// are computed on demand, a block at a time.
 
 class Liveness : public FunctionPass
 {
@@ -27,33 +33,70 @@ public:
         duinfo_(static_cast<DUInfo*>(du)),
         loops_(static_cast<LoopAnalyze*>(l)) {}
 
+    // A set of live registers, iterated over as operands.
+    using LiveSet = RegisterSet;
+
     std::string PrintSummary() const override;
 
     void ExecuteOnFunction(Function*) override;
-    void ExitFunction() override { visited_.clear(); livein_.clear(); liveout_.clear(); }
+    void ExitFunction() override
+    {
+        regs_ = 0;
+        def_.clear(); use_.clear(); phidef_.clear(); phiuse_.clear();
+        onpath_.clear(); visited_.clear();
+        livein_.clear(); liveout_.clear();
+        scanned_.clear(); liveafter_.clear();
+    }
 
-    const auto& LiveIn(const BasicBlock* bb) { return livein_[bb]; }
-    const auto& LiveOut(const BasicBlock* bb) { return liveout_[bb]; }
-    bool LiveInAt(const IROperand* op, const BasicBlock* bb) { return livein_[bb].count(op); }
-    bool LiveOutAt(const IROperand* op, const BasicBlock* bb) { return liveout_[bb].count(op); }
+    LiveSet LiveIn(const BasicBlock* bb) const
+    { return { livein_[Slot(bb)], CurFunc()->Registers() }; }
+    LiveSet LiveOut(const BasicBlock* bb) const
+    { return { liveout_[Slot(bb)], CurFunc()->Registers() }; }
+    bool LiveInAt(const IROperand* op, const BasicBlock* bb) const
+    { return livein_[Slot(bb)].Test(Number(op)); }
+    bool LiveOutAt(const IROperand* op, const BasicBlock* bb) const
+    { return liveout_[Slot(bb)].Test(Number(op)); }
+    // registers live right after the instruction, including what it defines if used later
+    LiveSet LiveAfter(const Instr*) const;
 
 private:
+    void LocalSets(const Function*);
     void PartialLiveness(const FlowGraph::GraphType&, const BasicBlock*);
     void PropagateHeader(const Function*);
     // Find outermost excluding loop. That is,
     // the highest loop header containing 'to' but not 'from'.
     const BasicBlock* FindOLE(const BasicBlock* from, const BasicBlock* to) const;
+    void ScanBlock(const BasicBlock*) const;
+
+    // The exit takes slot 0 and blocks follow by their numbers.
+    static size_t Slot(const BasicBlock* b) { return b ? b->Number() + 1 : 0; }
+    bool OnPath(const BasicBlock* b) const { return onpath_[Slot(b)]; }
+    bool Visited(const BasicBlock* b) const { return visited_[Slot(b)]; }
+    // Operands other than the registers of the function
+    // get a number past the end, in no set.
+    size_t Number(const IROperand* op) const
+    {
+        auto reg = op->As<Register>();
+        return reg && reg->Number() < regs_ ? reg->Number() : regs_;
+    }
+
+    // registers of the function when the pass ran
+    size_t regs_{};
+
+    // The local sets of DUInfo in bits; use_ is upward exposed uses only.
+    std::vector<BitVector> def_{};
+    std::vector<BitVector> use_{};
+    std::vector<BitVector> phidef_{};
+    std::vector<BitVector> phiuse_{};
 
-    bool OnPath(const BasicBlock* b) const { return onpath_.count(b); }
-    bool Visited(const BasicBlock* b) const { return visited_.count(b); }
+    std::vector<bool> onpath_{};
+    std::vector<bool> visited_{};
 
-    std::unordered_set<const BasicBlock*> onpath_{};
-    std::unordered_set<const BasicBlock*> visited_{};
+    std::vector<BitVector> livein_{};
+    std::vector<BitVector> liveout_{};
 
-    mutable std::unordered_map<const BasicBlock*,
-        std::unordered_set<const IROperand*>> livein_{};
-    mutable std::unordered_map<const BasicBlock*,
-        std::unordered_set<const IROperand*>> liveout_{};
+    mutable std::vector<bool> scanned_{};
+    mutable std::unordered_map<const Instr*, BitVector> liveafter_{};
 
     FlowGraph* fg_{};
     DUInfo* duinfo_{};
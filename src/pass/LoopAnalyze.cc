@@ -5,54 +5,55 @@
 
 void LoopAnalyze::IdentifyLoops(const Function* func)
 {
-    auto fg = fg_->GetFlowGraph();
-    for (auto& v : fg.GetVertices())
-        loopinfo_.emplace(*v, (LoopInfo){});
-    DFS(fg, func->At(0), 1);
+    const auto& fg = fg_->GetFlowGraph();
+    loopinfo_.resize(func->BlockNumbers() + 1);
+    DFS(fg, func->Front(), 1);
 }
 
 const BasicBlock* LoopAnalyze::DFS(
     const FlowGraph::GraphType& fg, const BasicBlock* b0, int pos)
 {
-    loopinfo_[b0].dfsppos_ = pos;
-    loopinfo_[b0].visited_ = true;
+    Info(b0).dfsppos_ = pos;
+    Info(b0).visited_ = true;
 
     for (auto [b, _] : fg[b0])
     {
         // Not traversed?
-        if (loopinfo_[b].visited_ == false)
+        if (Info(b).visited_ == false)
         {
             auto nh = DFS(fg, b, pos + 1);
             MarkLoopHeader(b0, nh);
             continue;
         }
 
-        auto h = loopinfo_[b].loopheader_;
+        auto h = Info(b).loopheader_;
         // We have encountered b before
-        if (loopinfo_[b].dfsppos_ > 0) // b in DFSP(b0)
+        if (Info(b).dfsppos_ > 0) // b in DFSP(b0)
         {
-            loopinfo_[b].isheader_ = true;
+            Info(b).isheader_ = true;
             MarkLoopHeader(b0, b);
         }
-        else if (loopinfo_[b].loopheader_ == nullptr)
+        else if (Info(b).loopheader_ == nullptr)
             continue;
+        else if (Info(h).dfsppos_ > 0) // h in DFSP(b0)
+            MarkLoopHeader(b0, h);
         else // h not in DFSP(b0); re-entry
         {
-            loopinfo_[h].isirreducible_ = true;
-            while (loopinfo_[h].loopheader_)
+            Info(h).isirreducible_ = true;
+            while (Info(h).loopheader_)
             {
-                h = loopinfo_[h].loopheader_;
-                if (loopinfo_[h].dfsppos_ > 0)
+                h = Info(h).loopheader_;
+                if (Info(h).dfsppos_ > 0)
                 {
                     MarkLoopHeader(b0, h);
                     break;
                 }
-                loopinfo_[h].isirreducible_ = true;
+                Info(h).isirreducible_ = true;
             }
         }
     }
-    loopinfo_[b0].dfsppos_ = 0;
-    return loopinfo_[b0].loopheader_;
+    Info(b0).dfsppos_ = 0;
+    return Info(b0).loopheader_;
 }
 
 void LoopAnalyze::MarkLoopHeader(const BasicBlock* b, const BasicBlock* h)
@@ -60,31 +61,39 @@ void LoopAnalyze::MarkLoopHeader(const BasicBlock* b, const BasicBlock* h)
     if (b == h || h == nullptr)
         return;
     auto cur1 = b, cur2 = h;
-    while (auto ih = loopinfo_[cur1].loopheader_)
+    while (auto ih = Info(cur1).loopheader_)
     {
         if (ih == cur2)
             return;
-        if (loopinfo_[ih].dfsppos_ < loopinfo_[cur2].dfsppos_)
+        if (Info(ih).dfsppos_ < Info(cur2).dfsppos_)
         {
-            loopinfo_[cur1].loopheader_ = cur2;
+            Info(cur1).loopheader_ = cur2;
             cur1 = cur2;
             cur2 = ih;
         }
         else
             cur1 = ih;
     }
-    loopinfo_[cur1].loopheader_ = cur2;
+    Info(cur1).loopheader_ = cur2;
 }
 
 
 bool LoopAnalyze::InIrreducible(const BasicBlock* bb) const
 {
-    auto header = loopinfo_.at(bb).loopheader_;
+    auto header = Info(bb).loopheader_;
     if (!header)
         return false;
-    if (loopinfo_.at(bb).isheader_)
+    if (Info(bb).isheader_)
         return false;
-    return loopinfo_.at(header).isirreducible_;
+    return Info(header).isirreducible_;
+}
+
+int LoopAnalyze::LoopDepth(const BasicBlock* bb) const
+{
+    int depth = Info(bb).isheader_ ? 1 : 0;
+    for (auto h = Info(bb).loopheader_; h; h = Info(h).loopheader_)
+        depth++;
+    return depth;
 }
 
 bool LoopAnalyze::IsReenrty(
@@ -99,7 +108,7 @@ bool LoopAnalyze::IsReenrty(
     //   +--b3
     if (!InIrreducible(to) || IsHeader(to))
         return false;
-    if (loopinfo_.at(from).loopheader_ == loopinfo_.at(to).loopheader_)
+    if (Info(from).loopheader_ == Info(to).loopheader_)
         return false;
     return true;
 }
@@ -109,20 +118,22 @@ std::string LoopAnalyze::PrintSummary() const
 {
     std::string summary{ fmt::format("Pass LoopAnalyze in function {}:\n", CurFunc()->Name()) };
     summary += "All loop headers:\n";
-    for (auto& [bb, info] : loopinfo_)
+    for (auto bb : *CurFunc())
     {
+        const auto& info = Info(bb);
         if (!info.isheader_)
             continue;
         summary += fmt::format("{}: {}\n",
             bb->Name(), info.isirreducible_ ? "irreducible" : "reducible");
     }
     summary += "Other blocks in loops:\n";
-    for (auto& [bb, info] : loopinfo_)
+    for (auto bb : *CurFunc())
     {
+        const auto& info = Info(bb);
         if (info.isheader_)
             continue;
-        if (bb && info.loopheader_)
-        // except exit block and blocks not in loop
+        if (info.loopheader_)
+        // except blocks not in loop
             summary += fmt::format("{}'s header: {}\n",
                 bb->Name(), info.loopheader_->Name());
     }
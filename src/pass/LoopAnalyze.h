@@ -4,7 +4,6 @@
 #include "pass/Pass.h"
 #include "pass/FlowGraph.h"
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 class Module;
@@ -29,12 +28,14 @@ public:
     void ExecuteOnFunction(Function* func) override { CurFunc() = func; IdentifyLoops(func); }
     void ExitFunction() override { loopinfo_.clear(); }
 
-    const BasicBlock* GetHeader(const BasicBlock* bb) const { return loopinfo_.at(bb).loopheader_; }
-    bool InLoop(const BasicBlock* bb) const { return loopinfo_.at(bb).loopheader_; }
-    bool IsHeader(const BasicBlock* bb) const { return loopinfo_.at(bb).isheader_; }
+    const BasicBlock* GetHeader(const BasicBlock* bb) const { return Info(bb).loopheader_; }
+    bool InLoop(const BasicBlock* bb) const { return Info(bb).loopheader_; }
+    bool IsHeader(const BasicBlock* bb) const { return Info(bb).isheader_; }
     bool InIrreducible(const BasicBlock*) const;
-    bool IsIrreducible(const BasicBlock* bb) const { return loopinfo_.at(bb).isirreducible_; }
+    bool IsIrreducible(const BasicBlock* bb) const { return Info(bb).isirreducible_; }
     bool IsReenrty(const BasicBlock* from, const BasicBlock* to) const;
+    // how many loops the block is nested in
+    int LoopDepth(const BasicBlock*) const;
 
 private:
     void IdentifyLoops(const Function*);
@@ -50,8 +51,17 @@ private:
         int dfsppos_{};
         const BasicBlock* loopheader_{};
     };
+    static size_t Slot(const BasicBlock* bb) { return bb ? bb->Number() + 1 : 0; }
+    LoopInfo& Info(const BasicBlock* bb) { return loopinfo_.at(Slot(bb)); }
+    // Blocks added after the pass ran belong to no loop.
+    const LoopInfo& Info(const BasicBlock* bb) const
+    {
+        static const LoopInfo none{};
+        return Slot(bb) < loopinfo_.size() ? loopinfo_[Slot(bb)] : none;
+    }
 
-    std::unordered_map<const BasicBlock*, LoopInfo> loopinfo_{};
+    // the exit first, then indexed by the numbers of blocks
+    std::vector<LoopInfo> loopinfo_{};
     FlowGraph* fg_{};
 };
 
@@ -0,0 +1,466 @@
+#include "pass/Mem2Reg.h"
+#include "IR/Instr.h"
+#include "IR/IRBuilder.h"
+#include "IR/IROperand.h"
+#include "IR/IRType.h"
+#include "IR/Value.h"
+#include <algorithm>
+#include <fmt/format.h>
+
+
+void Mem2Reg::FindPromotable(Function* func)
+{
+    for (auto bb : *func)
+    {
+        for (auto i : *bb)
+        {
+            auto alloca = i->As<AllocaInstr>();
+            if (!alloca || alloca->Num() != 1)
+                continue;
+            auto ty = alloca->Type();
+            if (ty->Is<IntType>() ||
+                (ty->Is<FloatType>() && ty->Size() <= 8))
+                allocas_.emplace(alloca->Result(), alloca);
+        }
+    }
+
+    mode_ = Mode::scan;
+    for (auto bb : *func)
+        for (auto i : *bb)
+            i->Accept(this);
+
+    for (auto bb : *func)
+    {
+        for (auto i : *bb)
+        {
+            auto store = i->As<StoreInstr>();
+            if (!store || !allocas_.count(store->Dest()))
+                continue;
+            auto& blks = defblks_[store->Dest()];
+            if (blks.empty() || blks.back() != bb)
+                blks.push_back(bb);
+        }
+    }
+}
+
+void Mem2Reg::InsertPhi(Function*)
+{
+    InstrBuilder ibud{};
+    for (auto [var, alloca] : allocas_)
+    {
+        std::unordered_set<const BasicBlock*> hasphi{};
+        auto worklist = defblks_[var];
+        std::unordered_set<const BasicBlock*> inlist(worklist.begin(), worklist.end());
+
+        while (!worklist.empty())
+        {
+            auto x = worklist.back();
+            worklist.pop_back();
+            for (auto frontier : dom_->GetDomFrontier(x))
+            {
+                auto y = const_cast<BasicBlock*>(frontier);
+                if (hasphi.count(y))
+                    continue;
+                hasphi.insert(y);
+
+                ibud.SetInsertPoint(y, y->Front());
+                ibud.InsertPhiInstr(fmt::format("{}.{}",
+                    alloca->Result()->Name(), y->Name()), alloca->Type());
+                phis_.emplace(ibud.LastInstr(), var);
+
+                if (!inlist.count(y))
+                {
+                    inlist.insert(y);
+                    worklist.push_back(y);
+                }
+            }
+        }
+    }
+}
+
+void Mem2Reg::Rename(BasicBlock* bb)
+{
+    std::unordered_map<const IROperand*, int> pushed{};
+    bool terminated = false;
+
+    for (auto i : *bb)
+    {
+        // Instructions following the terminator are unreachable.
+        if (terminated)
+            Unreachable(i);
+        else if (i->Is<BrInstr>() || i->Is<SwitchInstr>() || i->Is<RetInstr>())
+            terminated = true;
+        else if (auto phi = phis_.find(i); phi != phis_.end())
+        {
+            stacks_[phi->second].push_back(i->As<PhiInstr>()->Result());
+            pushed[phi->second]++;
+        }
+        else if (auto load = i->As<LoadInstr>();
+            load && allocas_.count(load->Pointer()))
+        {
+            replace_[load->Result()] = Top(load->Pointer());
+            dead_.insert(load);
+        }
+        else if (auto store = i->As<StoreInstr>();
+            store && allocas_.count(store->Dest()))
+        {
+            auto val = store->Value();
+            while (replace_.count(val))
+                val = replace_[val];
+            auto ty = allocas_[store->Dest()]->Type();
+            if (ty->Is<PtrType>() && (!val->Is<Register>() ||
+                val->Type()->ToString() != ty->ToString()))
+                val = PtrReg(store->Dest(), val, bb, i);
+            stacks_[store->Dest()].push_back(val);
+            pushed[store->Dest()]++;
+            dead_.insert(store);
+        }
+    }
+
+    std::unordered_set<const BasicBlock*> succs{};
+    for (auto [succ, _] : fg_->GetFlowGraph()[bb])
+    {
+        // the exit, or a block with more than one edge from bb
+        if (!succ || succs.count(succ))
+            continue;
+        succs.insert(succ);
+        for (auto i : *const_cast<BasicBlock*>(succ))
+            if (auto phi = phis_.find(i); phi != phis_.end())
+                i->As<PhiInstr>()->AddBlockValPair(bb, Top(phi->second));
+    }
+
+    for (auto child : dom_->GetChildren(bb))
+        Rename(const_cast<BasicBlock*>(child));
+
+    for (auto [var, num] : pushed)
+        stacks_[var].resize(stacks_[var].size() - num);
+}
+
+void Mem2Reg::RemoveDeadPhi(Function* func)
+{
+    mode_ = Mode::count;
+    for (auto bb : *func)
+        for (auto i : *bb)
+            if (!dead_.count(i))
+                i->Accept(this);
+
+    // Removing a phi may make another one dead.
+    bool changing = true;
+    while (changing)
+    {
+        changing = false;
+        for (auto phi = phis_.begin(); phi != phis_.end(); )
+        {
+            auto inst = phi->first->As<PhiInstr>();
+            if (usecnt_[inst->Result()] > 0)
+            {
+                ++phi;
+                continue;
+            }
+            for (auto [_, op] : inst->GetBlockValPair())
+                if (op != inst->Result())
+                    usecnt_[op]--;
+            dead_.insert(inst);
+            phi = phis_.erase(phi);
+            changing = true;
+        }
+    }
+}
+
+void Mem2Reg::Cleanup(Function* func)
+{
+    for (auto [var, alloca] : allocas_)
+    {
+        promoted_.push_back(var->As<Register>()->Name());
+        dead_.insert(alloca);
+    }
+
+    for (auto bb : *func)
+        bb->RemoveIf([this] (const Instr* i) { return dead_.count(i); });
+}
+
+
+const IROperand* Mem2Reg::Top(const IROperand* var)
+{
+    auto& stack = stacks_[var];
+    // The variable is used before initialized.
+    return stack.empty() ? Undef(var) : stack.back();
+}
+
+const IROperand* Mem2Reg::Undef(const IROperand* var)
+{
+    if (auto undef = undef_.find(var); undef != undef_.end())
+        return undef->second;
+
+    auto entry = CurFunc()->Front();
+    auto ty = allocas_[var]->Type();
+    if (ty->Is<PtrType>())
+    {
+        auto null = IntConst::CreateIntConst(CurFunc(), 0, ty->As<IntType>());
+        undef_[var] = PtrReg(var, null, entry, entry->Front());
+        return undef_[var];
+    }
+    const IROperand* zero = ty->Is<FloatType>() ?
+        static_cast<const IROperand*>(FloatConst::CreateFloatConst(
+            CurFunc(), 0.0, ty->As<FloatType>())) :
+        IntConst::CreateIntConst(CurFunc(), 0, ty->As<IntType>());
+    undef_[var] = zero;
+    return zero;
+}
+
+const Register* Mem2Reg::PtrReg(
+    const IROperand* var, const IROperand* val, BasicBlock* bb, Instr* pos)
+{
+    InstrBuilder ibud{};
+    ibud.SetInsertPoint(bb, pos);
+    auto name = fmt::format("{}.{}", var->As<Register>()->Name(), ptrregs_++);
+    auto ty = allocas_[var]->Type()->As<PtrType>();
+    if (auto reg = val->As<Register>(); reg)
+        return ibud.InsertBitcastInstr(name, ty, reg);
+    return ibud.InsertItoPtrInstr(name, ty, val);
+}
+
+
+void Mem2Reg::Unreachable(const Instr* i)
+{
+    if (auto load = i->As<LoadInstr>();
+        load && allocas_.count(load->Pointer()))
+    {
+        replace_[load->Result()] = Undef(load->Pointer());
+        dead_.insert(load);
+    }
+    else if (auto store = i->As<StoreInstr>();
+        store && allocas_.count(store->Dest()))
+        dead_.insert(store);
+}
+
+
+void Mem2Reg::Escape(const IROperand* op)
+{
+    if (mode_ == Mode::scan)
+        allocas_.erase(op);
+    else if (mode_ == Mode::count)
+        usecnt_[op]++;
+}
+
+void Mem2Reg::Operand(const IROperand*& op)
+{
+    if (mode_ == Mode::scan)
+        allocas_.erase(op);
+    else if (mode_ == Mode::rewrite)
+    {
+        while (replace_.count(op))
+            op = replace_[op];
+    }
+    else if (mode_ == Mode::count)
+        usecnt_[op]++;
+}
+
+void Mem2Reg::Pointer(const Register*& reg)
+{
+    // Pointers are registers by the time they are replaced.
+    const IROperand* op = reg;
+    if (mode_ == Mode::rewrite)
+        Operand(op);
+    reg = op->As<Register>();
+}
+
+void Mem2Reg::BinaryHelper(BinaryInstr* bin)
+{
+    Operand(bin->Lhs());
+    Operand(bin->Rhs());
+}
+
+void Mem2Reg::ConvertHelper(ConvertInstr* cvt)
+{
+    Operand(cvt->Value());
+}
+
+
+void Mem2Reg::VisitRetInstr(RetInstr* ret)
+{
+    if (ret->ReturnValue())
+        Operand(ret->ReturnValue());
+}
+
+void Mem2Reg::VisitBrInstr(BrInstr* br)
+{
+    if (br->Cond())
+        Operand(br->Cond());
+}
+
+void Mem2Reg::VisitSwitchInstr(SwitchInstr* swtch)
+{
+    auto ident = swtch->GetIdent();
+    Operand(ident);
+    swtch->SetIdent(ident);
+}
+
+void Mem2Reg::VisitCallInstr(CallInstr* call)
+{
+    if (call->FuncAddr())
+    {
+        Escape(call->FuncAddr());
+        Pointer(call->FuncAddr());
+    }
+    for (auto& arg : call->ArgvList())
+        Operand(arg);
+}
+
+
+void Mem2Reg::VisitAddInstr(AddInstr* inst) { BinaryHelper(inst); }
+void Mem2Reg::VisitFaddInstr(FaddInstr* inst) { BinaryHelper(inst); }
+void Mem2Reg::VisitSubInstr(SubInstr* inst) { BinaryHelper(inst); }
+void Mem2Reg::VisitFsubInstr(FsubInstr* inst) { BinaryHelper(inst); }
+void Mem2Reg::VisitMulInstr(MulInstr* inst) { BinaryHelper(inst); }
+void Mem2Reg::VisitFmulInstr(FmulInstr* inst) { BinaryHelper(inst); }
+void Mem2Reg::VisitDivInstr(DivInstr* inst) { BinaryHelper(inst); }
+void Mem2Reg::VisitFdivInstr(FdivInstr* inst) { BinaryHelper(inst); }
+void Mem2Reg::VisitModInstr(ModInstr* inst) { BinaryHelper(inst); }
+void Mem2Reg::VisitShlInstr(ShlInstr* inst) { BinaryHelper(inst); }
+void Mem2Reg::VisitLshrInstr(LshrInstr* inst) { BinaryHelper(inst); }
+void Mem2Reg::VisitAshrInstr(AshrInstr* inst) { BinaryHelper(inst); }
+void Mem2Reg::VisitAndInstr(AndInstr* inst) { BinaryHelper(inst); }
+void Mem2Reg::VisitOrInstr(OrInstr* inst) { BinaryHelper(inst); }
+void Mem2Reg::VisitXorInstr(XorInstr* inst) { BinaryHelper(inst); }
+
+
+void Mem2Reg::VisitLoadInstr(LoadInstr* load)
+{
+    if (mode_ == Mode::scan && load->Volatile())
+        allocas_.erase(load->Pointer());
+    else if (mode_ == Mode::count)
+        usecnt_[load->Pointer()]++;
+    Pointer(load->Pointer());
+}
+
+void Mem2Reg::VisitStoreInstr(StoreInstr* store)
+{
+    if (mode_ == Mode::scan && store->Volatile())
+        allocas_.erase(store->Dest());
+    else if (mode_ == Mode::count)
+        usecnt_[store->Dest()]++;
+    Pointer(store->Dest());
+    Operand(store->Value());
+}
+
+void Mem2Reg::VisitGetElePtrInstr(GetElePtrInstr* gep)
+{
+    Escape(gep->Pointer());
+    Pointer(gep->Pointer());
+    if (!gep->HoldsInt())
+        Operand(gep->OpIndex());
+}
+
+
+void Mem2Reg::VisitTruncInstr(TruncInstr* inst) { ConvertHelper(inst); }
+void Mem2Reg::VisitFtruncInstr(FtruncInstr* inst) { ConvertHelper(inst); }
+void Mem2Reg::VisitZextInstr(ZextInstr* inst) { ConvertHelper(inst); }
+void Mem2Reg::VisitSextInstr(SextInstr* inst) { ConvertHelper(inst); }
+void Mem2Reg::VisitFextInstr(FextInstr* inst) { ConvertHelper(inst); }
+void Mem2Reg::VisitFtoUInstr(FtoUInstr* inst) { ConvertHelper(inst); }
+void Mem2Reg::VisitFtoSInstr(FtoSInstr* inst) { ConvertHelper(inst); }
+void Mem2Reg::VisitUtoFInstr(UtoFInstr* inst) { ConvertHelper(inst); }
+void Mem2Reg::VisitStoFInstr(StoFInstr* inst) { ConvertHelper(inst); }
+void Mem2Reg::VisitPtrtoIInstr(PtrtoIInstr* inst) { ConvertHelper(inst); }
+void Mem2Reg::VisitItoPtrInstr(ItoPtrInstr* inst) { ConvertHelper(inst); }
+void Mem2Reg::VisitBitcastInstr(BitcastInstr* inst) { ConvertHelper(inst); }
+
+
+void Mem2Reg::VisitIcmpInstr(IcmpInstr* icmp)
+{
+    Operand(icmp->Op1());
+    Operand(icmp->Op2());
+}
+
+void Mem2Reg::VisitFcmpInstr(FcmpInstr* fcmp)
+{
+    Operand(fcmp->Op1());
+    Operand(fcmp->Op2());
+}
+
+void Mem2Reg::VisitSelectInstr(SelectInstr* select)
+{
+    Operand(select->SelType());
+    Operand(select->Value1());
+    Operand(select->Value2());
+}
+
+void Mem2Reg::VisitPhiInstr(PhiInstr* phi)
+{
+    for (auto& [_, op] : phi->GetBlockValPair())
+    {
+        // A phi merely passing its own value around a loop
+        // doesn't keep itself alive.
+        if (mode_ == Mode::count && op == phi->Result())
+            continue;
+        Operand(op);
+    }
+}
+
+
+std::string Mem2Reg::PrintSummary() const
+{
+    std::string summary{ fmt::format(
+        "Pass Mem2Reg in function {}:\n", CurFunc()->Name()) };
+    summary += "Allocas promoted:\n";
+    for (auto& name : promoted_)
+        summary += name + '\n';
+    summary += "Phi instructions inserted:\n";
+    for (auto [phi, _] : phis_)
+        summary += phi->ToString() + '\n';
+    return std::move(summary);
+}
+
+
+void Mem2Reg::ExecuteOnFunction(Function* func)
+{
+    CurFunc() = func;
+    FindPromotable(func);
+    if (allocas_.empty())
+        return;
+    InsertPhi(func);
+    Rename(func->Front());
+
+    // Loads in unreachable blocks read nothing meaningful, and phi
+    // instructions still need values from unreachable predecessors.
+    for (auto bb : *func)
+    {
+        if (dom_->Reachable(bb))
+            continue;
+        for (auto i : *bb)
+            Unreachable(i);
+        std::unordered_set<const BasicBlock*> succs{};
+        for (auto [succ, _] : fg_->GetFlowGraph()[bb])
+        {
+            if (!succ || succs.count(succ))
+                continue;
+            succs.insert(succ);
+            for (auto i : *const_cast<BasicBlock*>(succ))
+                if (auto phi = phis_.find(i); phi != phis_.end())
+                    i->As<PhiInstr>()->AddBlockValPair(bb, Undef(phi->second));
+        }
+    }
+
+    mode_ = Mode::rewrite;
+    for (auto bb : *func)
+        for (auto i : *bb)
+            i->Accept(this);
+
+    RemoveDeadPhi(func);
+    Cleanup(func);
+}
+
+void Mem2Reg::ExitFunction()
+{
+    allocas_.clear();
+    undef_.clear();
+    defblks_.clear();
+    phis_.clear();
+    stacks_.clear();
+    replace_.clear();
+    usecnt_.clear();
+    dead_.clear();
+    promoted_.clear();
+    ptrregs_ = 0;
+}
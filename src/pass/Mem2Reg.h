@@ -0,0 +1,140 @@
+#ifndef _MEM2REG_H_
+#define _MEM2REG_H_
+
+#include "pass/Pass.h"
+#include "pass/Dominators.h"
+#include "pass/FlowGraph.h"
+#include "visitir/IRVisitor.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class Module;
+class AllocaInstr;
+class BasicBlock;
+class BinaryInstr;
+class ConvertInstr;
+class Instr;
+class IROperand;
+class Register;
+
+
+// Promote allocas to SSA registers. An alloca is promoted if it holds
+// a scalar (an integer, a pointer or a float-point no more than 8 bytes),
+// and it is only loaded from and stored to; that is, its address never
+// escapes. Loads and stores take their pointers in registers of the type
+// pointed to, so a constant stored to a pointer, e.g., null, is converted
+// into a register, and so is a pointer stored without a cast from another
+// pointer type.
+// Phi instructions are placed at the iterated dominance frontiers of the
+// blocks storing to the variable, and then the variable is renamed by
+// walking the dominator tree. Phi instructions never used are removed
+// afterwards. The implementation is based on Efficiently Computing Static
+// Single Assignment Form and the Control Dependence Graph by Cytron et al.
+// (1991). See also chapter 3 in SSA-based Compiler Design.
+
+class Mem2Reg : public FunctionPass, private IRVisitor
+{
+public:
+    Mem2Reg(Module* m, Pass* fg, Pass* dom) : FunctionPass(m),
+        fg_(static_cast<FlowGraph*>(fg)), dom_(static_cast<Dominators*>(dom)) {}
+
+    std::string PrintSummary() const override;
+
+    void ExecuteOnFunction(Function*) override;
+    void ExitFunction() override;
+
+private:
+    enum class Mode { scan, rewrite, count };
+
+    void FindPromotable(Function*);
+    void InsertPhi(Function*);
+    void Rename(BasicBlock*);
+    void RemoveDeadPhi(Function*);
+    void Cleanup(Function*);
+
+    const IROperand* Top(const IROperand*);
+    const IROperand* Undef(const IROperand*);
+    // Convert a pointer stored to var into a register of its type before pos.
+    const Register* PtrReg(const IROperand*, const IROperand*, BasicBlock*, Instr*);
+    // Loads and stores never executed are simply dropped.
+    void Unreachable(const Instr*);
+
+    // The address of an alloca is taken if it is used
+    // other than as the pointer of loads and stores.
+    void Escape(const IROperand*);
+    // Handle an operand, which can be modified, of an instruction
+    // according to the current mode. That is, check if the address
+    // escapes, replace a loaded value with the value stored, or
+    // simply count how many times an operand is used.
+    void Operand(const IROperand*&);
+    // The same for the pointers of loads, stores, geps and calls,
+    // which are replaced once the pointers themselves are promoted.
+    void Pointer(const Register*&);
+    void BinaryHelper(BinaryInstr*);
+    void ConvertHelper(ConvertInstr*);
+
+    Mode mode_{};
+
+    std::unordered_map<const IROperand*, AllocaInstr*> allocas_{};
+    std::unordered_map<const IROperand*, const IROperand*> undef_{};
+    std::unordered_map<const IROperand*, std::vector<BasicBlock*>> defblks_{};
+    // phi instructions inserted, mapped to the variables (allocas) they merge
+    std::unordered_map<const Instr*, const IROperand*> phis_{};
+    std::unordered_map<const IROperand*, std::vector<const IROperand*>> stacks_{};
+    std::unordered_map<const IROperand*, const IROperand*> replace_{};
+    std::unordered_map<const IROperand*, int> usecnt_{};
+    std::unordered_set<const Instr*> dead_{};
+    std::vector<std::string> promoted_{};
+    int ptrregs_{};
+
+    FlowGraph* fg_{};
+    Dominators* dom_{};
+
+private:
+    void VisitRetInstr(RetInstr*) override;
+    void VisitBrInstr(BrInstr*) override;
+    void VisitSwitchInstr(SwitchInstr*) override;
+    void VisitCallInstr(CallInstr*) override;
+
+    void VisitAddInstr(AddInstr*) override;
+    void VisitFaddInstr(FaddInstr*) override;
+    void VisitSubInstr(SubInstr*) override;
+    void VisitFsubInstr(FsubInstr*) override;
+    void VisitMulInstr(MulInstr*) override;
+    void VisitFmulInstr(FmulInstr*) override;
+    void VisitDivInstr(DivInstr*) override;
+    void VisitFdivInstr(FdivInstr*) override;
+    void VisitModInstr(ModInstr*) override;
+    void VisitShlInstr(ShlInstr*) override;
+    void VisitLshrInstr(LshrInstr*) override;
+    void VisitAshrInstr(AshrInstr*) override;
+    void VisitAndInstr(AndInstr*) override;
+    void VisitOrInstr(OrInstr*) override;
+    void VisitXorInstr(XorInstr*) override;
+
+    void VisitLoadInstr(LoadInstr*) override;
+    void VisitStoreInstr(StoreInstr*) override;
+    void VisitGetElePtrInstr(GetElePtrInstr*) override;
+
+    void VisitTruncInstr(TruncInstr*) override;
+    void VisitFtruncInstr(FtruncInstr*) override;
+    void VisitZextInstr(ZextInstr*) override;
+    void VisitSextInstr(SextInstr*) override;
+    void VisitFextInstr(FextInstr*) override;
+    void VisitFtoUInstr(FtoUInstr*) override;
+    void VisitFtoSInstr(FtoSInstr*) override;
+    void VisitUtoFInstr(UtoFInstr*) override;
+    void VisitStoFInstr(StoFInstr*) override;
+    void VisitPtrtoIInstr(PtrtoIInstr*) override;
+    void VisitItoPtrInstr(ItoPtrInstr*) override;
+    void VisitBitcastInstr(BitcastInstr*) override;
+
+    void VisitIcmpInstr(IcmpInstr*) override;
+    void VisitFcmpInstr(FcmpInstr*) override;
+    void VisitSelectInstr(SelectInstr*) override;
+    void VisitPhiInstr(PhiInstr*) override;
+};
+
+#endif // _MEM2REG_H_
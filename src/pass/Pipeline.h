@@ -25,6 +25,8 @@ public:
         passes_[i] = std::make_unique<PASS>(module_, index2pass(std::forward<IPASS>(dep))...);
     }
 
+    bool HasPass(int i) const { return passes_.count(i); }
+
     template <class PASS = Pass>
     PASS* GetPass(int i)
     {
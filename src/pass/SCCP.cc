@@ -0,0 +1,768 @@
+#include "pass/SCCP.h"
+#include "IR/Instr.h"
+#include "IR/IROperand.h"
+#include "IR/IRType.h"
+#include "IR/Value.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <fmt/format.h>
+
+
+bool SCCP::Lattice::operator==(const Lattice& l) const
+{
+    if (state_ != l.state_)
+        return false;
+    if (state_ != State::constant)
+        return true;
+    if (isfloat_ != l.isfloat_)
+        return false;
+    if (!isfloat_)
+        return int_ == l.int_;
+    // -0.0 differs from 0.0 here, and a NaN equals itself.
+    return std::memcmp(&fp_, &l.fp_, sizeof(double)) == 0;
+}
+
+SCCP::Lattice SCCP::IntVal(unsigned long val, const IRType* ty)
+{
+    Lattice l{ Lattice::State::constant };
+    if (ty->Size() < 8)
+        val &= (1ul << ty->Size() * 8) - 1;
+    l.int_ = val;
+    return l;
+}
+
+SCCP::Lattice SCCP::FloatVal(double val, const IRType* ty)
+{
+    Lattice l{ Lattice::State::constant };
+    l.isfloat_ = true;
+    l.fp_ = ty->Size() == 4 ? static_cast<float>(val) : val;
+    return l;
+}
+
+SCCP::Lattice SCCP::Meet(const Lattice& l1, const Lattice& l2)
+{
+    if (l1.state_ == Lattice::State::top)
+        return l2;
+    if (l2.state_ == Lattice::State::top)
+        return l1;
+    return l1 == l2 ? l1 : Bottom();
+}
+
+long SCCP::Extend(const Lattice& l, const IRType* ty, bool sign)
+{
+    int bits = ty->Size() * 8;
+    if (!sign || bits == 64 || !(l.int_ & (1ul << (bits - 1))))
+        return l.int_;
+    return l.int_ | (~0ul << bits);
+}
+
+
+SCCP::Lattice SCCP::Get(const IROperand* op) const
+{
+    if (auto ic = op->As<IntConst>(); ic)
+        return IntVal(ic->Val(), ic->Type());
+    if (auto fc = op->As<FloatConst>(); fc)
+        return FloatVal(fc->Val(), fc->Type());
+    if (auto v = values_.find(op); v != values_.end())
+        return v->second;
+    // Parameters, pointers and other things never evaluated
+    // can be anything.
+    return defined_.count(op) ? Top() : Bottom();
+}
+
+void SCCP::Update(const IROperand* op, const Lattice& l)
+{
+    if (!op || !defined_.count(op))
+        return;
+    auto& cur = values_[op];
+    // Values only move down the lattice.
+    auto newval = cur.state_ == Lattice::State::top ? l : Meet(cur, l);
+    if (newval.state_ == Lattice::State::constant &&
+        newval.isfloat_ != op->Type()->Is<FloatType>())
+        newval = Bottom();
+    if (newval == cur)
+        return;
+    cur = newval;
+    for (auto user : users_[op])
+        ssalist_.push_back(user);
+}
+
+void SCCP::AddEdge(const BasicBlock* from, const BasicBlock* to)
+{
+    flowlist_.emplace_back(from, to);
+}
+
+void SCCP::VisitBlock(BasicBlock* bb)
+{
+    curbb_ = bb;
+    for (auto i : *bb)
+    {
+        i->Accept(this);
+        if (i->IsControlInstr())
+            break;
+    }
+}
+
+void SCCP::Propagate(Function* func)
+{
+    mode_ = Mode::scan;
+    for (auto bb : *func)
+    {
+        curbb_ = bb;
+        for (auto i : *bb)
+        {
+            curinst_ = i;
+            i->Accept(this);
+            if (i->IsControlInstr())
+                break;
+        }
+    }
+
+    mode_ = Mode::eval;
+    AddEdge(nullptr, func->Front());
+    while (!flowlist_.empty() || !ssalist_.empty())
+    {
+        if (!flowlist_.empty())
+        {
+            auto edge = flowlist_.back();
+            flowlist_.pop_back();
+            if (!execedges_.insert(edge).second)
+                continue;
+
+            auto bb = const_cast<BasicBlock*>(edge.second);
+            if (execblks_.insert(bb).second)
+                VisitBlock(bb);
+            else
+            {
+                // Only phi instructions see the new edge.
+                curbb_ = bb;
+                for (auto i : *bb)
+                    if (i->Is<PhiInstr>())
+                        i->Accept(this);
+            }
+        }
+        else
+        {
+            auto [inst, bb] = ssalist_.back();
+            ssalist_.pop_back();
+            if (!execblks_.count(bb))
+                continue;
+            curbb_ = bb;
+            inst->Accept(this);
+        }
+    }
+}
+
+
+SCCP::Lattice SCCP::EvalBinary(const BinaryInstr* bin) const
+{
+    auto lhs = Get(bin->Lhs());
+    auto rhs = Get(bin->Rhs());
+    if (lhs.state_ == Lattice::State::bottom ||
+        rhs.state_ == Lattice::State::bottom)
+        return Bottom();
+    if (lhs.state_ == Lattice::State::top ||
+        rhs.state_ == Lattice::State::top)
+        return Top();
+
+    // Operands of unexpected types are left to the code generator.
+    auto ty = bin->Result()->Type();
+    if (lhs.isfloat_ != rhs.isfloat_ || lhs.isfloat_ != ty->Is<FloatType>())
+        return Bottom();
+    switch (bin->id_)
+    {
+    case Instr::InstrId::fadd: return FloatVal(lhs.fp_ + rhs.fp_, ty);
+    case Instr::InstrId::fsub: return FloatVal(lhs.fp_ - rhs.fp_, ty);
+    case Instr::InstrId::fmul: return FloatVal(lhs.fp_ * rhs.fp_, ty);
+    case Instr::InstrId::fdiv: return FloatVal(lhs.fp_ / rhs.fp_, ty);
+    default:
+        if (lhs.isfloat_)
+            return Bottom();
+        break;
+    }
+
+    auto lty = bin->Lhs()->Type();
+    auto rty = bin->Rhs()->Type();
+    bool sign = lty->As<IntType>()->IsSigned() ||
+        rty->As<IntType>()->IsSigned();
+    unsigned long a = lhs.int_, b = rhs.int_;
+    // x86 only looks at the low bits of the shift count.
+    unsigned long count = b & (ty->Size() == 8 ? 63 : 31);
+
+    switch (bin->id_)
+    {
+    case Instr::InstrId::add: return IntVal(a + b, ty);
+    case Instr::InstrId::sub: return IntVal(a - b, ty);
+    case Instr::InstrId::mul: return IntVal(a * b, ty);
+    case Instr::InstrId::btand: return IntVal(a & b, ty);
+    case Instr::InstrId::btor: return IntVal(a | b, ty);
+    case Instr::InstrId::btxor: return IntVal(a ^ b, ty);
+    case Instr::InstrId::shl: return IntVal(a << count, ty);
+    case Instr::InstrId::lshr: return IntVal(a >> count, ty);
+    case Instr::InstrId::ashr:
+        return IntVal(Extend(lhs, lty, true) >> count, ty);
+
+    case Instr::InstrId::div:
+    case Instr::InstrId::mod:
+    {
+        // Leave the traps to the run time.
+        if (b == 0)
+            return Bottom();
+        if (!sign)
+            return IntVal(bin->id_ == Instr::InstrId::div ? a / b : a % b, ty);
+
+        long sa = Extend(lhs, lty, true);
+        long sb = Extend(rhs, rty, true);
+        if (sb == -1)
+        {
+            int bits = lty->Size() < 4 ? 32 : lty->Size() * 8;
+            if (a == (1ul << (bits - 1)))
+                return Bottom();
+        }
+        return IntVal(bin->id_ == Instr::InstrId::div ? sa / sb : sa % sb, ty);
+    }
+    default: return Bottom();
+    }
+}
+
+SCCP::Lattice SCCP::EvalConvert(const ConvertInstr* cvt) const
+{
+    auto val = Get(cvt->Value());
+    if (val.state_ != Lattice::State::constant)
+        return val;
+
+    auto from = cvt->Value()->Type();
+    auto to = cvt->Dest()->Type();
+    if (val.isfloat_ != from->Is<FloatType>())
+        return Bottom();
+    switch (cvt->id_)
+    {
+    case Instr::InstrId::trunc: return IntVal(val.int_, to);
+    case Instr::InstrId::zext: return IntVal(val.int_, to);
+    case Instr::InstrId::sext: return IntVal(Extend(val, from, true), to);
+    case Instr::InstrId::ftrunc: return FloatVal(val.fp_, to);
+    case Instr::InstrId::fext: return FloatVal(val.fp_, to);
+    // Round only once, as the hardware does.
+    case Instr::InstrId::utof:
+        return to->Size() == 4 ?
+            FloatVal(static_cast<float>(val.int_), to) :
+            FloatVal(static_cast<double>(val.int_), to);
+    case Instr::InstrId::stof:
+        return to->Size() == 4 ?
+            FloatVal(static_cast<float>(Extend(val, from, true)), to) :
+            FloatVal(static_cast<double>(Extend(val, from, true)), to);
+
+    case Instr::InstrId::ftou:
+    case Instr::InstrId::ftos:
+    {
+        // Values out of the range of the result give
+        // whatever the hardware gives, so leave them alone.
+        double t = std::trunc(val.fp_);
+        int bits = to->Size() * 8;
+        double lo = 0, hi = std::ldexp(1.0, bits < 64 ? bits : 63);
+        if (cvt->id_ == Instr::InstrId::ftos)
+            lo = -std::ldexp(1.0, bits - 1), hi = std::ldexp(1.0, bits - 1);
+        if (std::isnan(t) || t < lo || t >= hi)
+            return Bottom();
+        return IntVal(t < 0 ? static_cast<unsigned long>(static_cast<long>(t)) :
+            static_cast<unsigned long>(t), to);
+    }
+    default: return Bottom();
+    }
+}
+
+SCCP::Lattice SCCP::Truth(const IROperand* op) const
+{
+    auto val = Get(op);
+    if (val.state_ != Lattice::State::constant)
+        return val;
+
+    Lattice truth{ Lattice::State::constant };
+    if (!val.isfloat_)
+        truth.int_ = val.int_ != 0;
+    else if (std::isnan(val.fp_))
+        return Bottom();
+    else
+        truth.int_ = val.fp_ != 0;
+    return truth;
+}
+
+
+void SCCP::FoldBranch(BasicBlock* bb)
+{
+    auto pos = bb->begin();
+    while (pos != bb->end() && !(*pos)->IsControlInstr())
+        ++pos;
+    if (pos == bb->end())
+        return;
+
+    auto inst = *pos;
+    if (auto br = inst->As<BrInstr>(); br && br->Cond())
+    {
+        auto truth = Truth(br->Cond());
+        if (truth.state_ != Lattice::State::constant)
+            return;
+        auto target = truth.int_ ? br->GetTrueBlk() : br->GetFalseBlk();
+        branches_.push_back(fmt::format("{}: br {} to {}",
+            bb->Name(), br->Cond()->ToString(), target->Name()));
+        br->Cond() = nullptr;
+        br->SetTrueBlk(const_cast<BasicBlock*>(target));
+        br->SetFalseBlk(nullptr);
+    }
+    else if (auto swtch = inst->As<SwitchInstr>(); swtch)
+    {
+        auto ident = Get(swtch->GetIdent());
+        if (ident.state_ != Lattice::State::constant)
+            return;
+        auto ty = swtch->GetIdent()->Type();
+        auto target = swtch->GetDefault();
+        for (auto [tag, blk] : swtch->GetValueBlkPairs())
+        {
+            if (IntVal(tag->Val(), ty) == ident)
+            {
+                target = blk;
+                break;
+            }
+        }
+        branches_.push_back(fmt::format("{}: switch {} to {}",
+            bb->Name(), swtch->GetIdent()->ToString(), target->Name()));
+        bb->Insert(bb->Remove(pos), bb->Parent()->Make<BrInstr>(target));
+    }
+}
+
+void SCCP::Rewrite(Function* func)
+{
+    for (auto bb : *func)
+    {
+        if (!execblks_.count(bb))
+            continue;
+        FoldBranch(bb);
+
+        // Instructions following the terminator are never executed,
+        // and they may refer to the blocks removed. Allocas are kept
+        // for the same reason as in RemoveUnreachable.
+        auto term = bb->begin();
+        while (term != bb->end() && !(*term)->IsControlInstr())
+            ++term;
+        if (term != bb->end())
+            for (auto i = std::next(term); i != bb->end(); )
+                i = (*i)->Is<AllocaInstr>() ? std::next(i) : bb->Remove(i);
+
+        for (auto i : *bb)
+        {
+            auto phi = i->As<PhiInstr>();
+            if (!phi)
+                continue;
+            auto& pairs = phi->GetBlockValPair();
+            pairs.erase(std::remove_if(pairs.begin(), pairs.end(),
+                [this, bb] (const auto& pair) {
+                    return !execedges_.count({ pair.first, bb }); }),
+                pairs.end());
+        }
+    }
+
+    mode_ = Mode::rewrite;
+    for (auto bb : *func)
+    {
+        if (!execblks_.count(bb))
+            continue;
+        curbb_ = bb;
+        for (auto i = bb->end(); i != bb->begin(); )
+        {
+            curinst_ = *--i;
+            curinst_->Accept(this);
+            if (dead_.count(curinst_))
+                i = bb->Remove(i);
+        }
+    }
+}
+
+void SCCP::RemoveUnreachable(Function* func)
+{
+    auto entry = func->Front();
+    for (auto i = std::prev(func->end()); i != func->begin(); )
+    {
+        auto bb = *i--;
+        if (execblks_.count(bb))
+            continue;
+        removed_.push_back(bb->Name());
+        // A variable may be declared where control never reaches,
+        // e.g., at the beginning of a switch body, and used later.
+        for (auto inst : *bb)
+            if (auto alloca = inst->As<AllocaInstr>(); alloca)
+                entry->Insert(entry->begin(), func->Make<AllocaInstr>(
+                    alloca->Result(), alloca->Type(), alloca->Num(), alloca->Align()));
+        func->Remove(bb);
+    }
+}
+
+
+const IROperand* SCCP::Materialize(const IROperand* reg)
+{
+    auto& c = consts_[reg];
+    if (c)
+        return c;
+    auto val = Get(reg);
+    if (val.isfloat_)
+        c = FloatConst::CreateFloatConst(CurFunc(),
+            val.fp_, reg->Type()->As<FloatType>());
+    else
+        c = IntConst::CreateIntConst(CurFunc(),
+            val.int_, reg->Type()->As<IntType>());
+    return c;
+}
+
+
+void SCCP::Operand(const IROperand*& op)
+{
+    if (!op || !op->Is<Register>())
+        return;
+    if (mode_ == Mode::scan)
+        users_[op].emplace_back(curinst_, curbb_);
+    else if (mode_ == Mode::rewrite &&
+        Get(op).state_ == Lattice::State::constant)
+        op = Materialize(op);
+}
+
+void SCCP::Def(const IROperand* op)
+{
+    if (!op)
+        return;
+    if (mode_ == Mode::scan)
+    {
+        // Only scalars can be constants.
+        auto ty = op->Type();
+        if ((ty->Is<IntType>() && !ty->Is<PtrType>()) ||
+            (ty->Is<FloatType>() && ty->Size() <= 8))
+            defined_.insert(op);
+    }
+    else if (mode_ == Mode::rewrite &&
+        Get(op).state_ == Lattice::State::constant)
+    {
+        // Every use of the result is replaced by the constant.
+        folded_.push_back(fmt::format("{} = {}",
+            op->ToString(), Materialize(op)->ToString()));
+        dead_.insert(curinst_);
+    }
+}
+
+void SCCP::BinaryHelper(BinaryInstr* bin)
+{
+    if (mode_ == Mode::eval)
+    {
+        Update(bin->Result(), EvalBinary(bin));
+        return;
+    }
+    Def(bin->Result());
+    Operand(bin->Lhs());
+    Operand(bin->Rhs());
+}
+
+void SCCP::ConvertHelper(ConvertInstr* cvt)
+{
+    if (mode_ == Mode::eval)
+    {
+        Update(cvt->Dest(), EvalConvert(cvt));
+        return;
+    }
+    Def(cvt->Dest());
+    Operand(cvt->Value());
+}
+
+
+void SCCP::VisitRetInstr(RetInstr* ret)
+{
+    Operand(ret->ReturnValue());
+}
+
+void SCCP::VisitBrInstr(BrInstr* br)
+{
+    if (mode_ != Mode::eval)
+    {
+        Operand(br->Cond());
+        return;
+    }
+
+    if (!br->Cond())
+    {
+        AddEdge(curbb_, br->GetTrueBlk());
+        return;
+    }
+    auto truth = Truth(br->Cond());
+    if (truth.state_ == Lattice::State::top)
+        return;
+    if (truth.state_ == Lattice::State::bottom || truth.int_)
+        AddEdge(curbb_, br->GetTrueBlk());
+    if (truth.state_ == Lattice::State::bottom || !truth.int_)
+        AddEdge(curbb_, br->GetFalseBlk());
+}
+
+void SCCP::VisitSwitchInstr(SwitchInstr* swtch)
+{
+    if (mode_ != Mode::eval)
+    {
+        auto ident = swtch->GetIdent();
+        Operand(ident);
+        swtch->SetIdent(ident);
+        return;
+    }
+
+    auto ident = Get(swtch->GetIdent());
+    if (ident.state_ == Lattice::State::top)
+        return;
+    auto ty = swtch->GetIdent()->Type();
+    for (auto [tag, blk] : swtch->GetValueBlkPairs())
+    {
+        if (ident.state_ == Lattice::State::bottom)
+            AddEdge(curbb_, blk);
+        else if (IntVal(tag->Val(), ty) == ident)
+        {
+            AddEdge(curbb_, blk);
+            return;
+        }
+    }
+    AddEdge(curbb_, swtch->GetDefault());
+}
+
+void SCCP::VisitCallInstr(CallInstr* call)
+{
+    if (mode_ == Mode::eval)
+    {
+        Update(call->Result(), Bottom());
+        return;
+    }
+    Def(call->Result());
+    for (auto& arg : call->ArgvList())
+        Operand(arg);
+}
+
+
+void SCCP::VisitAddInstr(AddInstr* inst) { BinaryHelper(inst); }
+void SCCP::VisitFaddInstr(FaddInstr* inst) { BinaryHelper(inst); }
+void SCCP::VisitSubInstr(SubInstr* inst) { BinaryHelper(inst); }
+void SCCP::VisitFsubInstr(FsubInstr* inst) { BinaryHelper(inst); }
+void SCCP::VisitMulInstr(MulInstr* inst) { BinaryHelper(inst); }
+void SCCP::VisitFmulInstr(FmulInstr* inst) { BinaryHelper(inst); }
+void SCCP::VisitDivInstr(DivInstr* inst) { BinaryHelper(inst); }
+void SCCP::VisitFdivInstr(FdivInstr* inst) { BinaryHelper(inst); }
+void SCCP::VisitModInstr(ModInstr* inst) { BinaryHelper(inst); }
+void SCCP::VisitShlInstr(ShlInstr* inst) { BinaryHelper(inst); }
+void SCCP::VisitLshrInstr(LshrInstr* inst) { BinaryHelper(inst); }
+void SCCP::VisitAshrInstr(AshrInstr* inst) { BinaryHelper(inst); }
+void SCCP::VisitAndInstr(AndInstr* inst) { BinaryHelper(inst); }
+void SCCP::VisitOrInstr(OrInstr* inst) { BinaryHelper(inst); }
+void SCCP::VisitXorInstr(XorInstr* inst) { BinaryHelper(inst); }
+
+
+void SCCP::VisitAllocaInstr(AllocaInstr*) {}
+
+void SCCP::VisitLoadInstr(LoadInstr* load)
+{
+    if (mode_ == Mode::eval)
+        Update(load->Result(), Bottom());
+    else
+        Def(load->Result());
+}
+
+void SCCP::VisitStoreInstr(StoreInstr* store)
+{
+    Operand(store->Value());
+}
+
+void SCCP::VisitGetElePtrInstr(GetElePtrInstr* gep)
+{
+    if (!gep->HoldsInt())
+        Operand(gep->OpIndex());
+}
+
+
+void SCCP::VisitTruncInstr(TruncInstr* inst) { ConvertHelper(inst); }
+void SCCP::VisitFtruncInstr(FtruncInstr* inst) { ConvertHelper(inst); }
+void SCCP::VisitZextInstr(ZextInstr* inst) { ConvertHelper(inst); }
+void SCCP::VisitSextInstr(SextInstr* inst) { ConvertHelper(inst); }
+void SCCP::VisitFextInstr(FextInstr* inst) { ConvertHelper(inst); }
+void SCCP::VisitFtoUInstr(FtoUInstr* inst) { ConvertHelper(inst); }
+void SCCP::VisitFtoSInstr(FtoSInstr* inst) { ConvertHelper(inst); }
+void SCCP::VisitUtoFInstr(UtoFInstr* inst) { ConvertHelper(inst); }
+void SCCP::VisitStoFInstr(StoFInstr* inst) { ConvertHelper(inst); }
+void SCCP::VisitPtrtoIInstr(PtrtoIInstr* inst) { ConvertHelper(inst); }
+void SCCP::VisitItoPtrInstr(ItoPtrInstr* inst) { ConvertHelper(inst); }
+void SCCP::VisitBitcastInstr(BitcastInstr* inst) { ConvertHelper(inst); }
+
+
+void SCCP::VisitIcmpInstr(IcmpInstr* icmp)
+{
+    if (mode_ != Mode::eval)
+    {
+        Def(icmp->Result());
+        Operand(icmp->Op1());
+        Operand(icmp->Op2());
+        return;
+    }
+
+    auto lhs = Get(icmp->Op1());
+    auto rhs = Get(icmp->Op2());
+    if (lhs.state_ != Lattice::State::constant ||
+        rhs.state_ != Lattice::State::constant)
+    {
+        Update(icmp->Result(), Meet(lhs, rhs).state_ == Lattice::State::bottom ?
+            Bottom() : Top());
+        return;
+    }
+
+    if (lhs.isfloat_ || rhs.isfloat_)
+    {
+        Update(icmp->Result(), Bottom());
+        return;
+    }
+    auto lty = icmp->Op1()->Type();
+    auto rty = icmp->Op2()->Type();
+    bool sign = lty->As<IntType>()->IsSigned() ||
+        rty->As<IntType>()->IsSigned();
+    long a = Extend(lhs, lty, sign), b = Extend(rhs, rty, sign);
+    auto ua = static_cast<unsigned long>(a), ub = static_cast<unsigned long>(b);
+    bool res = false;
+    switch (icmp->Cond())
+    {
+    case Condition::eq: res = a == b; break;
+    case Condition::ne: res = a != b; break;
+    case Condition::gt: res = sign ? a > b : ua > ub; break;
+    case Condition::ge: res = sign ? a >= b : ua >= ub; break;
+    case Condition::lt: res = sign ? a < b : ua < ub; break;
+    case Condition::le: res = sign ? a <= b : ua <= ub; break;
+    }
+    Update(icmp->Result(), IntVal(res, icmp->Result()->Type()));
+}
+
+void SCCP::VisitFcmpInstr(FcmpInstr* fcmp)
+{
+    if (mode_ != Mode::eval)
+    {
+        Def(fcmp->Result());
+        Operand(fcmp->Op1());
+        Operand(fcmp->Op2());
+        return;
+    }
+
+    auto lhs = Get(fcmp->Op1());
+    auto rhs = Get(fcmp->Op2());
+    if (lhs.state_ != Lattice::State::constant ||
+        rhs.state_ != Lattice::State::constant)
+    {
+        Update(fcmp->Result(), Meet(lhs, rhs).state_ == Lattice::State::bottom ?
+            Bottom() : Top());
+        return;
+    }
+
+    // Unordered comparisons set the flags in a way
+    // that doesn't follow C, so leave them alone.
+    double a = lhs.fp_, b = rhs.fp_;
+    if (!lhs.isfloat_ || !rhs.isfloat_ || std::isnan(a) || std::isnan(b))
+    {
+        Update(fcmp->Result(), Bottom());
+        return;
+    }
+    bool res = false;
+    switch (fcmp->Cond())
+    {
+    case Condition::eq: res = a == b; break;
+    case Condition::ne: res = a != b; break;
+    case Condition::gt: res = a > b; break;
+    case Condition::ge: res = a >= b; break;
+    case Condition::lt: res = a < b; break;
+    case Condition::le: res = a <= b; break;
+    }
+    Update(fcmp->Result(), IntVal(res, fcmp->Result()->Type()));
+}
+
+void SCCP::VisitSelectInstr(SelectInstr* select)
+{
+    if (mode_ != Mode::eval)
+    {
+        Def(select->Result());
+        Operand(select->SelType());
+        Operand(select->Value1());
+        Operand(select->Value2());
+        return;
+    }
+
+    auto [cond, ty] = select->CondPair();
+    auto truth = Truth(cond);
+    if (truth.state_ == Lattice::State::top)
+        Update(select->Result(), Top());
+    else if (truth.state_ == Lattice::State::bottom)
+        Update(select->Result(),
+            Meet(Get(select->Value1()), Get(select->Value2())));
+    else
+        Update(select->Result(), Get(
+            bool(truth.int_) == ty ? select->Value1() : select->Value2()));
+}
+
+void SCCP::VisitPhiInstr(PhiInstr* phi)
+{
+    if (mode_ != Mode::eval)
+    {
+        Def(phi->Result());
+        for (auto& [_, op] : phi->GetBlockValPair())
+            Operand(op);
+        return;
+    }
+
+    auto val = Top();
+    for (auto [bb, op] : phi->GetBlockValPair())
+        if (execedges_.count({ bb, curbb_ }))
+            val = Meet(val, Get(op));
+    Update(phi->Result(), val);
+}
+
+
+std::string SCCP::PrintSummary() const
+{
+    std::string summary{ fmt::format(
+        "Pass SCCP in function {}:\n", CurFunc()->Name()) };
+    summary += "Values folded:\n";
+    for (auto& folded : folded_)
+        summary += folded + '\n';
+    summary += "Branches folded:\n";
+    for (auto& branch : branches_)
+        summary += branch + '\n';
+    summary += "Blocks removed:\n";
+    for (auto& name : removed_)
+        summary += name + '\n';
+    return std::move(summary);
+}
+
+
+void SCCP::ExecuteOnFunction(Function* func)
+{
+    CurFunc() = func;
+    Propagate(func);
+    Rewrite(func);
+    RemoveUnreachable(func);
+
+    if (branches_.empty() && removed_.empty())
+        return;
+    // Passes following this one see the new flow graph.
+    dom_->ExitFunction();
+    fg_->ExitFunction();
+    fg_->ExecuteOnFunction(func);
+    dom_->ExecuteOnFunction(func);
+}
+
+void SCCP::ExitFunction()
+{
+    values_.clear();
+    defined_.clear();
+    users_.clear();
+    execedges_.clear();
+    execblks_.clear();
+    flowlist_.clear();
+    ssalist_.clear();
+    consts_.clear();
+    dead_.clear();
+    folded_.clear();
+    branches_.clear();
+    removed_.clear();
+}
@@ -0,0 +1,171 @@
+#ifndef _SCCP_H_
+#define _SCCP_H_
+
+#include "pass/Pass.h"
+#include "pass/Dominators.h"
+#include "pass/FlowGraph.h"
+#include "visitir/IRVisitor.h"
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+class Module;
+class BasicBlock;
+class BinaryInstr;
+class ConvertInstr;
+class Instr;
+class IROperand;
+class IRType;
+class Register;
+
+
+// Sparse conditional constant propagation. Each virtual register is given
+// a lattice value: undetermined (top), a known constant, or overdefined
+// (bottom). Starting from the entry block, only instructions in blocks that
+// are found executable are evaluated, and a conditional branch or a switch
+// makes only the edges selected by its condition executable, so constants
+// flowing through phi instructions are not spoiled by values coming from
+// paths never taken. Afterwards, registers holding constants are replaced
+// by the constants, branches and switches on constants become unconditional
+// jumps, and blocks never executed are removed. The implementation is based
+// on Constant Propagation with Conditional Branches by Wegman & Zadeck (1991).
+// See also chapter 8 in SSA-based Compiler Design.
+
+class SCCP : public FunctionPass, private IRVisitor
+{
+public:
+    SCCP(Module* m, Pass* fg, Pass* dom) : FunctionPass(m),
+        fg_(static_cast<FlowGraph*>(fg)), dom_(static_cast<Dominators*>(dom)) {}
+
+    std::string PrintSummary() const override;
+
+    void ExecuteOnFunction(Function*) override;
+    void ExitFunction() override;
+
+private:
+    enum class Mode { scan, eval, rewrite };
+
+    struct Lattice
+    {
+        enum class State { top, constant, bottom };
+        State state_{ State::top };
+        // Integers are kept zero-extended from the size of their types,
+        // and float-points are rounded to the precision of their types.
+        unsigned long int_{};
+        double fp_{};
+        bool isfloat_{};
+
+        bool operator==(const Lattice&) const;
+        bool operator!=(const Lattice& l) const { return !(*this == l); }
+    };
+
+    using Edge = std::pair<const BasicBlock*, const BasicBlock*>;
+
+    static Lattice Top() { return Lattice{}; }
+    static Lattice Bottom() { return Lattice{ Lattice::State::bottom }; }
+    static Lattice IntVal(unsigned long, const IRType*);
+    static Lattice FloatVal(double, const IRType*);
+    static Lattice Meet(const Lattice&, const Lattice&);
+    // Extend an integer to 64 bits, with sign if asked.
+    static long Extend(const Lattice&, const IRType*, bool sign);
+
+    Lattice Get(const IROperand*) const;
+    void Update(const IROperand*, const Lattice&);
+    void AddEdge(const BasicBlock* from, const BasicBlock* to);
+    void VisitBlock(BasicBlock*);
+    void Propagate(Function*);
+
+    Lattice EvalBinary(const BinaryInstr*) const;
+    Lattice EvalConvert(const ConvertInstr*) const;
+    // Whether a branch on the value goes to the true side.
+    // Float-point NaNs are left undecided.
+    Lattice Truth(const IROperand*) const;
+
+    void FoldBranch(BasicBlock*);
+    void Rewrite(Function*);
+    void RemoveUnreachable(Function*);
+
+    // Handle an operand of an instruction according to the current mode.
+    // That is, record the instruction as a user of the operand, or replace
+    // the operand with the constant it holds.
+    void Operand(const IROperand*&);
+    void Def(const IROperand*);
+    // The constant replacing a register, built in the entry block.
+    const IROperand* Materialize(const IROperand*);
+    void BinaryHelper(BinaryInstr*);
+    void ConvertHelper(ConvertInstr*);
+
+    Mode mode_{};
+    BasicBlock* curbb_{};
+    Instr* curinst_{};
+
+    std::unordered_map<const IROperand*, Lattice> values_{};
+    // registers defined in the function, which are top until evaluated
+    std::unordered_set<const IROperand*> defined_{};
+    std::unordered_map<const IROperand*,
+        std::vector<std::pair<Instr*, BasicBlock*>>> users_{};
+
+    std::set<Edge> execedges_{};
+    std::unordered_set<const BasicBlock*> execblks_{};
+    std::vector<Edge> flowlist_{};
+    std::vector<std::pair<Instr*, BasicBlock*>> ssalist_{};
+
+    std::unordered_map<const IROperand*, const IROperand*> consts_{};
+    std::unordered_set<const Instr*> dead_{};
+    std::vector<std::string> folded_{};
+    std::vector<std::string> branches_{};
+    std::vector<std::string> removed_{};
+
+    FlowGraph* fg_{};
+    Dominators* dom_{};
+
+private:
+    void VisitRetInstr(RetInstr*) override;
+    void VisitBrInstr(BrInstr*) override;
+    void VisitSwitchInstr(SwitchInstr*) override;
+    void VisitCallInstr(CallInstr*) override;
+
+    void VisitAddInstr(AddInstr*) override;
+    void VisitFaddInstr(FaddInstr*) override;
+    void VisitSubInstr(SubInstr*) override;
+    void VisitFsubInstr(FsubInstr*) override;
+    void VisitMulInstr(MulInstr*) override;
+    void VisitFmulInstr(FmulInstr*) override;
+    void VisitDivInstr(DivInstr*) override;
+    void VisitFdivInstr(FdivInstr*) override;
+    void VisitModInstr(ModInstr*) override;
+    void VisitShlInstr(ShlInstr*) override;
+    void VisitLshrInstr(LshrInstr*) override;
+    void VisitAshrInstr(AshrInstr*) override;
+    void VisitAndInstr(AndInstr*) override;
+    void VisitOrInstr(OrInstr*) override;
+    void VisitXorInstr(XorInstr*) override;
+
+    void VisitAllocaInstr(AllocaInstr*) override;
+    void VisitLoadInstr(LoadInstr*) override;
+    void VisitStoreInstr(StoreInstr*) override;
+    void VisitGetElePtrInstr(GetElePtrInstr*) override;
+
+    void VisitTruncInstr(TruncInstr*) override;
+    void VisitFtruncInstr(FtruncInstr*) override;
+    void VisitZextInstr(ZextInstr*) override;
+    void VisitSextInstr(SextInstr*) override;
+    void VisitFextInstr(FextInstr*) override;
+    void VisitFtoUInstr(FtoUInstr*) override;
+    void VisitFtoSInstr(FtoSInstr*) override;
+    void VisitUtoFInstr(UtoFInstr*) override;
+    void VisitStoFInstr(StoFInstr*) override;
+    void VisitPtrtoIInstr(PtrtoIInstr*) override;
+    void VisitItoPtrInstr(ItoPtrInstr*) override;
+    void VisitBitcastInstr(BitcastInstr*) override;
+
+    void VisitIcmpInstr(IcmpInstr*) override;
+    void VisitFcmpInstr(FcmpInstr*) override;
+    void VisitSelectInstr(SelectInstr*) override;
+    void VisitPhiInstr(PhiInstr*) override;
+};
+
+#endif // _SCCP_H_
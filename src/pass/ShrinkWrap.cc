@@ -0,0 +1,202 @@
+#include "pass/ShrinkWrap.h"
+#include "IR/IROperand.h"
+#include "IR/Value.h"
+#include "utils/Graph.h"
+#include "visitir/x64.h"
+#include <fmt/format.h>
+
+
+void ShrinkWrap::CalleeSavedOf(const x64* mapped, std::vector<x64Phys>& regs) const
+{
+    auto add = [this, &regs] (RegTag tag) {
+        // RegTag has none and rip before the registers in x64Phys
+        if (tag == RegTag::none || tag == RegTag::rip)
+            return;
+        auto phys = static_cast<x64Phys>(static_cast<int>(tag) - 2);
+        if (callee_.count(phys))
+            regs.push_back(phys);
+    };
+
+    if (!mapped)
+        return;
+    else if (auto reg = mapped->As<x64Reg>(); reg)
+        add(reg->Tag());
+    else if (auto mem = mapped->As<x64Mem>(); mem)
+    {
+        add(mem->Base().Tag());
+        add(mem->Index().Tag());
+    }
+    else if (auto heter = mapped->As<x64Heter>(); heter)
+        for (const auto& place : *heter)
+            if (place.InReg())
+                add(place.ToReg());
+}
+
+void ShrinkWrap::FindUsers(Function* func)
+{
+    std::vector<x64Phys> regs{};
+    auto use = [this, &regs] (const IROperand* op) {
+        CalleeSavedOf(alloc_->GetIROpMap(op), regs); };
+    auto mark = [this, &regs] (const BasicBlock* bb) {
+        for (auto reg : regs)
+            users_[reg].insert(bb);
+    };
+
+    // parameters are homed in the prologue
+    for (auto param : func->Params())
+        use(param);
+    mark(func->Front());
+
+    for (auto bb : *func)
+    {
+        if (!dom_->Reachable(bb))
+            continue;
+        regs.clear();
+        for (auto op : live_->LiveIn(bb))
+            use(op);
+        if (info_->HasDef(bb))
+            for (auto op : info_->GetDef(bb))
+                use(op);
+        mark(bb);
+
+        if (!info_->HasPhiDef(bb))
+            continue;
+        regs.clear();
+        for (auto op : info_->GetPhiDef(bb))
+            use(op);
+        mark(bb);
+        // Copies for phis are placed at the end of the predecessors.
+        for (auto pred : fg_->GetPredsOf(bb))
+            if (dom_->Reachable(pred))
+                mark(pred);
+    }
+}
+
+
+const BasicBlock* ShrinkWrap::CommonDominator(
+    const BasicBlock* bb1, const BasicBlock* bb2) const
+{
+    std::unordered_set<const BasicBlock*> doms{};
+    for (auto bb = bb1; bb; bb = dom_->GetIDom(bb))
+        doms.insert(bb);
+    for (auto bb = bb2; bb; bb = dom_->GetIDom(bb))
+        if (doms.count(bb))
+            return bb;
+    return nullptr;
+}
+
+bool ShrinkWrap::Reach(
+    const BasicBlock* from, const BasicBlock* to, const BasicBlock* avoid) const
+{
+    const auto& graph = fg_->GetFlowGraph();
+    std::unordered_set<const BasicBlock*> visited{ from };
+    std::vector<const BasicBlock*> worklist{ from };
+    while (!worklist.empty())
+    {
+        auto bb = worklist.back();
+        worklist.pop_back();
+        for (auto [succ, _] : graph[bb])
+        {
+            if (succ == to)
+                return true;
+            if (succ && succ != avoid && visited.insert(succ).second)
+                worklist.push_back(succ);
+        }
+    }
+    return false;
+}
+
+bool ShrinkWrap::InLoop(const BasicBlock* bb) const
+{
+    return Reach(bb, bb, nullptr);
+}
+
+void ShrinkWrap::FindRegion(Function* func, x64Phys reg)
+{
+    const BasicBlock* save = nullptr;
+    for (auto bb : users_[reg])
+        save = save ? CommonDominator(save, bb) : bb;
+    // Saving the register again in a later iteration
+    // would overwrite the value of the caller.
+    while (save && InLoop(save))
+        save = dom_->GetIDom(save);
+
+    // If every return is reached through the save point,
+    // i.e., it post-dominates the entry, nothing is gained.
+    auto entry = func->Front();
+    if (!save || save == entry || !Reach(entry, nullptr, save))
+        return;
+
+    save_[reg] = save;
+    for (auto bb : *func)
+        if (dom_->Dominate(save, bb))
+            region_[reg].insert(bb);
+}
+
+
+std::vector<x64Phys> ShrinkWrap::SavedAt(const BasicBlock* bb) const
+{
+    std::vector<x64Phys> regs{};
+    for (auto reg : callee_)
+    {
+        auto save = save_.find(reg);
+        if (save == save_.end() ? !bb : save->second == bb)
+            regs.push_back(reg);
+    }
+    return regs;
+}
+
+std::vector<x64Phys> ShrinkWrap::Saved(const BasicBlock* bb) const
+{
+    std::vector<x64Phys> regs{};
+    for (auto reg : callee_)
+        if (!save_.count(reg) || region_.at(reg).count(bb))
+            regs.push_back(reg);
+    return regs;
+}
+
+std::vector<x64Phys> ShrinkWrap::RestoreOnEdge(
+    const BasicBlock* from, const BasicBlock* to) const
+{
+    std::vector<x64Phys> regs{};
+    for (const auto& [reg, region] : region_)
+        if (region.count(from) && !region.count(to))
+            regs.push_back(reg);
+    return regs;
+}
+
+
+void ShrinkWrap::ExecuteOnFunction(Function* func)
+{
+    CurFunc() = func;
+    if (func->Empty() || alloc_->OmitFramePointer())
+        return;
+    callee_ = alloc_->UsedCalleeSaved();
+    FindUsers(func);
+    for (auto reg : callee_)
+        FindRegion(func, reg);
+}
+
+void ShrinkWrap::ExitFunction()
+{
+    callee_.clear();
+    users_.clear();
+    save_.clear();
+    region_.clear();
+}
+
+
+std::string ShrinkWrap::PrintSummary() const
+{
+    std::string summary{ fmt::format(
+        "Pass ShrinkWrap in function {}:\n", CurFunc()->Name()) };
+    summary += "Callee-saved register : where it is saved\n";
+    for (auto reg : callee_)
+    {
+        x64Reg r{ static_cast<RegTag>(static_cast<int>(reg) + 2) };
+        auto save = save_.find(reg);
+        summary += fmt::format("{} : {}\n", r.ToString(),
+            save == save_.end() ? "prologue" : save->second->Name());
+    }
+    return std::move(summary);
+}
@@ -0,0 +1,82 @@
+#ifndef _SHRINK_WRAP_H_
+#define _SHRINK_WRAP_H_
+
+#include "pass/Pass.h"
+#include "pass/Dominators.h"
+#include "pass/DUInfo.h"
+#include "pass/FlowGraph.h"
+#include "pass/Liveness.h"
+#include "pass/x64Alloc.h"
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+class Module;
+class BasicBlock;
+class Function;
+class IROperand;
+class x64;
+
+
+// Shrink-wrapping of callee-saved registers. Rather than in the prologue,
+// each register is saved at the nearest common dominator of the blocks using
+// it, so paths never getting there, like the fast path of a guard clause,
+// skip the save and restore. A block uses a register if a value in it is
+// defined or live into the block, or is the result of a phi in a successor,
+// since the copy goes to the end of the block. The save point is moved up
+// the dominator tree out of loops, and the register is saved in the prologue
+// if the point ends up in the entry (e.g., a parameter is homed in it) or
+// post-dominates the entry, where every path would save it anyway. Registers
+// are restored on the edges leaving the region dominated by their save points,
+// and before the returns in it. This is a simplified version of Minimizing
+// Register Usage Penalty at Procedure Calls by Chow (1988). Functions without
+// the frame pointer are left alone.
+
+class ShrinkWrap : public FunctionPass
+{
+public:
+    ShrinkWrap(Module* m, Pass* fg, Pass* dom, Pass* du, Pass* live, Pass* alloc) :
+        FunctionPass(m), fg_(static_cast<FlowGraph*>(fg)),
+        dom_(static_cast<Dominators*>(dom)), info_(static_cast<DUInfo*>(du)),
+        live_(static_cast<Liveness*>(live)), alloc_(static_cast<x64Alloc*>(alloc)) {}
+
+    std::string PrintSummary() const override;
+
+    void ExecuteOnFunction(Function*) override;
+    void ExitFunction() override;
+
+    // Is any register saved elsewhere than in the prologue?
+    bool Wrapped() const { return !save_.empty(); }
+    // Registers to save at the beginning of bb, or in the prologue for nullptr.
+    std::vector<x64Phys> SavedAt(const BasicBlock*) const;
+    // Registers saved when control is in bb, restored before returning.
+    std::vector<x64Phys> Saved(const BasicBlock*) const;
+    // Registers to restore on the edge leaving their regions.
+    std::vector<x64Phys> RestoreOnEdge(const BasicBlock* from, const BasicBlock* to) const;
+
+private:
+    void CalleeSavedOf(const x64*, std::vector<x64Phys>&) const;
+    void FindUsers(Function*);
+
+    const BasicBlock* CommonDominator(const BasicBlock*, const BasicBlock*) const;
+    // Is there a path from 'from' to 'to' avoiding 'avoid'?
+    // The exit of the flow graph is represented by nullptr.
+    bool Reach(const BasicBlock* from, const BasicBlock* to, const BasicBlock* avoid) const;
+    bool InLoop(const BasicBlock*) const;
+    void FindRegion(Function*, x64Phys);
+
+    x64Alloc::RegSet callee_{};
+    std::map<x64Phys, std::unordered_set<const BasicBlock*>> users_{};
+    // save points and regions of registers not saved in the prologue
+    std::map<x64Phys, const BasicBlock*> save_{};
+    std::map<x64Phys, std::unordered_set<const BasicBlock*>> region_{};
+
+    FlowGraph* fg_{};
+    Dominators* dom_{};
+    DUInfo* info_{};
+    Liveness* live_{};
+    x64Alloc* alloc_{};
+};
+
+#endif // _SHRINK_WRAP_H_
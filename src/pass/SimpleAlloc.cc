@@ -1,6 +1,7 @@
 #include "pass/SimpleAlloc.h"
 #include "IR/Value.h"
 #include "IR/Instr.h"
+#include <unordered_set>
 
 
 RegTag SimpleAlloc::SpareHelper(RegList& v, const Register* r) const
@@ -43,7 +44,9 @@ void SimpleAlloc::Map2Stack(const Register* reg, size_t size, long offset)
 void SimpleAlloc::Allocate(const Register* reg)
 {
     auto tag = RegTag::none;
-    if (reg->Type()->Is<HeterType>())
+    // The three registers are only tracked within a basic block,
+    // so operands live across blocks are always kept on the stack.
+    if (reg->Type()->Is<HeterType>() || live_->LiveOutAt(reg, curbb_))
         goto alloconstack;
     tag = reg->Type()->Is<FloatType>() ?
         SpareFReg(reg) : SpareReg(reg);
@@ -59,20 +62,13 @@ alloconstack:
         auto offset = AllocateOnX64Stack(
             ArchInfo(), reg->Type()->Size(), reg->Type()->Size());
         Map2Stack(reg, offset);
+        // the stack slot holds the value of the pointer itself
+        if (reg->Type()->Is<PtrType>())
+            MarkLoadTwice(reg);
     }
 }
 
 
-long SimpleAlloc::AllocateOnX64Stack(x64Stack& info, size_t size, size_t align)
-{
-    info.allocated_ = MakeAlign(info.allocated_, align);
-    info.allocated_ += size;
-    long base = -info.allocated_;
-    info.rspoffset_ = info.allocated_;
-    return base;
-}
-
-
 void SimpleAlloc::Access(
     const Register* reg, const BasicBlock* bb, const Instr* i)
 {
@@ -100,6 +96,54 @@ find:
 }
 
 
+bool SimpleAlloc::NeedHome(const Register* param) const
+{
+    if (!info_->HasUse(param))
+        return false;
+
+    // The front-end stores parameters to their allocas at the beginning
+    // of the function. Those stores are emitted before anything else could
+    // clobber the registers, so the parameters can stay where they are.
+    std::unordered_set<const Instr*> leading{};
+    for (auto i : *curfunc_->Front())
+    {
+        if (i->Is<StoreInstr>())
+            leading.insert(i);
+        else if (!i->Is<AllocaInstr>())
+            break;
+    }
+    for (auto use : info_->GetUse(param))
+        if (!leading.count(use))
+            return true;
+    return false;
+}
+
+void SimpleAlloc::HomeParams()
+{
+    for (auto param : curfunc_->Params())
+    {
+        auto ty = param->Type();
+        if (!ty->Is<IntType>() && !ty->Is<FloatType>())
+            continue;
+        if (!GetIROpMap(param)->Is<x64Reg>())
+        {
+            // passed on the stack; the slot holds the pointer itself
+            if (ty->Is<PtrType>())
+                MarkLoadTwice(param);
+            continue;
+        }
+        if (!NeedHome(param))
+            continue;
+
+        auto offset = AllocateOnX64Stack(ArchInfo(), ty->Size(), ty->Size());
+        HomeParam(param, std::make_unique<x64Mem>(
+            ty->Size(), offset, RegTag::rbp, RegTag::none, 0));
+        if (ty->Is<PtrType>())
+            MarkLoadTwice(param);
+    }
+}
+
+
 void SimpleAlloc::BinaryAllocaHelper(BinaryInstr* i)
 {
     if (!MapConstAndGlobalVar(i->Lhs()))
@@ -128,12 +172,14 @@ void SimpleAlloc::ResetRegList()
 void SimpleAlloc::VisitFunction(Function* func)
 {
     ResetRegList();
+    curfunc_ = func;
 
     for (auto bb : *func)
         for (auto i : *bb)
             if (i->Is<AllocaInstr>())
                 VisitAllocaInstr(i->As<AllocaInstr>());
     LoadParam();
+    HomeParams();
 
     for (auto bb : *func)
         VisitBasicBlock(bb);
@@ -323,8 +369,15 @@ void SimpleAlloc::VisitSelectInstr(SelectInstr* i)
 
 void SimpleAlloc::VisitPhiInstr(PhiInstr* i)
 {
+    // Operands of a phi instruction are copied at the end of the
+    // predecessors, where they are live-out and thus on the stack.
     for (auto [_, op] : i->GetBlockValPair())
-        if (!MapConstAndGlobalVar(op))
-            Access(op->As<Register>(), curbb_, i);
-    Allocate(i->Result());
+        MapConstAndGlobalVar(op);
+
+    auto result = i->Result();
+    auto offset = AllocateOnX64Stack(
+        ArchInfo(), result->Type()->Size(), result->Type()->Size());
+    Map2Stack(result, offset);
+    if (result->Type()->Is<PtrType>())
+        MarkLoadTwice(result);
 }
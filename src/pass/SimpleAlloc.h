@@ -24,9 +24,10 @@ class Register;
 // a very strong guarantee that every operand, expect those given by alloca
 // instructions, is assigned once and used exactly once. Therefore, this naive
 // approach is bound to make correct and efficient allocations.
-// Due to the limitation above, DO NOT use the allocator if some optimization
-// passes that will make some IR operands reused are run. The allocator may simply
-// overwrite the reused operands, leading to problems.
+// Once mem2reg is run, an operand can be used more than once and across basic
+// blocks. Registers are then released only at the last use in a block, and
+// operands live-out at the defining block (including results of phi
+// instructions) are always put on the stack.
 // For more information about 3-TOSCA, see https://www.zhihu.com/question/29355187/answer/51935409
 // or the original paper (https://www.eecg.utoronto.ca/~jzhu/csc467/readings/ra-for-free.pdf).
 
@@ -48,7 +49,10 @@ private:
     void Map2Stack(const Register*, size_t size, long offset);
 
     void Allocate(const Register*);
-    long AllocateOnX64Stack(x64Stack&, size_t, size_t);
+    // Parameters passed in registers are moved to the stack in the prologue,
+    // since the registers are clobbered by calls and the code generator.
+    bool NeedHome(const Register*) const;
+    void HomeParams();
     void Access(const Register*, const BasicBlock*, const Instr*);
 
     void BinaryAllocaHelper(BinaryInstr*);
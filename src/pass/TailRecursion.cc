@@ -0,0 +1,227 @@
+#include "pass/TailRecursion.h"
+#include "IR/Instr.h"
+#include "IR/IROperand.h"
+#include "IR/IRType.h"
+#include "IR/Value.h"
+#include <algorithm>
+#include <fmt/format.h>
+#include <memory>
+#include <utility>
+#include <unordered_set>
+
+
+const Instr* TailRecursion::Terminator(const BasicBlock* bb)
+{
+    for (auto i : *bb)
+        if (i->IsControlInstr())
+            return i;
+    return nullptr;
+}
+
+bool TailRecursion::AddressTaken(Function* func)
+{
+    std::unordered_set<const IROperand*> allocas{};
+    for (auto bb : *func)
+        for (auto i : *bb)
+            if (auto alloca = i->As<AllocaInstr>(); alloca)
+                allocas.insert(alloca->Result());
+
+    auto taken = [&allocas] (const IROperand* op) { return allocas.count(op) > 0; };
+    for (auto bb : *func)
+    {
+        for (auto i : *bb)
+        {
+            if (auto store = i->As<StoreInstr>(); store && taken(store->Value()))
+                return true;
+            else if (auto call = i->As<CallInstr>(); call &&
+                std::any_of(call->ArgvList().begin(), call->ArgvList().end(), taken))
+                return true;
+            else if (auto gep = i->As<GetElePtrInstr>(); gep && taken(gep->Pointer()))
+                return true;
+            else if (auto cvt = i->As<ConvertInstr>(); cvt && taken(cvt->Value()))
+                return true;
+            else if (auto bin = i->As<BinaryInstr>(); bin &&
+                (taken(bin->Lhs()) || taken(bin->Rhs())))
+                return true;
+            else if (auto icmp = i->As<IcmpInstr>(); icmp &&
+                (taken(icmp->Op1()) || taken(icmp->Op2())))
+                return true;
+            else if (auto select = i->As<SelectInstr>(); select &&
+                (taken(select->Value1()) || taken(select->Value2())))
+                return true;
+            else if (auto ret = i->As<RetInstr>(); ret && taken(ret->ReturnValue()))
+                return true;
+            else if (auto phi = i->As<PhiInstr>(); phi)
+                for (auto [_, op] : phi->GetBlockValPair())
+                    if (taken(op))
+                        return true;
+        }
+    }
+    return false;
+}
+
+
+bool TailRecursion::FindParamSlots(Function* func)
+{
+    // Parameters are saved to their variables in the entry block.
+    auto entry = func->Front();
+    for (auto param : func->Params())
+    {
+        const Register* slot = nullptr;
+        for (auto i : *entry)
+            if (auto store = i->As<StoreInstr>(); store && store->Value() == param)
+                slot = store->Dest();
+        if (!slot)
+            return false;
+        slots_.push_back(slot);
+    }
+    return true;
+}
+
+bool TailRecursion::Returns(const BasicBlock* bb, BasicBlock::ConstIterType pos,
+    const BasicBlock* pred, std::unordered_set<const IROperand*> values,
+    bool stored, int depth) const
+{
+    auto retval = CurFunc()->ReturnValue();
+    for (; pos != bb->end(); ++pos)
+    {
+        auto inst = *pos;
+        if (auto phi = inst->As<PhiInstr>(); phi)
+        {
+            for (auto [from, op] : phi->GetBlockValPair())
+                if (from == pred && values.count(op))
+                    values.insert(phi->Result());
+        }
+        else if (auto load = inst->As<LoadInstr>(); load)
+        {
+            if (stored && load->Pointer() == retval)
+                values.insert(load->Result());
+        }
+        else if (auto store = inst->As<StoreInstr>(); store)
+        {
+            if (!retval || store->Dest() != retval)
+                return false;
+            stored = values.count(store->Value()) > 0;
+        }
+        else if (auto ret = inst->As<RetInstr>(); ret)
+            return !ret->ReturnValue() || values.count(ret->ReturnValue());
+        else if (auto br = inst->As<BrInstr>(); br && !br->Cond() && depth > 0)
+        {
+            auto succ = br->GetTrueBlk();
+            return Returns(succ, succ->begin(), bb, std::move(values), stored, depth - 1);
+        }
+        else
+            return false;
+    }
+    return false;
+}
+
+CallInstr* TailRecursion::FindTailCall(BasicBlock* bb) const
+{
+    auto func = CurFunc();
+    for (auto i : *bb)
+    {
+        auto call = i->As<CallInstr>();
+        if (!call || call->FuncName() != func->Name() ||
+            call->ArgvList().size() != func->Params().size())
+            continue;
+        auto next = std::next(std::as_const(*bb).IterOf(call));
+        if (Returns(bb, next, nullptr, { call->Result() }, false, maxdepth_))
+            return call;
+    }
+    return nullptr;
+}
+
+BasicBlock* TailRecursion::SplitEntry(Function* func)
+{
+    // Everything but the allocas and the saving of parameters
+    // goes to the loop header following the entry.
+    auto entry = func->Front();
+    auto header = BasicBlock::CreateBasicBlock(func, entry->Name() + ".tail");
+    func->Insert(std::next(func->begin()), func->Release(header));
+    const auto& params = func->Params();
+    for (auto i = entry->begin(); i != entry->end(); )
+    {
+        auto inst = *i++;
+        auto store = inst->As<StoreInstr>();
+        if (!inst->Is<AllocaInstr>() && (!store ||
+            std::find(params.begin(), params.end(), store->Value()) == params.end()))
+            header->Append(entry->Release(inst));
+    }
+    entry->Append(func->Make<BrInstr>(header));
+
+    for (auto bb : *func)
+        for (auto inst : *bb)
+        {
+            auto phi = inst->As<PhiInstr>();
+            if (!phi)
+                continue;
+            for (auto& [pred, _] : phi->GetBlockValPair())
+                if (pred == entry)
+                    pred = header;
+        }
+    return header;
+}
+
+void TailRecursion::Eliminate(BasicBlock* bb, CallInstr* call, const BasicBlock* header)
+{
+    eliminated_.push_back(bb->Name());
+    auto argv = call->ArgvList();
+    // The block no longer flows to where the result was returned.
+    if (auto br = Terminator(bb)->As<BrInstr>(); br)
+    {
+        for (auto inst : *const_cast<BasicBlock*>(br->GetTrueBlk()))
+        {
+            auto phi = inst->As<PhiInstr>();
+            if (!phi)
+                continue;
+            auto& pairs = phi->GetBlockValPair();
+            pairs.erase(std::remove_if(pairs.begin(), pairs.end(),
+                [bb] (const auto& pair) { return pair.first == bb; }), pairs.end());
+        }
+    }
+    for (auto i = bb->IterOf(call); i != bb->end(); )
+        i = bb->Remove(i);
+    for (int i = 0; i < argv.size(); ++i)
+        bb->Append(bb->Parent()->Make<StoreInstr>(argv[i], slots_[i], false));
+    bb->Append(bb->Parent()->Make<BrInstr>(header));
+}
+
+
+void TailRecursion::ExecuteOnFunction(Function* func)
+{
+    CurFunc() = func;
+    if (func->Empty() || func->Variadic() || func->StaticVar() ||
+        func->ReturnType()->Is<HeterType>())
+        return;
+    for (auto param : func->Params())
+        if (param->Type()->Is<HeterType>())
+            return;
+    if (AddressTaken(func) || !FindParamSlots(func))
+        return;
+    if (std::none_of(func->begin(), func->end(),
+        [this] (BasicBlock* bb) { return FindTailCall(bb) != nullptr; }))
+        return;
+
+    auto header = SplitEntry(func);
+    for (auto bb : *func)
+        if (auto call = FindTailCall(bb); call)
+            Eliminate(bb, call, header);
+}
+
+void TailRecursion::ExitFunction()
+{
+    slots_.clear();
+    eliminated_.clear();
+}
+
+
+std::string TailRecursion::PrintSummary() const
+{
+    std::string summary{ fmt::format(
+        "Pass TailRecursion in function {}:\n", CurFunc()->Name()) };
+    summary += "Tail calls eliminated:\n";
+    for (auto& name : eliminated_)
+        summary += name + '\n';
+    return std::move(summary);
+}
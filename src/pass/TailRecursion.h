@@ -0,0 +1,63 @@
+#ifndef _TAIL_RECURSION_H_
+#define _TAIL_RECURSION_H_
+
+#include "pass/Pass.h"
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+class Module;
+class BasicBlock;
+class CallInstr;
+class Instr;
+class IROperand;
+class Register;
+
+
+// Tail recursion elimination. A call of a function to itself whose result
+// is returned right away, directly, through the variable holding the return
+// value, or through phi instructions joining the arms of a ?:, is replaced by stores of the arguments to the variables
+// of the parameters and a jump back to the start of the function, right
+// after the parameters are saved. The pass runs on the IR before Mem2Reg,
+// which then turns the parameter variables into phi instructions in the
+// loop header. A function is left alone if the address of any of its local
+// variables is taken, since the next iteration would reuse storage the
+// callee may still refer to. Variadic functions and ones with static
+// variables (which live on the stack for now) aren't handled either.
+// See section 15.1 in Advanced Compiler Design and Implementation by Muchnick.
+
+class TailRecursion : public FunctionPass
+{
+public:
+    TailRecursion(Module* m) : FunctionPass(m) {}
+
+    std::string PrintSummary() const override;
+
+    void ExecuteOnFunction(Function*) override;
+    void ExitFunction() override;
+
+private:
+    static const Instr* Terminator(const BasicBlock*);
+    static bool AddressTaken(Function*);
+
+    bool FindParamSlots(Function*);
+    // Whether the instructions from pos on return one of the values
+    // and do nothing else, following at most depth unconditional jumps.
+    // Stored tells if the return value variable holds one of them.
+    bool Returns(const BasicBlock*, BasicBlock::ConstIterType pos, const BasicBlock* pred,
+        std::unordered_set<const IROperand*> values, bool stored, int depth) const;
+    // The call if the block ends with a tail call
+    // to the current function, or nullptr otherwise.
+    CallInstr* FindTailCall(BasicBlock*) const;
+    BasicBlock* SplitEntry(Function*);
+    void Eliminate(BasicBlock*, CallInstr*, const BasicBlock* header);
+
+    static constexpr int maxdepth_ = 4;
+
+    // variables holding the parameters
+    std::vector<const Register*> slots_{};
+
+    std::vector<std::string> eliminated_{};
+};
+
+#endif // _TAIL_RECURSION_H_
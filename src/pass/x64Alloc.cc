@@ -1,5 +1,7 @@
 #include "pass/x64Alloc.h"
+#include "IR/Instr.h"
 #include "IR/IROperand.h"
+#include "IR/IRType.h"
 #include "IR/Value.h"
 #include "visitir/SysVConv.h"
 #include "visitir/x64.h"
@@ -7,6 +9,142 @@
 #include <fmt/format.h>
 
 
+const std::vector<x64Phys>& x64Alloc::IntRegOrder() const
+{
+    static const std::vector<x64Phys> order = {
+        x64Phys::rcx, x64Phys::rdx, x64Phys::rsi, x64Phys::rdi,
+        x64Phys::r8,  x64Phys::r9,  x64Phys::r10, x64Phys::rbx,
+        x64Phys::r12, x64Phys::r13, x64Phys::r14, x64Phys::r15,
+    };
+    static const std::vector<x64Phys> leaforder = {
+        x64Phys::rcx, x64Phys::rdx, x64Phys::rsi, x64Phys::rdi,
+        x64Phys::r8,  x64Phys::r9,  x64Phys::r10, x64Phys::rbx,
+        x64Phys::r12, x64Phys::r13, x64Phys::r14, x64Phys::r15,
+        x64Phys::rbp,
+    };
+    return ArchInfo().leaf_ ? leaforder : order;
+}
+
+const std::vector<x64Phys>& x64Alloc::VecRegOrder()
+{
+    static const std::vector<x64Phys> order = {
+        x64Phys::xmm1,  x64Phys::xmm2,  x64Phys::xmm3,  x64Phys::xmm4,
+        x64Phys::xmm5,  x64Phys::xmm6,  x64Phys::xmm7,  x64Phys::xmm8,
+        x64Phys::xmm9,  x64Phys::xmm10, x64Phys::xmm11, x64Phys::xmm12,
+        x64Phys::xmm13, x64Phys::xmm14, x64Phys::xmm15,
+    };
+    return order;
+}
+
+const x64Alloc::RegSet& x64Alloc::CallClobbered()
+{
+    static const RegSet clobbered = {
+        x64Phys::rcx,   x64Phys::rdx,   x64Phys::rsi,   x64Phys::rdi,
+        x64Phys::r8,    x64Phys::r9,    x64Phys::r10,
+        x64Phys::xmm1,  x64Phys::xmm2,  x64Phys::xmm3,  x64Phys::xmm4,
+        x64Phys::xmm5,  x64Phys::xmm6,  x64Phys::xmm7,  x64Phys::xmm8,
+        x64Phys::xmm9,  x64Phys::xmm10, x64Phys::xmm11, x64Phys::xmm12,
+        x64Phys::xmm13, x64Phys::xmm14, x64Phys::xmm15,
+    };
+    return clobbered;
+}
+
+
+long x64Alloc::AllocateOnX64Stack(x64Stack& info, size_t size, size_t align)
+{
+    info.allocated_ = MakeAlign(info.allocated_, align);
+    info.allocated_ += size;
+    long base = -info.allocated_;
+    info.rspoffset_ = info.allocated_;
+    return base;
+}
+
+bool x64Alloc::IsLeaf(const Function* func)
+{
+    if (func->Variadic() || func->ReturnType()->Is<HeterType>())
+        return false;
+    for (auto param : func->Params())
+        if (param->Type()->Is<HeterType>())
+            return false;
+
+    for (auto bb : *func)
+    {
+        for (auto i : *bb)
+        {
+            if (i->Is<CallInstr>())
+                return false;
+            else if (auto load = i->As<LoadInstr>();
+                load && load->Result()->Type()->Is<HeterType>())
+                return false;
+            else if (auto store = i->As<StoreInstr>();
+                store && store->Value()->Type()->Is<HeterType>())
+                return false;
+        }
+    }
+    return true;
+}
+
+void x64Alloc::RebaseOnRsp(x64Stack& info)
+{
+    // Without a frame pointer, the stack right after the callee-saved
+    // registers are pushed looks like:
+    //      high address
+    // +-------------------+
+    // |  stack parameters |
+    // +-------------------+
+    // |  return address   |
+    // +-------------------+
+    // |  callee-saved     |
+    // +-------rsp---------+
+    // |  padding, locals  | <- in the red zone if they fit in
+    // +-------------------+
+    //      low address
+    // where the padding keeps locals aligned by 16 as rbp does.
+    long saved = 0;
+    for (auto reg : UsedCalleeSaved())
+        saved += static_cast<int>(reg) > 15 ? 16 : 8;
+    long padding = saved % 16 == 0 ? 8 : 0;
+    long below = info.allocated_ + padding;
+    info.rspoffset_ = below <= 128 ? 0 : below;
+    info.belowrsp_ = below <= 128 ? below : 0;
+
+    auto rebase = [&info, saved, padding] (x64* mapped) {
+        auto mem = mapped ? mapped->As<x64Mem>() : nullptr;
+        if (!mem || mem->GlobalLoc() || mem->Base() != RegTag::rbp)
+            return;
+        // rbp would point 8 bytes below the return address
+        if (mem->Offset() < 0)
+            mem->Offset() += info.rspoffset_ - padding;
+        else
+            mem->Offset() += info.rspoffset_ + saved - 8;
+        mem->Base() = x64Reg{ RegTag::rsp };
+    };
+    for (auto& [_, mapped] : ir_)
+        rebase(mapped.get());
+    for (auto& [_, from] : homed_)
+        rebase(from.get());
+}
+
+size_t x64Alloc::OutArgs(const Function* func)
+{
+    size_t size = 0;
+    for (auto bb : *func)
+    {
+        for (auto i : *bb)
+        {
+            auto call = i->As<CallInstr>();
+            if (!call)
+                continue;
+            auto proto = call->Proto() ? call->Proto() :
+                call->FuncAddr()->Type()->As<PtrType>()->Point2()->As<FuncType>();
+            SysVConv conv{ proto, &call->ArgvList() };
+            conv.MapArgv();
+            size = std::max(size, conv.StackSize() - conv.Padding());
+        }
+    }
+    return size;
+}
+
 void x64Alloc::LoadParam()
 {
     auto& params = CurFunc()->Params();
@@ -52,6 +190,12 @@ void x64Alloc::MapRegister(const IROperand* op, std::unique_ptr<x64> reg)
     ir_[op] = std::move(reg);
 }
 
+void x64Alloc::HomeParam(const IROperand* param, std::unique_ptr<x64> home)
+{
+    homed_.emplace_back(param, std::move(ir_[param]));
+    ir_[param] = std::move(home);
+}
+
 void x64Alloc::MarkLoadTwice(const IROperand* op)
 {
     auto mapped = ir_[op].get();
@@ -78,18 +222,23 @@ void x64Alloc::ExitFunction()
     ArchInfo() = x64Stack();
     CurFunc() = nullptr;
     ir_.clear();
+    homed_.clear();
     reg_.clear();
 }
 
 void x64Alloc::ExecuteOnFunction(Function* func)
 {
     CurFunc() = func;
+    ArchInfo().leaf_ = IsLeaf(func);
     VisitFunction(func);
+    ArchInfo().outargs_ = OutArgs(func);
     reg_ = std::move(UsedRegs());
     info_ = std::move(ArchInfo());
 
     if (func->ReturnType()->Is<HeterType>() && func->ReturnType()->Size() > 16)
         reg_.insert(x64Phys::rdi);
+    if (info_.leaf_)
+        RebaseOnRsp(info_);
 }
 
 
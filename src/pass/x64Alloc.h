@@ -6,6 +6,7 @@
 #include <memory>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 class Function;
 class IROperand;
@@ -41,7 +42,11 @@ struct x64Stack
     size_t belowrsp_{};
     // how many bytes we'll allocate on the stack.
     size_t allocated_{};
-    // is current function a leaf function?
+    // the most bytes of arguments passed on the stack by a call,
+    // written to the bottom of the stack instead of pushed
+    size_t outargs_{};
+    // is current function a leaf function? If so, the frame pointer
+    // is omitted, and the stack is addressed relative to rsp.
     bool leaf_{ true };
 };
 
@@ -71,6 +76,7 @@ class x64Alloc : public FunctionPass, protected IRVisitor, public RegAlloc<x64Ph
 public:
     using RegSet = std::set<x64Phys>;
     using RegX64Map = std::unordered_map<const IROperand*, std::unique_ptr<x64>>;
+    using HomedList = std::vector<std::pair<const IROperand*, std::unique_ptr<x64>>>;
 
     x64Alloc(Module* m) : FunctionPass(m) {}
 
@@ -80,7 +86,16 @@ public:
     void ExecuteOnFunction(Function*) override;
 
     const x64* GetIROpMap(const IROperand* op) const;
+    // Parameters moved from where they are passed in to their homes
+    // in the prologue. Each of them is paired with the passed-in place,
+    // while GetIROpMap returns the home.
+    const auto& HomedParams() const { return homed_; }
     long RspOffset() const { return info_.rspoffset_; }
+    size_t OutArgs() const { return info_.outargs_; }
+
+    // Leaf functions have no frame pointer. Their locals are put in the
+    // red zone if they fit, or else below the callee-saved registers.
+    bool OmitFramePointer() const { return info_.leaf_; }
 
     int IntRegCount() const { return intcnt_; }
     int VecRegCount() const { return veccnt_; }
@@ -99,10 +114,27 @@ protected:
             base : base + align - base % align;
     }
 
+    // Allocatable registers in the order they are tried. Caller-saved
+    // registers come first, since they are not saved in the prologue.
+    // rbp is allocatable as well if the frame pointer is omitted.
+    const std::vector<x64Phys>& IntRegOrder() const;
+    static const std::vector<x64Phys>& VecRegOrder();
+    // allocatable registers clobbered by a call
+    static const RegSet& CallClobbered();
+
+    long AllocateOnX64Stack(x64Stack&, size_t, size_t);
+    // Functions calling nothing, and copying no structures (which takes
+    // pushes), need no frame pointer.
+    static bool IsLeaf(const Function*);
+    // Rebase the stack slots from rbp to rsp once the callee-saved
+    // registers used are known.
+    void RebaseOnRsp(x64Stack&);
+    static size_t OutArgs(const Function*);
     void LoadParam();
     bool MapConstAndGlobalVar(const IROperand* op);
     void MapRegister(const IROperand*, std::unique_ptr<x64>);
     void MarkLoadTwice(const IROperand*);
+    void HomeParam(const IROperand*, std::unique_ptr<x64>);
 
 private:
     int intcnt_{};
@@ -110,6 +142,7 @@ private:
 
     x64Stack info_{};
     RegX64Map ir_{};
+    HomedList homed_{};
     RegSet reg_{};
 };
 
@@ -0,0 +1,113 @@
+#ifndef _BIT_VECTOR_H_
+#define _BIT_VECTOR_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+
+// A set of small integers as a dense array of bits. Operations on two sets
+// loop over whole words with no branches, which compilers turn into vector
+// instructions, so a dataflow step costs a few passes over memory.
+// Iteration skips zero words and finds set bits with ctz.
+
+class BitVector
+{
+public:
+    using Word = uint64_t;
+    static constexpr size_t bits_ = 64;
+
+    class Iterator
+    {
+    public:
+        using difference_type = ptrdiff_t;
+        using value_type = size_t;
+        using pointer = size_t*;
+        using reference = size_t;
+        using iterator_category = std::forward_iterator_tag;
+
+        Iterator(const std::vector<Word>& w, size_t i) : words_(&w), word_(i) { Skip(); }
+
+        size_t operator*() const { return word_ * bits_ + __builtin_ctzll(rest_); }
+        auto& operator++()
+        {
+            rest_ &= rest_ - 1;
+            if (!rest_)
+            {
+                word_ += 1;
+                Skip();
+            }
+            return *this;
+        }
+        auto operator++(int) { auto retval = *this; ++(*this); return retval; }
+
+        bool operator==(const Iterator& other) const
+        { return word_ == other.word_ && rest_ == other.rest_; }
+        bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+    private:
+        // Find the first word from word_ with a bit set.
+        void Skip()
+        {
+            for (rest_ = 0; word_ < words_->size(); ++word_)
+                if ((rest_ = (*words_)[word_]))
+                    return;
+        }
+
+        const std::vector<Word>* words_{};
+        size_t word_{};
+        Word rest_{};
+    };
+
+    BitVector() = default;
+    explicit BitVector(size_t n) : words_((n + bits_ - 1) / bits_) {}
+
+    auto begin() const { return Iterator(words_, 0); }
+    auto end() const { return Iterator(words_, words_.size()); }
+
+    bool Test(size_t i) const
+    { return i / bits_ < words_.size() && (words_[i / bits_] >> (i % bits_) & 1); }
+    void Set(size_t i) { words_[i / bits_] |= Word(1) << (i % bits_); }
+    void Reset(size_t i) { words_[i / bits_] &= ~(Word(1) << (i % bits_)); }
+    void Clear() { std::fill(words_.begin(), words_.end(), 0); }
+    // Make room for the integers less than n.
+    void Reserve(size_t n) { words_.resize(std::max(words_.size(), (n + bits_ - 1) / bits_)); }
+
+    bool Empty() const
+    {
+        Word any = 0;
+        for (auto w : words_)
+            any |= w;
+        return !any;
+    }
+    size_t Count() const
+    {
+        size_t count = 0;
+        for (auto w : words_)
+            count += __builtin_popcountll(w);
+        return count;
+    }
+
+    // Both sets are supposed to be of the same size.
+    auto& operator|=(const BitVector& other)
+    {
+        for (size_t i = 0; i < words_.size(); ++i)
+            words_[i] |= other.words_[i];
+        return *this;
+    }
+    auto& operator-=(const BitVector& other)
+    {
+        for (size_t i = 0; i < words_.size(); ++i)
+            words_[i] &= ~other.words_[i];
+        return *this;
+    }
+    bool operator==(const BitVector& other) const { return words_ == other.words_; }
+    bool operator!=(const BitVector& other) const { return words_ != other.words_; }
+
+private:
+    std::vector<Word> words_{};
+};
+
+#endif // _BIT_VECTOR_H_
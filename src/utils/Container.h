@@ -1,98 +1,187 @@
 #ifndef _CONTAINER_H_
 #define _CONTAINER_H_
 
-#include <algorithm>
-#include <memory>
-#include <vector>
+#include <cstddef>
+#include <iterator>
+
+template <class ELE> class Container;
+
+
+// An element of a Container: a node of the intrusive doubly linked list
+// the container keeps its elements in, and the container holding it.
+// Inserting, removing and moving an element takes constant time, and an
+// iterator to an element stays valid until the element itself is removed.
+// Containers link their elements but don't own them: the elements come
+// from a Pool, and outlive their removal until the pool is released.
+class ContainerNode
+{
+    template <class> friend class Container;
+
+protected:
+    template <class CNT, class ELE>
+    CNT* Owner() const
+    {
+        return static_cast<CNT*>(static_cast<Container<ELE>*>(
+            const_cast<void*>(owner_)));
+    }
+
+private:
+    const void* owner_{};
+    ContainerNode* prev_{};
+    ContainerNode* next_{};
+};
 
 
 template <class ELE>
 class Container
 {
 public:
-    template <typename T, typename V>
+    template <typename V>
     class Iterator
     {
-        using ptr = T;
-
     public:
         using difference_type = ptrdiff_t;
-        using value_type = V;
-        using pointer = ptr*;
-        using reference = ptr&;
-        using iterator_category = std::random_access_iterator_tag;
+        using value_type = V*;
+        using pointer = V**;
+        using reference = V*;
+        using iterator_category = std::bidirectional_iterator_tag;
 
-        Iterator(ptr* p, size_t i = 0) : start_(p), index_(i) {}
+        Iterator() = default;
+        Iterator(const Container* c, ContainerNode* n) : owner_(c), node_(n) {}
+        // An iterator converts to its const version.
+        operator Iterator<const V>() const { return { owner_, node_ }; }
 
-        auto& operator++() { index_++; return *this; }
+        auto& operator++() { node_ = node_->next_; return *this; }
         auto operator++(int) { auto retval = *this; ++(*this); return retval; }
-        auto& operator--() { index_--; return *this; }
+        // end() is a null node, whose predecessor is the last element.
+        auto& operator--() { node_ = node_ ? node_->prev_ : owner_->tail_; return *this; }
         auto operator--(int) { auto retval = *this; --(*this); return retval; }
 
-        auto& operator+=(size_t off) { index_ += off; return *this; }
-        auto& operator-=(size_t off) { index_ -= off; return *this; }
-        auto operator+(size_t off) const { auto retval = *this; return retval += off; }
-        auto operator-(size_t off) const { auto retval = *this; return retval -= off; }
-        size_t operator+(Iterator<T, V> other) const { return index_ + other.index_; }
-        size_t operator-(Iterator<T, V> other) const { return index_ - other.index_; }
-
-        bool operator==(Iterator<T, V> other) const
-        {
-            return start_ == other.start_ &&
-                index_ == other.index_;
-        }
-        bool operator!=(Iterator<T, V> other) const { return !(*this == other); }
+        bool operator==(Iterator<V> other) const { return node_ == other.node_; }
+        bool operator!=(Iterator<V> other) const { return !(*this == other); }
 
-        V* operator*() { return start_[index_].get(); }
-        V* operator*() const { return start_[index_].get(); }
+        V* operator*() const { return static_cast<V*>(node_); }
 
     private:
-        ptr* start_{};
-        size_t index_{};
+        friend class Container;
+        const Container* owner_{};
+        ContainerNode* node_{};
     };
 
-    using IterType = Iterator<std::unique_ptr<ELE>, ELE>;
-    using ConstIterType = Iterator<const std::unique_ptr<ELE>, const ELE>;
+    using IterType = Iterator<ELE>;
+    using ConstIterType = Iterator<const ELE>;
 
-    auto begin() { return IterType(elements_.data()); }
-    auto end() { return IterType(elements_.data(), elements_.size()); }
-    const auto begin() const { return ConstIterType(elements_.data()); }
-    const auto end() const { return ConstIterType(elements_.data(), elements_.size()); }
+    Container() = default;
+    Container(const Container&) = delete;
+    Container& operator=(const Container&) = delete;
 
-    void Append(std::unique_ptr<ELE> ele)
+    auto begin() { return IterType(this, head_); }
+    auto end() { return IterType(this, nullptr); }
+    auto begin() const { return ConstIterType(this, head_); }
+    auto end() const { return ConstIterType(this, nullptr); }
+    // the position of an element in this container
+    auto IterOf(ELE* ele) { return IterType(this, ele); }
+    auto IterOf(const ELE* ele) const
     {
-        elements_.push_back(std::move(ele));
+        return ConstIterType(this, const_cast<ELE*>(ele));
     }
-    void Insert(int i, std::unique_ptr<ELE> ele)
+
+    void Append(ELE* ele) { Insert(end(), ele); }
+    // Insert the element before pos, and return the position of it.
+    IterType Insert(IterType pos, ELE* ele)
+    {
+        Link(pos.node_, ele);
+        return IterType(this, ele);
+    }
+    // Remove the last element.
+    void Remove() { Remove(std::prev(end())); }
+    // Remove the element at pos, and return the position following it.
+    IterType Remove(IterType pos)
     {
-        elements_.insert(elements_.begin() + i,
-            std::move(ele));
+        auto next = IterType(this, pos.node_->next_);
+        Unlink(pos.node_);
+        return next;
+    }
+    IterType Remove(ELE* ele) { return Remove(IterOf(ele)); }
+    // Remove the elements satisfying pred in a single pass.
+    template <class Pred>
+    size_t RemoveIf(Pred pred)
+    {
+        size_t count = 0;
+        for (auto i = begin(); i != end(); )
+        {
+            if (pred(*i))
+            {
+                i = Remove(i);
+                count++;
+            }
+            else
+                ++i;
+        }
+        return count;
+    }
+    // Remove the element, and return it to be inserted elsewhere.
+    ELE* Release(ELE* ele)
+    {
+        Unlink(ele);
+        return ele;
+    }
+    // Forget the elements, which are about to be released with their pool.
+    void Clear()
+    {
+        head_ = tail_ = nullptr;
+        size_ = 0;
+    }
+    // Move the elements in [first, last) of another
+    // container, or this one, to the front of pos.
+    void Splice(IterType pos, Container& from, IterType first, IterType last)
+    {
+        while (first != last)
+        {
+            ContainerNode* node = *first++;
+            from.Unlink(node);
+            Link(pos.node_, node);
+        }
     }
-    void Remove() { elements_.pop_back(); }
-    void Remove(int i) { elements_.erase(elements_.begin() + i); }
 
-    bool Empty() const { return elements_.empty(); }
-    auto Size() const { return elements_.size(); }
+    bool Empty() const { return size_ == 0; }
+    auto Size() const { return size_; }
 
-    ELE* Front() { return elements_.front().get(); }
-    const ELE* Front() const { return elements_.front().get(); }
-    ELE* Back() { return elements_.back().get(); }
-    const ELE* Back() const { return elements_.back().get(); }
-    ELE* At(int i) { return elements_[i].get(); }
-    const ELE* At(int i) const { return elements_[i].get(); }
+    ELE* Front() { return static_cast<ELE*>(head_); }
+    const ELE* Front() const { return static_cast<const ELE*>(head_); }
+    ELE* Back() { return static_cast<ELE*>(tail_); }
+    const ELE* Back() const { return static_cast<const ELE*>(tail_); }
 
-    int IndexOf(const ELE* ptr) const
+    bool Contains(const ELE* ele) const
     {
-        auto begin = std::make_move_iterator(elements_.begin());
-        auto end = std::make_move_iterator(elements_.end());
-        auto pos = std::find_if(begin, end,
-            [ptr] (const auto& ele) { return ptr == ele.get(); });
-        return pos == end ? -1 : std::distance(begin, pos);
+        return ele && ele->ContainerNode::owner_ == this;
     }
 
 
-protected:
-    std::vector<std::unique_ptr<ELE>> elements_{};
+private:
+    // Link node in front of next, or at the end if next is null.
+    void Link(ContainerNode* next, ContainerNode* node)
+    {
+        auto prev = next ? next->prev_ : tail_;
+        node->owner_ = this;
+        node->prev_ = prev;
+        node->next_ = next;
+        (prev ? prev->next_ : head_) = node;
+        (next ? next->prev_ : tail_) = node;
+        size_++;
+    }
+    void Unlink(ContainerNode* node)
+    {
+        (node->prev_ ? node->prev_->next_ : head_) = node->next_;
+        (node->next_ ? node->next_->prev_ : tail_) = node->prev_;
+        node->owner_ = nullptr;
+        node->prev_ = node->next_ = nullptr;
+        size_--;
+    }
+
+    ContainerNode* head_{};
+    ContainerNode* tail_{};
+    size_t size_{};
 };
 
 #endif // _CONTAINER_H_
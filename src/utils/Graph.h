@@ -3,9 +3,11 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <numeric>
 #include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 
@@ -21,7 +23,7 @@ public:
     void AddEdge(const V& to) { vertices_.insert(indexof_.at(to)); }
     void AddEdge(int to) { vertices_.insert(to); }
     void DeleteEdge(const V& to) { vertices_.erase(indexof_.at(to)); }
-    void DeleteEdge(int to) { vertices_.insert(to); }
+    void DeleteEdge(int to) { vertices_.erase(to); }
 
 protected:
     C vertices_{};
@@ -44,6 +46,10 @@ public:
 
     bool operator[](const V& to) const { return Base::HasLinkTo(to); }
     bool operator[](int to) const { return Base::HasLinkTo(to); }
+
+    // iterate over the indices of the adjacent vertices
+    auto begin() const { return Base::vertices_.cbegin(); }
+    auto end() const { return Base::vertices_.cend(); }
 };
 
 
@@ -331,4 +337,166 @@ public:
     }
 };
 
+
+// A contiguous run of elements, e.g., the edges of a vertex in a CSRGraph.
+template <typename T>
+class Slice
+{
+public:
+    Slice() = default;
+    Slice(const T* b, const T* e) : begin_(b), end_(e) {}
+
+    const T* begin() const { return begin_; }
+    const T* end() const { return end_; }
+    size_t size() const { return end_ - begin_; }
+    bool empty() const { return begin_ == end_; }
+    const T& operator[](size_t i) const { return begin_[i]; }
+
+private:
+    const T* begin_{};
+    const T* end_{};
+};
+
+
+// Numbers vertices in the order they are added,
+// for those without dense numbers of their own.
+template <typename V>
+class HashIndex
+{
+public:
+    int operator()(const V& v) const
+    {
+        auto i = indexof_.find(v);
+        return i == indexof_.end() ? -1 : i->second;
+    }
+    int Add(const V& v) { return indexof_.emplace(v, indexof_.size()).first->second; }
+
+private:
+    std::unordered_map<V, int> indexof_{};
+};
+
+
+// A graph in compressed sparse row form: the edges leaving each vertex,
+// with their values, and the sources of the edges entering it are stored
+// in two arrays ordered by vertex, so walking the successors or the
+// predecessors of a vertex reads one contiguous run. The graph is made by
+// a Builder and never changed afterwards; build a new one instead. INDEX
+// maps vertices to dense indices, with Add(v) while building, and with
+// operator() on lookup, which may be out of range for vertices not in the
+// graph, i.e., having no edges. See chapter 2 of Direct Methods for
+// Sparse Linear Systems by Davis (2006).
+
+template <typename V, typename E, class INDEX = HashIndex<V>>
+class CSRGraph
+{
+public:
+    struct Edge
+    {
+        V to_{};
+        E value_{};
+    };
+
+    class Builder
+    {
+    public:
+        Builder(INDEX index = {}) : index_(std::move(index)) {}
+
+        void AddVertex(const V& v) { Add(v); }
+        // Edges leaving a vertex keep the order they are added in.
+        void AddValueEdge(const V& from, const V& to, const E& value)
+        {
+            int ifrom = Add(from);
+            edges_.push_back({ ifrom, Add(to), { to, value } });
+        }
+
+        CSRGraph Build()
+        {
+            CSRGraph graph{};
+            auto n = vertexof_.size();
+            graph.succbegin_.assign(n + 1, 0);
+            graph.predbegin_.assign(n + 1, 0);
+            for (auto& e : edges_)
+            {
+                graph.succbegin_[e.from_ + 1] += 1;
+                graph.predbegin_[e.to_ + 1] += 1;
+            }
+            std::partial_sum(graph.succbegin_.begin(),
+                graph.succbegin_.end(), graph.succbegin_.begin());
+            std::partial_sum(graph.predbegin_.begin(),
+                graph.predbegin_.end(), graph.predbegin_.begin());
+
+            // a stable counting sort by source and by target
+            graph.succs_.resize(edges_.size());
+            graph.preds_.resize(edges_.size());
+            auto nextsucc = graph.succbegin_;
+            auto nextpred = graph.predbegin_;
+            for (auto& e : edges_)
+            {
+                graph.succs_[nextsucc[e.from_]++] = std::move(e.edge_);
+                graph.preds_[nextpred[e.to_]++] = vertexof_[e.from_];
+            }
+
+            graph.index_ = std::move(index_);
+            graph.vertices_ = std::move(vertices_);
+            return graph;
+        }
+
+    private:
+        int Add(const V& v)
+        {
+            int i = index_.Add(v);
+            if (static_cast<size_t>(i) >= vertexof_.size())
+            {
+                vertexof_.resize(i + 1);
+                added_.resize(i + 1);
+            }
+            if (!added_[i])
+            {
+                added_[i] = true;
+                vertexof_[i] = v;
+                vertices_.push_back(v);
+            }
+            return i;
+        }
+
+        struct RawEdge
+        {
+            int from_{};
+            int to_{};
+            Edge edge_{};
+        };
+
+        INDEX index_{};
+        std::vector<RawEdge> edges_{};
+        // the vertex of each index, and the vertices in the order added
+        std::vector<V> vertexof_{};
+        std::vector<bool> added_{};
+        std::vector<V> vertices_{};
+    };
+
+    void Clear() { *this = CSRGraph(); }
+
+    const auto& GetVertices() const { return vertices_; }
+    Slice<Edge> GetEdges(const V& v) const { return Row(succbegin_, succs_, index_(v)); }
+    Slice<Edge> operator[](const V& v) const { return GetEdges(v); }
+    Slice<V> GetPreds(const V& v) const { return Row(predbegin_, preds_, index_(v)); }
+
+private:
+    template <typename T>
+    static Slice<T> Row(const std::vector<int>& begin, const std::vector<T>& items, int i)
+    {
+        if (i < 0 || static_cast<size_t>(i) + 1 >= begin.size())
+            return {};
+        return { items.data() + begin[i], items.data() + begin[i + 1] };
+    }
+
+    INDEX index_{};
+    std::vector<V> vertices_{};
+    // Edges of vertex i are in [begin[i], begin[i + 1]).
+    std::vector<int> succbegin_{};
+    std::vector<Edge> succs_{};
+    std::vector<int> predbegin_{};
+    std::vector<V> preds_{};
+};
+
 #endif // _GRAPH_H_
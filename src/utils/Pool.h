@@ -1,26 +1,92 @@
 #ifndef _POOL_H_
 #define _POOL_H_
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 
+// A bump-pointer arena for objects derived from T, which live until the
+// owner of the pool is destroyed. Objects are carved out of chunks that
+// double in size up to a limit, and are released all at once: only those
+// with a destructor to run are recorded, by their concrete type, so T
+// needs no virtual destructor. Merging pools hands over the chunks, not
+// the objects. See Fast Allocation and Deallocation of Memory Based on
+// Object Lifetimes by Hanson (1990).
+
 template <class T>
 class Pool
 {
 public:
-    void Add(std::unique_ptr<T> t) { pool_.push_back(std::move(t)); }
-    void Clear() { pool_.clear(); }
+    Pool() = default;
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+    ~Pool() { Clear(); }
+
+    template <class U, class... Args>
+    U* Make(Args&&... args)
+    {
+        static_assert(std::is_base_of_v<T, U>);
+        auto obj = new (Allocate(sizeof(U), alignof(U))) U(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<U>)
+            dtors_.emplace_back(obj, [] (void* p) { static_cast<U*>(p)->~U(); });
+        return obj;
+    }
+
+    void Clear()
+    {
+        for (auto i = dtors_.rbegin(); i != dtors_.rend(); ++i)
+            i->second(i->first);
+        dtors_.clear();
+        chunks_.clear();
+        cur_ = end_ = nullptr;
+        next_ = minchunk_;
+    }
+
     void Merge(Pool<T>* pool)
     {
-        pool_.insert(pool_.end(),
-            std::make_move_iterator(pool->pool_.begin()),
-            std::make_move_iterator(pool->pool_.end()));
+        dtors_.insert(dtors_.end(), pool->dtors_.begin(), pool->dtors_.end());
+        // Keep allocating from the current chunk.
+        chunks_.insert(chunks_.begin(),
+            std::make_move_iterator(pool->chunks_.begin()),
+            std::make_move_iterator(pool->chunks_.end()));
+        pool->dtors_.clear();
         pool->Clear();
     }
 
 private:
-    std::vector<std::unique_ptr<T>> pool_{};
+    void* Allocate(size_t size, size_t align)
+    {
+        auto addr = reinterpret_cast<uintptr_t>(cur_);
+        auto aligned = (addr + align - 1) & ~(uintptr_t)(align - 1);
+        if (!cur_ || aligned + size > reinterpret_cast<uintptr_t>(end_))
+        {
+            auto chunk = std::max(next_, size + align);
+            chunks_.emplace_back(new char[chunk]);
+            cur_ = chunks_.back().get();
+            end_ = cur_ + chunk;
+            next_ = std::min(next_ * 2, maxchunk_);
+            addr = reinterpret_cast<uintptr_t>(cur_);
+            aligned = (addr + align - 1) & ~(uintptr_t)(align - 1);
+        }
+        cur_ += aligned - addr + size;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    // Most pools belong to a basic block and hold a few objects.
+    static constexpr size_t minchunk_ = 256;
+    static constexpr size_t maxchunk_ = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> chunks_{};
+    std::vector<std::pair<void*, void (*)(void*)>> dtors_{};
+    char* cur_{};
+    char* end_{};
+    size_t next_{ minchunk_ };
 };
 
 #endif // _POOL_H_
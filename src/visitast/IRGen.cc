@@ -20,7 +20,7 @@ void IRGen::CurrentEnv::Epilogue(BasicBlock* bb)
 
     for (auto blk : *GetFunction())
         if (auto last = blk->LastInstr(); !last || !last->IsControlInstr())
-            blk->Append(std::make_unique<BrInstr>(bb));
+            blk->Append(GetFunction()->Make<BrInstr>(bb));
 }
 
 
@@ -125,17 +125,19 @@ const Register* IRGen::AllocaObject(
     else // if env_.InFunction()
     {
         const Register* reg = nullptr;
-        auto ty = raw->ToIRType(ibud_.Container());
+        auto ty = raw->ToIRType(ibud_.Func());
         if (isextern)
         {
             reg = Register::CreateRegister(
-                ibud_.Container(), '@' + name,
-                PtrType::GetPtrType(ibud_.Container(), ty));
+                ibud_.Func(), '@' + name,
+                PtrType::GetPtrType(ibud_.Func(), ty));
         }
         else
         {
             reg = ibud_.InsertAllocaInstr(
-                env_.GetRegName(), raw->ToIRType(ibud_.Container()));
+                env_.GetRegName(), raw->ToIRType(ibud_.Func()));
+            if (raw->Storage().IsStatic())
+                env_.GetFunction()->StaticVar() = true;
         }
         scopestack_.Top().AddObject(name, raw, reg);
         return reg;
@@ -153,6 +155,7 @@ Function* IRGen::AllocaFunc(const CFuncType* raw, const std::string& name)
         auto irname = '@' + name;
 
         pfunc = transunit_->AddFunc(irname, functy);
+        pfunc->Static() = raw->Storage().IsStatic();
         pfunc->Inline() = raw->Inline();
         pfunc->Noreturn() = raw->Noreturn();
         pfunc->Addr() = Register::CreateRegister(
@@ -342,12 +345,19 @@ void IRGen::HandleVaArg(CallExpr* call)
     auto callinstr = ibud_.LastInstr()->As<CallInstr>();        
     callinstr->AddArgv(casted);
     callinstr->AddArgv(
-        IntConst::CreateIntConst(ibud_.Container(), ty->Size()));
+        IntConst::CreateIntConst(ibud_.Func(), ty->Size()));
     callinstr->AddArgv(
-        IntConst::CreateIntConst(ibud_.Container(), ty->Align()));
+        IntConst::CreateIntConst(ibud_.Func(), ty->Align()));
 }
 
 
+// Accesses through volatile lvalues are marked on the loads and stores,
+// so that passes don't remove, merge or move them.
+static bool IsVolatile(const Expr* expr)
+{
+    return expr->Type() && expr->Type()->Qual().IsVolatile();
+}
+
 const IROperand* IRGen::LoadVal(Expr* expr)
 {
     if (expr->IsIdentifier())
@@ -360,30 +370,31 @@ const IROperand* IRGen::LoadVal(Expr* expr)
             auto inner = !ident->Type()->As<CArrayType>()->IsParam();
             // inner not set? That means the array has more
             // than one dimension and is passed to a function.
-            auto zero = IntConst::CreateIntConst(ibud_.Container(), 0);
+            auto zero = IntConst::CreateIntConst(ibud_.Func(), 0);
             ident->Val() = ibud_.InsertGetElePtrInstr(
                 env_.GetRegName(), inner, ident->Addr(), zero);
         }
         else
-            ident->Val() = ibud_.InsertLoadInstr(env_.GetRegName(), ident->Addr());
+            ident->Val() = ibud_.InsertLoadInstr(
+                env_.GetRegName(), ident->Addr(), IsVolatile(ident));
         return ident->Val();
     }
     else if (expr->IsSubscript())
     {
-        expr->Val() = ibud_.InsertLoadInstr(
-            env_.GetRegName(), expr->ToSubscript()->Addr());
+        expr->Val() = ibud_.InsertLoadInstr(env_.GetRegName(),
+            expr->ToSubscript()->Addr(), IsVolatile(expr));
         return expr->Val();
     }
     else if (expr->IsUnary() && expr->ToUnary()->Op() == Tag::asterisk)
     {
-        expr->Val() = ibud_.InsertLoadInstr(
-            env_.GetRegName(), expr->Val()->As<Register>());
+        expr->Val() = ibud_.InsertLoadInstr(env_.GetRegName(),
+            expr->Val()->As<Register>(), IsVolatile(expr));
         return expr->Val();
     }
     else if (expr->IsStrExpr())
     {
         auto zero = IntConst::CreateIntConst(
-            ibud_.Container(), 0, IntType::GetInt32(true));
+            ibud_.Func(), 0, IntType::GetInt32(true));
         expr->Val() = ibud_.InsertGetElePtrInstr(
             env_.GetRegName(), true, expr->Val()->As<Register>(), zero);
         return expr->Val();
@@ -391,8 +402,8 @@ const IROperand* IRGen::LoadVal(Expr* expr)
     else if (expr->IsAccess())
     {
         // Val of AccessExpr is always an address
-        expr->Val() = ibud_.InsertLoadInstr(
-            env_.GetRegName(), expr->Val()->As<Register>());
+        expr->Val() = ibud_.InsertLoadInstr(env_.GetRegName(),
+            expr->Val()->As<Register>(), IsVolatile(expr));
         return expr->Val();
     }
     else if (expr->IsExprList())
@@ -488,8 +499,18 @@ void IRGen::VisitDeclList(DeclList* list)
             initdecl->base_ = AllocaObject(
                 raw, name, raw->Storage().IsExtern());
 
+            // The address and the type of a global variable are in the
+            // pools of the environment, even if it has no initializer.
             if (!initdecl->initalizer_)
+            {
+                if (env_.InGlobalVar() && !raw->Storage().IsExtern())
+                {
+                    auto var = env_.GetGlobalVar();
+                    var->Pool<IROperand>::Merge(env_.GetOpPool());
+                    var->Pool<IRType>::Merge(env_.GetTypePool());
+                }
                 continue;
+            }
 
             // only insert store instr when we're translating
             // a function. the expr tree will be directly add
@@ -497,7 +518,8 @@ void IRGen::VisitDeclList(DeclList* list)
             if (env_.InFunction())
             {
                 auto val = LoadVal(initdecl->initalizer_.get());
-                ibud_.InsertStoreInstr(val, initdecl->base_, false);
+                ibud_.InsertStoreInstr(val, initdecl->base_,
+                    raw->Qual().IsVolatile());
             }
             else // if env_.InGlobalVar()
             {
@@ -563,8 +585,8 @@ void IRGen::VisitObjDef(ObjDef* def)
             continue;
         auto ctype = param->RawType();
         auto paramreg = Register::CreateRegister(
-            ibud_.Container(), env_.GetRegName(),
-            ctype->ToIRType(ibud_.Container()));
+            ibud_.Func(), env_.GetRegName(),
+            ctype->ToIRType(ibud_.Func()));
 
         env_.GetFunction()->AddParam(paramreg);
 
@@ -683,7 +705,7 @@ void IRGen::VisitAssignExpr(AssignExpr* assign)
 
     if (assign->op_ == Tag::assign)
     {
-        ibud_.InsertStoreInstr(rhs, addr, false);
+        ibud_.InsertStoreInstr(rhs, addr, IsVolatile(assign->left_.get()));
         assign->Val() = rhs;
         return;
     }
@@ -703,13 +725,13 @@ void IRGen::VisitAssignExpr(AssignExpr* assign)
         const IROperand* newrhs = nullptr;
         if (rhs->Is<IntConst>())
         {
-            newrhs = IntConst::CreateIntConst(ibud_.Container(),
+            newrhs = IntConst::CreateIntConst(ibud_.Func(),
                 rhs->As<IntConst>()->Val() * size, rhs->Type()->As<IntType>());
         }
         else
         {
             auto sizeconst = IntConst::CreateIntConst(
-                ibud_.Container(), size, rhs->Type()->As<IntType>());
+                ibud_.Func(), size, rhs->Type()->As<IntType>());
             newrhs = ibud_.InsertMulInstr(env_.GetRegName(), rhs, sizeconst);
         }
         result = ibud_.InsertSubInstr(regname, lhs->As<Register>(), newrhs);
@@ -753,7 +775,7 @@ void IRGen::VisitAssignExpr(AssignExpr* assign)
         result = ibud_.InsertXorInstr(regname, lhs, rhs);
 
 
-    ibud_.InsertStoreInstr(result, addr, false);
+    ibud_.InsertStoreInstr(result, addr, IsVolatile(assign->left_.get()));
     assign->Val() = result;
 }
 
@@ -771,7 +793,7 @@ void IRGen::VisitBinaryExpr(BinaryExpr* bin)
         if (env_.InGlobalVar())
             container = env_.GetOpPool();
         else if (ibud_.Container())
-            container = ibud_.Container();
+            container = ibud_.Func();
         else
             container = transunit_.get();
 
@@ -809,13 +831,13 @@ void IRGen::VisitBinaryExpr(BinaryExpr* bin)
         const IROperand* newrhs = nullptr;
         if (rhs->Is<IntConst>())
         {
-            newrhs = IntConst::CreateIntConst(ibud_.Container(),
+            newrhs = IntConst::CreateIntConst(ibud_.Func(),
                 rhs->As<IntConst>()->Val() * size, rhs->Type()->As<IntType>());
         }
         else
         {
             auto sizeconst = IntConst::CreateIntConst(
-                ibud_.Container(), size, rhs->Type()->As<IntType>());
+                ibud_.Func(), size, rhs->Type()->As<IntType>());
             newrhs = ibud_.InsertMulInstr(env_.GetRegName(), rhs, sizeconst);
         }
         result = ibud_.InsertSubInstr(regname, lhs->As<Register>(), newrhs);
@@ -845,7 +867,7 @@ void IRGen::VisitBinaryExpr(BinaryExpr* bin)
         if (IS_PTR(bin->left_) && IS_PTR(bin->right_))
         {
             auto sizeptr2 = lhsty->As<PtrType>()->Point2()->Size();
-            auto size = IntConst::CreateIntConst(ibud_.Container(), sizeptr2, lhsty->As<PtrType>());
+            auto size = IntConst::CreateIntConst(ibud_.Func(), sizeptr2, lhsty->As<PtrType>());
             result = ibud_.InsertDivInstr(env_.GetRegName(), result, size);
         }
     }
@@ -959,6 +981,8 @@ end:
     {
         auto callinstr = ibud_.LastInstr()->As<CallInstr>();
         auto argv = call->argvlist_->begin();
+        // Conversions of arguments must be placed before the call.
+        ibud_.SetInsertPoint(callinstr);
         for (auto ty : proto->ParamType())
         {
             auto op = (*argv)->Val();
@@ -967,6 +991,7 @@ end:
             callinstr->AddArgv(op);
             ++argv;
         }
+        ibud_.SetInsertPoint(ibud_.Container());
 
         if (proto->Variadic())
             for (; argv != call->ArgvList()->end(); ++argv)
@@ -986,39 +1011,39 @@ void IRGen::VisitCastExpr(CastExpr* cast)
 
     auto createint = [this] (const IRType* ty, const IROperand* op) -> const IntConst* {
         return IntConst::CreateIntConst(
-            this->ibud_.Container(), op->As<IntConst>()->Val(), ty->As<IntType>());
+            this->ibud_.Func(), op->As<IntConst>()->Val(), ty->As<IntType>());
     };
 
     if (ty->Is<CPtrType>() && expr->Is<CPtrType>())
     {
         if (expreg->Is<Constant>())
-            expreg = createint(ty->ToIRType(ibud_.Container()), expreg);
+            expreg = createint(ty->ToIRType(ibud_.Func()), expreg);
         else
             expreg = ibud_.InsertBitcastInstr(
-                env_.GetRegName(), ty->ToIRType(ibud_.Container()), expreg->As<Register>());
+                env_.GetRegName(), ty->ToIRType(ibud_.Func()), expreg->As<Register>());
     }
     else if (ty->Is<CPtrType>() && expr->Is<CArithmType>())
     {
         if (expreg->Is<Constant>())
-            expreg = createint(ty->ToIRType(ibud_.Container()), expreg);
+            expreg = createint(ty->ToIRType(ibud_.Func()), expreg);
         else
             expreg = ibud_.InsertItoPtrInstr(env_.GetRegName(),
-                ty->ToIRType(ibud_.Container())->As<PtrType>(), expreg->As<Register>());
+                ty->ToIRType(ibud_.Func())->As<PtrType>(), expreg->As<Register>());
     }
     else if (ty->Is<CArithmType>() && expr->Is<CPtrType>())
     {
         if (expreg->Is<Constant>())
-            expreg = createint(ty->ToIRType(ibud_.Container()), expreg);
+            expreg = createint(ty->ToIRType(ibud_.Func()), expreg);
         else
             expreg = ibud_.InsertPtrtoIInstr(env_.GetRegName(),
-                ty->ToIRType(ibud_.Container())->As<IntType>(), expreg->As<Register>());
+                ty->ToIRType(ibud_.Func())->As<IntType>(), expreg->As<Register>());
     }
     else
     {
         // cast->typename_ is arithmetic type
         // so does the type of cast->expr_
         expreg = ibud_.InsertArithmCastInstr(
-            ty->ToIRType(ibud_.Container()), expreg);
+            ty->ToIRType(ibud_.Func()), expreg);
     }
 
     cast->Val() = expreg;
@@ -1046,13 +1071,17 @@ void IRGen::VisitCondExpr(CondExpr* cond)
 
     auto initblk = ibud_.Container();
 
+    // Either operand may end up in a block other than the
+    // one it starts with, e.g., a logical expression.
     auto trueblk = bbud_.GetBasicBlock(env_.GetLabelName());
     ibud_.SetInsertPoint(trueblk);
     cond->true_->Accept(this);
+    auto trueend = ibud_.Container();
 
     auto falseblk = bbud_.GetBasicBlock(env_.GetLabelName());
     ibud_.SetInsertPoint(falseblk);
     cond->false_->Accept(this);
+    auto falseend = ibud_.Container();
 
     if (cond->true_->IsConstant() && cond->false_->IsConstant())
     {
@@ -1072,10 +1101,10 @@ void IRGen::VisitCondExpr(CondExpr* cond)
     ibud_.InsertBrInstr(
         LoadVal(cond->cond_.get()), trueblk, falseblk);
 
-    ibud_.SetInsertPoint(trueblk);
+    ibud_.SetInsertPoint(trueend);
     ibud_.InsertBrInstr(endblk);
 
-    ibud_.SetInsertPoint(falseblk);
+    ibud_.SetInsertPoint(falseend);
     ibud_.InsertBrInstr(endblk);
 
     ibud_.SetInsertPoint(endblk);
@@ -1085,8 +1114,8 @@ void IRGen::VisitCondExpr(CondExpr* cond)
     cond->Val() = ibud_.InsertPhiInstr(
         env_.GetRegName(), tval->Type());
     auto phi = ibud_.LastInstr()->As<PhiInstr>();
-    phi->AddBlockValPair(trueblk, tval);
-    phi->AddBlockValPair(falseblk, fval);
+    phi->AddBlockValPair(trueend, tval);
+    phi->AddBlockValPair(falseend, fval);
 }
 
 
@@ -1097,7 +1126,7 @@ void IRGen::VisitConstant(ConstExpr* constant)
     if (env_.InGlobalVar())
         container = env_.GetOpPool();
     else if (ibud_.Container())
-        container = ibud_.Container();
+        container = ibud_.Func();
     else
         container = transunit_.get();
 
@@ -1128,7 +1157,7 @@ void IRGen::VisitSzAlgnExpr(SzAlgnExpr* expr)
             expr->ContentAsDecl()->Type()->Size() :
             expr->ContentAsExpr()->Type()->Size();
         expr->Val() = IntConst::CreateIntConst(
-            ibud_.Container(), data, IntType::GetInt64(false));
+            ibud_.Func(), data, IntType::GetInt64(false));
     }
     else // if expr->IsAlignof()
     {
@@ -1136,7 +1165,7 @@ void IRGen::VisitSzAlgnExpr(SzAlgnExpr* expr)
             expr->ContentAsDecl()->Type()->Align() :
             expr->ContentAsExpr()->Type()->Align();
         expr->Val() = IntConst::CreateIntConst(
-            ibud_.Container(), data, IntType::GetInt64(false));
+            ibud_.Func(), data, IntType::GetInt64(false));
     }
 }
 
@@ -1239,7 +1268,7 @@ void IRGen::VisitLogicalExpr(LogicalExpr* logical)
             (!lconst->IsZero() && logical->op_ == Tag::logical_or))
         {
             logical->Val() = IntConst::CreateIntConst(
-                ibud_.Container(), !lconst->IsZero());
+                ibud_.Func(), !lconst->IsZero());
             return;
         }
 
@@ -1249,12 +1278,12 @@ void IRGen::VisitLogicalExpr(LogicalExpr* logical)
         {
             auto rconst = rhs->As<Constant>();
             logical->Val() = Evaluator::EvalBinary(
-                ibud_.Container(), logical->op_, lconst, rconst);
+                ibud_.Func(), logical->op_, lconst, rconst);
             return;
         }
 
-        auto zero = IntConst::CreateIntConst(ibud_.Container(), 0);
-        auto one = IntConst::CreateIntConst(ibud_.Container(), 1);
+        auto zero = IntConst::CreateIntConst(ibud_.Func(), 0);
+        auto one = IntConst::CreateIntConst(ibud_.Func(), 1);
 
         logical->Val() = ibud_.InsertSelectInstr(
             env_.GetRegName(), rhs, true, one, zero);
@@ -1275,9 +1304,11 @@ void IRGen::VisitLogicalExpr(LogicalExpr* logical)
     logical->right_->Accept(this);
     rhs = LoadVal(logical->right_.get());
 
-    auto zero = IntConst::CreateIntConst(ibud_.Container(), 0);
+    auto zero = IntConst::CreateIntConst(ibud_.Func(), 0);
     const Register* cmpans = ibud_.InsertCmpInstr(
         env_.GetRegName(), Condition::ne, rhs, zero);
+    // rhs may end up in a block other than midblk
+    auto midend = ibud_.Container();
     ibud_.InsertBrInstr(finalblk);
 
     ibud_.SetInsertPoint(finalblk);
@@ -1289,16 +1320,16 @@ void IRGen::VisitLogicalExpr(LogicalExpr* logical)
             result, IntType::GetInt8(true));
         auto phi = ibud_.LastInstr()->As<PhiInstr>();
         phi->AddBlockValPair(firstblk, zero);
-        phi->AddBlockValPair(midblk, cmpans);
+        phi->AddBlockValPair(midend, cmpans);
     }
     else if (logical->op_ == Tag::logical_or)
     {
         logical->Val() = ibud_.InsertPhiInstr(
             result, IntType::GetInt8(true));
-        auto one = IntConst::CreateIntConst(ibud_.Container(), 1);
+        auto one = IntConst::CreateIntConst(ibud_.Func(), 1);
         auto phi = ibud_.LastInstr()->As<PhiInstr>();
         phi->AddBlockValPair(firstblk, one);
-        phi->AddBlockValPair(midblk, cmpans);
+        phi->AddBlockValPair(midend, cmpans);
     }
 }
 
@@ -1413,7 +1444,7 @@ void IRGen::VisitUnaryExpr(UnaryExpr* unary)
         else if (!ibud_.Container())
             container = transunit_.get();
         else
-            container = ibud_.Container();
+            container = ibud_.Func();
 
         unary->Val() = Evaluator::EvalUnary(
             container, unary->op_, unary->content_->Val());
@@ -1432,7 +1463,7 @@ void IRGen::VisitUnaryExpr(UnaryExpr* unary)
 
         if (val->Type()->Is<FloatType>())
         {
-            auto one = FloatConst::CreateFloatConst(ibud_.Container(), 1, val->Type()->As<FloatType>());
+            auto one = FloatConst::CreateFloatConst(ibud_.Func(), 1, val->Type()->As<FloatType>());
             if (unary->op_ == Tag::inc || unary->op_ == Tag::postfix_inc)
                 newval = ibud_.InsertFaddInstr(env_.GetRegName(), val, one);
             else
@@ -1440,14 +1471,14 @@ void IRGen::VisitUnaryExpr(UnaryExpr* unary)
         }
         else
         {
-            auto one = IntConst::CreateIntConst(ibud_.Container(), 1, val->Type()->As<IntType>());
+            auto one = IntConst::CreateIntConst(ibud_.Func(), 1, val->Type()->As<IntType>());
             if (unary->op_ == Tag::inc || unary->op_ == Tag::postfix_inc)
                 newval = ibud_.InsertAddInstr(env_.GetRegName(), val, one);
             else
                 newval = ibud_.InsertSubInstr(env_.GetRegName(), val, one);
         }
 
-        ibud_.InsertStoreInstr(newval, addr, false);
+        ibud_.InsertStoreInstr(newval, addr, IsVolatile(unary->content_.get()));
         if (unary->op_ == Tag::postfix_inc || unary->op_ == Tag::postfix_dec)
             unary->Val() = val;
         else unary->Val() = newval;
@@ -1466,7 +1497,7 @@ void IRGen::VisitUnaryExpr(UnaryExpr* unary)
         if (addreg->Type()->As<PtrType>()->Point2()->Is<ArrayType>())
         {
             auto inner = !unary->content_->Type()->As<CArrayType>()->IsParam();
-            auto zero = IntConst::CreateIntConst(ibud_.Container(), 0);
+            auto zero = IntConst::CreateIntConst(ibud_.Func(), 0);
             addreg = ibud_.InsertGetElePtrInstr(
                 env_.GetRegName(), inner, addreg->As<Register>(), zero);
         }
@@ -1482,21 +1513,30 @@ void IRGen::VisitUnaryExpr(UnaryExpr* unary)
     }
     else if (unary->op_ == Tag::minus)
     {
-        auto zero = IntConst::CreateIntConst(ibud_.Container(), 0);
         auto rhs = LoadVal(unary->content_.get());
-        unary->Val() = ibud_.InsertSubInstr(env_.GetRegName(), zero, rhs);
+        if (auto ty = rhs->Type()->As<FloatType>(); ty)
+        {
+            // -0.0 - x flips the sign of zeros as well.
+            auto zero = FloatConst::CreateFloatConst(ibud_.Func(), -0.0, ty);
+            unary->Val() = ibud_.InsertFsubInstr(env_.GetRegName(), zero, rhs);
+        }
+        else
+        {
+            auto zero = IntConst::CreateIntConst(ibud_.Func(), 0);
+            unary->Val() = ibud_.InsertSubInstr(env_.GetRegName(), zero, rhs);
+        }
     }
     else if (unary->op_ == Tag::tilde)
     {
         auto rhs = LoadVal(unary->content_.get());
         auto minusone = IntConst::CreateIntConst(
-            ibud_.Container(), ~0ull, rhs->Type()->As<IntType>());
+            ibud_.Func(), ~0ull, rhs->Type()->As<IntType>());
         unary->Val() = ibud_.InsertXorInstr(env_.GetRegName(), minusone, rhs);
     }
     else if (unary->op_ == Tag::exclamation)
     {
-        auto zero = IntConst::CreateIntConst(ibud_.Container(), 0);
-        auto one = IntConst::CreateIntConst(ibud_.Container(), 1);
+        auto zero = IntConst::CreateIntConst(ibud_.Func(), 0);
+        auto one = IntConst::CreateIntConst(ibud_.Func(), 1);
         unary->Val() = ibud_.InsertSelectInstr(
             env_.GetRegName(), LoadVal(unary->content_.get()), true, zero, one);
     }
@@ -1574,8 +1614,7 @@ void IRGen::VisitCompoundStmt(CompoundStmt* compound)
 
 void IRGen::VisitContinueStmt(ContinueStmt* stmt)
 {
-    IterStmt* iter = static_cast<IterStmt*>(env_.StmtStackTop());
-    ibud_.InsertBrInstr(iter->continuepoint_);
+    ibud_.InsertBrInstr(env_.LoopStackTop()->continuepoint_);
 }
 
 
@@ -1588,6 +1627,7 @@ void IRGen::VisitDeclStmt(DeclStmt* stmt)
 void IRGen::VisitDoWhileStmt(DoWhileStmt* stmt)
 {
     env_.PushStmt(stmt);
+    env_.PushLoop(stmt);
 
     auto loopblk = bbud_.GetBasicBlock(env_.GetLabelName());
     ibud_.InsertBrInstr(loopblk);
@@ -1603,6 +1643,7 @@ void IRGen::VisitDoWhileStmt(DoWhileStmt* stmt)
     stmt->PushBrInstr(ibud_.LastInstr());
     Merge(stmt->stmt_->NextList(), stmt->nextlist_);
 
+    env_.PopLoop();
     env_.PopStmt();
 }
 
@@ -1617,6 +1658,7 @@ void IRGen::VisitExprStmt(ExprStmt* stmt)
 void IRGen::VisitForStmt(ForStmt* stmt)
 {
     env_.PushStmt(stmt);
+    env_.PushLoop(stmt);
 
     if (stmt->init_)
         stmt->init_->Accept(this);
@@ -1676,7 +1718,7 @@ void IRGen::VisitForStmt(ForStmt* stmt)
     if (stmt->increment_)
     {
         ibud_.InsertBrInstr(incblk);
-        bbud_.SetInsertPoint(bbud_.InsertPoint() + 1);
+        bbud_.SetInsertPoint(std::next(bbud_.InsertPoint()));
     }
     else if (stmt->condition_)
         ibud_.InsertBrInstr(cmpblk);
@@ -1691,6 +1733,7 @@ void IRGen::VisitForStmt(ForStmt* stmt)
 
     if (stmt->decl_)
         scopestack_.PopScope();
+    env_.PopLoop();
     env_.PopStmt();
 }
 
@@ -1825,6 +1868,7 @@ void IRGen::VisitTransUnit(TransUnit* tu)
 void IRGen::VisitWhileStmt(WhileStmt* stmt)
 {
     env_.PushStmt(stmt);
+    env_.PushLoop(stmt);
 
     auto cmpblk = bbud_.GetBasicBlock(env_.GetLabelName()),
         loopblk = bbud_.GetBasicBlock(env_.GetLabelName());
@@ -1844,5 +1888,6 @@ void IRGen::VisitWhileStmt(WhileStmt* stmt)
 
     Merge(stmt->stmt_->NextList(), stmt->nextlist_);
 
+    env_.PopLoop();
     env_.PopStmt();
 }
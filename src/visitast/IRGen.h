@@ -17,6 +17,7 @@ class HeterSpec;
 class IROperand;
 class IRType;
 class FuncType;
+class IterStmt;
 class Statement;
 
 
@@ -101,6 +102,10 @@ private:
         void PopStmt() { brkcntn_.pop(); }
         Statement* StmtStackTop() { return brkcntn_.top(); }
 
+        void PushLoop(IterStmt* s) { loop_.push(s); }
+        void PopLoop() { loop_.pop(); }
+        IterStmt* LoopStackTop() { return loop_.top(); }
+
         void PushSwitch(SwitchInstr* i) { swtch_.push(i); }
         void PopSwitch() { swtch_.pop(); }
         SwitchInstr* SwitchStackTop() { return swtch_.top(); }
@@ -131,6 +136,9 @@ private:
         // br instructions generated by break and
         // continue statements to find their way to go
         std::stack<Statement*> brkcntn_{};
+        // Map continue to the innermost loop, which
+        // may be outside the innermost switch.
+        std::stack<IterStmt*> loop_{};
         // Map case and break in switch.
         std::stack<SwitchInstr*> swtch_{};
         // To which basic block does a label map?
@@ -2,11 +2,20 @@
 #include "visitir/SysVConv.h"
 #include "visitir/x64.h"
 #include "IR/Value.h"
+#include "pass/BlockLayout.h"
+#include "pass/DUInfo.h"
+#include "pass/Liveness.h"
+#include "pass/ShrinkWrap.h"
 #include "pass/x64Alloc.h"
+#include <algorithm>
 #include <climits>
+#include <deque>
 #include <fmt/format.h>
+#include <iterator>
 #include <memory>
+#include <set>
 #include <string>
+#include <unordered_set>
 
 
 static std::string Cond2Str(Condition cond, bool issigned)
@@ -59,6 +68,26 @@ static bool IsVecReg(RegTag tag)
     return static_cast<int>(tag) > 17;
 }
 
+// All vector registers are clobbered by calls in the System V ABI,
+// though functions generated here save xmm6-xmm15 in the prologue.
+static bool IsCallerSaved(RegTag tag)
+{
+    switch (tag)
+    {
+    case RegTag::rax: case RegTag::rcx: case RegTag::rdx:
+    case RegTag::rsi: case RegTag::rdi: case RegTag::r8:
+    case RegTag::r9:  case RegTag::r10: case RegTag::r11:
+        return true;
+    default:
+        return IsVecReg(tag);
+    }
+}
+
+static bool HasPhi(const BasicBlock* bb)
+{
+    return !bb->Empty() && bb->Front()->Is<PhiInstr>();
+}
+
 
 std::string CodeGen::GetFpLabel(unsigned long repr, size_t size)
 {
@@ -124,6 +153,12 @@ const x64* CodeGen::MapPossibleRegister(const IROperand* op)
 
 const x64* CodeGen::LoadPointer(const Register* reg)
 {
+    if (auto gep = addrs_.find(reg); gep != addrs_.end())
+    {
+        tempmap_[reg] = FoldAddress(gep->second, true);
+        return tempmap_[reg].get();
+    }
+
     auto mapped = alloc_->GetIROpMap(reg);
     if (auto m = mapped->As<x64Reg>(); m)
     {
@@ -143,6 +178,19 @@ const x64* CodeGen::LoadPointer(const Register* reg)
     return tempmap_[reg].get();
 }
 
+const x64* CodeGen::MapPossibleImm(const IROperand* op)
+{
+    auto mapped = alloc_->GetIROpMap(op);
+    if (!mapped->Is<x64Imm>())
+        return mapped;
+
+    // the same as LoadPointer, use the second spare GP register
+    auto reg = std::make_unique<x64Reg>(GetSpareIntReg(1), mapped->Size());
+    asmfile_.EmitMov(mapped, reg.get());
+    tempmap_[op] = std::move(reg);
+    return tempmap_[op].get();
+}
+
 
 static inline size_t GetAlign(size_t num, size_t align)
 {
@@ -175,6 +223,28 @@ void CodeGen::DeallocFrame()
     AdjustRsp(stacksize_ - 8);
 }
 
+void CodeGen::FreeFrame()
+{
+    // Without the frame pointer, the locals are below
+    // the callee-saved registers rather than above.
+    if (alloc_->OmitFramePointer())
+    {
+        AdjustRsp(alloc_->RspOffset());
+        RestoreCalleeSaved();
+        return;
+    }
+    AdjustRsp(callarea_);
+    if (calleeslots_.empty())
+        RestoreCalleeSaved();
+    else
+    {
+        LoadCalleeSaved(wrap_->Saved(asmfile_.CurBlock()));
+        AdjustRsp(calleearea_);
+    }
+    DeallocFrame();
+    asmfile_.EmitLeave();
+}
+
 
 void CodeGen::MapHeterParam(const x64Mem* mem, const x64Heter* heter)
 {
@@ -193,17 +263,14 @@ void CodeGen::MapHeterParam(const x64Mem* mem, const x64Heter* heter)
         if (IsVecReg(phigh.ToReg()))
         {
             Copy8Bytes(mem, RegTag::rax, RegTag::r11, remain);
-            x64Reg to{ phigh.ToReg() };
-            asmfile_.EmitInstr(fmt::format(
-                "    vmovq %r11, {}\n", to.ToString()));
+            asmfile_.EmitVmovq(RegTag::r11, phigh.ToReg());
         }
         else
             Copy8Bytes(mem, RegTag::rax, phigh.ToReg(), remain);
     }
     else
     {
-        AdjustRsp(-8);
-        x64Mem rsp{ 0, 0, RegTag::rsp, RegTag::none, 0 };
+        x64Mem rsp{ 0, static_cast<long>(phigh.ToOffset()), RegTag::rsp, RegTag::none, 0 };
         Copy8Bytes(mem, RegTag::rax, &rsp, remain);
     }
 
@@ -214,26 +281,26 @@ void CodeGen::MapHeterParam(const x64Mem* mem, const x64Heter* heter)
         {
             x64Reg r{ i->ToReg() };
             if (IsVecReg(i->ToReg()))
-                asmfile_.EmitInstr(fmt::format(
-                    "    vmovq {}, {}\n", mem->ToString(), r.ToString()));
+                asmfile_.EmitVmovq(mem, &r);
             else
                 asmfile_.EmitMov(mem, &r);
         }
         else
         {
-            asmfile_.EmitInstr(
-                fmt::format("    pushq {}\n", mem->ToString()));
-            stacksize_ += 8;
+            x64Reg rax{ RegTag::rax };
+            x64Mem rsp{ 8, static_cast<long>(i->ToOffset()), RegTag::rsp, RegTag::none, 0 };
+            asmfile_.EmitMov(mem, &rax);
+            asmfile_.EmitMov(&rax, &rsp);
         }
     }
 }
 
-void CodeGen::MapPtrParam2Mem(const x64* ptr)
+void CodeGen::MapPtrParam2Mem(const x64* ptr, const x64Mem* to)
 {
     auto mem = ptr->As<x64Mem>();
     if (!mem)
     {
-        PushEmitHelper(ptr);
+        MovEmitHelper(ptr, to, 1);
         return;
     }
 
@@ -242,7 +309,7 @@ void CodeGen::MapPtrParam2Mem(const x64* ptr)
         asmfile_.EmitMov(ptr, &reg);
     else
         asmfile_.EmitLeaq(ptr, &reg);
-    PushEmitHelper(&reg);
+    asmfile_.EmitMov(&reg, to);
 }
 
 void CodeGen::MapPtrParam2Reg(const x64* ptr, const x64Reg* loc)
@@ -257,11 +324,9 @@ void CodeGen::MapPtrParam2Reg(const x64* ptr, const x64Reg* loc)
         asmfile_.EmitMov(ptr, loc);
 }
 
-void CodeGen::MapFltParam2Mem(const x64* flt)
+void CodeGen::MapFltParam2Mem(const x64* flt, const x64Mem* to)
 {
-    AdjustRsp(-8);
-    x64Mem rsp{ flt->Size(), 0, RegTag::rsp, RegTag::none, 0 };
-    VecMovEmitHelper(flt, &rsp);
+    VecMovEmitHelper(flt, to);
 }
 
 void CodeGen::MapFltParam2Reg(const x64* flt, const x64Reg* loc)
@@ -269,15 +334,29 @@ void CodeGen::MapFltParam2Reg(const x64* flt, const x64Reg* loc)
     VecMovEmitHelper(flt, loc);
 }
 
-void CodeGen::MapOtherParam2Mem(const x64* param)
+void CodeGen::MapOtherParam2Mem(const x64* param, const x64Mem* to)
 {
-    if (param->Is<x64Mem>())
+    // Fill the whole eightbyte, as pushq used to.
+    x64Mem slot{ 8, to->Offset(), RegTag::rsp, RegTag::none, 0 };
+    if (param->Is<x64Imm>())
+        MovEmitHelper(param, &slot, 1);
+    else if (param->Is<x64Mem>())
     {
+        x64Reg rax{ RegTag::rax };
         asmfile_.EmitMov(param, RegTag::rax);
-        PushEmitHelper(RegTag::rax, 8);
+        asmfile_.EmitMov(&rax, &slot);
     }
     else
-        PushEmitHelper(param);
+    {
+        auto original = param->Size();
+        if (original != 8)
+        {
+            MovzEmitHelper(original, 8, param);
+            const_cast<x64*>(param)->Size() = 8;
+        }
+        asmfile_.EmitMov(param, &slot);
+        const_cast<x64*>(param)->Size() = original;
+    }
 }
 
 void CodeGen::MapOtherParam2Reg(const x64* param, const x64Reg* loc)
@@ -288,66 +367,37 @@ void CodeGen::MapOtherParam2Reg(const x64* param, const x64Reg* loc)
     asmfile_.EmitMov(param, loc);
 }
 
-// PassParam must correctly adjust the value of rsp, as the VisitCallInstr method
-// will add rsp by the size of the parameters and padding directly.
+// Arguments passed on the stack are written to the outgoing argument area
+// at the bottom of the frame, at the offsets given by the calling convention,
+// so rsp stays where it is.
 void CodeGen::PassParam(
     const SysVConv& conv, int count, const std::vector<const IROperand*>& param)
 {
-    long prevoffset = 0;
     for (int i = param.size() - 1; i >= 0; --i)
     {
         auto load2reg = conv.PlaceOfArgv(i);
-        if (prevoffset && !load2reg)
-        {
-            // +--------------------------+ <- rsp in caller before
-            // |    80-byte big heter,    |    passing params
-            // |       align = 16         |
-            // +--------------------------+ <- prevoffset
-            // |         Padding          | <- size of padding is calc based
-            // +--------------------------+    on val of rbp in the callee,
-            // |       8-byte chunk       |    but not rsp in the caller
-            // +--------------------------+ <- OffsetOfArgv(i)
-            // |       Return addr        |
-            // +--------------------------+
-            // |         Saved rbp        |    rbp in callee;
-            // +--------------------------+ <- base of the offsets
-            //
-            // Sometimes heterogeneous parameters can have alignment
-            // more than 8. Things become tricky when alignment exceeds
-            // 16 and the case is now ignored for simplicity.
-            // If the alignment is just 16, we may need to add padding
-            // between the current and the next parameter. However, the
-            // padding is calculated from the perspective of rbp in callee,
-            // and we have to get it from the mapped offset.
-            auto chunk = param[i]->Type()->Size() <= 8 ?
-                8 : param[i]->Type()->Size();
-            auto padding = prevoffset - (conv.OffsetOfArgv(i) + chunk);
-            if (padding)
-                AdjustRsp(-padding);
-            prevoffset = 0;
-        }
-
         if (param[i]->Type()->Is<HeterType>())
         {
             // i >= count: if the function is variadic,
             // pass struct/union on the stack
             if (auto size = param[i]->Type()->Size(); size > 64 || i >= count)
             {
-                AdjustRsp(-size);
+                // the argument registers may have been loaded
                 asmfile_.EmitPush(RegTag::rcx, 8);
                 asmfile_.EmitPush(RegTag::rsi, 8);
                 asmfile_.EmitPush(RegTag::rdi, 8);
 
-                asmfile_.EmitInstr("    leaq 24(%rsp), %rdi\n");
+                x64Mem argv{ 8, static_cast<long>(conv.OffsetOfArgv(i) + 24),
+                    RegTag::rsp, RegTag::none, 0 };
+                x64Reg rcx{ RegTag::rcx };
+                asmfile_.EmitLeaq(&argv, RegTag::rdi);
                 asmfile_.EmitLeaq(alloc_->GetIROpMap(param[i]), RegTag::rsi);
-                asmfile_.EmitInstr(fmt::format("    movq ${}, %rcx\n", size));
-                asmfile_.EmitInstr("    rep movsb\n");
+                asmfile_.EmitMov(size, &rcx);
+                asmfile_.EmitRepMovsb();
 
                 asmfile_.EmitPop(RegTag::rdi, 8);
                 asmfile_.EmitPop(RegTag::rsi, 8);
                 asmfile_.EmitPop(RegTag::rcx, 8);
-
-                prevoffset = conv.OffsetOfArgv(i);
             }
             else
                 MapHeterParam(alloc_->GetIROpMap(param[i])->As<x64Mem>(),
@@ -356,21 +406,20 @@ void CodeGen::PassParam(
         }
 
         auto mapped = MapPossibleFloat(param[i]);
+        x64Mem to{ param[i]->Type()->Size(),
+            load2reg ? 0 : conv.OffsetOfArgv(i), RegTag::rsp, RegTag::none, 0 };
         if (!load2reg && param[i]->Type()->Is<PtrType>())
-            MapPtrParam2Mem(mapped);
+            MapPtrParam2Mem(mapped, &to);
         else if (!load2reg && param[i]->Type()->Is<FloatType>())
-            MapFltParam2Mem(mapped);
+            MapFltParam2Mem(mapped, &to);
         else if (!load2reg)
-            MapOtherParam2Mem(mapped);
+            MapOtherParam2Mem(mapped, &to);
         else if (load2reg && param[i]->Type()->Is<PtrType>())
             MapPtrParam2Reg(mapped, load2reg->As<x64Reg>());
         else if (load2reg && param[i]->Type()->Is<FloatType>())
             MapFltParam2Reg(mapped, load2reg->As<x64Reg>());
         else if (load2reg)
             MapOtherParam2Reg(mapped, load2reg->As<x64Reg>());
-
-        if (!load2reg)
-            prevoffset = conv.OffsetOfArgv(i);
     }
 }
 
@@ -399,30 +448,120 @@ void CodeGen::RestoreCalleeSaved()
     }
 }
 
-void CodeGen::SaveCallerSaved()
+void CodeGen::AllocCalleeSlots()
+{
+    // the slots are where the registers would have been pushed
+    for (auto phys : alloc_->UsedCalleeSaved())
+    {
+        auto reg = X64Phys2RegTag(phys);
+        calleearea_ += IsVecReg(reg) ? 16 : 8;
+        calleeslots_[reg] = 8 - static_cast<long>(stacksize_ + calleearea_);
+    }
+    AdjustRsp(-calleearea_);
+    StoreCalleeSaved(wrap_->SavedAt(nullptr));
+}
+
+void CodeGen::StoreCalleeSaved(const std::vector<x64Phys>& regs)
 {
-    auto regs = alloc_->UsedCallerSaved();
-    for (auto reg: regs)
+    for (auto phys : regs)
     {
+        auto reg = X64Phys2RegTag(phys);
+        x64Mem slot{ IsVecReg(reg) ? 16ul : 8ul, calleeslots_[reg], RegTag::rbp, RegTag::none, 0 };
         if (IsVecReg(reg))
-            PushXmmReg(X64Phys2RegTag(reg));
+            asmfile_.EmitVmov(reg, &slot);
         else
-            PushEmitHelper(X64Phys2RegTag(reg), 8);
+            asmfile_.EmitMov(reg, &slot);
     }
 }
 
-void CodeGen::RestoreCallerSaved()
+void CodeGen::LoadCalleeSaved(const std::vector<x64Phys>& regs)
 {
-    auto regs = alloc_->UsedCallerSaved();
-    for (auto i = regs.rbegin(); i != regs.rend(); ++i)
+    for (auto phys : regs)
     {
-        if (IsVecReg(*i))
-            PopXmmReg(X64Phys2RegTag(*i));
+        auto reg = X64Phys2RegTag(phys);
+        x64Mem slot{ IsVecReg(reg) ? 16ul : 8ul, calleeslots_[reg], RegTag::rbp, RegTag::none, 0 };
+        if (IsVecReg(reg))
+            asmfile_.EmitVmov(&slot, reg);
         else
-            PopEmitHelper(X64Phys2RegTag(*i), 8);
+            asmfile_.EmitMov(&slot, reg);
     }
 }
 
+std::vector<RegTag> CodeGen::LiveAcrossCall(const CallInstr* inst)
+{
+    // A value is live across the call if it's live after the call,
+    // other than the result of the call itself.
+    std::unordered_set<const IROperand*> live{};
+    for (auto op : live_->LiveAfter(inst))
+        if (!info_->HasDef(op) || info_->GetDef(op) != inst)
+            live.insert(op);
+
+    std::set<RegTag> regs{};
+    for (auto op : live)
+        if (auto mapped = alloc_->GetIROpMap(op); mapped && mapped->Is<x64Reg>() &&
+            IsCallerSaved(mapped->As<x64Reg>()->Tag()))
+            regs.insert(mapped->As<x64Reg>()->Tag());
+    return { regs.begin(), regs.end() };
+}
+
+void CodeGen::SaveCallerSaved(const CallInstr* inst)
+{
+    for (auto reg : callersaved_[inst])
+    {
+        x64Mem slot{ 8, saveslots_[reg], RegTag::rsp, RegTag::none, 0 };
+        if (IsVecReg(reg))
+            asmfile_.EmitVmov(reg, &slot);
+        else
+            asmfile_.EmitMov(reg, &slot);
+    }
+}
+
+void CodeGen::RestoreCallerSaved(const CallInstr* inst)
+{
+    for (auto reg : callersaved_[inst])
+    {
+        x64Mem slot{ 8, saveslots_[reg], RegTag::rsp, RegTag::none, 0 };
+        if (IsVecReg(reg))
+            asmfile_.EmitVmov(&slot, reg);
+        else
+            asmfile_.EmitMov(&slot, reg);
+    }
+}
+
+void CodeGen::AllocCallArea(const Function* func)
+{
+    // Below the callee-saved registers are the slots for caller-saved
+    // ones live across calls, and the outgoing arguments at the bottom.
+    // rsp is adjusted once here to be aligned by 16 at every call.
+    callarea_ = 0;
+    callersaved_.clear();
+    saveslots_.clear();
+
+    bool calls = false;
+    long offset = alloc_->OutArgs();
+    for (auto bb : *func)
+    {
+        for (auto i : *bb)
+        {
+            auto call = i->As<CallInstr>();
+            if (!call || call->FuncName() == "@__Ginkgo_va_start")
+                continue;
+            calls = true;
+            callersaved_[call] = LiveAcrossCall(call);
+            for (auto reg : callersaved_[call])
+                if (saveslots_.emplace(reg, offset).second)
+                    offset += 8;
+        }
+    }
+    if (!calls)
+        return;
+
+    auto oldstacksize = stacksize_;
+    AdjustRsp(-offset);
+    AlignRspBy(8, 16);
+    callarea_ = stacksize_ - oldstacksize;
+}
+
 
 void CodeGen::HandleVaStart(CallInstr* inst)
 {
@@ -430,37 +569,46 @@ void CodeGen::HandleVaStart(CallInstr* inst)
     auto addr = LoadPointer(argvs[0]->As<Register>())->As<x64Mem>();
     auto oldoff = addr->Offset();
     x64Reg rax{ RegTag::rax, 8 };
+    x64Mem argarea{ 8, 16, RegTag::rbp, RegTag::none, 0 };
+    // gp_offset and fp_offset are 4 bytes
+    auto storeoffset = [this, addr] (unsigned long val) {
+        x64Mem field{ *addr };
+        field.Size() = 4;
+        asmfile_.EmitMov(val, &field);
+    };
 
     if (argvs.size() == 1) // Only one argument?
     {
         // Supposed the function has prototype func(...).
         // An error should have reported by CodeChk if not so.
         // gp_offset = 0
-        asmfile_.EmitInstr(fmt::format("    movl $0, {}\n", addr->ToString()));
+        storeoffset(0);
         // fp_offset = 0
         const_cast<x64Mem*>(addr)->Offset() += 4;
-        asmfile_.EmitInstr(fmt::format("    movl $0, {}\n", addr->ToString()));
+        storeoffset(0);
         // overflow_arg_area = 16(%rbp)
         const_cast<x64Mem*>(addr)->Offset() += 4;
-        asmfile_.EmitInstr(fmt::format("    leaq 16(%rbp), %rax\n"));
+        asmfile_.EmitLeaq(&argarea, &rax);
         asmfile_.EmitMov(&rax, addr, 0);
     }
     else
     {
         // gp_offset = count of used GP registers * 8
-        asmfile_.EmitInstr(fmt::format(
-            "    movl ${}, {}\n", alloc_->IntRegCount() * 8, addr->ToString()));
+        storeoffset(alloc_->IntRegCount() * 8);
         // fp_offset = 48 + count of used vector registers * 8
         const_cast<x64Mem*>(addr)->Offset() += 4;
-        asmfile_.EmitInstr(fmt::format(
-            "    movl ${}, {}\n", 48 + alloc_->VecRegCount() * 8, addr->ToString()));
+        storeoffset(48 + alloc_->VecRegCount() * 8);
         // overflow_arg_area = address of the last address-known argument
         // plus its size; 16(%rbp) if it is passed in the register
         const_cast<x64Mem*>(addr)->Offset() += 4;
+        // the argument may have been moved from where it is passed in
         auto last = alloc_->GetIROpMap(argvs[1]);
+        for (auto& [param, from] : alloc_->HomedParams())
+            if (param == argvs[1])
+                last = from.get();
         if (last->Is<x64Reg>())
         {
-            asmfile_.EmitInstr(fmt::format("    leaq 16(%rbp), %rax\n"));
+            asmfile_.EmitLeaq(&argarea, &rax);
             asmfile_.EmitMov(&rax, addr, 0);
         }
         else // if (last->Is<x64Mem>())
@@ -473,7 +621,7 @@ void CodeGen::HandleVaStart(CallInstr* inst)
             else if (size > 8)
                 size += size % 8;
             const_cast<x64Mem*>(mem)->Offset() += size;
-            asmfile_.EmitInstr(fmt::format("    leaq {}, %rax\n", mem->ToString()));
+            asmfile_.EmitLeaq(mem, &rax);
             asmfile_.EmitMov(&rax, addr, 0);
             const_cast<x64Mem*>(mem)->Offset() = oldmem;
         }
@@ -482,13 +630,123 @@ void CodeGen::HandleVaStart(CallInstr* inst)
     // reg_save_area = -(112 + size of stack vars)(%rbp)
     const_cast<x64Mem*>(addr)->Offset() += 8;
     auto offset = -(alloc_->RspOffset() + 112);
-    asmfile_.EmitInstr(fmt::format("    leaq {}(%rbp), %rax\n", offset));
+    x64Mem savearea{ 8, offset, RegTag::rbp, RegTag::none, 0 };
+    asmfile_.EmitLeaq(&savearea, &rax);
     asmfile_.EmitMov(&rax, addr, 0);
 
     const_cast<x64Mem*>(addr)->Offset() = oldoff;
 }
 
 
+bool CodeGen::HasEdgeCode(const BasicBlock* from, const BasicBlock* to) const
+{
+    return HasPhi(to) || (!calleeslots_.empty() && !wrap_->RestoreOnEdge(from, to).empty());
+}
+
+void CodeGen::PhiCopyHelper(const BasicBlock* from, const BasicBlock* to)
+{
+    std::vector<std::pair<const x64*, const x64*>> copies{};
+    // Addresses of variables read nothing, so they are
+    // loaded after all the other copies are done.
+    std::vector<std::pair<const x64*, const x64*>> addrs{};
+
+    for (auto i : *const_cast<BasicBlock*>(to))
+    {
+        auto phi = i->As<PhiInstr>();
+        if (!phi)
+            continue;
+        auto& pairs = phi->GetBlockValPair();
+        auto pair = std::find_if(pairs.begin(), pairs.end(),
+            [from] (const auto& p) { return p.first == from; });
+        if (pair == pairs.end())
+            continue;
+
+        auto op = pair->second;
+        auto src = MapPossibleFloat(op);
+        auto dest = alloc_->GetIROpMap(phi->Result());
+        if (auto mem = src->As<x64Mem>();
+            mem && op->Type()->Is<PtrType>() && !mem->LoadTwice())
+            addrs.emplace_back(src, dest);
+        else
+            copies.emplace_back(src, dest);
+    }
+
+    ParallelMove(copies);
+    for (auto [src, dest] : addrs)
+        LeaqEmitHelper(src, dest);
+    if (!calleeslots_.empty())
+        LoadCalleeSaved(wrap_->RestoreOnEdge(from, to));
+}
+
+// All the copies of an edge take place simultaneously, e.g., the
+// result of a phi instruction can be an operand of another phi in the
+// same block (the swap problem). Copies are sequentialized by emitting
+// those whose destinations are no longer read first, and cycles are
+// broken with the second spare GP register, or a spare vector register
+// if the values are float-points held in vector registers.
+void CodeGen::ParallelMove(std::vector<std::pair<const x64*, const x64*>>& moves)
+{
+    // registers are the same location regardless of the size
+    auto same = [] (const x64* a, const x64* b) {
+        auto ra = a->As<x64Reg>();
+        auto rb = b->As<x64Reg>();
+        if (ra && rb)
+            return ra->Tag() == rb->Tag();
+        return *a == *b;
+    };
+    auto isvec = [] (const x64* op) {
+        auto reg = op->As<x64Reg>();
+        return reg && IsVecReg(reg->Tag());
+    };
+
+    moves.erase(std::remove_if(moves.begin(), moves.end(),
+        [&same] (const auto& m) { return same(m.first, m.second); }), moves.end());
+
+    auto emit = [this, &isvec] (const x64* src, const x64* dest) {
+        if (isvec(src) || isvec(dest))
+            VecMovEmitHelper(src, dest);
+        else // bitwise copy, float-points included
+            MovEmitHelper(src, dest);
+    };
+
+    x64Reg temp{ GetSpareIntReg(1) };
+    x64Reg vectemp{ GetSpareVecReg(0) };
+    std::deque<x64Reg> reads{};
+    while (!moves.empty())
+    {
+        auto ready = std::find_if(moves.begin(), moves.end(),
+            [&moves, &same] (const auto& m) {
+                return std::none_of(moves.begin(), moves.end(),
+                    [&m, &same] (const auto& n) {
+                        return &m != &n && same(n.first, m.second); });
+            });
+        if (ready != moves.end())
+        {
+            emit(ready->first, ready->second);
+            moves.erase(ready);
+            continue;
+        }
+
+        auto dest = moves.front().second;
+        bool vec = isvec(dest) || std::any_of(moves.begin(), moves.end(),
+            [&] (const auto& m) { return same(m.first, dest) && isvec(m.second); });
+        auto via = vec ? &vectemp : &temp;
+        via->Size() = dest->Size();
+        emit(dest, via);
+        for (auto& m : moves)
+        {
+            if (!same(m.first, dest))
+                continue;
+            // a copy may read the temporary in a narrower size than it was written
+            if (vec || m.second->Size() == via->Size())
+                m.first = via;
+            else
+                m.first = &reads.emplace_back(via->Tag(), m.second->Size());
+        }
+    }
+}
+
+
 void CodeGen::Copy8Bytes(
     const x64* mem, RegTag r1, RegTag r2, size_t size)
 {
@@ -578,17 +836,17 @@ void CodeGen::CopySmallHeterIn(const x64* mem, const HeterType* ty)
     }
 
     if (SysVConv::HasFloat(ty, 0, 8, 0))
-        asmfile_.EmitInstr("    vmovq %rax, %xmm0\n");
+        asmfile_.EmitVmovq(RegTag::rax, RegTag::xmm0);
     if (SysVConv::HasFloat(ty, 8, 16, 0))
-        asmfile_.EmitInstr("    vmovq %rdx, %xmm1\n");
+        asmfile_.EmitVmovq(RegTag::rdx, RegTag::xmm1);
 }
 
 void CodeGen::CopySmallHeterOut(const x64* mem, const HeterType* h)
 {
     if (SysVConv::HasFloat(h, 0, 8, 0))
-        asmfile_.EmitInstr("    vmovq %xmm0, %rax\n");
+        asmfile_.EmitVmovq(RegTag::xmm0, RegTag::rax);
     if (SysVConv::HasFloat(h, 8, 16, 0))
-        asmfile_.EmitInstr("    vmovq %xmm1, %rdx\n");
+        asmfile_.EmitVmovq(RegTag::xmm1, RegTag::rdx);
 
     auto size = h->Size();
     Copy8Bytes(RegTag::rax, mem->As<x64Mem>(), size > 8 ? 8 : size);
@@ -604,9 +862,10 @@ void CodeGen::CopySmallHeterOut(const x64* mem, const HeterType* h)
 void CodeGen::CopyBigHeter(const x64* m)
 {
     // The destination is already in rdi.
+    x64Reg rcx{ RegTag::rcx };
     asmfile_.EmitLeaq(m, RegTag::rsi);
-    asmfile_.EmitInstr(fmt::format("    movq ${}, %rcx\n", m->Size()));
-    asmfile_.EmitInstr("    rep movsb\n");
+    asmfile_.EmitMov(m->Size(), &rcx);
+    asmfile_.EmitRepMovsb();
 }
 
 void CodeGen::LoadHeterParam(const x64Heter* heter, const x64Mem* mem)
@@ -618,18 +877,17 @@ void CodeGen::LoadHeterParam(const x64Heter* heter, const x64Mem* mem)
         {
             x64Reg reg{ i->ToReg() };
             if (IsVecReg(i->ToReg()))
-                asmfile_.EmitInstr(fmt::format(
-                    "    vmovq {}, {}\n", reg.ToString(), mem->ToString()));
+                asmfile_.EmitVmovq(&reg, mem);
             else
                 asmfile_.EmitMov(&reg, mem, 0);
         }
         else // if i in stack
         {
-            auto offset = i->ToOffset();
-            asmfile_.EmitInstr(fmt::format(
-                "    movq {}(%rbp), %rax\n", static_cast<long>(offset) + 16));
-            asmfile_.EmitInstr(fmt::format(
-                "    movq %rax, {}\n", mem->ToString()));
+            auto offset = static_cast<long>(i->ToOffset()) + 16;
+            x64Mem param{ 8, offset, RegTag::rbp, RegTag::none, 0 };
+            x64Reg rax{ RegTag::rax };
+            asmfile_.EmitMov(&param, &rax);
+            asmfile_.EmitMov(&rax, mem, 0);
         }
         const_cast<x64Mem*>(mem)->Offset() += 8;
     }
@@ -650,15 +908,22 @@ void CodeGen::LoadHeterParam(const x64Heter* heter, const x64Mem* mem)
 
 RegTag CodeGen::GetSpareIntReg(int i) const
 {
+    // Callee-saved registers are never used as temporaries,
+    // since they are saved only if the allocator uses them.
+    static const std::set<x64Phys> callersaved = {
+        x64Phys::rax, x64Phys::rcx, x64Phys::rdx, x64Phys::rsi,
+        x64Phys::rdi, x64Phys::r8,  x64Phys::r9,  x64Phys::r10,
+        x64Phys::r11,
+    };
+
     auto notused = alloc_->NotUsedIntReg();
-    if (notused.empty() && i == 0)
-        return RegTag::rax;
-    else if (notused.empty() && i == 1)
-        return RegTag::r11;
-    else if (i == 0)
-        return X64Phys2RegTag(*notused.begin());
-    else
-        return X64Phys2RegTag(*std::next(notused.begin(), i));
+    std::vector<x64Phys> spare{};
+    std::copy_if(notused.begin(), notused.end(), std::back_inserter(spare),
+        [] (x64Phys phys) { return callersaved.count(phys); });
+
+    if (i < spare.size())
+        return X64Phys2RegTag(spare[i]);
+    return i == 0 ? RegTag::rax : RegTag::r11;
 }
 
 RegTag CodeGen::GetSpareVecReg(int i) const
@@ -673,6 +938,18 @@ RegTag CodeGen::GetSpareVecReg(int i) const
 }
 
 
+size_t CodeGen::GetElePtrScale(const GetElePtrInstr* inst) const
+{
+    if (auto ptr = inst->Pointer()->Type()->As<PtrType>(); ptr)
+    {
+        if (ptr->Point2()->Is<ArrayType>() && inst->IsInner())
+            return ptr->Point2()->As<ArrayType>()->ArrayOf()->Size();
+        return ptr->Point2()->Size();
+    }
+    // if "pointer" is an array
+    return inst->Pointer()->Type()->As<ArrayType>()->ArrayOf()->Size();
+}
+
 void CodeGen::GetElePtrImmHelper(
     const x64Mem* ptr, const x64Imm* i, const x64* rlt, size_t scl)
 {
@@ -740,6 +1017,291 @@ void CodeGen::GetElePtrMemHelper(
     LeaqEmitHelper(&mem, rlt);
 }
 
+// Spare register 1 is the only one used, as in LoadPointer, leaving
+// spare register 0 to the load or store addressing through the result.
+std::unique_ptr<x64Mem> CodeGen::FoldAddress(const GetElePtrInstr* gep, bool emit)
+{
+    x64Reg base{ RegTag::none }, index{ RegTag::none };
+    x64Reg spare{ GetSpareIntReg(1) };
+    size_t scale = 0;
+    long disp = 0;
+    bool spareused = false;
+
+    auto ptr = alloc_->GetIROpMap(gep->Pointer());
+    auto mem = ptr->As<x64Mem>();
+    if (auto reg = ptr->As<x64Reg>(); reg)
+        base = x64Reg(reg->Tag());
+    else if (!mem || mem->GlobalLoc())
+        return nullptr;
+    else if (mem->LoadTwice())
+    {
+        if (emit)
+            asmfile_.EmitMov(mem, &spare);
+        base = spare;
+        spareused = true;
+    }
+    else // the object itself is on the stack
+    {
+        base = mem->Base();
+        index = mem->Index();
+        scale = mem->Scale();
+        disp = mem->Offset();
+    }
+
+    if (gep->HoldsInt())
+    {
+        auto heter = gep->Pointer()->
+            Type()->As<PtrType>()->Point2()->As<HeterType>();
+        disp += heter->At(gep->IntIndex()).second;
+    }
+    else
+    {
+        auto size = GetElePtrScale(gep);
+        auto i = alloc_->GetIROpMap(gep->OpIndex());
+        if (auto imm = i->As<x64Imm>(); imm)
+            disp += static_cast<long>(imm->GetRepr().first * size);
+        else if (index != RegTag::none || i->Size() != 8 ||
+            (size != 1 && size != 2 && size != 4 && size != 8))
+            return nullptr;
+        else if (auto reg = i->As<x64Reg>(); reg)
+        {
+            index = *reg;
+            scale = size;
+        }
+        else if (spareused)
+            return nullptr;
+        else
+        {
+            if (emit)
+                asmfile_.EmitMov(i, &spare);
+            index = spare;
+            scale = size;
+        }
+    }
+
+    if (disp != static_cast<int>(disp))
+        return nullptr;
+    return std::make_unique<x64Mem>(8, disp, base, index, scale);
+}
+
+// Do the two locations share any byte, or register?
+static bool Overlap(const x64* op1, const x64* op2)
+{
+    if (!op1 || !op2)
+        return false;
+    if (auto reg1 = op1->As<x64Reg>(), reg2 = op2->As<x64Reg>(); reg1 && reg2)
+        return reg1->Tag() == reg2->Tag();
+    auto mem1 = op1->As<x64Mem>();
+    auto mem2 = op2->As<x64Mem>();
+    if (!mem1 || !mem2 || mem1->GlobalLoc() || mem2->GlobalLoc() ||
+        mem1->Base().Tag() != mem2->Base().Tag())
+        return false;
+    return mem1->Offset() < mem2->Offset() + static_cast<long>(mem2->Size()) &&
+        mem2->Offset() < mem1->Offset() + static_cast<long>(mem1->Size());
+}
+
+bool CodeGen::FoldableAddress(const GetElePtrInstr* gep)
+{
+    auto result = gep->Result();
+    if (!info_->HasUse(result) || !FoldAddress(gep, false))
+        return false;
+
+    // Every use is a load from, or a store to, the address later in this block.
+    std::unordered_set<const Instr*> uses{};
+    for (auto use : info_->GetUse(result))
+    {
+        if (use->Parent() != curbb_)
+            return false;
+        if (auto load = use->As<LoadInstr>(); load)
+        {
+            if (load->Result()->Type()->Is<HeterType>())
+                return false;
+        }
+        else if (auto store = use->As<StoreInstr>(); store)
+        {
+            if (store->Value() == result || store->Value()->Type()->Is<HeterType>())
+                return false;
+        }
+        else
+            return false;
+        uses.insert(use);
+    }
+
+    // The address is computed again at each use, so the instructions
+    // in between must leave the operands and the spare registers alone.
+    // Those folded into an op on memory write no register, though.
+    auto pointer = alloc_->GetIROpMap(gep->Pointer());
+    auto index = gep->HoldsInt() ? nullptr : alloc_->GetIROpMap(gep->OpIndex());
+    const Instr* rmw = nullptr;
+    for (auto pos = std::next(curbb_->IterOf(gep)); ; ++pos)
+    {
+        // Some use comes before the address.
+        if (pos == curbb_->end())
+            return false;
+        auto inst = *pos;
+        if (uses.erase(inst) && uses.empty())
+            return true;
+        if (auto load = inst->As<LoadInstr>(); load && load->Pointer() == result)
+            if (auto bin = ReadModifyWrite(load); bin)
+            {
+                rmw = bin;
+                continue;
+            }
+        if (inst == rmw)
+            continue;
+        const IROperand* def = nullptr;
+        switch (inst->id_)
+        {
+        case Instr::InstrId::add: case Instr::InstrId::sub: case Instr::InstrId::btand:
+        case Instr::InstrId::btor: case Instr::InstrId::btxor: case Instr::InstrId::fadd:
+        case Instr::InstrId::fsub: case Instr::InstrId::fmul: case Instr::InstrId::fdiv:
+            def = inst->As<BinaryInstr>()->Result();
+            break;
+        case Instr::InstrId::sext: case Instr::InstrId::zext: case Instr::InstrId::trunc:
+            def = inst->As<ConvertInstr>()->Dest();
+            break;
+        case Instr::InstrId::load:
+            def = inst->As<LoadInstr>()->Result();
+            if (def->Type()->Is<HeterType>())
+                return false;
+            break;
+        case Instr::InstrId::store:
+            if (inst->As<StoreInstr>()->Value()->Type()->Is<HeterType>())
+                return false;
+            break;
+        case Instr::InstrId::geteleptr:
+            def = inst->As<GetElePtrInstr>()->Result();
+            break;
+        case Instr::InstrId::icmp:
+            def = inst->As<IcmpInstr>()->Result();
+            break;
+        default:
+            return false;
+        }
+        if (!def)
+            continue;
+        auto mapped = alloc_->GetIROpMap(def);
+        if (Overlap(mapped, pointer) || Overlap(mapped, index))
+            return false;
+    }
+}
+
+bool CodeGen::FoldableLoad(const LoadInstr* load) const
+{
+    auto result = load->Result();
+    if (!next_ || !result->Type()->Is<IntType>() || result->Type()->Size() > 4 ||
+        !info_->HasUse(result) || info_->GetUse(result).size() != 1 ||
+        info_->GetUse(result).front() != next_)
+        return false;
+    if (auto zext = next_->As<ZextInstr>(); zext)
+        return zext->Value() == result;
+    if (auto sext = next_->As<SextInstr>(); sext)
+        return sext->Value() == result;
+    return false;
+}
+
+const BinaryInstr* CodeGen::ReadModifyWrite(const LoadInstr* load) const
+{
+    // looked for after the load rather than after the instruction
+    // visited, since FoldableAddress asks it ahead of the load
+    auto result = load->Result();
+    auto next = std::next(curbb_->IterOf(load));
+    auto bin = next == curbb_->end() ? nullptr : (*next)->As<BinaryInstr>();
+    if (!bin || !result->Type()->Is<IntType>() || !info_->HasUse(result) ||
+        info_->GetUse(result).size() != 1)
+        return nullptr;
+
+    bool commutative = bin->id_ == Instr::InstrId::add || bin->id_ == Instr::InstrId::btand ||
+        bin->id_ == Instr::InstrId::btor || bin->id_ == Instr::InstrId::btxor;
+    if (!commutative && bin->id_ != Instr::InstrId::sub)
+        return nullptr;
+    if (bin->Lhs() == bin->Rhs() || (bin->Lhs() != result && !commutative))
+        return nullptr;
+
+    auto pos = std::next(curbb_->IterOf(bin));
+    if (pos == curbb_->end() || !info_->HasUse(bin->Result()) ||
+        info_->GetUse(bin->Result()).size() != 1)
+        return nullptr;
+    auto store = (*pos)->As<StoreInstr>();
+    if (!store || store->Dest() != load->Pointer() || store->Value() != bin->Result())
+        return nullptr;
+    return bin;
+}
+
+bool CodeGen::FoldableScale(const BinaryInstr* bin) const
+{
+    auto result = bin->Result();
+    auto add = next_ ? next_->As<AddInstr>() : nullptr;
+    if (!add || !info_->HasUse(result) || info_->GetUse(result).size() != 1 ||
+        (add->Lhs() == result) == (add->Rhs() == result))
+        return false;
+
+    auto amount = bin->Rhs()->As<IntConst>();
+    if (!amount || !alloc_->GetIROpMap(bin->Lhs())->Is<x64Reg>())
+        return false;
+    auto val = amount->Val();
+    if (bin->Is<ShlInstr>() ? val < 1 || val > 3 : val != 2 && val != 4 && val != 8)
+        return false;
+
+    auto ans = alloc_->GetIROpMap(add->Result());
+    auto other = alloc_->GetIROpMap(add->Lhs() == result ? add->Rhs() : add->Lhs());
+    auto imm = other->As<x64Imm>();
+    return ans->Is<x64Reg>() && ans->Size() >= 4 && (other->Is<x64Reg>() ||
+        (imm && (long)imm->GetRepr().first == (int)imm->GetRepr().first));
+}
+
+// lea computes an add (or the sub of an immediate) into a third register,
+// and an add of a scaled index, without changing the flags.
+bool CodeGen::LeaGenHelper(const BinaryInstr* bin)
+{
+    auto ans = alloc_->GetIROpMap(bin->Result());
+    if (!ans->Is<x64Reg>() || ans->Size() < 4)
+        return false;
+
+    x64Reg base{ RegTag::none }, index{ RegTag::none };
+    size_t scale = 0;
+    long disp = 0;
+    bool scaled = false;
+    auto operand = [&] (const IROperand* op, bool negate) {
+        if (op == scaleop_)
+        {
+            auto def = info_->GetDef(op)->As<BinaryInstr>();
+            auto val = def->Rhs()->As<IntConst>()->Val();
+            index = x64Reg(alloc_->GetIROpMap(def->Lhs())->As<x64Reg>()->Tag());
+            scale = def->Is<ShlInstr>() ? 1ul << val : val;
+            scaled = true;
+            return true;
+        }
+        auto mapped = alloc_->GetIROpMap(op);
+        if (auto reg = mapped->As<x64Reg>(); reg && !negate)
+        {
+            (base == RegTag::none ? base : index) = x64Reg(reg->Tag());
+            scale = index == RegTag::none ? 0 : std::max(scale, 1ul);
+            return true;
+        }
+        auto imm = mapped->As<x64Imm>();
+        if (!imm)
+            return false;
+        // A 32-bit result only needs the sum modulo 2^32.
+        long val = ans->Size() == 4 ? (int)imm->GetRepr().first : imm->GetRepr().first;
+        disp = negate ? -val : val;
+        return disp == (int)disp;
+    };
+
+    if (!operand(bin->Lhs(), false) || !operand(bin->Rhs(), bin->Is<SubInstr>()))
+        return false;
+    // add to the register itself is as short, and not worth it
+    if (!scaled && (base == RegTag::none ||
+        *alloc_->GetIROpMap(bin->Lhs()) == *ans))
+        return false;
+
+    if (base == RegTag::none && index != RegTag::none && scale == 1)
+        std::swap(base, index);
+    x64Mem addr{ ans->Size(), disp, base, index, scale };
+    asmfile_.EmitBinary("lea", &addr, ans);
+    return true;
+}
+
 
 void CodeGen::BinaryGenHelper(
     const std::string& name, const BinaryInstr* bi)
@@ -748,6 +1310,11 @@ void CodeGen::BinaryGenHelper(
     auto rhs = alloc_->GetIROpMap(bi->Rhs());
     auto ans = alloc_->GetIROpMap(bi->Result());
 
+    // an immediate that can't be sign-extended from 32 bits
+    if (auto imm = rhs->As<x64Imm>(); imm && imm->Size() == 8 &&
+        (long)imm->GetRepr().first != (int)imm->GetRepr().first)
+        rhs = MapPossibleImm(bi->Rhs());
+
     if (*rhs == *ans)
     {
         auto tag = GetSpareIntReg(0);
@@ -761,8 +1328,17 @@ void CodeGen::BinaryGenHelper(
     if (*lhs != *ans)
         MovEmitHelper(lhs, ans);
 
-    if (ans->Is<x64Reg>() || rhs->Is<x64Reg>())
+    if (ans->Is<x64Reg>() || (rhs->Is<x64Reg>() && name != "imul"))
         asmfile_.EmitBinary(name, rhs, ans);
+    else if (name == "imul")
+    {
+        // the destination of imul must be a register
+        auto tag = GetSpareIntReg(0);
+        x64Reg temp{ tag, ans->Size() };
+        asmfile_.EmitMov(ans, &temp);
+        asmfile_.EmitBinary(name, rhs, &temp);
+        asmfile_.EmitMov(&temp, ans);
+    }
     else
     {
         auto tag = GetSpareIntReg(0);
@@ -779,20 +1355,21 @@ void CodeGen::VarithmGenHelper(
     auto rhs = MapPossibleFloat(bi->Rhs());
     auto ans = alloc_->GetIROpMap(bi->Result());
 
-    if (lhs->Is<x64Reg>() && ans->Is<x64Reg>())
+    // the second source operand must be a register
+    x64Reg temp{ GetSpareVecReg(0), ans->Size() };
+    if (!lhs->Is<x64Reg>())
+    {
+        asmfile_.EmitVmov(lhs, &temp);
+        lhs = &temp;
+    }
+
+    if (ans->Is<x64Reg>())
         asmfile_.EmitVarithm(name, rhs, lhs, ans);
-    else if (!ans->Is<x64Reg>())
+    else
     {
-        x64Reg temp{ GetSpareVecReg(0), ans->Size() };
         asmfile_.EmitVarithm(name, rhs, lhs, &temp);
         asmfile_.EmitVmov(&temp, ans);
     }
-    else // if (!lhs->Is<x64Reg>())
-    {
-        x64Reg temp{ GetSpareVecReg(0), ans->Size() };
-        asmfile_.EmitVmov(lhs, &temp);
-        asmfile_.EmitVarithm(name, rhs, &temp, ans);
-    }
 }
 
 void CodeGen::ShiftGenHelper(const std::string& name, const BinaryInstr* bin)
@@ -801,6 +1378,15 @@ void CodeGen::ShiftGenHelper(const std::string& name, const BinaryInstr* bin)
     auto rhs = alloc_->GetIROpMap(bin->Rhs());
     auto ans = alloc_->GetIROpMap(bin->Result());
 
+    // a constant count needs no %cl
+    if (auto imm = rhs->As<x64Imm>(); imm)
+    {
+        if (*lhs != *ans)
+            MovEmitHelper(lhs, ans);
+        asmfile_.EmitBinary(name, imm->GetRepr().first & 0xff, ans);
+        return;
+    }
+
     if (!(rhs->Is<x64Reg>() && *rhs == RegTag::rcx))
         asmfile_.EmitMov(rhs, RegTag::rcx);
     if (*lhs != *ans)
@@ -821,6 +1407,8 @@ const x64* CodeGen::PrepareDivMod(const BinaryInstr* bin)
 
     // the first op in DivInstr may not be in %*ax.
     // move it to %*ax if it is not.
+    if (!(*lhs == RegTag::rax))
+        asmfile_.EmitMov(lhs, RegTag::rax);
     if (lhs->Size() < 4)
     {
         x64Reg rax{ RegTag::rax, 4 };
@@ -829,13 +1417,15 @@ const x64* CodeGen::PrepareDivMod(const BinaryInstr* bin)
         else
             asmfile_.EmitMovz(lhs->Size(), 4, &rax);
     }
-    else if (!(*lhs == RegTag::rax))
-        asmfile_.EmitMov(lhs, RegTag::rax);
 
+    // %rdx is overwritten by cqto, so the divisor is
+    // always placed in the reserved register %r11.
     bool usetemp = false;
-    x64Reg temp{ GetSpareIntReg(1), 4 };
+    x64Reg temp{ RegTag::r11, rhs->Size() < 4 ? 4 : rhs->Size() };
     if (rhs->Size() < 4)
     {
+        x64Reg small{ temp.Tag(), rhs->Size() };
+        asmfile_.EmitMov(rhs, &small);
         if (sign)
             asmfile_.EmitMovs(rhs->Size(), 4, &temp);
         else
@@ -848,12 +1438,248 @@ const x64* CodeGen::PrepareDivMod(const BinaryInstr* bin)
         usetemp = true;
     }
 
-    asmfile_.EmitCxtx(lhs->Size() < 4 ? 4 : lhs->Size());
+    if (sign)
+        asmfile_.EmitCxtx(lhs->Size() < 4 ? 4 : lhs->Size());
+    else
+    {
+        x64Reg edx{ RegTag::rdx, 4 };
+        asmfile_.EmitBinary("xor", &edx, &edx);
+    }
     asmfile_.EmitUnary(sign ? "idiv" : "div", usetemp ? &temp : rhs);
     return ans;
 }
 
 
+static unsigned long LowBits(unsigned long val, size_t size)
+{
+    return size == 8 ? val : val & ((1ul << size * 8) - 1);
+}
+
+static int Log2(unsigned long val)
+{
+    int log = 0;
+    while (val >>= 1)
+        ++log;
+    return log;
+}
+
+// Can the operand size immediate be encoded in an instruction?
+static bool FitsImm(unsigned long val, size_t size)
+{
+    return size == 4 || (long)val == (int)val;
+}
+
+// The magic number m and the shift s such that x / d is the quotient
+// of x * m by 2^(prec + s) for all x of bits wide, with m in bits wide
+// too. prec is bits for unsigned division, and bits - 1 for signed one,
+// where d is the magnitude of the divisor. See Division by Invariant
+// Integers using Multiplication by Granlund and Montgomery (1994), and
+// chapter 10 in Hacker's Delight by Warren.
+static bool DivMagic(unsigned long d, int prec, int bits, int first,
+    unsigned long& magic, int& shift)
+{
+    using u128 = unsigned __int128;
+    for (int s = first; s <= Log2(d) + 1; ++s)
+    {
+        auto pow = u128(1) << (prec + s);
+        auto m = (pow + d - 1) / d;
+        // m only grows with s
+        if (m >> bits)
+            return false;
+        if (m * d - pow <= (u128(1) << s))
+        {
+            magic = static_cast<unsigned long>(m);
+            shift = s;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CodeGen::ConstMulGenHelper(const BinaryInstr* bin)
+{
+    auto ans = alloc_->GetIROpMap(bin->Result());
+    auto c = bin->Rhs()->As<IntConst>();
+    auto x = alloc_->GetIROpMap(bin->Lhs());
+    if (!c)
+    {
+        c = bin->Lhs()->As<IntConst>();
+        x = alloc_->GetIROpMap(bin->Rhs());
+    }
+    if (!c || (ans->Size() != 4 && ans->Size() != 8))
+        return false;
+
+    auto val = LowBits(c->Val(), ans->Size());
+    if (val && !(val & (val - 1)))
+    {
+        if (*x != *ans)
+            MovEmitHelper(x, ans);
+        if (val > 1)
+            asmfile_.EmitBinary("shl", Log2(val), ans);
+    }
+    else if ((val == 3 || val == 5 || val == 9) && ans->Is<x64Reg>())
+    {
+        x64Reg reg{ ans->As<x64Reg>()->Tag() };
+        if (auto r = x->As<x64Reg>(); r)
+            reg = x64Reg(r->Tag());
+        else
+            MovEmitHelper(x, ans);
+        x64Mem addr{ ans->Size(), 0, reg, reg, val - 1 };
+        asmfile_.EmitBinary("lea", &addr, ans);
+    }
+    else // the lower half of the product is the same whatever the sign
+        BinaryGenHelper("imul", bin);
+    return true;
+}
+
+// The dividend is copied to %r11, reserved for the divisor of idiv,
+// and %rax and %rdx, written by idiv anyway, are used as temporaries.
+bool CodeGen::ConstDivGenHelper(const BinaryInstr* bin, bool mod)
+{
+    auto c = bin->Rhs()->As<IntConst>();
+    auto lhs = alloc_->GetIROpMap(bin->Lhs());
+    auto ans = alloc_->GetIROpMap(bin->Result());
+    auto size = ans->Size();
+    if (!c || (size != 4 && size != 8) || lhs->Size() != size)
+        return false;
+
+    bool sign =
+        bin->Lhs()->Type()->As<IntType>()->IsSigned() ||
+        bin->Rhs()->Type()->As<IntType>()->IsSigned();
+    int bits = size * 8;
+    auto d = LowBits(c->Val(), size);
+    bool neg = sign && (d >> (bits - 1));
+    if (neg)
+        d = LowBits(-d, size);
+    if (d == 0)
+        return false;
+
+    bool pow2 = !(d & (d - 1));
+    bool wide = false;
+    unsigned long magic = 0;
+    int shift = Log2(d);
+    if (!pow2 && sign && !DivMagic(d, bits - 1, bits, 1, magic, shift))
+        return false;
+    // the quotient is 0 or 1, for which the compare of div is as good
+    else if (!pow2 && !sign && d >> (bits - 1))
+        return false;
+    else if (!pow2 && !sign && !DivMagic(d, bits, bits, 0, magic, shift))
+    {
+        // The magic number is bits + 1 wide, and the product is
+        // computed as in figure 4.1 of Granlund and Montgomery.
+        using u128 = unsigned __int128;
+        wide = true;
+        shift = Log2(d) + 1;
+        magic = static_cast<unsigned long>(
+            (u128(1) << bits) * ((u128(1) << shift) - d) / d + 1);
+    }
+
+    x64Reg rax{ RegTag::rax, size }, rdx{ RegTag::rdx, size }, r11{ RegTag::r11, size };
+    asmfile_.EmitMov(lhs, &r11);
+    const x64Reg* result = &r11;
+    if (pow2 && !sign)
+    {
+        if (!mod && shift)
+            asmfile_.EmitBinary("shr", shift, &r11);
+        else if (mod && FitsImm(d - 1, size))
+            asmfile_.EmitBinary("and", d - 1, &r11);
+        else if (mod)
+        {
+            asmfile_.EmitBinary("mov", d - 1, &rax);
+            asmfile_.EmitBinary("and", &rax, &r11);
+        }
+    }
+    else if (pow2 && shift == 0)
+    {
+        // x % 1 and x % -1 are 0, x / 1 and x / -1 are (-)x
+        if (mod)
+            asmfile_.EmitBinary("xor", &r11, &r11);
+    }
+    else if (pow2)
+    {
+        // x + d - 1 for negative dividends, x otherwise
+        asmfile_.EmitMov(&r11, &rdx);
+        asmfile_.EmitBinary("sar", bits - 1, &rdx);
+        asmfile_.EmitBinary("shr", bits - shift, &rdx);
+        asmfile_.EmitMov(&r11, &rax);
+        asmfile_.EmitBinary("add", &rdx, &rax);
+        if (!mod)
+        {
+            asmfile_.EmitBinary("sar", shift, &rax);
+            result = &rax;
+        }
+        else
+        {
+            if (FitsImm(LowBits(-d, size), size))
+                asmfile_.EmitBinary("and", LowBits(-d, size), &rax);
+            else
+            {
+                asmfile_.EmitBinary("sar", shift, &rax);
+                asmfile_.EmitBinary("shl", shift, &rax);
+            }
+            asmfile_.EmitBinary("sub", &rax, &r11);
+        }
+    }
+    else
+    {
+        const x64Reg* quot = &rdx;
+        asmfile_.EmitBinary("mov", magic, &rax);
+        if (sign)
+        {
+            asmfile_.EmitUnary("imul", &r11);
+            // the magic number is negative as a signed one
+            if (magic >> (bits - 1))
+                asmfile_.EmitBinary("add", &r11, &rdx);
+            if (shift > 1)
+                asmfile_.EmitBinary("sar", shift - 1, &rdx);
+            // x / d rounds toward zero, while the product rounds
+            // toward minus infinity, hence 1 added for negative x
+            asmfile_.EmitMov(&r11, &rax);
+            asmfile_.EmitBinary("sar", bits - 1, &rax);
+            asmfile_.EmitBinary("sub", &rax, &rdx);
+        }
+        else if (wide)
+        {
+            asmfile_.EmitUnary("mul", &r11);
+            asmfile_.EmitMov(&r11, &rax);
+            asmfile_.EmitBinary("sub", &rdx, &rax);
+            asmfile_.EmitBinary("shr", 1, &rax);
+            asmfile_.EmitBinary("add", &rdx, &rax);
+            if (shift > 1)
+                asmfile_.EmitBinary("shr", shift - 1, &rax);
+            quot = &rax;
+        }
+        else
+        {
+            asmfile_.EmitUnary("mul", &r11);
+            if (shift)
+                asmfile_.EmitBinary("shr", shift, &rdx);
+        }
+
+        result = quot;
+        if (mod)
+        {
+            // x % d is x - x / d * d, and the magnitude of d will do
+            auto temp = quot == &rax ? &rdx : &rax;
+            if (FitsImm(d, size))
+                asmfile_.EmitBinary("imul", d, quot);
+            else
+            {
+                asmfile_.EmitBinary("mov", d, temp);
+                asmfile_.EmitBinary("imul", temp, quot);
+            }
+            asmfile_.EmitBinary("sub", quot, &r11);
+            result = &r11;
+        }
+    }
+
+    if (neg && !mod)
+        asmfile_.EmitUnary("neg", result);
+    asmfile_.EmitMov(result, ans);
+    return true;
+}
+
+
 void CodeGen::LeaqEmitHelper(const x64* addr, const x64* dest)
 {
     auto mem = addr->As<x64Mem>();
@@ -941,9 +1767,9 @@ void CodeGen::VecMovEmitHelper(const x64* src, const x64* dest)
         asmfile_.EmitVmov(src, dest);
     else
     {
-        auto tag = GetSpareVecReg(0);
-        asmfile_.EmitVmov(src, tag);
-        asmfile_.EmitVmov(tag, dest);
+        x64Reg temp{ GetSpareVecReg(0), dest->Size() };
+        asmfile_.EmitVmov(src, &temp);
+        asmfile_.EmitVmov(&temp, dest);
     }
 }
 
@@ -971,52 +1797,56 @@ void CodeGen::VcvtEmitHelper(const x64* op1, const x64* op2)
         asmfile_.EmitVcvt(op1, op2);
         return;
     }
-    auto tag = GetSpareVecReg(0);
-    asmfile_.EmitVcvt(op1, tag);
-    asmfile_.EmitVmov(tag, op2);
+    // the temporary takes the precision of the destination
+    x64Reg temp{ GetSpareVecReg(0), op2->Size() };
+    asmfile_.EmitVcvt(op1, &temp);
+    asmfile_.EmitVmov(&temp, op2);
 }
 
 void CodeGen::VcvtsiEmitHelper(bool sign, const x64* op1, const x64* op2)
 {
-    size_t oldsz = 0;
-    if (op1->Size() != 4 && op1->Size() != 8)
+    // vcvtsi accepts neither immediates nor 8/16-bit integers
+    x64Reg temp{ RegTag::none };
+    if (op1->Is<x64Imm>() || (op1->Size() != 4 && op1->Size() != 8))
     {
-        if (op1->Is<x64Reg>() && sign)
-            asmfile_.EmitMovs(op1->Size(), 8, op1);
-        else if (op1->Is<x64Reg>() && !sign)
-            asmfile_.EmitMovz(op1->Size(), 8, op1);
-        oldsz = op1->Size();
-        const_cast<x64*>(op1)->Size() = 8;
+        temp = x64Reg(GetSpareIntReg(0), op1->Size() < 4 ? 4 : op1->Size());
+        if (op1->Is<x64Imm>() || op1->Size() >= 4)
+            asmfile_.EmitMov(op1, &temp);
+        else if (sign)
+            asmfile_.EmitMovs(op1, &temp);
+        else
+            asmfile_.EmitMovz(op1, &temp);
+        op1 = &temp;
     }
 
     if (op2->Is<x64Reg>())
         asmfile_.EmitVcvtsi(op1, op2);
     else
     {
-        auto tag = GetSpareVecReg(0);
-        asmfile_.EmitVcvtsi(op1, tag);
-        asmfile_.EmitVmov(tag, op2);
+        x64Reg temp{ GetSpareVecReg(0), op2->Size() };
+        asmfile_.EmitVcvtsi(op1, &temp);
+        asmfile_.EmitVmov(&temp, op2);
     }
-
-    if (oldsz)
-        const_cast<x64*>(op1)->Size() = oldsz;
 }
 
 void CodeGen::VcvttEmitHelper(const x64* op1, const x64* op2)
 {
     auto oldsz = op2->Size();
-    if (oldsz < 4)
-        const_cast<x64*>(op2)->Size() = 4;
     if (op2->Is<x64Reg>())
-        asmfile_.EmitVcvtt(op1, op2);
-    else
     {
-        auto tag = GetSpareVecReg(0);
-        asmfile_.EmitVcvtt(op1, tag);
-        asmfile_.EmitVmov(tag, op2);
+        if (oldsz < 4)
+            const_cast<x64*>(op2)->Size() = 4;
+        asmfile_.EmitVcvtt(op1, op2);
+        if (oldsz < 4)
+            const_cast<x64*>(op2)->Size() = oldsz;
+        return;
     }
-    if (oldsz < 4)
-        const_cast<x64*>(op2)->Size() = oldsz;
+
+    // vcvtt only writes to a general purpose register
+    x64Reg temp{ GetSpareIntReg(0), oldsz < 4 ? 4 : oldsz };
+    asmfile_.EmitVcvtt(op1, &temp);
+    temp.Size() = oldsz;
+    asmfile_.EmitMov(&temp, op2);
 }
 
 void CodeGen::UcomEmitHelper(const x64* op1, const x64* op2)
@@ -1026,9 +1856,9 @@ void CodeGen::UcomEmitHelper(const x64* op1, const x64* op2)
         asmfile_.EmitUcom(op1, op2);
         return;
     }
-    auto tag = GetSpareVecReg(0);
-    asmfile_.EmitVmov(op2, tag);
-    asmfile_.EmitUcom(op1, tag);
+    x64Reg temp{ GetSpareVecReg(0), op2->Size() };
+    asmfile_.EmitVmov(op2, &temp);
+    asmfile_.EmitUcom(op1, &temp);
 }
 
 
@@ -1036,7 +1866,7 @@ void CodeGen::PushEmitHelper(const x64* reg)
 {
     if (reg->Is<x64Imm>())
     {
-        asmfile_.EmitInstr("    pushq " + reg->ToString() + '\n');
+        asmfile_.EmitPush(reg);
         stacksize_ += 8;
         return;
     }
@@ -1215,10 +2045,18 @@ void CodeGen::VisitModule(Module* mod)
     for (auto val : *mod)
         val->Accept(this);
 
-    if (fpconst_.empty())
+    if (fpconst_.empty() && jumptables_.empty())
         return;
 
     asmfile_.EmitPseudoInstr(".section .rodata");
+    for (const auto& [label, targets] : jumptables_)
+    {
+        asmfile_.EmitPseudoInstr(".align", { "4" });
+        asmfile_.EmitLabel(label);
+        for (const auto& target : targets)
+            asmfile_.EmitPseudoInstr(".long", { target + '-' + label });
+        asmfile_.EmitBlankLine();
+    }
     for (const auto& [repr, label] : fpconst_)
     {
         asmfile_.EmitPseudoInstr(".align", { std::to_string(repr.size_) });
@@ -1257,7 +2095,7 @@ void CodeGen::VisitGlobalVar(GlobalVar* var)
         auto strsz = std::to_string(size);
         asmfile_.EmitPseudoInstr(".data");
         asmfile_.EmitPseudoInstr(".globl", { name });
-        asmfile_.EmitPseudoInstr(".align", { strsz });
+        asmfile_.EmitPseudoInstr(".align", { std::to_string(var->Type()->Align()) });
         asmfile_.EmitPseudoInstr(".type", { name, "@object" });
         asmfile_.EmitPseudoInstr(".size", { name, strsz });
         asmfile_.EmitLabel(name);
@@ -1301,60 +2139,115 @@ void CodeGen::VisitFunction(Function* func)
     asmfile_.EmitPseudoInstr(".globl", { name });
     asmfile_.EmitPseudoInstr(".type", { name, "@function" });
     asmfile_.EmitLabel(func->Name().substr(1));
+    // The prologue is kept in memory as well for the peephole optimizer.
+    asmfile_.Write2Mem();
+    asmfile_.EnterBlock(nullptr);
 
-    stacksize_ = 8;
-    asmfile_.EmitPush(RegTag::rbp, 8);
-    x64Reg rsp{ RegTag::rsp };
-    x64Reg rbp{ RegTag::rbp };
-    asmfile_.EmitMov(&rsp, &rbp);
-    AdjustRsp(-alloc_->RspOffset());
-
-    if (func->Variadic())
-    {
-        AlignRspBy(0, 8);
-        AdjustRsp(-112);
-        asmfile_.EmitMov(RegTag::rdi, (long)0);
-        asmfile_.EmitMov(RegTag::rsi, 8);
-        asmfile_.EmitMov(RegTag::rdx, 16);
-        asmfile_.EmitMov(RegTag::rcx, 24);
-        asmfile_.EmitMov(RegTag::r8, 32);
-        asmfile_.EmitMov(RegTag::r9, 40);
-
-        auto rax = x64Reg(RegTag::rax, 1);
-        auto label = GetLabel();
-        asmfile_.EmitTest(&rax, &rax);
-        asmfile_.EmitJmp("e", label);
-
-        asmfile_.EmitVmov(RegTag::xmm0, 48);
-        asmfile_.EmitVmov(RegTag::xmm1, 56);
-        asmfile_.EmitVmov(RegTag::xmm2, 64);
-        asmfile_.EmitVmov(RegTag::xmm3, 72);
-        asmfile_.EmitVmov(RegTag::xmm4, 80);
-        asmfile_.EmitVmov(RegTag::xmm5, 88);
-        asmfile_.EmitVmov(RegTag::xmm6, 96);
-        asmfile_.EmitVmov(RegTag::xmm7, 104);
+    if (alloc_->OmitFramePointer())
+    {
+        // locals go below the callee-saved registers, see x64Alloc
+        stacksize_ = 0;
+        SaveCalleeSaved();
+        AdjustRsp(-alloc_->RspOffset());
+    }
+    else
+    {
+        stacksize_ = 8;
+        calleeslots_.clear();
+        calleearea_ = 0;
+        asmfile_.EmitPush(RegTag::rbp, 8);
+        x64Reg rsp{ RegTag::rsp };
+        x64Reg rbp{ RegTag::rbp };
+        asmfile_.EmitMov(&rsp, &rbp);
+        AdjustRsp(-alloc_->RspOffset());
 
-        asmfile_.EmitLabel(label);
+        if (func->Variadic())
+        {
+            AlignRspBy(0, 8);
+            AdjustRsp(-112);
+            asmfile_.EmitMov(RegTag::rdi, (long)0);
+            asmfile_.EmitMov(RegTag::rsi, 8);
+            asmfile_.EmitMov(RegTag::rdx, 16);
+            asmfile_.EmitMov(RegTag::rcx, 24);
+            asmfile_.EmitMov(RegTag::r8, 32);
+            asmfile_.EmitMov(RegTag::r9, 40);
+
+            auto rax = x64Reg(RegTag::rax, 1);
+            auto label = GetLabel();
+            asmfile_.EmitTest(&rax, &rax);
+            asmfile_.EmitJmp("e", label);
+
+            asmfile_.EmitVmov(RegTag::xmm0, 48);
+            asmfile_.EmitVmov(RegTag::xmm1, 56);
+            asmfile_.EmitVmov(RegTag::xmm2, 64);
+            asmfile_.EmitVmov(RegTag::xmm3, 72);
+            asmfile_.EmitVmov(RegTag::xmm4, 80);
+            asmfile_.EmitVmov(RegTag::xmm5, 88);
+            asmfile_.EmitVmov(RegTag::xmm6, 96);
+            asmfile_.EmitVmov(RegTag::xmm7, 104);
+
+            asmfile_.EmitLabel(label);
+        }
+
+        if (wrap_ && wrap_->Wrapped())
+            AllocCalleeSlots();
+        else
+            SaveCalleeSaved();
+        AllocCallArea(func);
     }
 
-    SaveCalleeSaved();
-    asmfile_.Write2Mem();
+    // a parameter may be homed in the register another one is passed in
+    std::vector<std::pair<const x64*, const x64*>> homes{};
+    for (auto& [param, from] : alloc_->HomedParams())
+        homes.emplace_back(from.get(), alloc_->GetIROpMap(param));
+    ParallelMove(homes);
 
-    for (auto bb : *func)
-        VisitBasicBlock(bb);
+    if (layout_)
+        for (auto bb : layout_->Order())
+            VisitBasicBlock(bb);
+    else
+        for (auto bb : *func)
+            VisitBasicBlock(bb);
 
     asmfile_.Dump2File();
+    if (summary_ && peepholeprint_)
+    {
+        *summary_ << asmfile_.GetPeephole().PrintSummary(func->Name());
+        *summary_ << '\n';
+    }
     asmfile_.EmitBlankLine();
 
+    curbb_ = nullptr;
+    addrs_.clear();
+    loadop_ = nullptr;
+    scaleop_ = nullptr;
+    folded_.clear();
     pipeline_->ExitFunction();
+
+    // The operands and blocks are about to be released,
+    // so nothing may stay keyed by them.
+    tempmap_.clear();
+    bb2label_.clear();
+    if (!func->Inlined())
+        func->ReleaseBody();
 }
 
 void CodeGen::VisitBasicBlock(BasicBlock* bb)
 {
     asmfile_.EnterBlock(bb);
+    // padded with nops only when that takes at most 10 bytes
+    if (layout_ && layout_->Aligned(bb))
+        asmfile_.EmitPseudoInstr(".p2align", { "4,,10" });
     asmfile_.EmitLabel(GetLabel(bb));
-    for (auto inst : *bb)
-        inst->Accept(this);
+    if (!calleeslots_.empty())
+        StoreCalleeSaved(wrap_->SavedAt(bb));
+    curbb_ = bb;
+    for (auto it = bb->begin(); it != bb->end(); ++it)
+    {
+        next_ = std::next(it) == bb->end() ? nullptr : *std::next(it);
+        if (!folded_.count(*it))
+            (*it)->Accept(this);
+    }
 }
 
 
@@ -1403,6 +2296,10 @@ void CodeGen::VisitNode(UnaryNode* un)
 
 void CodeGen::VisitRetInstr(RetInstr* inst)
 {
+    // the function has jumped to the callee of a sibling call
+    if (inst == tailret_)
+        return;
+
     if (!inst->ReturnValue())
         goto ret;
     else if (inst->ReturnValue()->Type()->Is<IntType>())
@@ -1425,7 +2322,8 @@ void CodeGen::VisitRetInstr(RetInstr* inst)
         if (inst->ReturnValue()->Type()->Size() > 16)
         {
             CopyBigHeter(mapped);
-            asmfile_.EmitInstr("    movq %rdi, %rax\n");
+            x64Reg rdi{ RegTag::rdi };
+            asmfile_.EmitMov(&rdi, RegTag::rax);
         }
         else if (mapped->Is<x64Mem>())
             CopySmallHeterIn(mapped, inst->ReturnValue()->Type()->As<HeterType>());
@@ -1435,17 +2333,17 @@ void CodeGen::VisitRetInstr(RetInstr* inst)
                 x64Reg f{ from, 8 };
                 asmfile_.EmitMov(&f, RegTag::rax);
             };
-            auto fromstack = [this] (size_t offset, const std::string& r) {
+            auto fromstack = [this] (size_t offset, RegTag r) {
                 auto o = static_cast<long>(offset) + 16;
-                asmfile_.EmitInstr(
-                    fmt::format("    movq {}(%rbp), {}\n", o, r));
+                x64Mem mem{ 8, o, RegTag::rbp, RegTag::none, 0 };
+                asmfile_.EmitMov(&mem, r);
             };
             auto h = mapped->As<x64Heter>();
             auto& first = h->Front();
             if (first.InReg())
                 fromreg(first.ToReg(), RegTag::rax);
             else // if (first.InStack())
-                fromstack(first.ToOffset(), "%rax");
+                fromstack(first.ToOffset(), RegTag::rax);
 
             if (h->Size() <= 8)
                 goto ret;
@@ -1454,66 +2352,367 @@ void CodeGen::VisitRetInstr(RetInstr* inst)
             if (second.InReg())
                 fromreg(second.ToReg(), RegTag::rdx);
             else // if (second.InStack())
-                fromstack(second.ToOffset(), "%rdx");
+                fromstack(second.ToOffset(), RegTag::rdx);
         }
     }
 
 ret:
     // what if there's multiple ret instruction in a function?
     auto oldstacksize = stacksize_;
-    RestoreCalleeSaved();
-    DeallocFrame();
+    FreeFrame();
     stacksize_ = oldstacksize;
-
-    asmfile_.EmitLeave();
     asmfile_.EmitRet();
 }
 
 
+void CodeGen::BranchHelper(const std::vector<std::string>& conds,
+    const BasicBlock* taken, const BasicBlock* other)
+{
+    // Copies for the taken edge can't be placed before the conditional
+    // jumps, so they go to a separate place after the other edge.
+    auto curbb = asmfile_.CurBlock();
+    auto label = HasEdgeCode(curbb, taken) ? GetLabel() : GetLabel(taken);
+    for (const auto& cond : conds)
+        asmfile_.EmitJmp(cond, label);
+    PhiCopyHelper(curbb, other);
+    asmfile_.EmitJmp("", GetLabel(other));
+    if (HasEdgeCode(curbb, taken))
+    {
+        asmfile_.EmitLabel(label);
+        PhiCopyHelper(curbb, taken);
+        asmfile_.EmitJmp("", GetLabel(taken));
+    }
+}
+
 void CodeGen::VisitBrInstr(BrInstr* inst)
 {
+    // the function has jumped to the callee of a sibling call
+    if (inst == tailret_)
+        return;
+
+    auto curbb = asmfile_.CurBlock();
+    auto jump = [this, curbb] (const BasicBlock* to) {
+        PhiCopyHelper(curbb, to);
+        asmfile_.EmitJmp("", GetLabel(to));
+    };
+
     if (!inst->Cond())
     {
-        asmfile_.EmitJmp("", GetLabel(inst->GetTrueBlk()));
+        jump(inst->GetTrueBlk());
         return;
     }
     if (auto ic = inst->Cond()->As<IntConst>(); ic)
     {
-        if (ic->Val())
-            asmfile_.EmitJmp("", GetLabel(inst->GetTrueBlk()));
+        jump(ic->Val() ? inst->GetTrueBlk() : inst->GetFalseBlk());
+        return;
+    }
+
+    if (inst->Cond() == flagsop_)
+    {
+        flagsop_ = nullptr;
+        if (!flagsfloat_ || flagscond_ == Condition::gt || flagscond_ == Condition::ge)
+            BranchHelper({ Cond2Str(flagscond_, flagssigned_) },
+                inst->GetTrueBlk(), inst->GetFalseBlk());
+        else if (flagscond_ == Condition::ne)
+            BranchHelper({ "ne", "p" }, inst->GetTrueBlk(), inst->GetFalseBlk());
         else
-            asmfile_.EmitJmp("", GetLabel(inst->GetFalseBlk()));
+            BranchHelper({ "ne", "p" }, inst->GetFalseBlk(), inst->GetTrueBlk());
         return;
     }
 
     if (inst->Cond()->Type()->Is<FloatType>())
     {
+        // NaN is unordered with zero, and is true as well.
         auto cond = MapPossibleFloat(inst->Cond());
         auto zero = GetFpLabel({ 0, 0 }, cond->Size());
         x64Mem mem{ cond->Size(), std::move(zero) };
-        asmfile_.EmitUcom(&mem, cond);
+        UcomEmitHelper(&mem, cond);
+        BranchHelper({ "ne", "p" }, inst->GetTrueBlk(), inst->GetFalseBlk());
+        return;
+    }
+
+    asmfile_.EmitCmp((unsigned long)0, alloc_->GetIROpMap(inst->Cond()));
+    BranchHelper({ "ne" }, inst->GetTrueBlk(), inst->GetFalseBlk());
+}
+
+
+std::vector<CodeGen::CaseCluster> CodeGen::ClusterCases(
+    std::vector<std::pair<unsigned long, std::string>>& cases,
+    bool issigned, const std::string& deflabel)
+{
+    // A range becomes a jump table if it has at least 4 cases, and at least
+    // 40% of the values in it are cases. Ranges are formed greedily from the
+    // smallest value, each taking as many cases as possible.
+    static const size_t mincases = 4;
+    static const unsigned long maxrange = 4096;
+
+    auto less = [issigned] (unsigned long a, unsigned long b) {
+        return issigned ? static_cast<long>(a) < static_cast<long>(b) : a < b; };
+    std::sort(cases.begin(), cases.end(),
+        [less] (const auto& a, const auto& b) { return less(a.first, b.first); });
+
+    std::vector<CaseCluster> clusters{};
+    for (size_t i = 0; i < cases.size(); )
+    {
+        size_t last = i;
+        for (size_t j = cases.size() - 1; j >= i + mincases - 1 && j > i; --j)
+        {
+            auto range = cases[j].first - cases[i].first;
+            if (range < maxrange && (j - i + 1) * 10 >= (range + 1) * 4)
+            {
+                last = j;
+                break;
+            }
+        }
+
+        CaseCluster cluster{ cases[i].first, cases[last].first, {} };
+        if (last == i)
+            cluster.targets_.push_back(cases[i].second);
+        else
+        {
+            cluster.targets_.resize(cluster.high_ - cluster.low_ + 1, deflabel);
+            for (size_t j = i; j <= last; ++j)
+                cluster.targets_[cases[j].first - cluster.low_] = cases[j].second;
+        }
+        clusters.push_back(std::move(cluster));
+        i = last + 1;
+    }
+    return clusters;
+}
+
+void CodeGen::JumpTableHelper(const CaseCluster& cluster, const std::string& miss)
+{
+    // index = ident - low, which is in the table if it's
+    // not above high - low as an unsigned integer.
+    x64Reg ident{ GetSpareIntReg(0), 8 };
+    x64Reg index{ GetSpareIntReg(1), 8 };
+    asmfile_.EmitMov(&ident, &index);
+    auto low = static_cast<long>(cluster.low_);
+    if (low >= INT32_MIN && low <= INT32_MAX)
+    {
+        if (low != 0)
+            asmfile_.EmitBinary("sub", cluster.low_, &index);
     }
     else
-        asmfile_.EmitCmp((unsigned long)0, alloc_->GetIROpMap(inst->Cond()));
-    asmfile_.EmitJmp("ne", GetLabel(inst->GetTrueBlk()));
-    asmfile_.EmitJmp("", GetLabel(inst->GetFalseBlk()));
+    {
+        asmfile_.EmitBinary("mov", -cluster.low_, &index);
+        asmfile_.EmitBinary("add", &ident, &index);
+    }
+    asmfile_.EmitCmp(cluster.high_ - cluster.low_, &index);
+    asmfile_.EmitJmp("a", miss);
+
+    // Entries are offsets from the table, so it works in PIC as well.
+    auto table = GetLabel();
+    x64Mem addr{ 8, table };
+    x64Mem entry{ 4, 0, ident, index, 4 };
+    asmfile_.EmitLeaq(&addr, &ident);
+    asmfile_.EmitMovs(&entry, &index);
+    asmfile_.EmitBinary("add", &ident, &index);
+    asmfile_.EmitJmp(&index);
+    jumptables_.emplace_back(table, cluster.targets_);
 }
 
+void CodeGen::SwitchSearchHelper(const std::vector<CaseCluster>& clusters,
+    size_t first, size_t last, bool issigned, const std::string& deflabel)
+{
+    x64Reg ident{ GetSpareIntReg(0), 8 };
+    auto compare = [this, &ident] (unsigned long val) {
+        auto sval = static_cast<long>(val);
+        if (sval >= INT32_MIN && sval <= INT32_MAX)
+            asmfile_.EmitCmp(val, &ident);
+        else
+        {
+            x64Reg temp{ GetSpareIntReg(1), 8 };
+            asmfile_.EmitBinary("mov", val, &temp);
+            asmfile_.EmitCmp(&temp, &ident);
+        }
+    };
+
+    // A few clusters are tested one by one.
+    if (last - first <= 3)
+    {
+        for (auto i = first; i < last; ++i)
+        {
+            if (clusters[i].targets_.size() == 1)
+            {
+                compare(clusters[i].low_);
+                asmfile_.EmitJmp("e", clusters[i].targets_.front());
+                continue;
+            }
+            auto miss = i + 1 == last ? deflabel : GetLabel();
+            JumpTableHelper(clusters[i], miss);
+            if (i + 1 != last)
+                asmfile_.EmitLabel(miss);
+        }
+        if (clusters[last - 1].targets_.size() == 1)
+            asmfile_.EmitJmp("", deflabel);
+        return;
+    }
+
+    auto mid = (first + last) / 2;
+    auto left = GetLabel();
+    compare(clusters[mid].low_);
+    asmfile_.EmitJmp(issigned ? "l" : "b", left);
+    SwitchSearchHelper(clusters, mid, last, issigned, deflabel);
+    asmfile_.EmitLabel(left);
+    SwitchSearchHelper(clusters, first, mid, issigned, deflabel);
+}
 
 void CodeGen::VisitSwitchInstr(SwitchInstr* inst)
 {
-    // I use a somewhat straight forward way to translate
-    // the switch instruction. no jump table is used, though.
+    // The identifier is extended to 64 bits in a spare register, and the
+    // cases are found by a balanced binary search over clusters of them,
+    // where dense clusters are looked up in jump tables. See Hennessy &
+    // Mendelsohn, Compilation of the Pascal Case Statement (1982), and
+    // Sayle, A Superoptimizer Analysis of Multiway Branching (2008).
+
+    auto curbb = asmfile_.CurBlock();
+    auto type = inst->GetIdent()->Type()->As<IntType>();
+    bool issigned = type->IsSigned();
+    auto extend = [issigned, size = type->Size()] (unsigned long val) {
+        if (size == 8)
+            return val;
+        auto bits = size * 8;
+        val &= (1ul << bits) - 1;
+        if (issigned && (val >> (bits - 1)))
+            val |= ~0ul << bits;
+        return val;
+    };
+
+    // cases jumping to blocks with phi instructions, and the labels
+    // where copies for the edges are placed
+    std::vector<std::pair<const BasicBlock*, std::string>> edges{};
+    auto target = [this, curbb, &edges] (const BasicBlock* bb) {
+        if (!HasEdgeCode(curbb, bb))
+            return GetLabel(bb);
+        for (const auto& [succ, label] : edges)
+            if (succ == bb)
+                return label;
+        edges.emplace_back(bb, GetLabel());
+        return edges.back().second;
+    };
 
     auto ident = alloc_->GetIROpMap(inst->GetIdent());
-    for (auto [tag, bb] : inst->GetValueBlkPairs())
+    auto deflabel = target(inst->GetDefault());
+    if (auto imm = ident->As<x64Imm>(); imm)
+    {
+        auto val = extend(imm->GetRepr().first);
+        auto label = deflabel;
+        for (auto [tag, bb] : inst->GetValueBlkPairs())
+            if (extend(tag->As<IntConst>()->Val()) == val)
+                label = target(bb);
+        asmfile_.EmitJmp("", label);
+    }
+    else
+    {
+        std::vector<std::pair<unsigned long, std::string>> cases{};
+        for (auto [tag, bb] : inst->GetValueBlkPairs())
+            cases.emplace_back(extend(tag->As<IntConst>()->Val()), target(bb));
+        auto clusters = ClusterCases(cases, issigned, deflabel);
+
+        x64Reg reg{ GetSpareIntReg(0), 8 };
+        if (ident->Size() == 8)
+            asmfile_.EmitMov(ident, &reg);
+        else if (issigned)
+            asmfile_.EmitMovs(ident, &reg);
+        else
+            asmfile_.EmitMovz(ident, &reg);
+        SwitchSearchHelper(clusters, 0, clusters.size(), issigned, deflabel);
+    }
+
+    for (auto& [bb, label] : edges)
+    {
+        asmfile_.EmitLabel(label);
+        PhiCopyHelper(curbb, bb);
+        asmfile_.EmitJmp("", GetLabel(bb));
+    }
+}
+
+
+bool CodeGen::SiblingCall(const CallInstr* inst) const
+{
+    // A call whose result is returned right away can jump to the callee
+    // after the frame is torn down, if the callee needs nothing in it: all
+    // arguments are passed in registers, and no local variable lives in
+    // memory the callee may refer to. xmm6 and xmm7 pass arguments, but are
+    // restored as callee-saved registers here. The return may also follow
+    // a jump to a block of phi instructions, as in the join of a ?:.
+    if (!next_ || !ReturnsResult(inst))
+        return false;
+    if (inst->FuncAddr() || inst->FuncName().rfind("@__Ginkgo_", 0) == 0)
+        return false;
+
+    auto func = alloc_->CurFunc();
+    if (func->Variadic() || func->ReturnType()->Is<HeterType>() ||
+        inst->Proto()->ReturnType()->Is<HeterType>())
+        return false;
+    for (auto param : func->Params())
+        if (param->Type()->Is<HeterType>())
+            return false;
+    for (auto arg : inst->ArgvList())
+        if (arg->Type()->Is<HeterType>())
+            return false;
+    for (auto bb : *func)
+        for (auto i : *bb)
+            if (i->Is<AllocaInstr>())
+                return false;
+
+    SysVConv conv{ inst->Proto(), &inst->ArgvList() };
+    conv.MapArgv();
+    // the stack size counts the padding for alignment as well
+    return conv.StackSize() == conv.Padding() && conv.CountRegs().second <= 6;
+}
+
+bool CodeGen::ReturnsResult(const CallInstr* inst) const
+{
+    const IROperand* result = inst->Result();
+    auto ret = next_->As<RetInstr>();
+    if (auto br = next_->As<BrInstr>(); br && !br->Cond())
     {
-        CmpEmitHelper(ident, alloc_->GetIROpMap(tag));
-        asmfile_.EmitJmp("z", GetLabel(bb));
+        for (auto i : *br->GetTrueBlk())
+        {
+            if (auto phi = i->As<PhiInstr>(); phi)
+            {
+                for (auto [pred, op] : phi->GetBlockValPair())
+                    if (pred == asmfile_.CurBlock() && op == result)
+                        result = phi->Result();
+                continue;
+            }
+            ret = i->As<RetInstr>();
+            break;
+        }
     }
-    asmfile_.EmitJmp("", GetLabel(inst->GetDefault()));
+    return ret && (!ret->ReturnValue() || ret->ReturnValue() == result);
 }
 
+void CodeGen::TailCallHelper(CallInstr* inst)
+{
+    auto proto = inst->Proto();
+    SysVConv conv{ proto, &inst->ArgvList() };
+    conv.MapArgv();
+    PassParam(conv, proto->ParamType().size(), inst->ArgvList());
+
+    auto [_, vec] = conv.CountRegs();
+    if (proto->Variadic())
+    {
+        if (vec == 0)
+        {
+            x64Reg rax{ RegTag::rax };
+            asmfile_.EmitBinary("xor", &rax, &rax);
+        }
+        else
+        {
+            x64Reg al{ RegTag::rax, 1 };
+            asmfile_.EmitMov(vec, &al);
+        }
+    }
+
+    auto oldstacksize = stacksize_;
+    FreeFrame();
+    stacksize_ = oldstacksize;
+    asmfile_.EmitJmp("", inst->FuncName().substr(1) + "@PLT");
+    tailret_ = next_;
+}
 
 void CodeGen::VisitCallInstr(CallInstr* inst)
 {
@@ -1522,15 +2721,20 @@ void CodeGen::VisitCallInstr(CallInstr* inst)
         HandleVaStart(inst);
         return;
     }
+    if (SiblingCall(inst))
+    {
+        TailCallHelper(inst);
+        return;
+    }
 
     // Layout of the stack:
     //         high address
     // +------------------------+
     // |       Local Vars       |
     // +------------------------+
-    // |   Caller Saved Regs    |
+    // |   Callee Saved Regs    |
     // +------------------------+
-    // |        Padding         |
+    // |   Caller Saved Regs    |
     // +------------------------+
     // |  Argvs Passed on Stack |
     // +------------------------+  <- rsp in caller
@@ -1538,7 +2742,7 @@ void CodeGen::VisitCallInstr(CallInstr* inst)
     // +------------------------+
     //         low address
 
-    SaveCallerSaved();
+    SaveCallerSaved(inst);
     auto proto = inst->Proto() ?
         inst->Proto() :
         // Call through a function pointer?
@@ -1547,18 +2751,6 @@ void CodeGen::VisitCallInstr(CallInstr* inst)
     SysVConv conv{ proto, &inst->ArgvList() };
     conv.MapArgv();
 
-    auto [_, vec] = conv.CountRegs();
-    if (proto->Variadic())
-    {
-        if (vec == 0)
-            asmfile_.EmitInstr("    xorq %rax, %rax\n");
-        else
-            asmfile_.EmitInstr("    movb $" + std::to_string(vec) + ", %al\n");
-    }
-
-    auto extra = GetAlign(stacksize_, 16);
-    AdjustRsp(-(conv.Padding() + extra));
-
     if (proto->ReturnType()->Is<HeterType>() && proto->ReturnType()->Size() > 16)
         asmfile_.EmitLeaq(alloc_->GetIROpMap(inst->Result()), RegTag::rdi);
 
@@ -1566,14 +2758,27 @@ void CodeGen::VisitCallInstr(CallInstr* inst)
     // the size of variadic part will be included in conv.StackSize() as well.
     PassParam(conv, proto->ParamType().size(), inst->ArgvList());
 
+    // rax may be used as a temporary while passing parameters
+    auto [_, vec] = conv.CountRegs();
+    if (proto->Variadic())
+    {
+        if (vec == 0)
+        {
+            x64Reg rax{ RegTag::rax };
+            asmfile_.EmitBinary("xor", &rax, &rax);
+        }
+        else
+        {
+            x64Reg al{ RegTag::rax, 1 };
+            asmfile_.EmitMov(vec, &al);
+        }
+    }
+
     if (inst->FuncAddr())
         asmfile_.EmitCall(alloc_->GetIROpMap(inst->FuncAddr()));
     else
         asmfile_.EmitCall(inst->FuncName().substr(1) + "@PLT");
-    // adjust rsp directly here since conv.StackSize()
-    // has already included 'padding'
-    AdjustRsp(conv.StackSize() + extra);
-    RestoreCallerSaved();
+    RestoreCallerSaved(inst);
 
     if (!inst->Result())
         return;
@@ -1602,13 +2807,31 @@ void CodeGen::VisitCallInstr(CallInstr* inst)
 }
 
 
-void CodeGen::VisitAddInstr(AddInstr* inst)     { BinaryGenHelper("add", inst); }
+void CodeGen::VisitAddInstr(AddInstr* inst)
+{
+    if (!LeaGenHelper(inst))
+        BinaryGenHelper("add", inst);
+}
+
+void CodeGen::VisitSubInstr(SubInstr* inst)
+{
+    if (!LeaGenHelper(inst))
+        BinaryGenHelper("sub", inst);
+}
+
+void CodeGen::VisitShlInstr(ShlInstr* inst)
+{
+    // the scaled index of lea for the add after it
+    if (FoldableScale(inst))
+        scaleop_ = inst->Result();
+    else
+        ShiftGenHelper("shl", inst);
+}
+
 void CodeGen::VisitFaddInstr(FaddInstr* inst)   { VarithmGenHelper("add", inst); }
-void CodeGen::VisitSubInstr(SubInstr* inst)     { BinaryGenHelper("sub", inst); }
 void CodeGen::VisitFsubInstr(FsubInstr* inst)   { VarithmGenHelper("sub", inst); }
 void CodeGen::VisitFmulInstr(FmulInstr* inst)   { VarithmGenHelper("mul", inst); }
 void CodeGen::VisitFdivInstr(FdivInstr* inst)   { VarithmGenHelper("div", inst); }
-void CodeGen::VisitShlInstr(ShlInstr* inst)     { ShiftGenHelper("shl", inst); }
 void CodeGen::VisitLshrInstr(LshrInstr* inst)   { ShiftGenHelper("shr", inst); }
 void CodeGen::VisitAshrInstr(AshrInstr* inst)   { ShiftGenHelper("sar", inst); }
 void CodeGen::VisitAndInstr(AndInstr* inst)     { BinaryGenHelper("and", inst); }
@@ -1617,6 +2840,13 @@ void CodeGen::VisitXorInstr(XorInstr* inst)     { BinaryGenHelper("xor", inst);
 
 void CodeGen::VisitMulInstr(MulInstr* inst)
 {
+    if (FoldableScale(inst))
+    {
+        scaleop_ = inst->Result();
+        return;
+    }
+    if (ConstMulGenHelper(inst))
+        return;
     if (inst->Lhs()->Type()->As<IntType>()->IsSigned() ||
         inst->Rhs()->Type()->As<IntType>()->IsSigned())
     {
@@ -1625,12 +2855,14 @@ void CodeGen::VisitMulInstr(MulInstr* inst)
     }
     auto lhs = alloc_->GetIROpMap(inst->Lhs());
     asmfile_.EmitMov(lhs, RegTag::rax);
-    asmfile_.EmitUnary("mul", alloc_->GetIROpMap(inst->Rhs()));
+    asmfile_.EmitUnary("mul", MapPossibleImm(inst->Rhs()));
     asmfile_.EmitMov(RegTag::rax, alloc_->GetIROpMap(inst->Result()));
 }
 
 void CodeGen::VisitDivInstr(DivInstr* inst)
 {
+    if (ConstDivGenHelper(inst, false))
+        return;
     auto ans = PrepareDivMod(inst);
     // if result register is not %*ax, move it to the result register.
     if (!(*ans == RegTag::rax))
@@ -1639,6 +2871,8 @@ void CodeGen::VisitDivInstr(DivInstr* inst)
 
 void CodeGen::VisitModInstr(ModInstr* inst)
 {
+    if (ConstDivGenHelper(inst, true))
+        return;
     auto ans = PrepareDivMod(inst);
     // if result register is not %*dx, move it to the result register.
     if (!(*alloc_->GetIROpMap(inst->Result()) == RegTag::rdx))
@@ -1676,9 +2910,9 @@ void CodeGen::VisitStoreInstr(StoreInstr* inst)
 
             asmfile_.EmitLeaq(mappeddest, RegTag::rdi);
             asmfile_.EmitLeaq(mapped, RegTag::rsi);
-            asmfile_.EmitInstr(fmt::format(
-                "    movq ${}, %rcx\n", value->Type()->Size()));
-            asmfile_.EmitInstr("    rep movsb\n");
+            x64Reg rcx{ RegTag::rcx };
+            asmfile_.EmitMov(value->Type()->Size(), &rcx);
+            asmfile_.EmitRepMovsb();
 
             asmfile_.EmitPop(RegTag::rdi, 8);
             asmfile_.EmitPop(RegTag::rsi, 8);
@@ -1691,6 +2925,14 @@ void CodeGen::VisitStoreInstr(StoreInstr* inst)
     if (value->Type()->Is<PtrType>() &&
         mappedval->Is<x64Mem>() && !mappedval->As<x64Mem>()->LoadTwice())
         LeaqEmitHelper(mappedval, mappeddest);
+    else if (mappedval->Is<x64Mem>())
+    {
+        // the destination addressed by a pointer is 8 bytes
+        // whatever it holds, so size the move by the value
+        x64Reg reg{ GetSpareIntReg(0), value->Type()->Size() };
+        asmfile_.EmitMov(mappedval, &reg);
+        asmfile_.EmitMov(&reg, mappeddest, 0);
+    }
     else
         MovEmitHelper(mappedval, mappeddest, 0);
 }
@@ -1700,6 +2942,46 @@ void CodeGen::VisitLoadInstr(LoadInstr* inst)
     auto result = inst->Result();
     auto mappedptr = LoadPointer(inst->Pointer());
 
+    if (auto bin = ReadModifyWrite(inst); bin)
+    {
+        // load, op, store => op on memory
+        std::string name{};
+        switch (bin->id_)
+        {
+        case Instr::InstrId::add: name = "add"; break;
+        case Instr::InstrId::sub: name = "sub"; break;
+        case Instr::InstrId::btand: name = "and"; break;
+        case Instr::InstrId::btor: name = "or"; break;
+        default: name = "xor"; break;
+        }
+        x64Mem mem{ *mappedptr->As<x64Mem>() };
+        mem.Size() = result->Type()->Size();
+        auto other = alloc_->GetIROpMap(
+            bin->Lhs() == result ? bin->Rhs() : bin->Lhs());
+        auto imm = other->As<x64Imm>();
+        if (other->Is<x64Reg>() || (imm && (imm->Size() < 8 ||
+            (long)imm->GetRepr().first == (int)imm->GetRepr().first)))
+            asmfile_.EmitBinary(name, other, &mem);
+        else
+        {
+            x64Reg temp{ GetSpareIntReg(0), mem.Size() };
+            asmfile_.EmitMov(other, &temp);
+            asmfile_.EmitBinary(name, &temp, &mem);
+        }
+        folded_.insert(bin);
+        folded_.insert(*std::next(curbb_->IterOf(bin)));
+        return;
+    }
+    if (FoldableLoad(inst))
+    {
+        // the extension after it reads the memory instead
+        auto mem = std::make_unique<x64Mem>(*mappedptr->As<x64Mem>());
+        mem->Size() = result->Type()->Size();
+        tempmap_[result] = std::move(mem);
+        loadop_ = result;
+        return;
+    }
+
     if (inst->Pointer()->Name()[0] == '@') // Global variable or extern symbol?
     {
         auto ptr = inst->Pointer()->Type()->As<PtrType>();
@@ -1726,9 +3008,9 @@ void CodeGen::VisitLoadInstr(LoadInstr* inst)
         auto mappedres = alloc_->GetIROpMap(result);
         asmfile_.EmitLeaq(mappedres, RegTag::rdi);
         asmfile_.EmitLeaq(mappedptr, RegTag::rsi);
-        asmfile_.EmitInstr(fmt::format(
-            "    movq ${}, %rcx\n", result->Type()->Size()));
-        asmfile_.EmitInstr("    rep movsb\n");
+        x64Reg rcx{ RegTag::rcx };
+        asmfile_.EmitMov(result->Type()->Size(), &rcx);
+        asmfile_.EmitRepMovsb();
 
         if (used.count(RegTag2X64Phys(RegTag::rcx)))
             asmfile_.EmitPop(RegTag::rdi, 8);
@@ -1747,6 +3029,13 @@ void CodeGen::VisitLoadInstr(LoadInstr* inst)
 
 void CodeGen::VisitGetElePtrInstr(GetElePtrInstr* inst)
 {
+    // computed in the addressing mode of the loads and stores using it
+    if (FoldableAddress(inst))
+    {
+        addrs_[inst->Result()] = inst;
+        return;
+    }
+
     if (inst->HoldsInt()) // Want to get pointer to a field in a structure?
     {
         auto heter = inst->Pointer()->
@@ -1779,17 +3068,7 @@ void CodeGen::VisitGetElePtrInstr(GetElePtrInstr* inst)
         return;
     }
 
-    size_t size = 0;
-    if (auto ptr = inst->Pointer()->Type()->As<PtrType>(); ptr)
-    {
-        if (ptr->Point2()->Is<ArrayType>() && inst->IsInner())
-            size = ptr->Point2()->As<ArrayType>()->ArrayOf()->Size();
-        else
-            size = ptr->Point2()->Size();
-    }
-    else // if "pointer" is an array
-        size = inst->Pointer()->Type()->As<ArrayType>()->ArrayOf()->Size();
-
+    auto size = GetElePtrScale(inst);
     auto pointer = MapPossibleRegister(inst->Pointer())->As<x64Mem>();
     auto index = alloc_->GetIROpMap(inst->OpIndex());
     auto result = alloc_->GetIROpMap(inst->Result());
@@ -1845,17 +3124,30 @@ void CodeGen::VisitFtruncInstr(FtruncInstr* inst)
 
 void CodeGen::VisitZextInstr(ZextInstr* inst)
 {
-    auto from = alloc_->GetIROpMap(inst->Value());
+    auto from = inst->Value() == loadop_ ?
+        tempmap_[loadop_].get() : MapPossibleImm(inst->Value());
     auto to = alloc_->GetIROpMap(inst->Dest());
     if (from->Size() < 4)
+    {
         MovzEmitHelper(from, to);
-    else // clean the higher 32 bits as well
-        asmfile_.EmitMov(from, from);
+        return;
+    }
+
+    // writing to a 32-bit register clears the higher 32 bits as well
+    x64Reg temp{ to->Is<x64Reg>() ?
+        to->As<x64Reg>()->Tag() : GetSpareIntReg(0), from->Size() };
+    asmfile_.EmitMov(from, &temp);
+    if (to->Is<x64Mem>())
+    {
+        temp.Size() = to->Size();
+        asmfile_.EmitMov(&temp, to);
+    }
 }
 
 void CodeGen::VisitSextInstr(SextInstr* inst)
 {
-    auto from = alloc_->GetIROpMap(inst->Value());
+    auto from = inst->Value() == loadop_ ?
+        tempmap_[loadop_].get() : MapPossibleImm(inst->Value());
     auto to = alloc_->GetIROpMap(inst->Dest());
     MovsEmitHelper(from, to);
 }
@@ -1883,12 +3175,22 @@ void CodeGen::VisitFtoSInstr(FtoSInstr* inst)
 
 void CodeGen::VisitUtoFInstr(UtoFInstr* inst)
 {
-    auto from = alloc_->GetIROpMap(inst->Value());
+    auto from = MapPossibleImm(inst->Value());
     auto to = alloc_->GetIROpMap(inst->Dest());
     if (from->Size() != 8)
     {
-        MovzEmitHelper(from->Size(), 8, from);
-        VcvtsiEmitHelper(false, from, to);
+        // zero-extend to 64 bits in a temporary register,
+        // leaving the original operand untouched.
+        x64Reg temp{ GetSpareIntReg(1), 8 };
+        if (from->Size() < 4)
+            asmfile_.EmitMovz(from, &temp);
+        else
+        {
+            temp.Size() = 4;
+            asmfile_.EmitMov(from, &temp);
+            temp.Size() = 8;
+        }
+        VcvtsiEmitHelper(false, &temp, to);
         return;
     }
 
@@ -1920,7 +3222,7 @@ void CodeGen::VisitUtoFInstr(UtoFInstr* inst)
 
 void CodeGen::VisitStoFInstr(StoFInstr* inst)
 {
-    auto from = alloc_->GetIROpMap(inst->Value());
+    auto from = MapPossibleImm(inst->Value());
     auto to = alloc_->GetIROpMap(inst->Dest());
     VcvtsiEmitHelper(true, from, to);
 }
@@ -1947,7 +3249,7 @@ void CodeGen::VisitPtrtoIInstr(PtrtoIInstr* inst)
 
 void CodeGen::VisitItoPtrInstr(ItoPtrInstr* inst)
 {
-    auto from = alloc_->GetIROpMap(inst->Value());
+    auto from = MapPossibleImm(inst->Value());
     auto to = alloc_->GetIROpMap(inst->Dest());
     // LoadTwice has been set in the register allocator,
     // and the destination of itoptr must be a load-twice
@@ -1977,19 +3279,35 @@ void CodeGen::VisitBitcastInstr(BitcastInstr* inst)
             asmfile_.EmitMov(from, to);
         return;
     }
-    else if (from->Is<x64Reg>())
+    else if (from->Is<x64Reg>() || from->Is<x64Imm>())
     {
-        asmfile_.EmitMov(from, to);
+        MovEmitHelper(from, to);
         return;
     }
+    // Only the address of an object is taken; any other
+    // value is simply held in memory, like a phi result.
     auto m = from->As<x64Mem>();
-    if (m->LoadTwice())
+    if (m->LoadTwice() || !inst->Value()->Type()->Is<PtrType>())
         MovEmitHelper(m, to);
     else
         LeaqEmitHelper(m, to);
 }
 
 
+bool CodeGen::FusibleCompare(const Register* result) const
+{
+    if (!next_ || !info_->HasUse(result))
+        return false;
+    const auto& uses = info_->GetUse(result);
+    if (uses.size() != 1 || uses.front() != next_)
+        return false;
+    if (next_->Is<BrInstr>())
+        return true;
+    if (auto select = next_->As<SelectInstr>(); select)
+        return select->CondPair().first == result;
+    return false;
+}
+
 void CodeGen::VisitIcmpInstr(IcmpInstr* inst)
 {
     auto lhs = alloc_->GetIROpMap(inst->Op1());
@@ -1999,45 +3317,115 @@ void CodeGen::VisitIcmpInstr(IcmpInstr* inst)
         inst->Op2()->Type()->As<IntType>()->IsSigned();
 
     CmpEmitHelper(rhs, lhs);
+    if (FusibleCompare(inst->Result()))
+    {
+        flagsop_ = inst->Result();
+        flagscond_ = inst->Cond();
+        flagssigned_ = issigned;
+        flagsfloat_ = false;
+        return;
+    }
     SetEmitHelper(inst->Cond(), issigned, ans);
     if (ans->Size() != 1)
         MovzEmitHelper(1, ans->Size(), ans);
 }
 
 
-void CodeGen::VisitFcmpInstr(FcmpInstr* inst)
+Condition CodeGen::FcmpEmitHelper(const FcmpInstr* inst)
 {
+    // ucomis sets ZF, PF and CF if either operand is NaN, in which case
+    // only != holds. Flags of "above" and "above or equal" are clear then,
+    // so a < b is tested as b > a. Equality needs PF to be checked as well.
     auto lhs = MapPossibleFloat(inst->Op1());
     auto rhs = MapPossibleFloat(inst->Op2());
+    auto cond = inst->Cond();
+    if (cond == Condition::lt || cond == Condition::le)
+    {
+        UcomEmitHelper(lhs, rhs);
+        return cond == Condition::lt ? Condition::gt : Condition::ge;
+    }
+    UcomEmitHelper(rhs, lhs);
+    return cond;
+}
+
+void CodeGen::VisitFcmpInstr(FcmpInstr* inst)
+{
     auto ans = alloc_->GetIROpMap(inst->Result());
+    auto cond = FcmpEmitHelper(inst);
+    bool parity = cond == Condition::eq || cond == Condition::ne;
 
-    UcomEmitHelper(rhs, lhs);
-    asmfile_.EmitSet(Cond2Str(inst->Cond(), false), ans);
-    if (ans->Size() != 1)
-        MovzEmitHelper(1, ans->Size(), ans);
+    // cmov can't test two flags at once
+    if (FusibleCompare(inst->Result()) && !(parity && next_->Is<SelectInstr>()))
+    {
+        flagsop_ = inst->Result();
+        flagscond_ = cond;
+        flagssigned_ = false;
+        flagsfloat_ = true;
+        return;
+    }
+    if (!parity)
+    {
+        SetEmitHelper(cond, false, ans);
+        return;
+    }
+
+    x64Reg flag{ GetSpareIntReg(0), 1 };
+    x64Reg unordered{ GetSpareIntReg(1), 1 };
+    asmfile_.EmitSet(Cond2Str(cond, false), &flag);
+    asmfile_.EmitSet(cond == Condition::eq ? "np" : "p", &unordered);
+    asmfile_.EmitBinary(cond == Condition::eq ? "and" : "or", &unordered, &flag);
+    if (ans->Size() == 1)
+        MovEmitHelper(&flag, ans);
+    else
+        MovzEmitHelper(&flag, ans);
 }
 
 
 void CodeGen::VisitSelectInstr(SelectInstr* inst)
 {
     auto [cond, ty] = inst->CondPair();
-    auto mappedcond = MapPossibleFloat(cond);
     auto v1 = MapPossibleFloat(inst->Value1());
     auto v2 = MapPossibleFloat(inst->Value2());
     auto ans = alloc_->GetIROpMap(inst->Result());
 
-    if (cond->Type()->Is<IntType>())
-        asmfile_.EmitTest(mappedcond, mappedcond);
+    // the first value is selected if sel holds
+    auto sel = ty ? Condition::ne : Condition::eq;
+    bool issigned = false;
+    if (cond == flagsop_)
+    {
+        flagsop_ = nullptr;
+        sel = ty ? flagscond_ : NotCond(flagscond_);
+        issigned = flagssigned_;
+    }
+    else if (cond->Type()->Is<IntType>())
+    {
+        auto mappedcond = cond->Is<IntConst>() ?
+            MapPossibleImm(cond) : MapPossibleFloat(cond);
+        TestEmitHelper(mappedcond, mappedcond);
+    }
     else
     {
+        auto mappedcond = MapPossibleFloat(cond);
         x64Mem zero{ mappedcond->Size(), GetFpLabel(0, mappedcond->Size()) };
         asmfile_.EmitUcom(&zero, mappedcond);
     }
 
-    if (auto t = inst->Result()->Type()->As<IntType>(); t)
+    // The result may share the location with the second
+    // value, which must not be overwritten before the move.
+    if (auto t = inst->Result()->Type()->As<IntType>(); t && *v2 == *ans)
+        CMovEmitHelper(sel, issigned, v1, ans);
+    else if (t)
+    {
+        if (*v1 != *ans)
+            MovEmitHelper(v1, ans);
+        CMovEmitHelper(NotCond(sel), issigned, v2, ans);
+    }
+    else if (*v2 == *ans)
     {
-        asmfile_.EmitMov(v1, ans);
-        CMovEmitHelper(ty ? Condition::eq : Condition::ne, t->IsSigned(), v2, ans);
+        auto temp = GetLabel();
+        asmfile_.EmitJmp(Cond2Str(NotCond(sel), issigned), temp);
+        VecMovEmitHelper(v1, ans);
+        asmfile_.EmitLabel(temp);
     }
     else
     {
@@ -2047,7 +3435,7 @@ void CodeGen::VisitSelectInstr(SelectInstr* inst)
         // so I don't use them here
         auto temp = GetLabel();
         VecMovEmitHelper(v1, ans);
-        asmfile_.EmitJmp(ty ? "e" : "ne", temp);
+        asmfile_.EmitJmp(Cond2Str(sel, issigned), temp);
         VecMovEmitHelper(v2, ans);
         asmfile_.EmitLabel(temp);
     }
@@ -2056,36 +3444,6 @@ void CodeGen::VisitSelectInstr(SelectInstr* inst)
 
 void CodeGen::VisitPhiInstr(PhiInstr* inst)
 {
-    // FIXME: the current implementation can't correctly solve
-    // the lost-copies and phi-swap problems. With limited
-    // use of phi instructions in the code generated by the
-    // front end, however, it's okay to ignore them before
-    // mem2reg pass is actually implemented.
-
-    auto curbb = asmfile_.CurBlock();
-    auto mappedres = alloc_->GetIROpMap(inst->Result());
-
-    for (auto [bb, op] : inst->GetBlockValPair())
-    {
-        asmfile_.SwitchBlock(bb);
-        auto br = bb->LastInstr()->As<BrInstr>();
-        if (br && br->Cond() && !br->Cond()->Is<IntConst>())
-            asmfile_.SetInsertPoint(-2);
-        else if (br /* && !br->Cond() */)
-        // Direct jump; Note that constant condition
-        // is treated as if it were a direct jump
-            asmfile_.SetInsertPoint(-1);
-        else // if the last instruction of bb is SwitchInstr
-        {
-            auto swtch = bb->LastInstr()->As<SwitchInstr>();
-            asmfile_.SetInsertPoint(-(swtch->GetValueBlkPairs().size() * 2 + 1));
-        }
-        if (op->Type()->Is<IntType>())
-            MovEmitHelper(alloc_->GetIROpMap(op), mappedres);
-        else if (op->Type()->Is<FloatType>())
-            VecMovEmitHelper(MapPossibleFloat(op), mappedres);
-    }
-
-    asmfile_.SwitchBlock(curbb);
-    asmfile_.SetInsertPoint(0);
+    // Nothing to do here. Copies for phi instructions are
+    // emitted at the end of predecessors by PhiCopyHelper.
 }
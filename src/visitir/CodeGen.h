@@ -9,11 +9,18 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 class BinaryInstr;
+class BlockLayout;
 class Constant;
+class DUInfo;
+class Instr;
 class IROperand;
+class Liveness;
 class Register;
+class ShrinkWrap;
 class SysVConv;
 class x64;
 class x64Alloc;
@@ -21,6 +28,7 @@ class x64Imm;
 class x64Mem;
 class x64Reg;
 class x64Heter;
+enum class x64Phys;
 enum class Condition;
 enum class RegTag;
 
@@ -28,12 +36,18 @@ enum class RegTag;
 class CodeGen : public IRVisitor
 {
 public:
-    CodeGen(Pipeline* p, x64Alloc* a) : pipeline_(p), alloc_(a) {}
-    CodeGen(const std::string& f, Pipeline* p, x64Alloc* a) : asmfile_(f), pipeline_(p), alloc_(a) {}
+    CodeGen(Pipeline* p, x64Alloc* a, DUInfo* du,
+        Liveness* l, ShrinkWrap* s, BlockLayout* b) : pipeline_(p),
+        alloc_(a), info_(du), live_(l), wrap_(s), layout_(b) {}
+    CodeGen(const std::string& f, Pipeline* p, x64Alloc* a, DUInfo* du,
+        Liveness* l, ShrinkWrap* s, BlockLayout* b) : asmfile_(f), pipeline_(p),
+        alloc_(a), info_(du), live_(l), wrap_(s), layout_(b) {}
 
     void SetSummaryStream(std::ostream* s) { summary_ = s; }
     void AddFuncPass2Print(FunctionPass* p) { funcpass_.push_back(p); }
     void AddModulePass2Print(ModulePass* p) { modulepass_.push_back(p); }
+    void EnablePeephole() { asmfile_.EnablePeephole(); }
+    void PrintPeephole() { peepholeprint_ = true; }
 
     std::string GetAsmName() const { return asmfile_.AsmName(); }
 
@@ -103,6 +117,7 @@ private:
     std::ostream* summary_{};
     std::vector<const FunctionPass*> funcpass_{};
     std::vector<const ModulePass*> modulepass_{};
+    bool peepholeprint_{};
 
 private:
     struct FpRepr
@@ -133,6 +148,17 @@ private:
         size_t size_;
     };
 
+    // Cases of a switch are grouped into clusters, each of which is either
+    // a single case or a range of cases dense enough for a jump table.
+    // Values are sign- or zero-extended to 64 bits.
+    struct CaseCluster
+    {
+        unsigned long low_;
+        unsigned long high_;
+        // one target for each value in the range, holes going to the default
+        std::vector<std::string> targets_;
+    };
+
     std::string GetFpLabel(unsigned long, size_t);
     std::string GetFpLabel(std::pair<unsigned long, unsigned long>, size_t);
     std::string GetLabel() const;
@@ -149,26 +175,63 @@ private:
     // it points to. MapPossibleRegister tackle with this problem.
     const x64* MapPossibleRegister(const IROperand*); 
     const x64* LoadPointer(const Register*);
+    // many instructions (movz, div, test, etc.) don't accept an immediate,
+    // which is common after mem2reg. MapPossibleImm loads it to a register.
+    const x64* MapPossibleImm(const IROperand*);
 
     void AlignRspBy(size_t, size_t);
     void AdjustRsp(long);
     void DeallocFrame();
+    // Restore the callee-saved registers and free the frame before leaving.
+    void FreeFrame();
 
     void MapHeterParam(const x64Mem*, const x64Heter*);
-    void MapPtrParam2Mem(const x64*);
+    void MapPtrParam2Mem(const x64*, const x64Mem*);
     void MapPtrParam2Reg(const x64*, const x64Reg*);
-    void MapFltParam2Mem(const x64*);
+    void MapFltParam2Mem(const x64*, const x64Mem*);
     void MapFltParam2Reg(const x64*, const x64Reg*);
-    void MapOtherParam2Mem(const x64*);
+    void MapOtherParam2Mem(const x64*, const x64Mem*);
     void MapOtherParam2Reg(const x64*, const x64Reg*);
     void PassParam(const SysVConv&, int, const std::vector<const IROperand*>&);
 
     void SaveCalleeSaved();
     void RestoreCalleeSaved();
-    void SaveCallerSaved();
-    void RestoreCallerSaved();
+    // With shrink-wrapping, the slots of callee-saved registers are
+    // reserved in the prologue, and filled at their save points instead.
+    void AllocCalleeSlots();
+    void StoreCalleeSaved(const std::vector<x64Phys>&);
+    void LoadCalleeSaved(const std::vector<x64Phys>&);
+    // Only caller-saved registers holding values live across the call
+    // are saved, which the allocators other than SimpleAlloc avoid anyway.
+    std::vector<RegTag> LiveAcrossCall(const CallInstr*);
+    void SaveCallerSaved(const CallInstr*);
+    void RestoreCallerSaved(const CallInstr*);
+    // Reserve the slots for caller-saved registers and the outgoing
+    // arguments once in the prologue, so rsp stays put around calls.
+    void AllocCallArea(const Function*);
 
     void HandleVaStart(CallInstr*);
+    bool SiblingCall(const CallInstr*) const;
+    bool ReturnsResult(const CallInstr*) const;
+    void TailCallHelper(CallInstr*);
+
+    // Phi instructions are lowered to copies on the edge from the
+    // current block to its successor, emitted right before the jump,
+    // followed by restores of callee-saved registers leaving the region
+    // where they are saved.
+    bool HasEdgeCode(const BasicBlock*, const BasicBlock*) const;
+    void PhiCopyHelper(const BasicBlock*, const BasicBlock*);
+    // Jump to the first block if any of the conditions holds,
+    // or to the second one otherwise.
+    void BranchHelper(const std::vector<std::string>&,
+        const BasicBlock*, const BasicBlock*);
+    void ParallelMove(std::vector<std::pair<const x64*, const x64*>>&);
+
+    std::vector<CaseCluster> ClusterCases(
+        std::vector<std::pair<unsigned long, std::string>>&, bool, const std::string&);
+    void SwitchSearchHelper(const std::vector<CaseCluster>&,
+        size_t, size_t, bool, const std::string&);
+    void JumpTableHelper(const CaseCluster&, const std::string&);
 
     void Copy8Bytes(const x64*, RegTag, RegTag, size_t);
     void Copy8Bytes(RegTag, const x64Mem*, size_t);
@@ -182,14 +245,32 @@ private:
     RegTag GetSpareIntReg(int) const;
     RegTag GetSpareVecReg(int) const;
 
+    size_t GetElePtrScale(const GetElePtrInstr*) const;
     void GetElePtrImmHelper(const x64Mem*, const x64Imm*, const x64*, size_t);
     void GetElePtrRegHelper(const x64Mem*, const x64Reg*, const x64*, size_t);
     void GetElePtrMemHelper(const x64Mem*, const x64Mem*, const x64*, size_t);
 
+    // Patterns spanning several instructions, matched on the IR in the
+    // current block: a geteleptr only used as the address of loads and
+    // stores becomes base + index * scale + displacement in them, a load
+    // extended right after becomes movz or movs from memory, a scaled
+    // index added to something becomes lea, and load, op, store on the
+    // same address becomes the op on memory.
+    std::unique_ptr<x64Mem> FoldAddress(const GetElePtrInstr*, bool);
+    bool FoldableAddress(const GetElePtrInstr*);
+    bool FoldableLoad(const LoadInstr*) const;
+    const BinaryInstr* ReadModifyWrite(const LoadInstr*) const;
+    bool FoldableScale(const BinaryInstr*) const;
+    bool LeaGenHelper(const BinaryInstr*);
+
     void BinaryGenHelper(const std::string&, const BinaryInstr*);
     void VarithmGenHelper(const std::string&, const BinaryInstr*);
     void ShiftGenHelper(const std::string&, const BinaryInstr*);
     const x64* PrepareDivMod(const BinaryInstr*);
+    // Multiplication and division by a constant without imul, div or idiv
+    // where cheaper sequences exist. Return false if there is none.
+    bool ConstMulGenHelper(const BinaryInstr*);
+    bool ConstDivGenHelper(const BinaryInstr*, bool mod);
 
     void LeaqEmitHelper(const x64*, const x64*);
     void MovEmitHelper(const x64*, const x64*, int = 1);
@@ -215,6 +296,8 @@ private:
 
     void CMovEmitHelper(Condition, bool, const x64*, const x64*);
     void CmpEmitHelper(const x64*, const x64*);
+    Condition FcmpEmitHelper(const FcmpInstr*);
+    bool FusibleCompare(const Register*) const;
     void SetEmitHelper(Condition, bool, const x64*);
     void TestEmitHelper(const x64*, const x64*);
 
@@ -226,9 +309,42 @@ private:
     std::unordered_map<
         const IROperand*, std::unique_ptr<const x64>> tempmap_{};
     std::unordered_map<FpRepr, std::string, FpRepr::Hash, FpRepr::Equal> fpconst_{};
+    // jump tables of switches, emitted with the float point constants
+    std::vector<std::pair<std::string, std::vector<std::string>>> jumptables_{};
+
+    // A comparison used only by the branch or select right after it
+    // leaves its result in the flags, rather than in a register.
+    const Instr* next_{};
+    const IROperand* flagsop_{};
+    Condition flagscond_{};
+    bool flagssigned_{};
+    bool flagsfloat_{};
+    // geteleptrs folded into the addresses using them, a load folded
+    // into the extension after it, a scaled index folded into the add
+    // after it, and instructions already emitted with an earlier one
+    const BasicBlock* curbb_{};
+    std::unordered_map<const IROperand*, const GetElePtrInstr*> addrs_{};
+    const IROperand* loadop_{};
+    const IROperand* scaleop_{};
+    std::unordered_set<const Instr*> folded_{};
+    // the return (or jump to it) following a sibling call, never reached
+    const Instr* tailret_{};
+    // caller-saved registers saved around each call, their slots
+    // off rsp, and the size of the area reserved for calls
+    std::unordered_map<const CallInstr*, std::vector<RegTag>> callersaved_{};
+    std::unordered_map<RegTag, long> saveslots_{};
+    size_t callarea_{};
+    // rbp-relative slots of callee-saved registers if shrink-wrapped
+    std::unordered_map<RegTag, long> calleeslots_{};
+    size_t calleearea_{};
 
     Pipeline* pipeline_{};
     x64Alloc* alloc_{};
+    DUInfo* info_{};
+    Liveness* live_{};
+    // nullptr if not optimizing
+    ShrinkWrap* wrap_{};
+    BlockLayout* layout_{};
     EmitAsm asmfile_{ "" };
 };
 
@@ -5,15 +5,20 @@
 #define INDENT "    "
 
 
-static char GetIntTag(const x64* op)
+static char GetIntTag(size_t size)
 {
-    if (op->Size() == 1) return 'b';
-    if (op->Size() == 2) return 'w';
-    if (op->Size() == 4) return 'l';
-    if (op->Size() == 8) return 'q';
+    if (size == 1) return 'b';
+    if (size == 2) return 'w';
+    if (size == 4) return 'l';
+    if (size == 8) return 'q';
     return '\0';
 }
 
+static char GetIntTag(const x64* op)
+{
+    return GetIntTag(op->Size());
+}
+
 static std::string GetFltTag(const x64* op)
 {
     if (op->Size() == 4)
@@ -24,21 +29,24 @@ static std::string GetFltTag(const x64* op)
 }
 
 
-void EmitAsm::EmitInstr(const std::string& str)
+#define OP(x) AsmOperand::Of(x)
+
+
+void EmitAsm::EmitInstr(AsmInstr inst)
 {
     if (write2file_)
-        file_ << str;
+        file_ << inst.ToString();
     else if (insertpoint_ == 0)
-        blks_[curblk_].push_back(str);
+        blks_[curblk_].push_back(std::move(inst));
     else if (insertpoint_ < 0)
     {
         auto pos = (blks_[curblk_].crbegin() - insertpoint_).base();
-        blks_[curblk_].insert(pos, str);
+        blks_[curblk_].insert(pos, std::move(inst));
     }
     else // if (insertpoint_ > 0)
     {
         auto pos = blks_[curblk_].cbegin() + (insertpoint_ - 1);
-        blks_[curblk_].insert(pos, str);
+        blks_[curblk_].insert(pos, std::move(inst));
     }
 }
 
@@ -56,9 +64,22 @@ void EmitAsm::SwitchBlock(const BasicBlock* bb)
 
 void EmitAsm::Dump2File()
 {
-    for (auto bb : blkindexes_)
-        for (auto s : blks_[bb])
-            file_ << s;
+    if (optimize_)
+    {
+        std::vector<AsmInstr> code{};
+        for (auto bb : blkindexes_)
+            for (auto& inst : blks_[bb])
+                code.push_back(std::move(inst));
+        peephole_.Run(code);
+        for (const auto& inst : code)
+            file_ << inst.ToString();
+    }
+    else
+    {
+        for (auto bb : blkindexes_)
+            for (const auto& inst : blks_[bb])
+                file_ << inst.ToString();
+    }
 
     blks_.clear();
     blkindexes_.clear();
@@ -69,17 +90,17 @@ void EmitAsm::Dump2File()
 
 void EmitAsm::EmitBlankLine()
 {
-    EmitInstr("\n");
+    EmitInstr(AsmInstr::Other(""));
 }
 
 void EmitAsm::EmitLabel(const std::string& label)
 {
-    EmitInstr(fmt::format("{}:\n", label));
+    EmitInstr(AsmInstr::Label(label));
 }
 
 void EmitAsm::EmitPseudoInstr(const std::string& instr)
 {
-    EmitInstr(fmt::format(INDENT "{}\n", instr));
+    EmitInstr(AsmInstr::Other(fmt::format(INDENT "{}", instr)));
 }
 
 void EmitAsm::EmitPseudoInstr(
@@ -88,8 +109,8 @@ void EmitAsm::EmitPseudoInstr(
     std::string line = fmt::format(INDENT "{} ", instr);
     for (auto i = args.begin(); i < args.end() - 1; ++i)
         line += fmt::format("{}, ", *i);
-    line += fmt::format("{}\n", *(args.end() - 1));
-    EmitInstr(line);
+    line += *(args.end() - 1);
+    EmitInstr(AsmInstr::Other(line));
 }
 
 
@@ -97,13 +118,17 @@ void EmitAsm::EmitCxtx(size_t size)
 {
     char from = size == 4 ? 'l' : 'q';
     char to = size == 4 ? 'd' : 'o';
-    EmitInstr(fmt::format(INDENT "c{}t{}\n", from, to));
+    EmitInstr(fmt::format("c{}t{}", from, to));
+}
+
+void EmitAsm::EmitRepMovsb()
+{
+    EmitInstr("rep movsb");
 }
 
 void EmitAsm::EmitLeaq(const x64* addr, const x64* dest)
 {
-    EmitInstr(fmt::format(
-        INDENT "leaq {}, {}\n", addr->ToString(), dest->ToString()));
+    EmitInstr("leaq", { OP(addr), OP(dest) });
 }
 
 void EmitAsm::EmitLeaq(const x64* addr, RegTag dest)
@@ -114,20 +139,17 @@ void EmitAsm::EmitLeaq(const x64* addr, RegTag dest)
 
 void EmitAsm::EmitUnary(const std::string& instr, const x64* op)
 {
-    EmitInstr(fmt::format(
-        INDENT "{}{} {}\n", instr, GetIntTag(op), op->ToString()));
+    EmitInstr(instr + GetIntTag(op), { OP(op) });
 }
 
 void EmitAsm::EmitBinary(const std::string& instr, unsigned long imm, const x64* op)
 {
-    EmitInstr(fmt::format(INDENT "{}{} ${}, {}\n",
-        instr, GetIntTag(op), std::to_string(imm), op->ToString()));
+    EmitInstr(instr + GetIntTag(op), { AsmOperand::Imm(imm), OP(op) });
 }
 
 void EmitAsm::EmitBinary(const std::string& instr, const x64* op1, const x64* op2)
 {
-    EmitInstr(fmt::format(INDENT "{}{} {}, {}\n",
-        instr, GetIntTag(op1), op1->ToString(), op2->ToString()));
+    EmitInstr(instr + GetIntTag(op1), { OP(op1), OP(op2) });
 }
 
 
@@ -137,14 +159,11 @@ void EmitAsm::EmitVarithm(const std::string& instr, const x64* op1,
     auto precision = GetFltTag(op1);
 
     if (instr == "sqrt")
-        EmitInstr(fmt::format(INDENT "{}{} {}, {}\n",
-            instr, precision, op1->ToString(), dest->ToString()));
+        EmitInstr(instr + precision, { OP(op1), OP(dest) });
     else if (instr == "and")
-        EmitInstr(fmt::format(INDENT "{}{} {}, {}, {}\n",
-            instr, precision, op1->ToString(), op2->ToString(), dest->ToString()));
+        EmitInstr(instr + precision, { OP(op1), OP(op2), OP(dest) });
     else
-        EmitInstr(fmt::format(INDENT "v{}{} {}, {}, {}\n",
-            instr, precision, op1->ToString(), op2->ToString(), dest->ToString()));
+        EmitInstr('v' + instr + precision, { OP(op1), OP(op2), OP(dest) });
 }
 
 void EmitAsm::EmitVarithm(const std::string& instr, RegTag op1, RegTag op2, RegTag op3)
@@ -158,9 +177,7 @@ void EmitAsm::EmitVcvtt(const x64* src, const x64* dest)
 {
     auto from = GetFltTag(src);
     auto to = GetIntTag(dest);
-
-    EmitInstr(fmt::format(INDENT "vcvtt{}2si{} {}, {}\n",
-        from, to, src->ToString(), dest->ToString()));
+    EmitInstr(fmt::format("vcvtt{}2si{}", from, to), { OP(src), OP(dest) });
 }
 
 void EmitAsm::EmitVcvtt(const x64* op1, RegTag op2)
@@ -174,10 +191,7 @@ void EmitAsm::EmitVcvt(const x64* op1, const x64* dest)
 {
     auto from = GetFltTag(op1);
     auto to = GetFltTag(dest);
-    auto sdest = dest->ToString();
-
-    EmitInstr(fmt::format(INDENT "vcvt{}2{} {}, {}, {}\n",
-        from, to, op1->ToString(), sdest, sdest));
+    EmitInstr(fmt::format("vcvt{}2{}", from, to), { OP(op1), OP(dest), OP(dest) });
 }
 
 void EmitAsm::EmitVcvt(const x64* op1, RegTag op2)
@@ -190,10 +204,7 @@ void EmitAsm::EmitVcvtsi(const x64* op1, const x64* dest)
 {
     auto t2 = GetFltTag(dest);
     auto suffix = GetIntTag(op1);
-    auto sdest = dest->ToString();
-
-    EmitInstr(fmt::format(INDENT "vcvtsi2{}{} {}, {}, {}\n",
-        t2, suffix, op1->ToString(), sdest, sdest));
+    EmitInstr(fmt::format("vcvtsi2{}{}", t2, suffix), { OP(op1), OP(dest), OP(dest) });
 }
 
 void EmitAsm::EmitVcvtsi(const x64* op1, RegTag op2)
@@ -205,8 +216,7 @@ void EmitAsm::EmitVcvtsi(const x64* op1, RegTag op2)
 
 void EmitAsm::EmitUcom(const x64* op1, const x64* op2)
 {
-   EmitInstr(fmt::format(INDENT "vucomi{} {}, {}\n",
-        GetFltTag(op1), op1->ToString(), op2->ToString()));
+    EmitInstr("vucomi" + GetFltTag(op1), { OP(op1), OP(op2) });
 }
 
 void EmitAsm::EmitUcom(const x64* op1, RegTag op2)
@@ -219,109 +229,100 @@ void EmitAsm::EmitUcom(const x64* op1, RegTag op2)
 void EmitAsm::EmitMov(const x64* src, const x64* dest, int suffix)
 {
     char tag = suffix == 0 ? GetIntTag(src) : GetIntTag(dest);
-    EmitInstr(fmt::format(INDENT "mov{} {}, {}\n",
-        tag, src->ToString(), dest->ToString()));
+    EmitInstr(std::string("mov") + tag, { OP(src), OP(dest) });
+}
+
+void EmitAsm::EmitMov(unsigned long imm, const x64* dest)
+{
+    EmitInstr(std::string("mov") + GetIntTag(dest), { AsmOperand::Imm(imm), OP(dest) });
 }
 
 void EmitAsm::EmitMov(const x64* src, RegTag tag)
 {
     auto dest = x64Reg(tag, src->Size());
-    EmitInstr(fmt::format(INDENT "mov{} {}, {}\n",
-        GetIntTag(src), src->ToString(), dest.ToString()));
+    EmitMov(src, &dest, 0);
 }
 
 void EmitAsm::EmitMov(RegTag tag, const x64* dest)
 {
     auto src = x64Reg(tag, dest->Size());
-    EmitInstr(fmt::format(INDENT "mov{} {}, {}\n",
-        GetIntTag(dest), src.ToString(), dest->ToString()));
+    EmitMov(&src, dest);
 }
 
 void EmitAsm::EmitMov(RegTag tag, long offset)
 {
     auto src = x64Reg(tag, 8);
     auto rsp = x64Mem(8, offset, RegTag::rsp, RegTag::none, 0);
-    EmitInstr(fmt::format(
-        INDENT "movq {}, {}\n", src.ToString(), rsp.ToString()));
+    EmitMov(&src, &rsp);
 }
 
 void EmitAsm::EmitMovz(const x64* src, const x64* dest)
 {
+    // There's no movzlq. Writing to a 32-bit register
+    // clears the higher 32 bits as well.
+    if (src->Size() == 4 && dest->Size() == 8)
+    {
+        auto lower = OP(dest);
+        lower.size_ = 4;
+        EmitInstr("movl", { OP(src), lower });
+        return;
+    }
+
     char from = GetIntTag(src);
     char to = GetIntTag(dest);
-    EmitInstr(fmt::format(INDENT "movz{}{} {}, {}\n",
-        from, to, src->ToString(), dest->ToString()));
+    EmitInstr(fmt::format("movz{}{}", from, to), { OP(src), OP(dest) });
 }
 
 void EmitAsm::EmitMovz(size_t from, size_t to, const x64* op)
 {
-    auto original = op->Size();
-
-    const_cast<x64*>(op)->Size() = from;
-    auto sfrm = op->ToString();
-    auto tfrm = GetIntTag(op);
+    auto sfrm = OP(op), sto = OP(op);
+    sfrm.size_ = from;
+    sto.size_ = to;
 
-    const_cast<x64*>(op)->Size() = to;
-    auto sto = op->ToString();
-    auto tto = GetIntTag(op);
-
-    EmitInstr(fmt::format(
-        INDENT "movz{}{} {}, {}\n", tfrm, tto, sfrm, sto));
-
-    const_cast<x64*>(op)->Size() = original;
+    if (from == 4 && to == 8)
+        EmitInstr("movl", { sfrm, sfrm });
+    else
+        EmitInstr(fmt::format("movz{}{}",
+            GetIntTag(from), GetIntTag(to)), { sfrm, sto });
 }
 
 void EmitAsm::EmitMovs(const x64* src, const x64* dest)
 {
     char from = GetIntTag(src);
     char to = GetIntTag(dest);
-    EmitInstr(fmt::format(INDENT "movs{}{} {}, {}\n",
-        from, to, src->ToString(), dest->ToString()));
+    EmitInstr(fmt::format("movs{}{}", from, to), { OP(src), OP(dest) });
 }
 
 void EmitAsm::EmitMovs(size_t from, size_t to, const x64* op)
 {
-    auto original = op->Size();
-
-    const_cast<x64*>(op)->Size() = from;
-    auto sfrm = op->ToString();
-    auto tfrm = GetIntTag(op);
-
-    const_cast<x64*>(op)->Size() = to;
-    auto sto = op->ToString();
-    auto tto = GetIntTag(op);
-
-    EmitInstr(fmt::format(
-        INDENT "movs{}{} {}, {}\n", tfrm, tto, sfrm, sto));
-
-    const_cast<x64*>(op)->Size() = original;
+    auto sfrm = OP(op), sto = OP(op);
+    sfrm.size_ = from;
+    sto.size_ = to;
+    EmitInstr(fmt::format("movs{}{}",
+        GetIntTag(from), GetIntTag(to)), { sfrm, sto });
 }
 
 
 void EmitAsm::EmitVmov(const x64* src, const x64* dest)
 {
-    EmitInstr(fmt::format(INDENT "vmov{} {}, {}\n",
-        GetFltTag(src), src->ToString(), dest->ToString()));
+    EmitInstr("vmov" + GetFltTag(src), { OP(src), OP(dest) });
 }
 
 void EmitAsm::EmitVmov(const x64* src, RegTag dest)
 {
     auto destreg = x64Reg(dest, src->Size());
-    EmitInstr(fmt::format(INDENT "vmov{} {}, {}\n",
-        GetFltTag(src), src->ToString(), destreg.ToString()));
+    EmitVmov(src, &destreg);
 }
 
 void EmitAsm::EmitVmov(RegTag src, const x64* dest)
 {
     auto srcreg = x64Reg(src, dest->Size());
-    EmitInstr(fmt::format(INDENT "vmov{} {}, {}\n",
-        GetFltTag(dest), srcreg.ToString(), dest->ToString()));
+    EmitInstr("vmov" + GetFltTag(dest), { OP(&srcreg), OP(dest) });
 }
 
 void EmitAsm::EmitVmovap(const x64Reg* src, const x64Reg* dest)
 {
-    EmitInstr(fmt::format(INDENT "vmovap{} {}, {}\n",
-        GetFltTag(src)[1], src->ToString(), dest->ToString()));
+    EmitInstr(std::string("vmovap") + GetFltTag(src)[1], { OP(src), OP(dest) });
 }
 
 void EmitAsm::EmitVmovap(const x64Reg* src, RegTag dest)
@@ -343,11 +344,21 @@ void EmitAsm::EmitVmov(RegTag src, long offset)
     EmitVmov(&reg, &rsp);
 }
 
+void EmitAsm::EmitVmovq(const x64* src, const x64* dest)
+{
+    EmitInstr("vmovq", { OP(src), OP(dest) });
+}
+
+void EmitAsm::EmitVmovq(RegTag src, RegTag dest)
+{
+    x64Reg from{ src }, to{ dest };
+    EmitVmovq(&from, &to);
+}
+
 
 void EmitAsm::EmitPop(const x64* dest)
 {
-    EmitInstr(fmt::format(INDENT "pop{} {}\n",
-        GetIntTag(dest), dest->ToString()));
+    EmitInstr(std::string("pop") + GetIntTag(dest), { OP(dest) });
 }
 
 void EmitAsm::EmitPop(RegTag tag, size_t size)
@@ -358,8 +369,11 @@ void EmitAsm::EmitPop(RegTag tag, size_t size)
 
 void EmitAsm::EmitPush(const x64* dest)
 {
-    EmitInstr(fmt::format(INDENT "push{} {}\n",
-        GetIntTag(dest), dest->ToString()));
+    // Immediates are always pushed as quadwords.
+    if (dest->Is<x64Imm>())
+        EmitInstr("pushq", { OP(dest) });
+    else
+        EmitInstr(std::string("push") + GetIntTag(dest), { OP(dest) });
 }
 
 void EmitAsm::EmitPush(RegTag tag, size_t size)
@@ -371,42 +385,44 @@ void EmitAsm::EmitPush(RegTag tag, size_t size)
 
 void EmitAsm::EmitCall(const std::string& func)
 {
-    EmitInstr(fmt::format(INDENT "call {}\n", func));
+    EmitInstr("call", { AsmOperand::Label(func) });
 }
 
 void EmitAsm::EmitCall(const x64* func)
 {
-    EmitInstr(fmt::format(INDENT "call *{}\n", func->ToString()));
+    EmitInstr("call", { AsmOperand::Indirect(func) });
 }
 
 void EmitAsm::EmitLeave()
 {
-    EmitInstr(INDENT "leave\n");
+    EmitInstr("leave");
 }
 
 void EmitAsm::EmitRet()
 {
-    EmitInstr(INDENT "ret\n");
+    EmitInstr("ret");
 }
 
 
 void EmitAsm::EmitJmp(const std::string& cond, const std::string& label)
 {
-    EmitInstr(fmt::format(INDENT "j{} {}\n",
-        cond.empty() ? "mp" : cond, label));
+    EmitInstr('j' + (cond.empty() ? "mp" : cond), { AsmOperand::Label(label) });
+}
+
+void EmitAsm::EmitJmp(const x64* target)
+{
+    EmitInstr("jmp", { AsmOperand::Indirect(target) });
 }
 
 void EmitAsm::EmitCMov(const std::string& cond, const x64* op1, const x64* op2)
 {
-    EmitInstr(fmt::format(INDENT "cmov{} {}, {}\n",
-        cond, op1->ToString(), op2->ToString()));
+    EmitInstr("cmov" + cond, { OP(op1), OP(op2) });
 }
 
 
 void EmitAsm::EmitCmp(const x64* op1, const x64* op2)
 {
-    EmitInstr(fmt::format(INDENT "cmp{} {}, {}\n",
-        GetIntTag(op1), op1->ToString(), op2->ToString()));
+    EmitInstr(std::string("cmp") + GetIntTag(op1), { OP(op1), OP(op2) });
 }
 
 void EmitAsm::EmitCmp(const x64* op1, RegTag op2)
@@ -417,14 +433,12 @@ void EmitAsm::EmitCmp(const x64* op1, RegTag op2)
 
 void EmitAsm::EmitCmp(unsigned long c, const x64* op1)
 {
-    EmitInstr(fmt::format(INDENT "cmp{} ${}, {}\n",
-        GetIntTag(op1), std::to_string(c), op1->ToString()));
+    EmitInstr(std::string("cmp") + GetIntTag(op1), { AsmOperand::Imm(c), OP(op1) });
 }
 
 void EmitAsm::EmitTest(const x64* op1, const x64* op2)
 {
-    EmitInstr(fmt::format(INDENT "test{} {}, {}\n",
-        GetIntTag(op1), op1->ToString(), op2->ToString()));
+    EmitInstr(std::string("test") + GetIntTag(op1), { OP(op1), OP(op2) });
 }
 
 void EmitAsm::EmitTest(RegTag op1, const x64* op2)
@@ -435,19 +449,18 @@ void EmitAsm::EmitTest(RegTag op1, const x64* op2)
 
 void EmitAsm::EmitTest(const x64* op1, unsigned long c)
 {
-    EmitInstr(fmt::format(INDENT "test{} {}, ${}\n",
-        GetIntTag(op1), std::to_string(c), op1->ToString()));
+    EmitInstr(std::string("test") + GetIntTag(op1), { AsmOperand::Imm(c), OP(op1) });
 }
 
 void EmitAsm::EmitSet(const std::string& cond, const x64* dest)
 {
-    EmitInstr(fmt::format(INDENT "set{} {}\n",
-        cond, dest->ToString()));
+    EmitInstr("set" + cond, { OP(dest) });
 }
 
 void EmitAsm::EmitSet(const std::string& cond, RegTag dest)
 {
     x64Reg reg{ dest, 1 };
-    EmitInstr(fmt::format(INDENT "set{} {}\n",
-        cond, reg.ToString()));
+    EmitSet(cond, &reg);
 }
+
+#undef OP
@@ -1,6 +1,7 @@
 #ifndef _EMIT_ASM_H_
 #define _EMIT_ASM_H_
 
+#include "visitir/Peephole.h"
 #include <cstdio>
 #include <fstream>
 #include <initializer_list>
@@ -31,7 +32,9 @@ public:
     void Write2Mem() { write2file_ = false; }
     void Dump2File();
 
-    void EmitInstr(const std::string&);
+    // Instructions in memory go through the peephole optimizer when dumped.
+    void EnablePeephole() { optimize_ = true; }
+    const Peephole& GetPeephole() const { return peephole_; }
 
     void EmitBlankLine();
     void EmitLabel(const std::string&);
@@ -40,6 +43,7 @@ public:
         const std::string&, std::initializer_list<std::string>);
 
     void EmitCxtx(size_t);
+    void EmitRepMovsb();
     void EmitLeaq(const x64* addr, const x64* dest);
     void EmitLeaq(const x64* addr, RegTag dest);
     void EmitUnary(const std::string& instr, const x64* op);
@@ -62,6 +66,7 @@ public:
     void EmitUcom(const x64* op1, RegTag op2);
 
     void EmitMov(const x64* src, const x64* dest, int = 1);
+    void EmitMov(unsigned long imm, const x64* dest);
     void EmitMov(RegTag, const x64* dest);
     void EmitMov(const x64* src, RegTag);
     void EmitMov(RegTag, long offset);
@@ -74,6 +79,9 @@ public:
     void EmitVmov(const x64* src, RegTag);
     void EmitVmov(RegTag, const x64* dest);
     void EmitVmov(RegTag, long offset);
+    // between a general purpose register and a vector one
+    void EmitVmovq(const x64* src, const x64* dest);
+    void EmitVmovq(RegTag, RegTag);
     void EmitVmovap(const x64Reg* src, const x64Reg* dest);
     void EmitVmovap(const x64Reg* src, RegTag dest);
     void EmitVmovap(RegTag, const x64Reg*);
@@ -89,6 +97,7 @@ public:
     void EmitRet();
 
     void EmitJmp(const std::string&, const std::string&);
+    void EmitJmp(const x64* target);
     void EmitCMov(const std::string& cond, const x64* op1, const x64* op2);
 
     void EmitCmp(const x64* op1, const x64* op2);
@@ -101,6 +110,10 @@ public:
     void EmitSet(const std::string& cond, RegTag dest);
 
 private:
+    void EmitInstr(AsmInstr);
+    void EmitInstr(const std::string& opcode, std::vector<AsmOperand> ops = {})
+    { EmitInstr(AsmInstr::Instr(opcode, std::move(ops))); }
+
     mutable int labelindex_{};
 
     // Similar to InsertPoint in IRBuilder, but is simpler than it.
@@ -109,13 +122,16 @@ private:
     // < 0: insert before the -insertpoint_ th to the last instruction in current block
     int insertpoint_{};
     std::unordered_map<
-        const BasicBlock*, std::vector<std::string>> blks_{};
+        const BasicBlock*, std::vector<AsmInstr>> blks_{};
     std::vector<const BasicBlock*> blkindexes_{};
     const BasicBlock* curblk_{};
 
     std::string filename_{};
     std::ofstream file_{};
     bool write2file_{ true };
+
+    bool optimize_{};
+    Peephole peephole_{};
 };
 
 #endif // _EMIT_ASM_H_
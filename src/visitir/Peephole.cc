@@ -0,0 +1,533 @@
+#include "visitir/Peephole.h"
+#include "visitir/x64.h"
+#include <cstdlib>
+#include <fmt/format.h>
+#include <unordered_map>
+
+#define INDENT "    "
+
+
+static bool StartsWith(const std::string& str, const char* prefix)
+{
+    return str.rfind(prefix, 0) == 0;
+}
+
+// Is the opcode the base followed by an optional size suffix?
+static bool IsOpcode(const std::string& opcode, const char* base)
+{
+    if (!StartsWith(opcode, base))
+        return false;
+    auto rest = opcode.substr(std::char_traits<char>::length(base));
+    return rest.empty() || rest == "b" || rest == "w" || rest == "l" || rest == "q";
+}
+
+static bool IsIntMov(const std::string& opcode)
+{
+    return opcode == "movb" || opcode == "movw" ||
+        opcode == "movl" || opcode == "movq";
+}
+
+static bool IsShift(const std::string& opcode)
+{
+    return IsOpcode(opcode, "shl") || IsOpcode(opcode, "shr") ||
+        IsOpcode(opcode, "sar") || IsOpcode(opcode, "sal");
+}
+
+static bool IsRspAdjust(const AsmInstr& inst)
+{
+    return (inst.opcode_ == "addq" || inst.opcode_ == "subq") &&
+        inst.operands_.size() == 2 && inst.operands_[0].IsImm() &&
+        inst.operands_[1].IsReg() && inst.operands_[1].reg_ == RegTag::rsp;
+}
+
+// A 32-bit operation on a register clears the upper half of it,
+// so it is not a no-op even if the lower half is left unchanged.
+static bool ClearsUpper(const AsmInstr& inst)
+{
+    const auto& dest = inst.operands_.back();
+    return inst.opcode_.back() == 'l' && dest.IsReg() && dest.size_ == 4;
+}
+
+
+AsmOperand AsmOperand::Of(const x64* op)
+{
+    if (auto reg = op->As<x64Reg>(); reg)
+        return Reg(reg->Tag(), reg->Size());
+    else if (auto imm = op->As<x64Imm>(); imm)
+        return Imm(imm->GetRepr().first);
+
+    AsmOperand asmop{};
+    asmop.size_ = op->Size();
+    if (auto mem = op->As<x64Mem>(); mem)
+    {
+        asmop.kind_ = Kind::mem;
+        asmop.label_ = mem->Label();
+        asmop.imm_ = mem->Offset();
+        asmop.reg_ = mem->Base().Tag();
+        asmop.index_ = mem->Index().Tag();
+        asmop.scale_ = mem->Scale();
+    }
+    else // x64Heter, which is never an operand by itself
+        asmop.kind_ = Kind::label;
+    return asmop;
+}
+
+AsmOperand AsmOperand::Reg(RegTag tag, size_t size)
+{
+    AsmOperand op{};
+    op.kind_ = Kind::reg;
+    op.reg_ = tag;
+    op.size_ = tag >= RegTag::xmm0 ? 16 : size;
+    return op;
+}
+
+AsmOperand AsmOperand::Imm(unsigned long val)
+{
+    AsmOperand op{};
+    op.kind_ = Kind::imm;
+    op.imm_ = static_cast<long>(val);
+    return op;
+}
+
+AsmOperand AsmOperand::Mem(size_t size, long disp, RegTag base)
+{
+    AsmOperand op{};
+    op.kind_ = Kind::mem;
+    op.size_ = size;
+    op.imm_ = disp;
+    op.reg_ = base;
+    return op;
+}
+
+AsmOperand AsmOperand::Label(const std::string& label)
+{
+    AsmOperand op{};
+    op.kind_ = Kind::label;
+    op.label_ = label;
+    return op;
+}
+
+AsmOperand AsmOperand::Indirect(const x64* op)
+{
+    auto asmop = Of(op);
+    asmop.indirect_ = true;
+    return asmop;
+}
+
+bool AsmOperand::operator==(const AsmOperand& op) const
+{
+    if (kind_ != op.kind_ || indirect_ != op.indirect_)
+        return false;
+    switch (kind_)
+    {
+    case Kind::reg:
+        return reg_ == op.reg_ && size_ == op.size_;
+    case Kind::imm:
+        return imm_ == op.imm_;
+    case Kind::mem:
+        if (!label_.empty() || !op.label_.empty())
+            return label_ == op.label_;
+        return imm_ == op.imm_ && reg_ == op.reg_ && index_ == op.index_ &&
+            (index_ == RegTag::none || scale_ == op.scale_);
+    default:
+        return label_ == op.label_;
+    }
+}
+
+bool AsmOperand::Uses(RegTag tag) const
+{
+    return kind_ == Kind::mem && (reg_ == tag || index_ == tag);
+}
+
+std::string AsmOperand::ToString() const
+{
+    std::string text = indirect_ ? "*" : "";
+    switch (kind_)
+    {
+    case Kind::reg:
+        return text + x64Reg{ reg_, size_ }.ToString();
+    case Kind::imm:
+        // printed as the unsigned representation, as x64Imm does
+        return text + '$' + std::to_string(static_cast<unsigned long>(imm_));
+    case Kind::mem:
+    {
+        x64Mem mem = label_.empty() ?
+            x64Mem{ size_, imm_, x64Reg{ reg_ }, x64Reg{ index_ }, scale_ } :
+            x64Mem{ size_, label_ };
+        return text + mem.ToString();
+    }
+    default:
+        return text + label_;
+    }
+}
+
+
+AsmInstr AsmInstr::Instr(const std::string& opcode, std::vector<AsmOperand> ops)
+{
+    return { Kind::instr, opcode, std::move(ops) };
+}
+
+AsmInstr AsmInstr::Label(const std::string& name)
+{
+    return { Kind::label, name, {} };
+}
+
+AsmInstr AsmInstr::Other(const std::string& line)
+{
+    return { Kind::other, line, {} };
+}
+
+std::string AsmInstr::ToString() const
+{
+    if (kind_ == Kind::label)
+        return opcode_ + ":\n";
+    if (kind_ == Kind::other)
+        return opcode_ + '\n';
+
+    std::string line = INDENT + opcode_;
+    for (size_t i = 0; i < operands_.size(); ++i)
+        line += (i == 0 ? " " : ", ") + operands_[i].ToString();
+    return line + '\n';
+}
+
+std::string AsmInstr::Target() const
+{
+    if (!IsJump() || operands_.size() != 1)
+        return "";
+    const auto& op = operands_[0];
+    return op.kind_ == AsmOperand::Kind::label && !op.indirect_ &&
+        StartsWith(op.label_, ".L") ? op.label_ : "";
+}
+
+
+enum class FlagsUse { none, read, write, unknown };
+
+static FlagsUse FlagsOf(const AsmInstr& inst)
+{
+    const auto& opcode = inst.opcode_;
+    if (inst.IsCondJump() || StartsWith(opcode, "set") || StartsWith(opcode, "cmov") ||
+        IsOpcode(opcode, "adc") || IsOpcode(opcode, "sbb"))
+        return FlagsUse::read;
+    if (IsShift(opcode))
+    {
+        // A shift by zero, e.g., by %cl, leaves the flags unchanged.
+        const auto& count = inst.operands_[0];
+        if (inst.operands_.size() == 2 && count.IsImm())
+            return count.imm_ ? FlagsUse::write : FlagsUse::none;
+        return FlagsUse::unknown;
+    }
+    for (auto base : { "add", "sub", "and", "or", "xor", "cmp", "test",
+        "inc", "dec", "neg", "imul", "mul", "idiv", "div" })
+        if (IsOpcode(opcode, base))
+            return FlagsUse::write;
+    for (auto cmp : { "vucomiss", "vucomisd", "vcomiss", "vcomisd" })
+        if (opcode == cmp)
+            return FlagsUse::write;
+
+    if (StartsWith(opcode, "mov") || StartsWith(opcode, "lea") ||
+        StartsWith(opcode, "cvt") || StartsWith(opcode, "v"))
+        return FlagsUse::none;
+    for (auto base : { "push", "pop", "not", "xchg" })
+        if (IsOpcode(opcode, base))
+            return FlagsUse::none;
+    for (auto other : { "cltd", "cqto", "cltq", "cwtl", "rep movsb", "leave", "nop" })
+        if (opcode == other)
+            return FlagsUse::none;
+    return FlagsUse::unknown;
+}
+
+size_t Peephole::Next(const Code& code, size_t i)
+{
+    return i + 1 < code.size() && code[i + 1].IsInstr() ? i + 1 : 0;
+}
+
+// Are the flags written before being read after code[i]?
+bool Peephole::FlagsDead(const Code& code, size_t i)
+{
+    for (auto k = i + 1; k < code.size(); ++k)
+    {
+        const auto& inst = code[k];
+        if (!inst.IsInstr())
+            return false;
+        if (StartsWith(inst.opcode_, "call") || inst.opcode_ == "ret")
+            return true;
+        if (inst.opcode_ == "jmp")
+        {
+            // sibling calls, but not jumps within the function
+            return inst.Target().empty() && !inst.operands_[0].indirect_;
+        }
+        auto use = FlagsOf(inst);
+        if (use == FlagsUse::write)
+            return true;
+        if (use != FlagsUse::none)
+            return false;
+    }
+    return true;
+}
+
+
+// mov A, B; mov B, A => mov A, B
+bool Peephole::RedundantMov(Code& code, size_t i)
+{
+    auto j = Next(code, i);
+    if (!j || !IsIntMov(code[i].opcode_) || code[i].opcode_ != code[j].opcode_)
+        return false;
+    const auto& src = code[i].operands_[0];
+    const auto& dest = code[i].operands_[1];
+    if (code[j].operands_[0] != dest || code[j].operands_[1] != src)
+        return false;
+    if (src.IsMem() && src.Uses(dest.reg_))
+        return false;
+    if (src.kind_ == AsmOperand::Kind::imm || ClearsUpper(code[j]))
+        return false;
+    code.erase(code.begin() + j);
+    return true;
+}
+
+// mov %r1, M; mov M, %r2 => mov %r1, M; mov %r1, %r2
+bool Peephole::StoreReload(Code& code, size_t i)
+{
+    auto j = Next(code, i);
+    if (!j || !IsIntMov(code[i].opcode_) || code[i].opcode_ != code[j].opcode_)
+        return false;
+    const auto& src = code[i].operands_[0];
+    const auto& mem = code[i].operands_[1];
+    if (!src.IsReg() || !mem.IsMem() || code[j].operands_[0] != mem ||
+        !code[j].operands_[1].IsReg())
+        return false;
+    code[j].operands_[0] = src;
+    return true;
+}
+
+// mov %r, %r => (nothing)
+bool Peephole::SelfMov(Code& code, size_t i)
+{
+    const auto& opcode = code[i].opcode_;
+    const auto& ops = code[i].operands_;
+    bool mov = (IsIntMov(opcode) && opcode != "movl") || StartsWith(opcode, "vmovap");
+    if (!mov || ops.size() != 2 || !ops[0].IsReg() || ops[0] != ops[1])
+        return false;
+    code.erase(code.begin() + i);
+    return true;
+}
+
+// shl $0, x => (nothing)
+bool Peephole::ZeroShift(Code& code, size_t i)
+{
+    const auto& ops = code[i].operands_;
+    if (!IsShift(code[i].opcode_) || ops.size() != 2 ||
+        !ops[0].IsImm(0) || ClearsUpper(code[i]))
+        return false;
+    code.erase(code.begin() + i);
+    return true;
+}
+
+// add $0, x => (nothing)
+bool Peephole::ZeroAddSub(Code& code, size_t i)
+{
+    const auto& opcode = code[i].opcode_;
+    const auto& ops = code[i].operands_;
+    if (!(IsOpcode(opcode, "add") || IsOpcode(opcode, "sub")) || ops.size() != 2 ||
+        !ops[0].IsImm(0) || ClearsUpper(code[i]) || !FlagsDead(code, i))
+        return false;
+    code.erase(code.begin() + i);
+    return true;
+}
+
+// cmp $0, %r => test %r, %r
+bool Peephole::CmpZero(Code& code, size_t i)
+{
+    auto& inst = code[i];
+    if (!IsOpcode(inst.opcode_, "cmp") || inst.opcode_ == "cmp" ||
+        inst.operands_.size() != 2 || !inst.operands_[0].IsImm(0) ||
+        !inst.operands_[1].IsReg())
+        return false;
+    inst.opcode_ = "test" + inst.opcode_.substr(3);
+    inst.operands_[0] = inst.operands_[1];
+    return true;
+}
+
+// mov $0, %r => xorl %r, %r
+bool Peephole::ZeroReg(Code& code, size_t i)
+{
+    auto& inst = code[i];
+    if ((inst.opcode_ != "movl" && inst.opcode_ != "movq") ||
+        !inst.operands_[0].IsImm(0) || !inst.operands_[1].IsReg() ||
+        inst.operands_[1].reg_ == RegTag::none || !FlagsDead(code, i))
+        return false;
+    // Writing the lower half clears the whole register.
+    auto reg = AsmOperand::Reg(inst.operands_[1].reg_, 4);
+    inst.opcode_ = "xorl";
+    inst.operands_ = { reg, reg };
+    return true;
+}
+
+// add $a, %rsp; sub $b, %rsp => add $(a - b), %rsp
+bool Peephole::MergeRsp(Code& code, size_t i)
+{
+    auto j = Next(code, i);
+    if (!j || !IsRspAdjust(code[i]) || !IsRspAdjust(code[j]) || !FlagsDead(code, j))
+        return false;
+    auto amount = [&code] (size_t k) {
+        auto imm = code[k].operands_[0].imm_;
+        return code[k].opcode_ == "addq" ? imm : -imm;
+    };
+    auto total = amount(i) + amount(j);
+    code.erase(code.begin() + j);
+    if (total == 0)
+        code.erase(code.begin() + i);
+    else
+    {
+        code[i].opcode_ = total > 0 ? "addq" : "subq";
+        code[i].operands_[0] = AsmOperand::Imm(std::labs(total));
+    }
+    return true;
+}
+
+// add $a, %rsp; leave => leave
+bool Peephole::RspBeforeLeave(Code& code, size_t i)
+{
+    auto j = Next(code, i);
+    if (!j || !IsRspAdjust(code[i]) || code[j].opcode_ != "leave" || !FlagsDead(code, i))
+        return false;
+    code.erase(code.begin() + i);
+    return true;
+}
+
+// jmp L; L: => L:
+bool Peephole::JumpToNext(Code& code, size_t i)
+{
+    auto target = code[i].Target();
+    if (target.empty())
+        return false;
+    for (auto k = i + 1; k < code.size() && (code[k].IsLabel() || code[k].IsAlign()); ++k)
+    {
+        if (code[k].opcode_ == target)
+        {
+            code.erase(code.begin() + i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// jcc L1; jmp L2; L1: => jncc L2; L1:
+bool Peephole::BranchOverJump(Code& code, size_t i)
+{
+    static const std::unordered_map<std::string, std::string> inverse{
+        { "e", "ne" }, { "ne", "e" }, { "z", "nz" }, { "nz", "z" },
+        { "l", "ge" }, { "ge", "l" }, { "g", "le" }, { "le", "g" },
+        { "b", "ae" }, { "ae", "b" }, { "a", "be" }, { "be", "a" },
+        { "p", "np" }, { "np", "p" }, { "s", "ns" }, { "ns", "s" },
+        { "o", "no" }, { "no", "o" }, { "c", "nc" }, { "nc", "c" },
+    };
+
+    auto j = Next(code, i);
+    if (!j || !code[i].IsCondJump() || code[j].opcode_ != "jmp")
+        return false;
+    auto target = code[i].Target();
+    auto cond = inverse.find(code[i].opcode_.substr(1));
+    if (target.empty() || code[j].Target().empty() || cond == inverse.end())
+        return false;
+    for (auto k = j + 1; k < code.size() && (code[k].IsLabel() || code[k].IsAlign()); ++k)
+    {
+        if (code[k].opcode_ == target)
+        {
+            code[i].opcode_ = 'j' + cond->second;
+            code[i].operands_ = code[j].operands_;
+            code.erase(code.begin() + j);
+            return true;
+        }
+    }
+    return false;
+}
+
+// jmp L1; ... L1: jmp L2 => jmp L2; ... L1: jmp L2
+bool Peephole::JumpToJump(Code& code, size_t i)
+{
+    auto target = code[i].Target();
+    if (target.empty())
+        return false;
+    for (size_t k = 0; k < code.size(); ++k)
+    {
+        if (!code[k].IsLabel() || code[k].opcode_ != target)
+            continue;
+        while (k < code.size() && code[k].IsLabel())
+            ++k;
+        if (k == code.size() || code[k].opcode_ != "jmp")
+            return false;
+        auto next = code[k].Target();
+        if (next.empty() || next == target)
+            return false;
+        code[i].operands_ = code[k].operands_;
+        return true;
+    }
+    return false;
+}
+
+// jmp L; (anything but a label) => jmp L
+bool Peephole::Unreachable(Code& code, size_t i)
+{
+    auto j = Next(code, i);
+    if (!j || !code[i].IsBarrier())
+        return false;
+    code.erase(code.begin() + j);
+    return true;
+}
+
+
+const std::vector<Peephole::Rule> Peephole::rules_{
+    { "redundant-mov", RedundantMov },
+    { "store-reload", StoreReload },
+    { "self-mov", SelfMov },
+    { "zero-shift", ZeroShift },
+    { "zero-add-sub", ZeroAddSub },
+    { "cmp-zero", CmpZero },
+    { "zero-reg", ZeroReg },
+    { "merge-rsp", MergeRsp },
+    { "rsp-before-leave", RspBeforeLeave },
+    { "jump-to-next", JumpToNext },
+    { "branch-over-jump", BranchOverJump },
+    { "jump-to-jump", JumpToJump },
+    { "unreachable", Unreachable },
+};
+
+void Peephole::Run(std::vector<AsmInstr>& code)
+{
+    fired_.assign(rules_.size(), 0);
+    for (int sweep = 0; sweep < maxsweep_; ++sweep)
+    {
+        bool changed = false;
+        for (size_t i = 0; i < code.size(); ++i)
+        {
+            for (size_t r = 0; r < rules_.size(); ++r)
+            {
+                if (i >= code.size() || !code[i].IsInstr())
+                    break;
+                if (rules_[r].apply_(code, i))
+                {
+                    fired_[r] += 1;
+                    changed = true;
+                }
+            }
+        }
+        if (!changed)
+            break;
+    }
+}
+
+std::string Peephole::PrintSummary(const std::string& func) const
+{
+    std::string summary{ fmt::format(
+        "Pass Peephole in function {}:\n", func) };
+    summary += "Rewrite rule : times fired\n";
+    int total = 0;
+    for (size_t r = 0; r < fired_.size(); ++r)
+    {
+        total += fired_[r];
+        if (fired_[r])
+            summary += fmt::format("{} : {}\n", rules_[r].name_, fired_[r]);
+    }
+    summary += fmt::format("total : {}\n", total);
+    return summary;
+}
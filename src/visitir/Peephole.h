@@ -0,0 +1,130 @@
+#ifndef _PEEPHOLE_H_
+#define _PEEPHOLE_H_
+
+#include "visitir/x64.h"
+#include <string>
+#include <vector>
+
+
+// An operand of an instruction, recorded by EmitAsm from the x64 operand
+// it is emitted with and printed in AT&T syntax only when written out.
+// Operands compare by what they denote rather than by spelling, e.g.,
+// (%rax) and 0(%rax) are the same. Registers in addresses are 64-bit,
+// and vector registers compare regardless of the size they are used at.
+struct AsmOperand
+{
+    enum class Kind { reg, imm, mem, label };
+
+    static AsmOperand Of(const x64*);
+    static AsmOperand Reg(RegTag, size_t);
+    static AsmOperand Imm(unsigned long);
+    static AsmOperand Mem(size_t, long, RegTag);
+    static AsmOperand Label(const std::string&);
+    // the target of an indirect call or jump, e.g., *%rax
+    static AsmOperand Indirect(const x64*);
+
+    bool operator==(const AsmOperand&) const;
+    bool operator!=(const AsmOperand& op) const { return !(*this == op); }
+    bool IsReg() const { return kind_ == Kind::reg; }
+    bool IsMem() const { return kind_ == Kind::mem; }
+    bool IsImm() const { return kind_ == Kind::imm; }
+    bool IsImm(long val) const { return kind_ == Kind::imm && imm_ == val; }
+    // Does the address of a memory operand use the register?
+    bool Uses(RegTag) const;
+
+    std::string ToString() const;
+
+    Kind kind_{};
+    // the register, or the base of memory
+    RegTag reg_{ RegTag::none };
+    RegTag index_{ RegTag::none };
+    size_t scale_{};
+    // the size of a register, or of the data in memory
+    size_t size_{};
+    // the value of an immediate, or the displacement of memory
+    long imm_{};
+    // the name of a label, or the symbol of a rip-relative memory operand
+    std::string label_{};
+    bool indirect_{};
+};
+
+
+// A line of the assembly: an instruction, a label, or anything
+// else (directives, blank lines) that is kept as it is.
+struct AsmInstr
+{
+    enum class Kind { instr, label, other };
+
+    static AsmInstr Instr(const std::string&, std::vector<AsmOperand> = {});
+    static AsmInstr Label(const std::string&);
+    static AsmInstr Other(const std::string&);
+    std::string ToString() const;
+
+    bool IsInstr() const { return kind_ == Kind::instr; }
+    bool IsLabel() const { return kind_ == Kind::label; }
+    // padding before a label, which falls through to it
+    bool IsAlign() const { return kind_ == Kind::other && opcode_.find(".p2align") != std::string::npos; }
+    bool IsJump() const { return IsInstr() && opcode_[0] == 'j'; }
+    bool IsCondJump() const { return IsJump() && opcode_ != "jmp"; }
+    // jmp or ret, after which the code is unreachable up to a label
+    bool IsBarrier() const { return IsInstr() && (opcode_ == "jmp" || opcode_ == "ret"); }
+    // the label jumped to, or empty for jumps elsewhere (e.g., sibling calls)
+    std::string Target() const;
+
+    Kind kind_{};
+    // the opcode, the name of a label, or the whole line for others
+    std::string opcode_{};
+    std::vector<AsmOperand> operands_{};
+};
+
+
+// Peephole optimization of the instructions of a function, run by EmitAsm
+// between CodeGen and writing them to the file. It works on the opcodes
+// and operands EmitAsm recorded, and each rule in the table looks at a
+// small window starting at an instruction and rewrites it in place. Rules
+// are tried at every instruction until none fires, since one rewrite often
+// exposes another (e.g., removing a jump makes two moves adjacent). Most
+// rules are local to the window; the few that change the flags check that
+// no instruction reads them before they are written again, following the
+// code straight down. See section 18.11 in Advanced Compiler Design and
+// Implementation by Muchnick, and Peephole Optimization by McKeeman (1965).
+
+class Peephole
+{
+public:
+    void Run(std::vector<AsmInstr>&);
+    std::string PrintSummary(const std::string& func) const;
+
+private:
+    using Code = std::vector<AsmInstr>;
+    struct Rule
+    {
+        const char* name_;
+        bool (*apply_)(Code&, size_t);
+    };
+    static const std::vector<Rule> rules_;
+
+    static size_t Next(const Code&, size_t);
+    static bool FlagsDead(const Code&, size_t);
+
+    static bool RedundantMov(Code&, size_t);
+    static bool StoreReload(Code&, size_t);
+    static bool SelfMov(Code&, size_t);
+    static bool ZeroShift(Code&, size_t);
+    static bool ZeroAddSub(Code&, size_t);
+    static bool CmpZero(Code&, size_t);
+    static bool ZeroReg(Code&, size_t);
+    static bool MergeRsp(Code&, size_t);
+    static bool RspBeforeLeave(Code&, size_t);
+    static bool JumpToNext(Code&, size_t);
+    static bool BranchOverJump(Code&, size_t);
+    static bool JumpToJump(Code&, size_t);
+    static bool Unreachable(Code&, size_t);
+
+    // Jumps to jumps in a cycle would be retargeted forever.
+    static constexpr int maxsweep_ = 8;
+
+    std::vector<int> fired_{};
+};
+
+#endif // _PEEPHOLE_H_
@@ -124,7 +124,8 @@ bool x64Mem::operator==(const x64Mem& mem) const
 {
     if (!label_.empty())
         return label_ == mem.label_;
-    return base_ == mem.base_ &&
+    return offset_ == mem.offset_ &&
+        base_ == mem.base_ &&
         index_ == mem.index_ &&
         scale_ == mem.scale_;
 }
@@ -102,11 +102,13 @@ public:
     bool operator!=(const x64Mem& mem) const { return !(*this == mem); }
 
     bool GlobalLoc() const { return !label_.empty(); }
+    const auto& Label() const { return label_; }
     bool& LoadTwice() { return loadtwice_; }
     bool LoadTwice() const { return loadtwice_; }
 
     auto& Offset() { return offset_; }
     auto Offset() const { return offset_; }
+    auto& Base() { return base_; }
     auto& Base() const { return base_; }
     auto& Index() const { return index_; }
     auto& Scale() { return scale_; }
@@ -0,0 +1,85 @@
+#include "test.h"
+
+int count = 0;
+
+void touch() { count++; }
+int neq(float a, float b) { return a != b; }
+float twice(float a) { return a * 2.0f; }
+
+int ints_across(int a, int b, int c)
+{
+    int x = a + b, y = b * c, z = a - c;
+    touch();
+    int w = x * y;
+    touch();
+    return w + z + x + y;
+}
+
+double dbls_across(double a, double b)
+{
+    double x = a * b, y = a - b;
+    touch();
+    return x + y;
+}
+
+float narrow_across(double d)
+{
+    float f = d;
+    touch();
+    return f + 1.0f;
+}
+
+float widen_across(int i, long l)
+{
+    float f = i;
+    float g = l;
+    touch();
+    return f + g;
+}
+
+int ucom_across(float a, float b)
+{
+    float x = a + 1.0f, y = b + 1.0f;
+    touch();
+    if (x < y)
+        return 1;
+    return x == y ? 0 : 2;
+}
+
+int neq_loop()
+{
+    double v[4];
+    v[0] = 1.0; v[1] = 2.0; v[2] = 2.0; v[3] = 3.5;
+    int c = 0;
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 4; ++j)
+            c += neq((float)v[i], (float)v[j]);
+    return c;
+}
+
+float many_across(float a, float b, float c, float d)
+{
+    float s1 = twice(a), s2 = twice(b);
+    float s3 = twice(c), s4 = twice(d);
+    double t = (double)s1 * s2;
+    float u = t;
+    touch();
+    return s1 + s2 + s3 + s4 + u;
+}
+
+int main()
+{
+    assert(ints_across(3, 4, 5) == 165);
+    assert(dbls_across(2.5, 0.5) == 3.25);
+    assert(narrow_across(2.5) == 3.5f);
+    assert(widen_across(3, 4000000000) == 4000000003.0f);
+    assert(ucom_across(1.5f, 2.5f) == 1);
+    assert(ucom_across(2.5f, 2.5f) == 0);
+    assert(ucom_across(3.5f, 2.5f) == 2);
+
+    assert(neq_loop() == 10);
+    assert(many_across(1.0f, 2.0f, 3.0f, 4.0f) == 28.0f);
+    assert(count == 9);
+
+    SUCCESS;
+}
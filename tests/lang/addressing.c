@@ -0,0 +1,106 @@
+#include "test.h"
+
+struct rec { char tag; short s; int i; long l; double d; };
+
+int grid[4][5];
+
+// Indices of each width, scaled into the address.
+long index_int(long* a, int i) { return a[i]; }
+long index_long(long* a, long i) { return a[i + 1]; }
+int index_char(int* a, char c) { return a[c]; }
+int index_neg(int* a, int i) { return a[i - 2]; }
+short index_short(short* a, unsigned i) { return a[i]; }
+
+// Loads extended from memory.
+int load_schar(char* p, int i) { return p[i]; }
+int load_uchar(unsigned char* p, int i) { return p[i]; }
+long load_short(short* p) { return *p; }
+unsigned long load_ushort(unsigned short* p) { return *p; }
+long load_int(int* p, int i) { return p[i]; }
+
+// Fields through a pointer.
+long fields(struct rec* r)
+{
+    return r->tag + r->s + r->i + r->l + (long)r->d;
+}
+
+// Read-modify-write of memory.
+void rmw(int* a, int i, int x)
+{
+    a[i] += x;
+    a[i + 1] -= x;
+    a[i + 2] ^= x;
+    a[i + 3] |= x;
+    a[i] *= 2;
+    a[i + 1]++;
+    a[i + 2]--;
+}
+
+void rmw_field(struct rec* r, long x)
+{
+    r->l += x;
+    r->i -= (int)x;
+    r->s <<= 1;
+}
+
+// Arithmetic an lea can compute.
+long lea(long x, long y)
+{
+    return x * 3 + x * 5 + x * 9 + (x + y * 4 + 8) + (y << 3);
+}
+
+int grid_sum()
+{
+    int s = 0;
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 5; ++j)
+            s += grid[i][j] * (j + 1);
+    return s;
+}
+
+int main()
+{
+    long la[4];
+    la[0] = 10; la[1] = 20; la[2] = 30; la[3] = 4294967296;
+    assert(index_int(la, 2) == 30 && index_long(la, 2) == 4294967296);
+
+    int ia[6];
+    for (int i = 0; i < 6; ++i)
+        ia[i] = i * 100 - 200;
+    assert(index_char(ia, 5) == 300 && index_neg(ia, 2) == -200 && index_neg(ia, 5) == 100);
+    assert(load_int(ia, 0) == -200);
+
+    short sa[3];
+    sa[0] = -5; sa[1] = 32767; sa[2] = -32768;
+    assert(index_short(sa, 1) == 32767 && index_short(sa, 2) == -32768);
+    assert(load_short(&sa[2]) == -32768);
+    unsigned short us = 65535;
+    assert(load_ushort(&us) == 65535);
+
+    char ca[2];
+    ca[0] = -1; ca[1] = 127;
+    assert(load_schar(ca, 0) == -1 && load_schar(ca, 1) == 127);
+    assert(load_uchar((unsigned char*)ca, 0) == 255);
+
+    struct rec r;
+    r.tag = -2; r.s = -300; r.i = 70000; r.l = 4294967296; r.d = 2.5;
+    assert(fields(&r) == -2 - 300 + 70000 + 4294967296 + 2);
+    r.s = 300;
+    rmw_field(&r, 10);
+    assert(r.l == 4294967306 && r.i == 69990 && r.s == 600);
+
+    int b[5];
+    b[0] = 1; b[1] = 2; b[2] = 3; b[3] = 4; b[4] = 5;
+    rmw(b, 1, 6);
+    assert(b[0] == 1 && b[1] == 16 && b[2] == -2 && b[3] == 1 && b[4] == 7);
+
+    assert(lea(1, 2) == 3 + 5 + 9 + 17 + 16);
+    assert(lea(-2, 3) == -6 - 10 - 18 + 18 + 24);
+
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 5; ++j)
+            grid[i][j] = i - j;
+    assert(grid_sum() == 6 + 4 - 6 - 24 - 50);
+
+    SUCCESS;
+}
@@ -0,0 +1,124 @@
+#include "test.h"
+
+int count = 0;
+int touch() { return ++count; }
+
+// The results are unused, but the calls and the store stay.
+void effects(int* p)
+{
+    int a = touch() * 2;
+    int b = a + 1;
+    *p = 5;
+    touch();
+}
+
+int unreachable(int x)
+{
+    return x + 1;
+    touch();
+    return x;
+}
+
+// Both arms of the branch go to the same block.
+int same_target(int x)
+{
+    int r = x * 3;
+    if (x)
+        ;
+    else
+        ;
+    return r;
+}
+
+int all_default(int x)
+{
+    switch (x)
+    {
+    case 1:
+    case 2:
+    default:
+        break;
+    }
+    return x;
+}
+
+// Chains of empty blocks are threaded and straight lines merged.
+int chain(int x)
+{
+    int r = 0;
+    if (x > 100)
+        r = 3;
+    else if (x > 10)
+        ;
+    else if (x > 0)
+        ;
+    else
+        r = -1;
+    {
+        {
+            r += 1;
+        }
+    }
+    return r;
+}
+
+int jumps(int x)
+{
+    int r = 0;
+    if (x < 0)
+        goto negative;
+    goto positive;
+negative:
+    r -= 10;
+    goto done;
+positive:
+    r += 10;
+done:
+    return r;
+}
+
+// The loop computes nothing used, but it has to terminate.
+int dead_loop(int n)
+{
+    int s = 0;
+    for (int i = 0; i < n; ++i)
+        s += i;
+    return n;
+}
+
+int after_switch(int x)
+{
+    switch (x)
+    {
+        int hidden;
+    case 0:
+        hidden = 4;
+        return hidden;
+    default:
+        hidden = x;
+        return hidden * 2;
+    }
+}
+
+int main()
+{
+    int v = 0;
+    effects(&v);
+    assert(v == 5 && count == 2);
+    assert(unreachable(4) == 5);
+    assert(same_target(2) == 6);
+    assert(same_target(0) == 0);
+    assert(all_default(9) == 9);
+    assert(chain(-5) == 0);
+    assert(chain(5) == 1);
+    assert(chain(50) == 1);
+    assert(chain(500) == 4);
+    assert(jumps(-1) == -10);
+    assert(jumps(1) == 10);
+    assert(dead_loop(1000) == 1000);
+    assert(after_switch(0) == 4);
+    assert(after_switch(3) == 6);
+    assert(count == 2);
+
+    SUCCESS;
+}
@@ -0,0 +1,252 @@
+#include "test.h"
+
+// Division and modulo by each constant, and the same by a variable
+// the compiler knows nothing about, which the results are checked against.
+#define DIVMOD(name, T, D) \
+    T name##_d = (D); \
+    T name##_div(T a) { return a / (D); } \
+    T name##_mod(T a) { return a % (D); }
+
+#define CHECK(name, a) \
+    assert(name##_div(a) == (a) / name##_d && name##_mod(a) == (a) % name##_d)
+
+// Multiplication by each constant, likewise.
+#define MUL(name, T, C) \
+    T name##_c = (C); \
+    T name##_mul(T a) { return a * (C); }
+
+#define CHECK_MUL(name, a) assert(name##_mul(a) == (a) * name##_c)
+
+DIVMOD(i_1, int, 1)
+DIVMOD(i_m1, int, -1)
+DIVMOD(i_2, int, 2)
+DIVMOD(i_m2, int, -2)
+DIVMOD(i_3, int, 3)
+DIVMOD(i_m3, int, -3)
+DIVMOD(i_7, int, 7)
+DIVMOD(i_m7, int, -7)
+DIVMOD(i_10, int, 10)
+DIVMOD(i_16, int, 16)
+DIVMOD(i_m16, int, -16)
+DIVMOD(i_641, int, 641)
+DIVMOD(i_max, int, 2147483647)
+DIVMOD(i_min, int, (-2147483647 - 1))
+
+void check_int(int a)
+{
+    CHECK(i_1, a);
+    // the minimum divided by -1 overflows
+    if (a != (-2147483647 - 1))
+        CHECK(i_m1, a);
+    CHECK(i_2, a);
+    CHECK(i_m2, a);
+    CHECK(i_3, a);
+    CHECK(i_m3, a);
+    CHECK(i_7, a);
+    CHECK(i_m7, a);
+    CHECK(i_10, a);
+    CHECK(i_16, a);
+    CHECK(i_m16, a);
+    CHECK(i_641, a);
+    CHECK(i_max, a);
+    CHECK(i_min, a);
+}
+
+DIVMOD(u_1, unsigned, 1u)
+DIVMOD(u_2, unsigned, 2u)
+DIVMOD(u_3, unsigned, 3u)
+DIVMOD(u_7, unsigned, 7u)
+DIVMOD(u_10, unsigned, 10u)
+DIVMOD(u_16, unsigned, 16u)
+DIVMOD(u_641, unsigned, 641u)
+DIVMOD(u_2p31, unsigned, 2147483648u)
+DIVMOD(u_2p31p1, unsigned, 2147483649u)
+DIVMOD(u_2p32m1, unsigned, 4294967295u)
+
+void check_unsigned(unsigned a)
+{
+    CHECK(u_1, a);
+    CHECK(u_2, a);
+    CHECK(u_3, a);
+    CHECK(u_7, a);
+    CHECK(u_10, a);
+    CHECK(u_16, a);
+    CHECK(u_641, a);
+    CHECK(u_2p31, a);
+    CHECK(u_2p31p1, a);
+    CHECK(u_2p32m1, a);
+}
+
+DIVMOD(l_1, long, 1)
+DIVMOD(l_m1, long, -1)
+DIVMOD(l_2, long, 2)
+DIVMOD(l_m3, long, -3)
+DIVMOD(l_7, long, 7)
+DIVMOD(l_m7, long, -7)
+DIVMOD(l_16, long, 16)
+DIVMOD(l_m16, long, -16)
+DIVMOD(l_641, long, 641)
+DIVMOD(l_2p32, long, 4294967296)
+DIVMOD(l_m2p32, long, -4294967296)
+DIVMOD(l_2p32p1, long, 4294967297)
+DIVMOD(l_max, long, 9223372036854775807)
+DIVMOD(l_min, long, (-9223372036854775807 - 1))
+
+void check_long(long a)
+{
+    CHECK(l_1, a);
+    // the minimum divided by -1 overflows
+    if (a != (-9223372036854775807 - 1))
+        CHECK(l_m1, a);
+    CHECK(l_2, a);
+    CHECK(l_m3, a);
+    CHECK(l_7, a);
+    CHECK(l_m7, a);
+    CHECK(l_16, a);
+    CHECK(l_m16, a);
+    CHECK(l_641, a);
+    CHECK(l_2p32, a);
+    CHECK(l_m2p32, a);
+    CHECK(l_2p32p1, a);
+    CHECK(l_max, a);
+    CHECK(l_min, a);
+}
+
+DIVMOD(ul_1, unsigned long, 1)
+DIVMOD(ul_2, unsigned long, 2)
+DIVMOD(ul_3, unsigned long, 3)
+DIVMOD(ul_7, unsigned long, 7)
+DIVMOD(ul_10, unsigned long, 10)
+DIVMOD(ul_16, unsigned long, 16)
+DIVMOD(ul_2p32, unsigned long, 4294967296)
+DIVMOD(ul_2p32p1, unsigned long, 4294967297)
+DIVMOD(ul_2p63, unsigned long, (unsigned long)-1 - 9223372036854775807)
+DIVMOD(ul_2p64m1, unsigned long, (unsigned long)-1)
+
+void check_ulong(unsigned long a)
+{
+    CHECK(ul_1, a);
+    CHECK(ul_2, a);
+    CHECK(ul_3, a);
+    CHECK(ul_7, a);
+    CHECK(ul_10, a);
+    CHECK(ul_16, a);
+    CHECK(ul_2p32, a);
+    CHECK(ul_2p32p1, a);
+    CHECK(ul_2p63, a);
+    CHECK(ul_2p64m1, a);
+}
+
+MUL(mi_0, int, 0)
+MUL(mi_1, int, 1)
+MUL(mi_m1, int, -1)
+MUL(mi_3, int, 3)
+MUL(mi_m3, int, -3)
+MUL(mi_5, int, 5)
+MUL(mi_9, int, 9)
+MUL(mi_10, int, 10)
+MUL(mi_16, int, 16)
+MUL(mi_m16, int, -16)
+MUL(mi_641, int, 641)
+
+// The products are small enough not to overflow.
+void check_mul_int(int a)
+{
+    CHECK_MUL(mi_0, a);
+    CHECK_MUL(mi_1, a);
+    CHECK_MUL(mi_m1, a);
+    CHECK_MUL(mi_3, a);
+    CHECK_MUL(mi_m3, a);
+    CHECK_MUL(mi_5, a);
+    CHECK_MUL(mi_9, a);
+    CHECK_MUL(mi_10, a);
+    CHECK_MUL(mi_16, a);
+    CHECK_MUL(mi_m16, a);
+    CHECK_MUL(mi_641, a);
+}
+
+MUL(mul_3, unsigned long, 3)
+MUL(mul_9, unsigned long, 9)
+MUL(mul_24, unsigned long, 24)
+MUL(mul_2p32, unsigned long, 4294967296)
+MUL(mul_2p32p1, unsigned long, 4294967297)
+MUL(mul_max, unsigned long, (unsigned long)-1)
+
+// The products wrap around.
+void check_mul_ulong(unsigned long a)
+{
+    CHECK_MUL(mul_3, a);
+    CHECK_MUL(mul_9, a);
+    CHECK_MUL(mul_24, a);
+    CHECK_MUL(mul_2p32, a);
+    CHECK_MUL(mul_2p32p1, a);
+    CHECK_MUL(mul_max, a);
+}
+
+int main()
+{
+    check_int((-2147483647 - 1));
+    check_int(0);
+    check_int(1);
+    check_int(-1);
+    check_int(7);
+    check_int(-7);
+    check_int(100);
+    check_int(-100);
+    check_int(12345);
+    check_int(-12345);
+    check_int(2147483647);
+    check_int(-2147483647);
+
+    check_unsigned(0u);
+    check_unsigned(1u);
+    check_unsigned(7u);
+    check_unsigned(100u);
+    check_unsigned(12345u);
+    check_unsigned(2147483647u);
+    check_unsigned(2147483648u);
+    check_unsigned(2147483649u);
+    check_unsigned(4294967294u);
+    check_unsigned(4294967295u);
+
+    check_long((-9223372036854775807 - 1));
+    check_long(0);
+    check_long(1);
+    check_long(-1);
+    check_long(100);
+    check_long(-100);
+    check_long(4294967296);
+    check_long(-4294967296);
+    check_long(4294967297);
+    check_long(-4294967297);
+    check_long(-2147483648);
+    check_long(9223372036854775807);
+    check_long(-9223372036854775807);
+
+    check_ulong(0);
+    check_ulong(1);
+    check_ulong(7);
+    check_ulong(100);
+    check_ulong(4294967295);
+    check_ulong(4294967296);
+    check_ulong(4294967297);
+    check_ulong(9223372036854775807);
+    check_ulong((unsigned long)-1 - 9223372036854775807);
+    check_ulong((unsigned long)-1 - 1);
+    check_ulong((unsigned long)-1);
+
+    check_mul_int(0);
+    check_mul_int(1);
+    check_mul_int(-1);
+    check_mul_int(12345);
+    check_mul_int(-65536);
+    check_mul_int(3000000);
+
+    check_mul_ulong(0);
+    check_mul_ulong(7);
+    check_mul_ulong(4294967295u);
+    check_mul_ulong((unsigned long)-1);
+    check_mul_ulong((unsigned long)-1 - 9223372036854775807);
+
+    SUCCESS;
+}
@@ -0,0 +1,72 @@
+#include "test.h"
+
+int redundant(int a, int b)
+{
+    int x = a * b + 1;
+    int y = b * a + 1;
+    int z = a * b + 1;
+    return x + y + z;
+}
+
+// An expression in one arm doesn't dominate the other arm, nor the join.
+int arms(int a, int b, int c)
+{
+    int r;
+    if (c)
+        r = a + b;
+    else
+        r = a - b;
+    return r + (a + b);
+}
+
+// Same operands, but different operations or types.
+long distinct(int a, int b)
+{
+    unsigned ua = a, ub = b;
+    long la = a, lb = b;
+    long r = (long)(a / b) * 1000000 + (long)(ua / ub % 1000);
+    r += (a < b) * 10 + (ua < ub) * 100;
+    return r + (la * lb - (long)(a * b));
+}
+
+// The loads are not numbered, as the store in between changes memory.
+int memory(int* p)
+{
+    int x = *p + 1;
+    *p = 10;
+    int y = *p + 1;
+    return x * 100 + y;
+}
+
+double floats(double a, double b)
+{
+    double x = a / b;
+    double y = a / b;
+    int lt = a < b, gt = a > b, le = a <= b;
+    return x + y + lt * 10 + gt * 100 + le * 1000;
+}
+
+int index(int* arr, int i)
+{
+    int* p = arr + i;
+    int* q = arr + i;
+    *p = *p + 1;
+    return *q + arr[i];
+}
+
+int main()
+{
+    assert(redundant(3, 4) == 39);
+    assert(arms(5, 3, 1) == 16);
+    assert(arms(5, 3, 0) == 10);
+    assert(distinct(-7, 2) == -3000000 + 644 + 10);
+    assert(distinct(100000, 3) == 33333000000 + 333);
+    int v = 4;
+    assert(memory(&v) == 511);
+    assert(floats(1.0, 4.0) == 0.5 + 10 + 1000);
+    int arr[3];
+    arr[0] = 1; arr[1] = 2; arr[2] = 3;
+    assert(index(arr, 1) == 6);
+
+    SUCCESS;
+}
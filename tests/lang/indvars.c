@@ -0,0 +1,101 @@
+#include "test.h"
+
+int sum_int(int* a, int n)
+{
+    int s = 0;
+    for (int i = 0; i < n; ++i)
+        s += a[i];
+    return s;
+}
+
+// Down from the end, and from a negative offset.
+long backward(long* a, int n)
+{
+    long s = 0;
+    for (int i = n - 1; i >= 0; i--)
+        s = s * 10 + a[i];
+    return s;
+}
+
+int offset(int* a, int lo, int hi)
+{
+    int s = 0;
+    for (int i = lo; i < hi; ++i)
+        s += a[i + 3];
+    return s;
+}
+
+// A step of more than one, and elements of several sizes.
+double strided(double* d, char* c, short* h, int n)
+{
+    double s = 0;
+    for (int i = 0; i < n; i += 2)
+        s += d[i] + c[i] + h[i];
+    return s;
+}
+
+// The index is also used as a value, so the narrow variable stays.
+int weighted(int* a, int n)
+{
+    int s = 0;
+    for (int i = 0; i < n; ++i)
+        s += i * a[i];
+    return s;
+}
+
+int m[3][4];
+
+int matrix()
+{
+    int s = 0;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 4; ++j)
+            s += m[i][j] * (i + 1);
+    return s;
+}
+
+void fill(unsigned char* a, int n)
+{
+    for (int i = 0; i < n; ++i)
+        a[i] = i * 3;
+}
+
+int main()
+{
+    int a[10];
+    for (int i = 0; i < 10; ++i)
+        a[i] = i + 1;
+    assert(sum_int(a, 10) == 55);
+    assert(sum_int(a, 0) == 0);
+    assert(offset(a, -3, 2) == 1 + 2 + 3 + 4 + 5);
+
+    long l[4];
+    l[0] = 1; l[1] = 2; l[2] = 3; l[3] = 4;
+    assert(backward(l, 4) == 4321);
+    assert(backward(l, 0) == 0);
+
+    double d[5];
+    char c[5];
+    short h[5];
+    for (int i = 0; i < 5; ++i)
+    {
+        d[i] = i * 0.5;
+        c[i] = -i;
+        h[i] = i * 100;
+    }
+    assert(strided(d, c, h, 5) == (0 + 1 + 2) + (0 - 2 - 4) + (0 + 200 + 400));
+    assert(strided(d, c, h, 4) == (0 + 1) + (0 - 2) + (0 + 200));
+
+    assert(weighted(a, 4) == 0 * 1 + 1 * 2 + 2 * 3 + 3 * 4);
+
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 4; ++j)
+            m[i][j] = i + j;
+    assert(matrix() == 1 * 6 + 2 * 10 + 3 * 14);
+
+    unsigned char u[100];
+    fill(u, 100);
+    assert(u[0] == 0 && u[10] == 30 && u[99] == (99 * 3) % 256);
+
+    SUCCESS;
+}
@@ -0,0 +1,95 @@
+#include "test.h"
+
+struct point { int x; int y; };
+
+int calls = 0;
+
+static int get_x(struct point* p) { return p->x; }
+static void set_y(struct point* p, int y) { p->y = y; }
+inline int sq(int a) { return a * a; }
+static double half(double d) { return d / 2.0; }
+static float mix(float a, int b, double c) { return a + b + c; }
+
+// More than one return, each storing a different value.
+static int sign(int a)
+{
+    if (a < 0)
+        return -1;
+    if (a > 0)
+        return 1;
+    return 0;
+}
+
+// A callee with a loop and a local array of its own.
+inline int sum_to(int n)
+{
+    int a[8];
+    int s = 0;
+    for (int i = 0; i < 8; ++i)
+        a[i] = i < n ? i + 1 : 0;
+    for (int i = 0; i < 8; ++i)
+        s += a[i];
+    return s;
+}
+
+// Its calls are inlined into it first, then it is inlined into main.
+static int dist2(struct point* a, struct point* b)
+{
+    return sq(get_x(a) - get_x(b)) + sq(a->y - b->y);
+}
+
+static void count() { calls++; }
+
+// Recursion within a component is left as calls.
+static int fact(int n) { return n <= 1 ? 1 : n * fact(n - 1); }
+static int is_odd(int n);
+static int is_even(int n) { return n == 0 ? 1 : is_odd(n - 1); }
+static int is_odd(int n) { return n == 0 ? 0 : is_even(n - 1); }
+
+// An argument read after the callee writes to its parameter.
+static int clobber(int a)
+{
+    a = a * 3;
+    return a + 1;
+}
+
+int main()
+{
+    struct point p, q;
+    p.x = 1; p.y = 2;
+    q.x = 4; q.y = 6;
+    assert(get_x(&p) == 1);
+    set_y(&p, 5);
+    assert(p.y == 5);
+    set_y(&p, 2);
+    assert(dist2(&p, &q) == 25);
+    assert(sq(sq(3)) == 81);
+
+    assert(half(5.0) == 2.5);
+    assert(mix(1.5f, 2, 0.25) == 3.75f);
+
+    assert(sign(-7) == -1 && sign(0) == 0 && sign(9) == 1);
+    int s = 0;
+    for (int i = -3; i <= 3; ++i)
+        s += sign(i) * i;
+    assert(s == 12);
+
+    assert(sum_to(0) == 0);
+    assert(sum_to(3) == 6);
+    int t = 0;
+    for (int n = 0; n <= 8; ++n)
+        t += sum_to(n);
+    assert(t == 120);
+
+    for (int i = 0; i < 5; ++i)
+        count();
+    assert(calls == 5);
+
+    assert(fact(6) == 720);
+    assert(is_even(10) && !is_odd(10) && is_odd(7));
+
+    int a = 4;
+    assert(clobber(a) == 13 && a == 4);
+
+    SUCCESS;
+}
@@ -0,0 +1,141 @@
+#include "test.h"
+
+// Dense around zero, looked up in a single table.
+int dense(int a)
+{
+    switch (a)
+    {
+    case -4: return 40;
+    case -3: return 30;
+    case -2: return 20;
+    case -1: return 10;
+    case 0: return 0;
+    case 1: return 1;
+    case 2: return 2;
+    case 4: return 4;
+    case 5: return 5;
+    default: return -100;
+    }
+}
+
+// Too sparse for a table, found by a binary search.
+int sparse(int a)
+{
+    switch (a)
+    {
+    case -1000000: return 1;
+    case -1000: return 2;
+    case -1: return 3;
+    case 7: return 4;
+    case 100: return 5;
+    case 65536: return 6;
+    case 2147483647: return 7;
+    case -2147483647 - 1: return 8;
+    default: return 0;
+    }
+}
+
+// A dense cluster of negative cases among sparse ones, with fall through.
+int mixed(int a)
+{
+    int r = 0;
+    switch (a)
+    {
+    case -500: r += 1;
+    case -10: r += 10; break;
+    case -9: case -8: r += 20; break;
+    case -7: r += 30;
+    case -6: r += 40; break;
+    case -5: r += 50; break;
+    case -4: case -3: r += 60; break;
+    case 300: r += 70; break;
+    case 301: r += 80; break;
+    case 303: r += 90; break;
+    default: r = -1;
+    }
+    return r;
+}
+
+// Values with the sign bit set are large, not negative.
+int unsig(unsigned a)
+{
+    switch (a)
+    {
+    case 0: return 1;
+    case 1: return 2;
+    case 2: return 3;
+    case 3: return 4;
+    case 0x7fffffff: return 5;
+    case 0xfffffffd: return 6;
+    case 0xfffffffe: return 7;
+    case 0xffffffff: return 8;
+    default: return 0;
+    }
+}
+
+int chars(char c)
+{
+    switch (c)
+    {
+    case -128: return 1;
+    case -2: return 2;
+    case -1: return 3;
+    case 0: return 4;
+    case 1: return 5;
+    case 2: return 6;
+    case 127: return 7;
+    default: return 0;
+    }
+}
+
+int longs(long a)
+{
+    switch (a)
+    {
+    case 4294967296: return 1;
+    case 4294967297: return 2;
+    case 4294967298: return 3;
+    case 4294967299: return 4;
+    case 0: return 5;
+    case -4294967296: return 6;
+    default: return 0;
+    }
+}
+
+int main()
+{
+    int s = 0;
+    for (int i = -5; i <= 6; ++i)
+        s += dense(i) * (i + 6);
+    assert(s == -100 + 80 + 90 + 80 + 50 + 0 + 7 + 16 - 900 + 40 + 55 - 1200);
+    assert(dense(-4) == 40 && dense(-1) == 10 && dense(0) == 0);
+    assert(dense(3) == -100 && dense(5) == 5 && dense(-5) == -100);
+
+    assert(sparse(-1000000) == 1 && sparse(-1000) == 2 && sparse(-1) == 3);
+    assert(sparse(7) == 4 && sparse(100) == 5 && sparse(65536) == 6);
+    assert(sparse(2147483647) == 7 && sparse(-2147483647 - 1) == 8);
+    assert(sparse(0) == 0 && sparse(-999) == 0 && sparse(65535) == 0);
+
+    assert(mixed(-500) == 11 && mixed(-10) == 10);
+    assert(mixed(-9) == 20 && mixed(-8) == 20);
+    assert(mixed(-7) == 70 && mixed(-6) == 40 && mixed(-5) == 50);
+    assert(mixed(-4) == 60 && mixed(-3) == 60 && mixed(-2) == -1);
+    assert(mixed(-11) == -1 && mixed(-499) == -1 && mixed(0) == -1);
+    assert(mixed(300) == 70 && mixed(301) == 80 && mixed(302) == -1);
+    assert(mixed(303) == 90 && mixed(304) == -1);
+
+    assert(unsig(0) == 1 && unsig(3) == 4 && unsig(4) == 0);
+    assert(unsig(0x7fffffff) == 5 && unsig(0x80000000) == 0);
+    assert(unsig(-3) == 6 && unsig(-2) == 7 && unsig(-1) == 8 && unsig(-4) == 0);
+
+    assert(chars(-128) == 1 && chars(-2) == 2 && chars(-1) == 3);
+    assert(chars(0) == 4 && chars(2) == 6 && chars(127) == 7);
+    assert(chars(3) == 0 && chars(-3) == 0 && chars(126) == 0);
+
+    long big = 4294967296;
+    assert(longs(big) == 1 && longs(big + 3) == 4 && longs(big + 4) == 0);
+    assert(longs(0) == 5 && longs(-big) == 6);
+    assert(longs(1) == 0 && longs(big - 1) == 0 && longs(-big + 1) == 0);
+
+    SUCCESS;
+}
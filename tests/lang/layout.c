@@ -0,0 +1,125 @@
+#include "test.h"
+
+// Loops rotated so the test is at the bottom, run zero or more times.
+int count_up(int n)
+{
+    int c = 0;
+    for (int i = 0; i < n; ++i)
+        c++;
+    return c;
+}
+
+int count_down(int n)
+{
+    int c = 0;
+    while (n-- > 0)
+        c += 2;
+    return c;
+}
+
+// Exits from the middle of a loop, and loops skipping the rest of the body.
+int find(int n, int key)
+{
+    int i = 0;
+    while (1)
+    {
+        if (i >= n)
+            return -1;
+        if (i * i == key)
+            break;
+        i++;
+    }
+    return i;
+}
+
+int skip_odd(int n)
+{
+    int s = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        if (i & 1)
+            continue;
+        s += i;
+    }
+    return s;
+}
+
+// Nested loops whose inner trip count depends on the outer.
+int triangle(int n)
+{
+    int s = 0;
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j <= i; ++j)
+            s += j;
+    return s;
+}
+
+// Values swapped on the back edge.
+int fib(int n)
+{
+    int a = 0, b = 1;
+    for (int i = 0; i < n; ++i)
+    {
+        int t = a + b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+int digits(int n)
+{
+    int d = 0;
+    do
+    {
+        d++;
+        n /= 10;
+    } while (n);
+    return d;
+}
+
+// A switch in a loop, whose cases jump to the latch.
+int classify(int n)
+{
+    int r = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        switch (i % 4)
+        {
+        case 0: r += 1; break;
+        case 1: r += 10; continue;
+        case 2: r += 100;
+        default: r += 1000;
+        }
+        r += 5;
+    }
+    return r;
+}
+
+// An unlikely branch out of a hot loop.
+int checked_sum(int n, int bad)
+{
+    int s = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        if (i == bad)
+            return -s;
+        s += i;
+    }
+    return s;
+}
+
+int main()
+{
+    assert(count_up(0) == 0 && count_up(1) == 1 && count_up(10) == 10);
+    assert(count_down(0) == 0 && count_down(-3) == 0 && count_down(4) == 8);
+    assert(find(10, 49) == 7 && find(10, 50) == -1 && find(0, 0) == -1);
+    assert(skip_odd(0) == 0 && skip_odd(7) == 12);
+    assert(triangle(0) == 0 && triangle(4) == 0 + 1 + 3 + 6);
+    assert(fib(0) == 0 && fib(1) == 1 && fib(10) == 55);
+    assert(digits(0) == 1 && digits(9) == 1 && digits(12345) == 5);
+    assert(classify(0) == 0 && classify(4) == 6 + 10 + 1105 + 1005);
+    assert(checked_sum(5, 10) == 10 && checked_sum(5, 3) == -3);
+
+    SUCCESS;
+}
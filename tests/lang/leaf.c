@@ -0,0 +1,81 @@
+#include "test.h"
+
+// Leaf functions, whose locals live below the stack pointer.
+int small(int a, int b)
+{
+    int x = a * b;
+    int* p = &x;
+    *p += a;
+    return x;
+}
+
+long sum_array(int n)
+{
+    long a[8];
+    for (int i = 0; i < 8; ++i)
+        a[i] = i * (long)n;
+    long s = 0;
+    for (int i = 0; i < 8; ++i)
+        s += a[i];
+    return s;
+}
+
+// Locals larger than the red zone.
+int large(int n)
+{
+    int a[64];
+    for (int i = 0; i < 64; ++i)
+        a[i] = i + n;
+    int s = 0;
+    for (int i = 0; i < 64; i += 7)
+        s += a[i];
+    return s;
+}
+
+double dot(double x, double y)
+{
+    double v[4];
+    double w[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        v[i] = x + i;
+        w[i] = y - i;
+    }
+    double s = 0.0;
+    for (int i = 0; i < 4; ++i)
+        s += v[i] * w[i];
+    return s;
+}
+
+struct pair { int a; long b; };
+
+long by_struct(int a, long b)
+{
+    struct pair p;
+    p.a = a;
+    p.b = b;
+    struct pair q = p;
+    return q.a + q.b;
+}
+
+// Not a leaf, calling the leaves with values of its own on the stack.
+long caller(int n)
+{
+    int keep[4];
+    for (int i = 0; i < 4; ++i)
+        keep[i] = n * i;
+    long s = small(n, 2) + sum_array(n) + large(n) + by_struct(n, 100);
+    return s + keep[3];
+}
+
+int main()
+{
+    assert(small(3, 4) == 15);
+    assert(sum_array(2) == 56);
+    assert(large(1) == 0 + 7 + 14 + 21 + 28 + 35 + 42 + 49 + 56 + 63 + 10);
+    assert(dot(1.0, 4.0) == 4.0 + 6.0 + 6.0 + 4.0);
+    assert(by_struct(5, 4294967296) == 4294967301);
+    assert(caller(1) == 3 + 28 + 325 + 101 + 3);
+
+    SUCCESS;
+}
@@ -0,0 +1,113 @@
+#include "test.h"
+
+int g = 0;
+int h = 0;
+void bump() { g++; }
+
+// The load of g is a candidate, but the loop stores through an alias of it.
+int alias_global(int n)
+{
+    int* p = &g;
+    int s = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        s += g;
+        *p = *p + 1;
+    }
+    return s;
+}
+
+// The same for an element of a local array, stored to through another index.
+int alias_array(int n, int k)
+{
+    int a[4];
+    a[0] = 0; a[1] = 1; a[2] = 2; a[3] = 3;
+    int* q = a + k;
+    int s = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        s += a[2];
+        q[0] = q[0] + 10;
+    }
+    return s;
+}
+
+// The callee writes to the global read in the loop.
+int through_call(int n)
+{
+    g = 0;
+    int s = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        s += g;
+        bump();
+    }
+    return s;
+}
+
+// The loop stores to another global only, so the load may be hoisted.
+int unrelated(int n)
+{
+    g = 5;
+    h = 0;
+    for (int i = 0; i < n; ++i)
+        h = h + g;
+    return h;
+}
+
+// The division is invariant but must not run when the loop doesn't.
+int no_trap(int n, int a, int b)
+{
+    int s = 0;
+    for (int i = 0; i < n; ++i)
+        s += a / b + a * b;
+    return s;
+}
+
+// Invariant code in a branch of the body, and in an inner loop.
+long nested(int n, int m, long x, long y)
+{
+    long s = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        if (i % 2)
+            s += x * y + 1;
+        for (int j = 0; j < m; ++j)
+            s += (x << 2) - y;
+    }
+    return s;
+}
+
+struct pair { int a, b; };
+
+int field_alias(int n, struct pair* p, int* q)
+{
+    int s = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        s += p->a;
+        *q += 1;
+    }
+    return s;
+}
+
+int main()
+{
+    g = 3;
+    assert(alias_global(4) == 3 + 4 + 5 + 6);
+    assert(g == 7);
+    assert(alias_array(3, 2) == 2 + 12 + 22);
+    assert(alias_array(3, 1) == 6);
+    assert(through_call(4) == 0 + 1 + 2 + 3);
+    assert(unrelated(4) == 20);
+    assert(no_trap(0, 7, 0) == 0);
+    assert(no_trap(3, 7, 2) == 3 * (3 + 14));
+    assert(nested(4, 3, 5, 2) == 2 * 11 + 12 * 18);
+
+    struct pair pr;
+    pr.a = 1; pr.b = 2;
+    assert(field_alias(3, &pr, &pr.a) == 1 + 2 + 3);
+    assert(field_alias(3, &pr, &pr.b) == 4 * 3);
+
+    SUCCESS;
+}
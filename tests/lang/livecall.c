@@ -0,0 +1,70 @@
+#include "test.h"
+
+int calls = 0;
+
+// It clobbers every caller-saved register it can.
+int clobber(int a, int b, int c, int d, int e, int f)
+{
+    calls++;
+    return a + b + c + d + e + f;
+}
+
+double fclobber(double a, double b, double c, double d)
+{
+    calls++;
+    return a * b + c * d;
+}
+
+// More values live across the call than there are callee-saved registers.
+int many(int n)
+{
+    int a = n + 1, b = n + 2, c = n + 3, d = n + 4, e = n + 5;
+    int f = n + 6, g = n + 7, h = n + 8, i = n + 9, j = n + 10;
+    int r = clobber(n, n, n, n, n, n);
+    return a + b + c + d + e + f + g + h + i + j + r;
+}
+
+// Vector registers are all caller-saved.
+double floats(double x)
+{
+    double a = x * 2.0, b = x + 1.0, c = x - 1.0;
+    double r = fclobber(x, x, x, x);
+    return a + b + c + r;
+}
+
+// Values dead after one call, and live across the next.
+int staged(int x)
+{
+    int a = x * 3;
+    int r1 = clobber(a, a, 0, 0, 0, 0);
+    int b = x * 5;
+    int r2 = clobber(r1, 0, 0, 0, 0, 0);
+    return r2 + b;
+}
+
+// A loop whose counter, bound and sum live across the call.
+long loop(int n)
+{
+    long s = 0;
+    for (int i = 0; i < n; ++i)
+        s += clobber(i, 1, 0, 0, 0, 0) * (long)i;
+    return s;
+}
+
+// The result of one call is an argument of the next.
+int chain(int x)
+{
+    return clobber(clobber(x, 1, 2, 3, 4, 5), clobber(x, 0, 0, 0, 0, 0), x, 0, 0, 0);
+}
+
+int main()
+{
+    assert(many(1) == 2 + 3 + 4 + 5 + 6 + 7 + 8 + 9 + 10 + 11 + 6);
+    assert(floats(3.0) == 6.0 + 4.0 + 2.0 + 18.0);
+    assert(staged(2) == 12 + 10);
+    assert(loop(5) == 2 + 6 + 12 + 20);
+    assert(chain(4) == 19 + 4 + 4);
+    assert(calls == 1 + 1 + 2 + 5 + 3);
+
+    SUCCESS;
+}
@@ -0,0 +1,155 @@
+#include "test.h"
+
+int branch(int c)
+{
+    int x;
+    if (c > 0)
+        x = 1;
+    else if (c < 0)
+        x = -1;
+    else
+        x = 0;
+    return x;
+}
+
+// The two variables swap on each iteration, which needs
+// the phis of the header to be read at the same time.
+int swap(int n)
+{
+    int a = 1, b = 2;
+    for (int i = 0; i < n; ++i)
+    {
+        int t = a;
+        a = b;
+        b = t;
+    }
+    return a * 10 + b;
+}
+
+long fib(int n)
+{
+    long a = 0, b = 1;
+    while (n-- > 0)
+    {
+        long c = a + b;
+        a = b;
+        b = c;
+    }
+    return a;
+}
+
+// Only the variables whose address isn't taken are promoted.
+void inc(int* p) { (*p)++; }
+int escaped(int n)
+{
+    int sum = 0, count = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        sum += i;
+        inc(&count);
+    }
+    return sum * 100 + count;
+}
+
+double mixed(char c, short s, double d, int* p)
+{
+    char c2 = c;
+    short s2 = s;
+    double d2 = d;
+    int* p2 = p;
+    for (int i = 0; i < 3; ++i)
+    {
+        c2 += 1;
+        s2 *= 2;
+        d2 /= 2.0;
+        p2 = p2 + 1;
+    }
+    return c2 + s2 + d2 + *p2;
+}
+
+// Pointers are promoted too, including null ones, ones converted
+// from another pointer type, and pointers to functions.
+int twice(int x) { return x * 2; }
+int pointers(int c, long* l)
+{
+    int* p = 0;
+    char* b = l;
+    int (*f)(int) = twice;
+    int* q;
+    int v = 5;
+    if (c)
+    {
+        p = &v;
+        q = p;
+    }
+    int r = p ? *p + *q : -1;
+    while (*b == 0)
+        b = b + 1;
+    return f(r) * 100 + *b;
+}
+
+int nested(int n)
+{
+    int total = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        int row = 0;
+        for (int j = 0; j <= i; ++j)
+        {
+            if (j % 2)
+                continue;
+            row += j;
+        }
+        total += row;
+        if (total > 1000)
+            break;
+    }
+    return total;
+}
+
+int early(int n)
+{
+    int r = 7;
+    if (n == 0)
+        return r;
+    r = n;
+    do
+    {
+        r += n;
+        n--;
+    } while (n > 0);
+    return r;
+}
+
+int main()
+{
+    assert(branch(5) == 1);
+    assert(branch(-3) == -1);
+    assert(branch(0) == 0);
+
+    assert(swap(0) == 12);
+    assert(swap(1) == 21);
+    assert(swap(4) == 12);
+    assert(swap(7) == 21);
+
+    assert(fib(0) == 0);
+    assert(fib(1) == 1);
+    assert(fib(10) == 55);
+    assert(fib(90) == 2880067194370816120);
+
+    assert(escaped(5) == 1005);
+
+    int arr[4];
+    arr[0] = 1; arr[1] = 2; arr[2] = 3; arr[3] = 4;
+    assert(mixed('a', 3, 16.0, arr) == 'd' + 24 + 2.0 + 4);
+
+    long l = 0x70000;
+    assert(pointers(1, &l) == 2007);
+    assert(pointers(0, &l) == -193);
+
+    assert(nested(5) == 10);
+    assert(early(0) == 7);
+    assert(early(3) == 9);
+
+    SUCCESS;
+}
@@ -0,0 +1,86 @@
+#include "test.h"
+
+double zero = 0.0;
+
+// Each comparison with a NaN operand is false, except !=.
+int br_lt(double a, double b) { if (a < b) return 1; return 0; }
+int br_le(double a, double b) { if (a <= b) return 1; return 0; }
+int br_gt(double a, double b) { if (a > b) return 1; return 0; }
+int br_ge(double a, double b) { if (a >= b) return 1; return 0; }
+int br_eq(double a, double b) { if (a == b) return 1; return 0; }
+int br_ne(double a, double b) { if (a != b) return 1; return 0; }
+
+int br_not_lt(float a, float b) { if (!(a < b)) return 1; return 0; }
+int br_not_eq(float a, float b) { if (!(a == b)) return 1; return 0; }
+
+int sel_lt(float a, float b) { return a < b ? 1 : 0; }
+int sel_ge(float a, float b) { return a >= b ? 1 : 0; }
+int sel_eq(float a, float b) { return a == b ? 5 : 7; }
+int sel_ne(float a, float b) { return a != b ? 5 : 7; }
+double sel_min(double a, double b) { return a < b ? a : b; }
+double sel_max(double a, double b) { return a > b ? a : b; }
+
+// Loop conditions, which are the back edges of loops.
+int loop_lt(double x, double limit)
+{
+    int n = 0;
+    while (x < limit && n < 100)
+    {
+        x += 1.0;
+        n++;
+    }
+    return n;
+}
+
+int loop_ne(double x, double y)
+{
+    int n = 0;
+    for (; x != y && n < 10; ++n)
+        ;
+    return n;
+}
+
+// A comparison used both by a branch and as a value.
+int both(double a, double b)
+{
+    int c = a <= b;
+    if (a <= b)
+        return c + 10;
+    return c + 20;
+}
+
+int main()
+{
+    double nan = zero / zero;
+    float fnan = nan;
+    double one = 1.0;
+
+    assert(br_lt(nan, one) == 0 && br_lt(one, nan) == 0 && br_lt(nan, nan) == 0);
+    assert(br_le(nan, one) == 0 && br_le(one, nan) == 0 && br_le(nan, nan) == 0);
+    assert(br_gt(nan, one) == 0 && br_gt(one, nan) == 0 && br_gt(nan, nan) == 0);
+    assert(br_ge(nan, one) == 0 && br_ge(one, nan) == 0 && br_ge(nan, nan) == 0);
+    assert(br_eq(nan, one) == 0 && br_eq(one, nan) == 0 && br_eq(nan, nan) == 0);
+    assert(br_ne(nan, one) == 1 && br_ne(one, nan) == 1 && br_ne(nan, nan) == 1);
+    assert(br_lt(one, 2.0) == 1 && br_ge(one, one) == 1 && br_eq(one, one) == 1);
+    assert(br_ne(one, one) == 0 && br_gt(2.0, one) == 1 && br_le(2.0, one) == 0);
+
+    assert(br_not_lt(fnan, 1.0f) == 1 && br_not_lt(1.0f, fnan) == 1);
+    assert(br_not_lt(1.0f, 2.0f) == 0 && br_not_lt(2.0f, 1.0f) == 1);
+    assert(br_not_eq(fnan, fnan) == 1 && br_not_eq(1.0f, 1.0f) == 0);
+
+    assert(sel_lt(fnan, 1.0f) == 0 && sel_lt(1.0f, fnan) == 0 && sel_lt(1.0f, 2.0f) == 1);
+    assert(sel_ge(fnan, 1.0f) == 0 && sel_ge(1.0f, fnan) == 0 && sel_ge(2.0f, 2.0f) == 1);
+    assert(sel_eq(fnan, fnan) == 7 && sel_eq(1.0f, 1.0f) == 5);
+    assert(sel_ne(fnan, fnan) == 5 && sel_ne(1.0f, 1.0f) == 7);
+    assert(sel_min(nan, one) == one && sel_max(nan, one) == one);
+    assert(sel_min(one, 2.0) == one && sel_max(one, 2.0) == 2.0);
+    double m = sel_min(one, nan);
+    assert(m != m);
+
+    assert(loop_lt(0.0, 5.0) == 5 && loop_lt(nan, 5.0) == 0 && loop_lt(0.0, nan) == 0);
+    assert(loop_ne(one, one) == 0 && loop_ne(nan, nan) == 10);
+
+    assert(both(one, 2.0) == 11 && both(2.0, one) == 20 && both(nan, one) == 20);
+
+    SUCCESS;
+}
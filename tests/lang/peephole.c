@@ -0,0 +1,92 @@
+#include "test.h"
+
+// Adding or shifting by zero is not a no-op for 32-bit registers,
+// whose upper halves are cleared.
+unsigned long widen(unsigned a, int k)
+{
+    unsigned b = a + 0;
+    unsigned c = b << 0;
+    unsigned d = c - 0;
+    return (unsigned long)d + k;
+}
+
+unsigned long widen_shift(unsigned long a)
+{
+    unsigned b = (unsigned)(a >> 0);
+    return b;
+}
+
+// Comparisons with zero, signed and unsigned.
+int cmp_zero(int a, unsigned b, long c)
+{
+    int r = 0;
+    if (a < 0) r += 1;
+    if (a == 0) r += 2;
+    if (a > 0) r += 4;
+    if (b > 0) r += 8;
+    if (b <= 0) r += 16;
+    if (c >= 0) r += 32;
+    if (c != 0) r += 64;
+    return r;
+}
+
+// Zeros assigned between a comparison and its use.
+int zero_between(int a, int b)
+{
+    int z = 0;
+    int lt = a < b;
+    int w = 0;
+    return lt + z + w;
+}
+
+// Values swapped back and forth.
+int swap(int a, int b)
+{
+    int t = a;
+    a = b;
+    b = t;
+    t = a;
+    a = b;
+    b = t;
+    return a * 10 + b;
+}
+
+// A store and a reload in another size.
+union pun { long l; int i[2]; char c[8]; };
+
+int reload(long v)
+{
+    union pun p;
+    p.l = v;
+    int lo = p.i[0];
+    char c = p.c[0];
+    return lo + c;
+}
+
+int store_reload(int* p, int a)
+{
+    *p = a;
+    int b = *p;
+    *p = b + 1;
+    return *p + b;
+}
+
+int main()
+{
+    assert(widen(4294967295u, 1) == 4294967296);
+    assert(widen_shift(0x1ffffffff) == 4294967295u);
+
+    assert(cmp_zero(-1, 0, -1) == 1 + 16 + 64);
+    assert(cmp_zero(0, 1, 0) == 2 + 8 + 32);
+    assert(cmp_zero(5, 4294967295u, 4294967296) == 4 + 8 + 32 + 64);
+
+    assert(zero_between(1, 2) == 1 && zero_between(2, 1) == 0);
+    assert(swap(1, 2) == 12);
+
+    assert(reload(0x100000003) == 3 + 3);
+    assert(reload(-1) == -2);
+    int x = 0;
+    assert(store_reload(&x, 7) == 15 && x == 8);
+
+    SUCCESS;
+}
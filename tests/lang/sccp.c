@@ -0,0 +1,103 @@
+#include "test.h"
+
+int count = 0;
+void touch() { count++; }
+
+// The branch is decided by constants only, so the call is removed.
+int folded()
+{
+    int a = 3, b = 4;
+    int c = a * b - 2;
+    if (c != 10)
+        touch();
+    return c;
+}
+
+// Both paths give the same value to the phi.
+int same(int x)
+{
+    int r;
+    if (x > 5)
+        r = 2 + 3;
+    else
+        r = 10 / 2;
+    return r * x;
+}
+
+// A value is constant only along the executable edges.
+int loop(int n)
+{
+    int k = 1;
+    for (int i = 0; i < n; ++i)
+    {
+        if (k != 1)
+            k = 2;
+    }
+    return k;
+}
+
+int wrap()
+{
+    unsigned u = 4294967295u;
+    unsigned v = u + 2;
+    int s = -7;
+    unsigned char c = 300;
+    signed char d = 200;
+    return (v == 1) + (s / 2 == -3) * 2 + (s % 3 == -1) * 4 +
+        (c == 44) * 8 + (d == -56) * 16 + ((s >> 1) == -4) * 32 +
+        ((unsigned)s >> 28 == 15) * 64 + ((unsigned)s > 1u) * 128 + (s < 1) * 256;
+}
+
+// The division by zero is never executed, so it must not be folded.
+int guarded(int x)
+{
+    int zero = 0;
+    if (zero)
+        return x / zero;
+    return x;
+}
+
+int folded_switch()
+{
+    int k = 2;
+    switch (k * 3)
+    {
+    case 5: touch(); return 5;
+    case 6: return 6;
+    default: touch(); return 0;
+    }
+}
+
+double floats()
+{
+    double a = 0.1, b = 0.2;
+    float f = 16777217;
+    long l = (long)(a + b == 0.3) + (long)f;
+    return l + a * 10;
+}
+
+long wide()
+{
+    long a = 1;
+    a = a << 40;
+    unsigned long b = (unsigned long)-1 / 3;
+    int i = (int)(a >> 35);
+    return a + (b == 6148914691236517205ul) + i;
+}
+
+int main()
+{
+    assert(folded() == 10);
+    assert(same(7) == 35);
+    assert(same(1) == 5);
+    assert(loop(0) == 1);
+    assert(loop(10) == 1);
+    assert(wrap() == 511);
+    assert(guarded(9) == 9);
+    assert(folded_switch() == 6);
+    assert(floats() == 16777217.0);
+    assert(wide() == 1099511627776l + 1 + 32);
+    assert(count == 0);
+
+    SUCCESS;
+}
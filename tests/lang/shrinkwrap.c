@@ -0,0 +1,76 @@
+#include "test.h"
+
+int calls = 0;
+// Variadic functions aren't inlined, so the calls remain.
+int id(int a, ...) { calls++; return a; }
+
+// The fast path returns before any callee-saved register is used.
+int guarded(int* p, int n)
+{
+    if (!p)
+        return -1;
+    if (n <= 0)
+        return 0;
+    int a = id(*p), b = id(n), c = id(a + b);
+    return a + b + c + id(a * b);
+}
+
+// The slow path is in the middle, with exits on both sides of it.
+int middle(int n)
+{
+    if (n < 0)
+        return -n;
+    int s = n;
+    if (n > 10)
+    {
+        int a = id(n), b = id(n + 1);
+        s = a * b + id(a);
+    }
+    if (s == 0)
+        return 100;
+    return s;
+}
+
+// The region that clobbers the registers is a loop.
+int in_loop(int n, int k)
+{
+    if (k == 0)
+        return n;
+    int s = 0, t = 1;
+    for (int i = 0; i < n; ++i)
+    {
+        s += id(i) * k;
+        t += id(s);
+    }
+    return s + t;
+}
+
+// Many values in callee-saved registers of the caller
+// across calls to the functions above.
+int caller(int n)
+{
+    int x = 7;
+    int a = n + 1, b = n + 2, c = n + 3, d = n + 4, e = n + 5;
+    int r = guarded(0, 3) + guarded(&x, 0) + middle(-4) + in_loop(9, 0);
+    int s = guarded(&x, 2) + middle(12) + in_loop(3, 2);
+    return a + b + c + d + e + r + s;
+}
+
+int main()
+{
+    int x = 5;
+    assert(guarded(0, 1) == -1 && guarded(&x, 0) == 0);
+    assert(calls == 0);
+    assert(guarded(&x, 2) == 5 + 2 + 7 + 10 && calls == 4);
+
+    assert(middle(-3) == 3 && middle(0) == 100 && middle(4) == 4);
+    assert(calls == 4);
+    assert(middle(11) == 132 + 11 && calls == 7);
+
+    assert(in_loop(4, 0) == 4 && calls == 7);
+    assert(in_loop(3, 2) == 6 + 1 + 0 + 2 + 6 && calls == 13);
+
+    assert(caller(0) == 15 + 12 + 32 + 168 + 15);
+
+    SUCCESS;
+}
@@ -0,0 +1,79 @@
+#include "test.h"
+
+// More than 6 integers and 8 float-points, so the rest go on the stack.
+long ints(int a, int b, int c, int d, int e, int f, int g, long h, char i, short j)
+{
+    return a + b * 2 + c * 3 + d * 4 + e * 5 + f * 6 + g * 7 + h * 8 + i * 9 + j * 10;
+}
+
+double floats(double a, double b, double c, double d, double e,
+    double f, double g, double h, double i, float j, double k)
+{
+    return a + b * 2 + c * 3 + d * 4 + e * 5 + f * 6 +
+        g * 7 + h * 8 + i * 9 + j * 10 + k * 11;
+}
+
+double mixed(int a, double b, int c, double d, int e, double f, int g, double h,
+    int i, double j, int k, double l, int m, double n, int o, double p,
+    int q, double r, int s, double t)
+{
+    return a + b + c + d + e + f + g + h + i + j +
+        k + l + m + n + o + p + q + r + s + t;
+}
+
+struct big { long x; long y; long z; };
+
+long by_value(int a, int b, int c, int d, int e, int f, struct big s, int g)
+{
+    return a + b + c + d + e + f + s.x * 10 + s.y * 100 + s.z * 1000 + g;
+}
+
+// Leaf-like callers, each making a single call.
+long call_ints(int n) { return ints(n, n, n, n, n, n, n, 4294967296, 1, -1); }
+
+double call_floats(double x)
+{
+    return floats(x, x, x, x, x, x, x, x, x, 0.5f, -1.0);
+}
+
+double call_mixed(int n)
+{
+    return mixed(n, 0.5, n, 0.5, n, 0.5, n, 0.5, n, 0.5,
+        n, 0.5, n, 0.5, n, 0.5, n, 0.5, n, 0.5);
+}
+
+long call_by_value(int n)
+{
+    struct big s;
+    s.x = 1; s.y = 2; s.z = 3;
+    return by_value(n, n, n, n, n, n, s, 7);
+}
+
+// The arguments on the stack are themselves results of calls
+// with arguments on the stack.
+long nested(int n)
+{
+    return ints(n, n, n, n, n, n, (int)ints(1, 1, 1, 1, 1, 1, 1, 1, 1, 1),
+        ints(n, 0, 0, 0, 0, 0, 0, 0, 0, 0), 2, (short)call_ints(0));
+}
+
+// Calls in a loop, whose arguments change each iteration.
+double loop(int n)
+{
+    double s = 0.0;
+    for (int i = 0; i < n; ++i)
+        s += floats(i, i, i, i, i, i, i, i, i, 1.0f, i);
+    return s;
+}
+
+int main()
+{
+    assert(call_ints(1) == 28 + 34359738368 + 9 - 10);
+    assert(call_floats(1.0) == 45.0 + 5.0 - 11.0);
+    assert(call_mixed(2) == 20.0 + 5.0);
+    assert(call_by_value(1) == 6 + 3210 + 7);
+    assert(nested(1) == 21 + 7 * 55 + 8 + 18 - 10);
+    assert(loop(3) == 3 * 10.0 + 56.0 * 3);
+
+    SUCCESS;
+}
@@ -0,0 +1,63 @@
+// Addresses computed by geteleptr are folded into the loads and stores
+// using them as base + index * scale + displacement, loads extended right
+// after become movz or movs from memory, a scaled index added to something
+// becomes lea, and a load, op and store on the same address become the op
+// on memory, whose address is folded as well.
+
+int load_index(int* a, long i)
+{
+    return a[i];
+}
+
+long load_ext(int* a, long i)
+{
+    return a[i];
+}
+
+unsigned char_at(unsigned char* s, long i)
+{
+    return s[i];
+}
+
+struct point { int x; int y; };
+
+int field(struct point* p)
+{
+    return p->y;
+}
+
+void bump(int* a, long i, int v)
+{
+    a[i] += v;
+}
+
+long scaled_add(long a, long b)
+{
+    return a + b * 4;
+}
+
+// CHECK: load_index:
+// CHECK-NOT: leaq
+// CHECK: movl (%rdi, %rsi, 4),
+// CHECK: ret
+// CHECK: load_ext:
+// CHECK-NOT: leaq
+// CHECK: movslq (%rdi, %rsi, 4),
+// CHECK: ret
+// CHECK: char_at:
+// CHECK: movzbl (%rdi, %rsi, 1),
+// CHECK: ret
+// CHECK: field:
+// CHECK-NOT: leaq
+// CHECK: movl 4(%rdi),
+// CHECK: ret
+// CHECK: bump:
+// CHECK-NOT: leaq
+// CHECK-NOT: imul
+// CHECK: addl %esi, (%rdi, %rcx, 4)
+// CHECK-NOT: mov
+// CHECK: ret
+// CHECK: scaled_add:
+// CHECK-NOT: imul
+// CHECK: leaq (%rdi, %rsi, 4),
+// CHECK: ret
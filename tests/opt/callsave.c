@@ -0,0 +1,36 @@
+// Caller-saved registers are saved around a call only when they hold a
+// value still needed after it, and a value that spans a call goes to a
+// callee-saved register instead, which the prologue saves once.
+
+int ext(int);
+
+int dead_after(int a, int b)
+{
+    int t = a * b;
+    int r = ext(t);
+    return r + 1;
+}
+
+int live_across(int a, int b)
+{
+    int t = a * b;
+    int r = ext(a);
+    return r + t;
+}
+
+// CHECK: dead_after:
+// CHECK: imull
+// CHECK-NOT: push
+// CHECK: call ext
+// CHECK-NOT: pop
+// CHECK: addl $1
+// CHECK: ret
+// CHECK: live_across:
+// CHECK: pushq %rbx
+// CHECK: imull %esi, %ebx
+// CHECK-NOT: push
+// CHECK: call ext
+// CHECK-NOT: pop
+// CHECK: addl %ebx
+// CHECK: popq %rbx
+// CHECK: ret
@@ -0,0 +1,100 @@
+// Division and modulo by a constant are done without div or idiv: by a
+// multiply-high with a magic number and shifts, or for powers of two by
+// shifts and masks, biased toward zero when signed. Multiplication by a
+// constant uses lea or a shift where one does. Variable operands still
+// get imul and idiv.
+
+int div7(int x)
+{
+    return x / 7;
+}
+
+unsigned udiv10(unsigned x)
+{
+    return x / 10;
+}
+
+int mod8(int x)
+{
+    return x % 8;
+}
+
+unsigned umod16(unsigned x)
+{
+    return x % 16;
+}
+
+int div4(int x)
+{
+    return x / 4;
+}
+
+int mul9(int x)
+{
+    return x * 9;
+}
+
+int mul8(int x)
+{
+    return x * 8;
+}
+
+long mul3(long x)
+{
+    return x * 3;
+}
+
+int mul_var(int x, int y)
+{
+    return x * y;
+}
+
+int div_var(int x, int y)
+{
+    return x / y;
+}
+
+// CHECK: div7:
+// CHECK-NOT: div
+// CHECK: movl $2454267027, %eax
+// CHECK: imull
+// CHECK: sarl $2,
+// CHECK: sarl $31,
+// CHECK: ret
+// CHECK: udiv10:
+// CHECK-NOT: div
+// CHECK: movl $3435973837, %eax
+// CHECK: mull
+// CHECK: shrl $3,
+// CHECK: ret
+// CHECK: mod8:
+// CHECK-NOT: div
+// CHECK: shrl $29,
+// CHECK: andl $4294967288,
+// CHECK: ret
+// CHECK: umod16:
+// CHECK-NOT: div
+// CHECK: andl $15,
+// CHECK: ret
+// CHECK: div4:
+// CHECK-NOT: div
+// CHECK: shrl $30,
+// CHECK: sarl $2,
+// CHECK: ret
+// CHECK: mul9:
+// CHECK-NOT: imul
+// CHECK: leal (%rdi, %rdi, 8),
+// CHECK: ret
+// CHECK: mul8:
+// CHECK-NOT: imul
+// CHECK: shll $3,
+// CHECK: ret
+// CHECK: mul3:
+// CHECK-NOT: imul
+// CHECK: leaq (%rdi, %rdi, 2),
+// CHECK: ret
+// CHECK: mul_var:
+// CHECK: imull %esi,
+// CHECK: div_var:
+// CHECK: cltd
+// CHECK: idivl %esi
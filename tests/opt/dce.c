@@ -0,0 +1,53 @@
+// Values nobody uses are removed, blocks that only jump on are threaded
+// through and removed, and a block left with a single predecessor is
+// merged into it.
+
+int unused(int a, int b)
+{
+    int t = a * b;
+    int u = t + 7;
+    return a;
+}
+
+int unreachable(int a)
+{
+    if (a > 0)
+        return 1;
+    else
+        return 2;
+    a = a * 3;
+    return a;
+}
+
+int empty_blocks(int a)
+{
+    int r = a;
+    if (a)
+    {
+    }
+    else
+    {
+    }
+    return r;
+}
+
+// CHECK: Pass DCE in function @unused:
+// CHECK: Instructions removed: 2
+// CHECK: Pass DCE in function @unreachable:
+// CHECK: Blocks removed:
+// CHECK: Jumps threaded:
+// CHECK: Pass DCE in function @empty_blocks:
+// CHECK: Jumps threaded:
+// CHECK: Blocks merged:
+// CHECK: into 0
+
+// CHECK: unused:
+// CHECK-NOT: imull
+// CHECK: ret
+// CHECK: unreachable:
+// CHECK-NOT: $3
+// CHECK: ret
+// CHECK: empty_blocks:
+// CHECK-NOT: cmpl
+// CHECK-NOT: jmp
+// CHECK: ret
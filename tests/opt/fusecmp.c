@@ -0,0 +1,41 @@
+// A comparison used only by the branch right after it sets the flags
+// the branch jumps on, without a boolean materialized in between. A
+// comparison whose result is used as a value is still set to a register.
+
+int less(int a, int b, int x)
+{
+    if (a < b)
+        return x + 1;
+    return x - 1;
+}
+
+int fless(double a, double b)
+{
+    if (a < b)
+        return 1;
+    return 2;
+}
+
+int kept(int a, int b)
+{
+    int t = a > b;
+    return t + a;
+}
+
+// CHECK: less:
+// CHECK-NOT: set
+// CHECK: cmpl
+// CHECK-NOT: set
+// CHECK-NOT: test
+// CHECK: jge
+// CHECK: ret
+// CHECK: fless:
+// CHECK-NOT: set
+// CHECK: vucomisd
+// CHECK-NOT: set
+// CHECK: jbe
+// CHECK: ret
+// CHECK: kept:
+// CHECK: cmpl
+// CHECK: setg
+// CHECK: ret
@@ -0,0 +1,51 @@
+// Expressions computed again, in the same order or commuted, and ones
+// computed in a dominating block are replaced by the first value, while
+// expressions of the same operands in another order are kept apart.
+
+int redundant(int a, int b)
+{
+    int x = a * b + 3;
+    int y = a * b + 3;
+    return x ^ y;
+}
+
+int commuted(int a, int b)
+{
+    return (a + b) - (b + a);
+}
+
+int distinct(int a, int b)
+{
+    return (a - b) * (b - a);
+}
+
+int dominated(int a, int b, int c)
+{
+    int x = a * b;
+    if (c)
+        return a * b + 1;
+    return x;
+}
+
+// CHECK: Pass GVN in function @redundant:
+// CHECK: ->
+// CHECK: ->
+// CHECK: Pass GVN in function @commuted:
+// CHECK: ->
+// CHECK: Pass GVN in function @distinct:
+// CHECK-NOT: ->
+// CHECK: Pass GVN in function @dominated:
+// CHECK: ->
+
+// CHECK: redundant:
+// CHECK: imull
+// CHECK-NOT: imull
+// CHECK: ret
+// CHECK: commuted:
+// CHECK: addl
+// CHECK-NOT: addl
+// CHECK: ret
+// CHECK: dominated:
+// CHECK: imull
+// CHECK-NOT: imull
+// CHECK: ret
@@ -0,0 +1,39 @@
+// The int counters of loops indexing arrays are widened to 64 bits, so
+// there's no sign extension in the loop, and the address of the element
+// is bumped by its size each iteration instead of scaling the index.
+
+long sum_array(int* a, int n)
+{
+    long s = 0;
+    for (int i = 0; i < n; ++i)
+        s += a[i];
+    return s;
+}
+
+void scale(double* v, int n, double k)
+{
+    for (int i = 0; i < n; ++i)
+        v[i] = v[i] * k;
+}
+
+// CHECK: Pass IndVars in function @sum_array:
+// CHECK: Induction variables widened:
+// CHECK: to i64
+// CHECK: Addresses reduced:
+// CHECK: i32*
+// CHECK: Pass IndVars in function @scale:
+// CHECK: to i64
+// CHECK: Addresses reduced:
+// CHECK: f64*
+
+// CHECK: sum_array:
+// CHECK: .p2align
+// CHECK-NOT: ,4)
+// CHECK-NOT: movslq -
+// CHECK: leaq 4(
+// CHECK: ret
+// CHECK: scale:
+// CHECK: .p2align
+// CHECK-NOT: ,8)
+// CHECK: leaq 8(
+// CHECK: ret
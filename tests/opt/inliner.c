@@ -0,0 +1,56 @@
+// Small callees are inlined, including the calls they got inlined into
+// them, while a recursive function is inlined into its callers once and
+// never into itself.
+
+struct point { int x; int y; };
+
+static int get_x(struct point* p) { return p->x; }
+static int get_y(struct point* p) { return p->y; }
+
+int manhattan(struct point* p)
+{
+    return get_x(p) + get_y(p);
+}
+
+static int square(int a) { return a * a; }
+static int sum_squares(int a, int b) { return square(a) + square(b); }
+
+int nested(int a, int b)
+{
+    return sum_squares(a, b) + 1;
+}
+
+int fact(int n)
+{
+    return n <= 1 ? 1 : n * fact(n - 1);
+}
+
+int use_fact(int n)
+{
+    return fact(n) + 1;
+}
+
+// CHECK: Pass Inliner:
+// CHECK: Calls inlined:
+// CHECK-NOT: of @fact
+// CHECK: in block 0 of @manhattan
+// CHECK: in block 0 of @manhattan
+// CHECK: @square in block 0 of @sum_squares
+// CHECK: @square in block 0 of @sum_squares
+// CHECK: @sum_squares in block 0 of @nested
+// CHECK: @fact in block 0 of @use_fact
+
+// CHECK: manhattan:
+// CHECK-NOT: call
+// CHECK: ret
+// CHECK: nested:
+// CHECK-NOT: call
+// CHECK: imull
+// CHECK: imull
+// CHECK: ret
+// CHECK: fact:
+// CHECK: call fact
+// CHECK: use_fact:
+// CHECK: call fact
+// CHECK-NOT: call
+// CHECK: ret
@@ -0,0 +1,56 @@
+// Loops are rotated so the test is at the bottom, entered by a jump to
+// it, and their tops are aligned. A loop iteration then takes a single
+// branch. An unlikely exit from the loop goes after the function's
+// return, so the hot path falls through.
+
+int count_up(int n)
+{
+    int c = 0;
+    for (int i = 0; i < n; ++i)
+        c += i;
+    return c;
+}
+
+int checked_sum(int n, int bad)
+{
+    int s = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        if (i == bad)
+            return -s;
+        s += i;
+    }
+    return s;
+}
+
+// CHECK: Pass BlockLayout in function @count_up:
+// CHECK: Block order
+// CHECK:  *
+// CHECK: Rotated loops:
+// CHECK: Pass BlockLayout in function @checked_sum:
+// CHECK: Block order
+// CHECK:  *
+// CHECK: Rotated loops:
+
+// CHECK: count_up:
+// CHECK: jmp .L1
+// CHECK: .p2align
+// CHECK: .L2:
+// CHECK-NOT: jmp
+// CHECK: .L1:
+// CHECK: cmpl
+// CHECK: jl .L2
+// CHECK-NOT: jmp
+// CHECK: ret
+// CHECK: checked_sum:
+// CHECK: jmp .L5
+// CHECK: .p2align
+// CHECK: .L6:
+// CHECK: je .L7
+// CHECK-NOT: jmp
+// CHECK: .L5:
+// CHECK: jl .L6
+// CHECK-NOT: jmp
+// CHECK: ret
+// CHECK: .L7:
+// CHECK: jmp .L9
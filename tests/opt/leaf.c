@@ -0,0 +1,43 @@
+// Leaf functions set up no frame: they keep no frame pointer, address
+// their locals from rsp in the red zone below it and never adjust rsp.
+// A function making a call still gets its frame.
+
+int add3(int a, int b, int c)
+{
+    return a + b + c;
+}
+
+int sum_array(int n)
+{
+    int a[4];
+    for (int i = 0; i < 4; ++i)
+        a[i] = i * n;
+    return a[0] + a[1] + a[2] + a[3];
+}
+
+int ext(int);
+
+int non_leaf(int x)
+{
+    return ext(x) + 1;
+}
+
+// CHECK: add3:
+// CHECK-NOT: %rbp
+// CHECK-NOT: %rsp
+// CHECK: ret
+// CHECK: sum_array:
+// CHECK-NOT: %rbp
+// CHECK-NOT: , %rsp
+// CHECK: leaq -24(%rsp)
+// CHECK-NOT: %rbp
+// CHECK-NOT: , %rsp
+// CHECK: movl -24(%rsp)
+// CHECK-NOT: %rbp
+// CHECK: ret
+// CHECK: non_leaf:
+// CHECK: pushq %rbp
+// CHECK: movq %rsp, %rbp
+// CHECK: call ext
+// CHECK: leave
+// CHECK: ret
@@ -0,0 +1,43 @@
+// Locals are promoted to registers, with phis where their definitions
+// meet. A local whose address is taken stays in memory, while the
+// pointer holding its address is promoted.
+
+int select_max(int a, int b)
+{
+    int m = a;
+    if (b > a)
+        m = b;
+    return m;
+}
+
+int sum_to(int n)
+{
+    int s = 0;
+    for (int i = 1; i <= n; ++i)
+        s += i;
+    return s;
+}
+
+int escaped(int a)
+{
+    int x = a;
+    int* p = &x;
+    *p += 1;
+    return x;
+}
+
+// CHECK: Pass Mem2Reg in function @select_max:
+// CHECK: Phi instructions inserted:
+// CHECK: = phi i32
+
+// CHECK: Pass Mem2Reg in function @sum_to:
+// CHECK: Phi instructions inserted:
+// CHECK: = phi i32
+// CHECK: = phi i32
+
+// CHECK: Pass Mem2Reg in function @escaped:
+// CHECK: %6
+// CHECK-NOT: %4
+// CHECK: Phi instructions inserted:
+// CHECK-NOT: = phi
+// CHECK: .globl escaped
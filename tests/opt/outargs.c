@@ -0,0 +1,29 @@
+// Arguments passed on the stack are written with mov into an area the
+// prologue reserves once, so rsp stays put between calls, with no push
+// or rsp adjustment around each of them.
+
+int many(int a, int b, int c, int d, int e, int f, int g, int h);
+
+int two_calls(int x)
+{
+    int r = many(x, 1, 2, 3, 4, 5, 6, 7);
+    return r + many(r, x, 2, 3, 4, 5, x, 8);
+}
+
+// CHECK: two_calls:
+// CHECK: subq $16, %rsp
+// CHECK-NOT: push
+// CHECK-NOT: , %rsp
+// CHECK: movq $7, 8(%rsp)
+// CHECK-NOT: push
+// CHECK-NOT: , %rsp
+// CHECK: call many
+// CHECK-NOT: push
+// CHECK-NOT: , %rsp
+// CHECK: movq $8, 8(%rsp)
+// CHECK-NOT: push
+// CHECK-NOT: , %rsp
+// CHECK: call many
+// CHECK-NOT: , %rsp
+// CHECK: addq $16, %rsp
+// CHECK: ret
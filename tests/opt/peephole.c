@@ -0,0 +1,69 @@
+// The peephole optimizer rewrites the code CodeGen emits at -O1 and
+// reports how many times each of its rules fired: reloads of a slot
+// just stored become register moves, compares with zero become tests,
+// zeroed registers are xored, and jumps to the next label are dropped.
+
+int ext(int);
+
+int store_reload(int a, int b, int c)
+{
+    int t1 = a * b, t2 = b * c, t3 = c * a, t4 = a * a, t5 = b * b, t6 = c * c;
+    int r = ext(a);
+    return r + t1 + t2 + t3 + t4 + t5 + t6;
+}
+
+int skip_odd(int n)
+{
+    int s = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        if (i & 1)
+            continue;
+        s += i;
+    }
+    return s;
+}
+
+int call_zero(void)
+{
+    return ext(0) + 1;
+}
+
+int abs_val(int x)
+{
+    if (x > 0)
+        return x;
+    return -x;
+}
+
+// CHECK: Pass Peephole in function @store_reload:
+// CHECK: store-reload : 4
+// CHECK: total : 5
+// CHECK: Pass Peephole in function @skip_odd:
+// CHECK: cmp-zero : 1
+// CHECK: jump-to-next : 3
+// CHECK: Pass Peephole in function @call_zero:
+// CHECK: zero-reg : 1
+// CHECK: Pass Peephole in function @abs_val:
+// CHECK: branch-over-jump : 1
+
+// CHECK: store_reload:
+// CHECK: movl %eax, -16(%rbp)
+// CHECK-NOT: , %eax
+// CHECK: movl %eax, %eax
+// CHECK: imull -4(%rbp), %eax
+// CHECK: call ext
+// CHECK: skip_odd:
+// CHECK-NOT: cmpl $0
+// CHECK: testl %ebx, %ebx
+// CHECK-NOT: jmp .L4
+// CHECK: .L4:
+// CHECK: call_zero:
+// CHECK-NOT: movl $0
+// CHECK: xorl %edi, %edi
+// CHECK: call ext
+// CHECK: abs_val:
+// CHECK: jle
+// CHECK-NOT: jmp .L10
+// CHECK: .L10:
+// CHECK: ret
@@ -0,0 +1,46 @@
+// Constants are propagated through arithmetic, branches on them are
+// folded along with the blocks they make unreachable, and a value kept
+// the same around a loop is still known to be constant after it.
+
+int folded(void)
+{
+    int a = 6;
+    int b = a * 7;
+    return b - 2;
+}
+
+int dead_branch(int x)
+{
+    int k = 3;
+    if (k > 5)
+        x = x * 100;
+    return x + k;
+}
+
+int loop_const(int n)
+{
+    int c = 4;
+    for (int i = 0; i < n; ++i)
+        c = c * 1;
+    return c;
+}
+
+// CHECK: Pass SCCP in function @folded:
+// CHECK: = i32 42
+// CHECK: Pass SCCP in function @dead_branch:
+// CHECK: Branches folded:
+// CHECK: br i8
+// CHECK: Blocks removed:
+// CHECK: Pass SCCP in function @loop_const:
+// CHECK: = i32 4
+
+// CHECK: folded:
+// CHECK: movl $40, %eax
+// CHECK: ret
+// CHECK: dead_branch:
+// CHECK-NOT: $100
+// CHECK: ret
+// CHECK: loop_const:
+// CHECK-NOT: imul
+// CHECK: movl $4, %eax
+// CHECK: ret
@@ -0,0 +1,32 @@
+// A callee-saved register used only past a guard clause is saved and
+// restored there, so the fast path skips both. One holding a parameter
+// is still saved in the prologue, since the parameter is homed there.
+
+int ext(int);
+
+int guarded(int x, int y)
+{
+    if (x < 0)
+        return y;
+    int t = x * y;
+    int r = ext(x);
+    return r + t;
+}
+
+// CHECK: Pass ShrinkWrap in function @guarded:
+// CHECK: %rbx :
+// CHECK: %r12 : prologue
+
+// CHECK: guarded:
+// CHECK-NOT: %rbx
+// CHECK: movq %r12,
+// CHECK-NOT: %rbx
+// CHECK: jge
+// CHECK-NOT: %rbx
+// CHECK: jmp
+// CHECK: movq %rbx,
+// CHECK: call ext
+// CHECK: , %rbx
+// CHECK-NOT: %rbx
+// CHECK: , %r12
+// CHECK: ret
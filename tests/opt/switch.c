@@ -0,0 +1,66 @@
+// Dense switches, whether their cases start at zero or below it, jump
+// through a table, while sparse ones search their cases in halves.
+
+int dense(int x)
+{
+    switch (x)
+    {
+    case 0: return 10;
+    case 1: return 21;
+    case 2: return 32;
+    case 3: return 43;
+    case 4: return 54;
+    case 5: return 65;
+    default: return -1;
+    }
+}
+
+int negative(int x)
+{
+    switch (x)
+    {
+    case -3: return 1;
+    case -2: return 2;
+    case -1: return 3;
+    case 0: return 4;
+    case 1: return 5;
+    case 2: return 6;
+    default: return 0;
+    }
+}
+
+int sparse(int x)
+{
+    switch (x)
+    {
+    case 1: return 1;
+    case 100: return 2;
+    case 1000: return 3;
+    case 10000: return 4;
+    case 100000: return 5;
+    case 1000000: return 6;
+    default: return 0;
+    }
+}
+
+// CHECK: dense:
+// CHECK: cmpq $5,
+// CHECK: ja
+// CHECK: jmp *
+// CHECK: negative:
+// CHECK: subq
+// CHECK: cmpq $5,
+// CHECK: jmp *
+// CHECK: sparse:
+// CHECK: cmpq $10000,
+// CHECK: jl
+// CHECK-NOT: jmp *
+// CHECK: .section .rodata
+// CHECK: .long
+// CHECK: .long
+// CHECK: .long
+// CHECK: .long
+// CHECK: .long
+// CHECK: .long
+// CHECK: .align
+// CHECK: .long
@@ -0,0 +1,57 @@
+// Self tail calls become loops, a tail call to another function becomes
+// a jump after the frame is torn down, and a call whose result is still
+// used after it stays a call.
+
+int gcd(int a, int b)
+{
+    if (b == 0)
+        return a;
+    return gcd(b, a % b);
+}
+
+int sum(int n, int acc)
+{
+    if (n == 0)
+        return acc;
+    return sum(n - 1, acc + n);
+}
+
+int helper(int x);
+
+int tail_other(int x)
+{
+    return helper(x + 1);
+}
+
+int not_tail(int n)
+{
+    if (n == 0)
+        return 0;
+    return 1 + not_tail(n - 1);
+}
+
+// CHECK: Pass TailRecursion in function @gcd:
+// CHECK: Tail calls eliminated:
+// CHECK: 10
+// CHECK: Pass TailRecursion in function @sum:
+// CHECK: Tail calls eliminated:
+// CHECK: 10
+// CHECK: Pass TailRecursion in function @not_tail:
+// CHECK: Tail calls eliminated:
+
+// CHECK: gcd:
+// CHECK-NOT: call
+// CHECK: .p2align
+// CHECK: idivl
+// CHECK: jne
+// CHECK: ret
+// CHECK: sum:
+// CHECK-NOT: call
+// CHECK: ret
+// CHECK: tail_other:
+// CHECK-NOT: call
+// CHECK: leave
+// CHECK: jmp helper
+// CHECK: not_tail:
+// CHECK: call not_tail
+// CHECK: ret
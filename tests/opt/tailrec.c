@@ -0,0 +1,77 @@
+#include "test.h"
+
+// The recursions are deeper than the stack allows,
+// unless the tail calls are turned into loops or jumps.
+#define DEPTH 10000000
+
+long sum(long n, long acc)
+{
+    if (n == 0)
+        return acc;
+    return sum(n - 1, acc + n);
+}
+
+// The tail call is in an arm of a ?:, which joins at a phi.
+int count(int n, int acc)
+{
+    return n == 0 ? acc : count(n - 1, acc + (n & 1));
+}
+
+double dsum(int n, double acc)
+{
+    if (n <= 0)
+        return acc;
+    return dsum(n - 1, acc + 0.5);
+}
+
+int g = 0;
+void walk(int n)
+{
+    if (n == 0)
+        return;
+    g++;
+    walk(n - 1);
+}
+
+unsigned gcd(unsigned a, unsigned b)
+{
+    if (b == 0)
+        return a;
+    return gcd(b, a % b);
+}
+
+// Mutual recursion, where the calls jump to each other.
+int is_even(int n);
+int is_odd(int n) { if (n == 0) return 0; return is_even(n - 1); }
+int is_even(int n) { if (n == 0) return 1; return is_odd(n - 1); }
+
+// The parameters are swapped on each call.
+int swap(int n, int a, int b)
+{
+    if (n == 0)
+        return a * 10 + b;
+    return swap(n - 1, b, a);
+}
+
+// Not a tail call, but recursive all the same.
+long fact(int n)
+{
+    if (n <= 1)
+        return 1;
+    return n * fact(n - 1);
+}
+
+int main()
+{
+    assert(sum(DEPTH, 0) == 50000005000000);
+    assert(count(DEPTH, 0) == DEPTH / 2);
+    assert(dsum(DEPTH, 0.0) == DEPTH / 2);
+    walk(DEPTH);
+    assert(g == DEPTH);
+    assert(gcd(1071, 462) == 21 && gcd(17, 5) == 1 && gcd(0, 9) == 0 + 9);
+    assert(is_even(DEPTH) == 1 && is_odd(DEPTH + 1) == 1 && is_odd(DEPTH) == 0);
+    assert(swap(DEPTH, 1, 2) == 12 && swap(DEPTH + 1, 1, 2) == 21);
+    assert(fact(15) == 1307674368000);
+
+    SUCCESS;
+}
@@ -0,0 +1,46 @@
+// Loads of volatile objects stay in the loop, while the same load of
+// an object that isn't volatile is hoisted into the preheader.
+
+int plain;
+volatile int flag;
+
+int poll_plain(int n)
+{
+    int s = 0;
+    for (int i = 0; i < n; ++i)
+        s += plain;
+    return s;
+}
+
+int poll_flag(int n)
+{
+    int s = 0;
+    for (int i = 0; i < n; ++i)
+        s += flag;
+    return s;
+}
+
+int poll_ptr(volatile int* p, int n)
+{
+    int s = 0;
+    for (int i = 0; i < n; ++i)
+        s += *p;
+    return s;
+}
+
+// CHECK: poll_plain:
+// CHECK: plain(%rip)
+// CHECK: .p2align
+// CHECK-NOT: plain(%rip)
+// CHECK: ret
+
+// CHECK: poll_flag:
+// CHECK-NOT: flag(%rip)
+// CHECK: .p2align
+// CHECK: flag(%rip)
+// CHECK: ret
+
+// CHECK: poll_ptr:
+// CHECK: .p2align
+// CHECK: (%
+// CHECK: ret
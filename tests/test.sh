@@ -73,16 +73,86 @@ report_failure() {
     fail=$((fail + 1))
 }
 
+# two arguments
+# first argument: source file with the patterns
+# second argument: output to match the patterns against
+# Each "// CHECK: text" in the source must be found in the output
+# after the line the previous one is found in, and no "// CHECK-NOT:
+# text" may be found between the lines the CHECKs around it match.
+match_patterns() {
+    awk '
+    function clean(from, to,    k, l) {
+        for (k = 1; k <= nots; ++k)
+            for (l = from; l < to; ++l)
+                if (index(out[l], notpat[k])) {
+                    print "unexpected \"" notpat[k] "\" at line " l
+                    return 0
+                }
+        return 1
+    }
+    FNR == NR {
+        if (match($0, /\/\/ CHECK(-NOT)?:[ \t]*/)) {
+            kind[++n] = index(substr($0, RSTART, RLENGTH), "-NOT") ? "not" : "check"
+            pat[n] = substr($0, RSTART + RLENGTH)
+            sub(/[ \t]+$/, "", pat[n])
+        }
+        next
+    }
+    { out[++m] = $0 }
+    END {
+        pos = 1
+        for (i = 1; i <= n; ++i) {
+            if (kind[i] == "not") {
+                notpat[++nots] = pat[i]
+                continue
+            }
+            for (j = pos; j <= m && !index(out[j], pat[i]); ++j)
+                ;
+            if (j > m) {
+                print "missing \"" pat[i] "\""
+                exit 1
+            }
+            if (!clean(pos, j))
+                exit 1
+            nots = 0
+            pos = j + 1
+        }
+        if (!clean(pos, m + 1))
+            exit 1
+    }' "$1" "$2"
+}
+
 # three arguments
 # first argument: name of the test
 # second argument: source files included by this test
 # thrid argument: disable output of a.out or not
+# A test whose source has CHECK patterns isn't run. Instead, the output
+# of the compiler, that is, the pass summaries it prints followed by the
+# assembly, is matched against the patterns.
 test_file() {
     GREEN="\033[0;32m"
     RED="\033[0;31m"
     RESET="\033[0;0m"
 
     echo -n "testing $1... "
+    local source=($2)
+    if grep -q "// CHECK" "${source[0]}"; then
+        eval "$gk -I ../../tests $2 -S -o out.s" > out.txt
+        cat out.s >> out.txt 2> /dev/null
+        if [[ $3 == 0 ]]; then
+            match_patterns "${source[0]}" out.txt > /dev/null
+        else
+            match_patterns "${source[0]}" out.txt
+        fi
+        if [[ $? == 0 ]]; then
+            report_success
+        else
+            report_failure
+        fi
+        rm -f out.s out.txt
+        return
+    fi
+
     eval "$gk -I ../../tests $2 -o a.out"
     if ! [[ -f "a.out" ]]; then
         report_failure
@@ -103,6 +173,24 @@ test_file() {
     rm a.out
 }
 
+# three arguments, the same as test_file
+# If the current directory has flags.txt, the test is run once with
+# each line of it added to the arguments.
+test_with_flags() {
+    if ! [[ -f "flags.txt" ]]; then
+        test_file "$1" "$2" $3
+        return
+    fi
+
+    local flags=()
+    while IFS= read -r line; do
+        flags+=("$line")
+    done < "flags.txt"
+    for f in "${flags[@]}"; do
+        test_file "$1 [$f]" "$2 $f" $3
+    done
+}
+
 # one argument
 # first: directory name
 test_dir() {
@@ -113,15 +201,16 @@ test_dir() {
     fi
 
     while IFS= read -r line; do
-        local name="${line[0]}"
-        local args="${word[@]:1}"
+        local words=($line)
+        local name="${words[0]}"
+        local args="${words[@]:1}"
         local filename=""
         if [[ -z "$args" ]]; then
             filename="${name}.c"
         else
             filename="$args"
         fi
-        test_file "$name" "$filename" 0
+        test_with_flags "$name" "$filename" 0
     done < "hints.txt"
     cd ..
 }
@@ -135,11 +224,11 @@ run_ginkgo() {
         test_dir "$1"
     else # in some subdirectory?
         find_dir
-        for d in $dirs; do
+        for d in "${dirs[@]}"; do
             find_test "$d" "$1"
             if [[ $? == 1 ]]; then
                 cd "$d"
-                test_file "$1" "$filename" 1
+                test_with_flags "$1" "$filename" 1
                 cd ..
                 break
             fi
@@ -159,7 +248,7 @@ fi
 # no argument - run all the tests
 if [[ $# == 0 ]]; then
     find_dir
-    for d in $dirs; do
+    for d in "${dirs[@]}"; do
         run_ginkgo "$d"
     done
 else